@@ -25,6 +25,7 @@
 #include "common/textconsole.h"
 
 #include "audio/mixer_intern.h"
+#include "audio/mixer_kernels.h"
 #include "audio/rate.h"
 #include "audio/audiostream.h"
 #include "audio/timestamp.h"
@@ -46,15 +47,17 @@ public:
 	~Channel();
 
 	/**
-	 * Mixes the channel's samples into the given buffer.
+	 * Mixes the channel's samples into the given accumulation buffer.
 	 *
-	 * @param data buffer where to mix the data
-	 * @param len  number of sample *pairs*. So a value of
-	 *             10 means that the buffer contains twice 10 sample, each
-	 *             16 bits, for a total of 40 bytes.
+	 * @param data       buffer where to mix the data
+	 * @param len        number of sample *pairs*. So a value of
+	 *                   10 means that the buffer contains twice 10 samples, each
+	 *                   32 bits, for a total of 80 bytes.
+	 * @param firstBlock whether this is the first block of a mixer callback,
+	 *                   which is where the elapsed time is measured from
 	 * @return number of sample pairs processed (which can still be silence!)
 	 */
-	int mix(int16 *data, uint len);
+	int mix(int32 *data, uint len, bool firstBlock);
 
 	/**
 	 * Queries whether the channel is still playing or not.
@@ -78,14 +81,20 @@ public:
 	 *
 	 * @param paused true, when the channel should be paused.
 	 *               false when it should be unpaused.
+	 * @param time   the time the request was made at, in milliseconds.
 	 */
-	void pause(bool paused);
+	void pause(bool paused, uint32 time);
 
 	/**
 	 * Queries whether the channel is currently paused.
 	 */
 	bool isPaused() const { return (_pauseLevel != 0); }
 
+	/**
+	 * Queries how many times the channel has been paused.
+	 */
+	int getPauseLevel() const { return _pauseLevel; }
+
 	/**
 	 * Sets the channel's own volume.
 	 *
@@ -141,9 +150,12 @@ public:
 	void notifyGlobalVolChange() { updateChannelVolumes(); }
 
 	/**
-	 * Queries how long the channel has been playing.
+	 * Queries the state used to compute how long the channel has been playing.
 	 */
-	Timestamp getElapsedTime();
+	uint32 getSamplesConsumed() const { return _samplesConsumed; }
+	uint32 getMixerTimeStamp() const { return _mixerTimeStamp; }
+	uint32 getPauseStartTime() const { return _pauseStartTime; }
+	uint32 getPauseTime() const { return _pauseTime; }
 
 	/**
 	 * Replaces the channel's stream with a version that loops indefinitely.
@@ -197,12 +209,23 @@ private:
 #pragma mark -
 
 MixerImpl::MixerImpl(uint sampleRate, bool stereo, uint outBufSize)
-	: _mutex(), _sampleRate(sampleRate), _stereo(stereo), _outBufSize(outBufSize), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _sampleRate(sampleRate), _stereo(stereo), _outBufSize(outBufSize), _mixerReady(false), _handleSeed(0), _soundTypeSettings(),
+	  _commandRead(0), _commandWrite(0), _commandsOverflowed(false) {
 
 	assert(sampleRate > 0);
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	for (int i = 0; i != NUM_CHANNELS; i++) {
 		_channels[i] = nullptr;
+		_channelStates[i].handle = 0xffffffff;
+	}
+
+	// Allocate the accumulation buffer up front, so that the audio callback
+	// never has to allocate memory
+	_mixBuffer.resize((outBufSize > 0 ? outBufSize : (uint)DEFAULT_MIX_FRAMES) * (stereo ? 2 : 1));
+
+	// The callback cannot run yet, so the kernels are selected before any
+	// thread uses them
+	MixerKernels::init();
 }
 
 MixerImpl::~MixerImpl() {
@@ -251,6 +274,141 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	_handleSeed++;
 	if (handle)
 		*handle = chanHandle;
+
+	ChannelState &state = _channelStates[index];
+	state.handle = chanHandle._val;
+	state.volume = chan->getVolume();
+	state.balance = chan->getBalance();
+	state.rate = state.nativeRate = chan->getRate();
+	publishElapsedTime(index);
+}
+
+void MixerImpl::removeChannel(int index) {
+	_channelStates[index].handle = 0xffffffff;
+	delete _channels[index];
+	_channels[index] = nullptr;
+}
+
+int MixerImpl::findChannel(SoundHandle handle) const {
+	const int index = handle._val % NUM_CHANNELS;
+	if (_channelStates[index].handle != handle._val)
+		return -1;
+	return index;
+}
+
+void MixerImpl::queueCommand(Command::Type type, SoundHandle handle, int32 value) {
+	const uint32 time = (type == Command::kPause) ? g_system->getMillis(true) : 0;
+
+	Common::StackLock commandLock(_commandMutex);
+
+	// Simply ignore requests for sounds that already terminated
+	const int index = findChannel(handle);
+	if (index == -1)
+		return;
+
+	ChannelState &state = _channelStates[index];
+	switch (type) {
+	case Command::kSetVolume:
+		state.volume = value;
+		break;
+	case Command::kSetBalance:
+		state.balance = value;
+		break;
+	case Command::kSetRate:
+		state.rate = value;
+		break;
+	case Command::kResetRate:
+		state.rate = state.nativeRate;
+		break;
+	case Command::kPause:
+		// The same as Channel::pause()
+		if (value) {
+			if (++state.pauseLevel == 1)
+				state.pauseStartTime = time;
+		} else if (state.pauseLevel > 0) {
+			if (!--state.pauseLevel) {
+				state.pauseTime = time - state.pauseStartTime;
+				state.pauseStartTime = 0;
+			}
+		}
+		break;
+	default:
+		break;
+	}
+
+	Command cmd;
+	cmd.type = type;
+	cmd.handle = handle._val;
+	cmd.value = value;
+	cmd.time = time;
+
+	// The audio callback is not keeping up (or not running at all), so keep
+	// the command until the callback takes it along with the ring
+	const uint write = _commandWrite.load(std::memory_order_relaxed);
+	if (!_overflowCommands.empty() || write - _commandRead.load(std::memory_order_acquire) >= COMMAND_QUEUE_SIZE) {
+		_overflowCommands.push_back(cmd);
+		_commandsOverflowed.store(true, std::memory_order_release);
+		return;
+	}
+
+	_commands[write % COMMAND_QUEUE_SIZE] = cmd;
+	_commandWrite.store(write + 1, std::memory_order_release);
+}
+
+void MixerImpl::applyCommand(const Command &cmd) {
+	// Ignore commands for sounds that already terminated
+	const int index = cmd.handle % NUM_CHANNELS;
+	if (!_channels[index] || _channels[index]->getHandle()._val != cmd.handle)
+		return;
+
+	Channel *chan = _channels[index];
+	switch (cmd.type) {
+	case Command::kSetVolume:
+		chan->setVolume(cmd.value);
+		break;
+	case Command::kSetBalance:
+		chan->setBalance(cmd.value);
+		break;
+	case Command::kSetRate:
+		chan->setRate(cmd.value);
+		break;
+	case Command::kResetRate:
+		chan->resetRate();
+		break;
+	case Command::kPause:
+		chan->pause(cmd.value != 0, cmd.time);
+		break;
+	default:
+		break;
+	}
+}
+
+void MixerImpl::processQueuedCommands() {
+	const uint write = _commandWrite.load(std::memory_order_acquire);
+	uint read = _commandRead.load(std::memory_order_relaxed);
+	for (; read != write; read++)
+		applyCommand(_commands[read % COMMAND_QUEUE_SIZE]);
+	_commandRead.store(read, std::memory_order_release);
+}
+
+void MixerImpl::processCommands() {
+	processQueuedCommands();
+
+	for (uint i = 0; i < _overflowCommands.size(); i++)
+		applyCommand(_overflowCommands[i]);
+	_overflowCommands.clear();
+	_commandsOverflowed.store(false, std::memory_order_relaxed);
+}
+
+void MixerImpl::publishElapsedTime(int index) {
+	const Channel *chan = _channels[index];
+	ChannelState &state = _channelStates[index];
+
+	state.samplesConsumed = chan->getSamplesConsumed();
+	state.mixerTimeStamp = chan->getMixerTimeStamp();
+	state.pauseStartTime = chan->getPauseStartTime();
+	state.pauseTime = chan->getPauseTime();
+	state.pauseLevel = chan->getPauseLevel();
 }
 
 void MixerImpl::playStream(
@@ -262,6 +420,7 @@ void MixerImpl::playStream(
 			bool permanent,
 			bool reverseStereo) {
 	Common::StackLock lock(_mutex);
+	Common::StackLock commandLock(_commandMutex);
 
 	if (stream == nullptr) {
 		warning("stream is 0");
@@ -308,10 +467,8 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	// Since the mixer callback has been called, the mixer must be ready...
 	_mixerReady = true;
 
-	//  zero the buf
-	memset(buf, 0, len);
-
 	// we store 16-bit samples
+	const uint numOutChannels = _stereo ? 2 : 1;
 	if (_stereo) {
 		assert(len % 4 == 0);
 		len >>= 2;
@@ -320,54 +477,91 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 		len >>= 1;
 	}
 
-	// mix all channels
-	int res = 0, tmp;
-	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i]) {
-			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = nullptr;
-			} else if (!_channels[i]->isPaused()) {
-				tmp = _channels[i]->mix(buf, len);
-
-				if (tmp > res)
-					res = tmp;
+	// Apply the channel changes requested since the last callback. Only
+	// when the ring overflowed, this has to wait for the engine threads.
+	if (_commandsOverflowed.load(std::memory_order_acquire)) {
+		Common::StackLock commandLock(_commandMutex);
+		processCommands();
+	} else {
+		processQueuedCommands();
+	}
+
+	// mix all channels, one block of the accumulation buffer at a time
+	int32 *mixBuf = _mixBuffer.data();
+	const uint blockLen = _mixBuffer.size() / numOutChannels;
+	int res = 0;
+	for (uint pos = 0; pos < len; pos += blockLen) {
+		const uint count = MIN(blockLen, len - pos);
+		memset(mixBuf, 0, count * numOutChannels * sizeof(int32));
+
+		int blockRes = 0, tmp;
+		for (int i = 0; i != NUM_CHANNELS; i++)
+			if (_channels[i] && !_channels[i]->isPaused()) {
+				tmp = _channels[i]->mix(mixBuf, count, pos == 0);
+
+				if (tmp > blockRes)
+					blockRes = tmp;
 			}
+
+		// saturate the mixed samples to 16-bit once all channels were added
+		MixerKernels::clamp(buf + pos * numOutChannels, mixBuf, count * numOutChannels);
+		res += blockRes;
+	}
+
+	{
+		Common::StackLock commandLock(_commandMutex);
+
+		// Also apply the changes requested while mixing, so that the timing
+		// state is published together with any pause requests
+		processCommands();
+
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (!_channels[i])
+				continue;
+			if (_channels[i]->isFinished())
+				removeChannel(i);
+			else
+				publishElapsedTime(i);
 		}
+	}
 
 	return res;
 }
 
 void MixerImpl::stopAll() {
 	Common::StackLock lock(_mutex);
+	Common::StackLock commandLock(_commandMutex);
+	processCommands();
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != nullptr && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = nullptr;
+			removeChannel(i);
 		}
 	}
 }
 
 void MixerImpl::stopID(int id) {
 	Common::StackLock lock(_mutex);
+	Common::StackLock commandLock(_commandMutex);
+	processCommands();
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != nullptr && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = nullptr;
+			removeChannel(i);
 		}
 	}
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
 	// Simply ignore stop requests for handles of sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (!isSoundHandleActive(handle))
 		return;
 
-	delete _channels[index];
-	_channels[index] = nullptr;
+	Common::StackLock lock(_mutex);
+	Common::StackLock commandLock(_commandMutex);
+	processCommands();
+
+	const int index = findChannel(handle);
+	if (index != -1)
+		removeChannel(index);
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
@@ -386,67 +580,51 @@ bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 }
 
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
-	Common::StackLock lock(_mutex);
-
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
-
-	_channels[index]->setVolume(volume);
+	queueCommand(Command::kSetVolume, handle, volume);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Common::StackLock commandLock(_commandMutex);
+
+	const int index = findChannel(handle);
+	if (index == -1)
 		return 0;
 
-	return _channels[index]->getVolume();
+	return _channelStates[index].volume;
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
-	Common::StackLock lock(_mutex);
-
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
-
-	_channels[index]->setBalance(balance);
+	queueCommand(Command::kSetBalance, handle, balance);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Common::StackLock commandLock(_commandMutex);
+
+	const int index = findChannel(handle);
+	if (index == -1)
 		return 0;
 
-	return _channels[index]->getBalance();
+	return _channelStates[index].balance;
 }
 
 void MixerImpl::setChannelRate(SoundHandle handle, uint32 rate) {
-	Common::StackLock lock(_mutex);
-
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
-
-	_channels[index]->setRate(rate);
+	// The new rate is applied in the audio callback
+	prepareRateConversion(rate, _sampleRate);
+	queueCommand(Command::kSetRate, handle, rate);
 }
 
 uint32 MixerImpl::getChannelRate(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Common::StackLock commandLock(_commandMutex);
+
+	const int index = findChannel(handle);
+	if (index == -1)
 		return 0;
-	
-	return _channels[index]->getRate();
+
+	return _channelStates[index].rate;
 }
 
 void MixerImpl::resetChannelRate(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
-	
-	_channels[index]->resetRate();
+	queueCommand(Command::kResetRate, handle, 0);
 }
 
 uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
@@ -454,20 +632,45 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 }
 
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock commandLock(_commandMutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return Timestamp(0, _sampleRate);
+	Audio::Timestamp ts(0, _sampleRate);
+
+	const int index = findChannel(handle);
+	if (index == -1)
+		return ts;
+
+	const ChannelState &state = _channelStates[index];
+	if (state.mixerTimeStamp == 0)
+		return ts;
 
-	return _channels[index]->getElapsedTime();
+	uint32 delta;
+	if (state.pauseLevel)
+		delta = state.pauseStartTime - state.mixerTimeStamp;
+	else
+		delta = g_system->getMillis(true) - state.mixerTimeStamp - state.pauseTime;
+
+	// Convert the number of samples into a time duration.
+
+	ts = ts.addFrames(state.samplesConsumed);
+	ts = ts.addMsecs(delta);
+
+	// In theory it would seem like a good idea to limit the approximation
+	// so that it never exceeds the theoretical upper bound set by
+	// _samplesDecoded. Meanwhile, back in the real world, doing so makes
+	// the Broken Sword cutscenes noticeably jerkier. I guess the mixer
+	// isn't invoked at the regular intervals that I first imagined.
+
+	return ts;
 }
 
 void MixerImpl::loopChannel(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
+	Common::StackLock commandLock(_commandMutex);
+	processCommands();
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findChannel(handle);
+	if (index == -1)
 		return;
 
 	_channels[index]->loop();
@@ -475,32 +678,34 @@ void MixerImpl::loopChannel(SoundHandle handle) {
 
 void MixerImpl::pauseAll(bool paused) {
 	Common::StackLock lock(_mutex);
+	Common::StackLock commandLock(_commandMutex);
+	processCommands();
+
+	const uint32 time = g_system->getMillis(true);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != nullptr) {
-			_channels[i]->pause(paused);
+			_channels[i]->pause(paused, time);
+			publishElapsedTime(i);
 		}
 	}
 }
 
 void MixerImpl::pauseID(int id, bool paused) {
 	Common::StackLock lock(_mutex);
+	Common::StackLock commandLock(_commandMutex);
+	processCommands();
+
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != nullptr && _channels[i]->getId() == id) {
-			_channels[i]->pause(paused);
+			_channels[i]->pause(paused, g_system->getMillis(true));
+			publishElapsedTime(i);
 			return;
 		}
 	}
 }
 
 void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
-	Common::StackLock lock(_mutex);
-
-	// Simply ignore (un)pause requests for sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
-
-	_channels[index]->pause(paused);
+	queueCommand(Command::kPause, handle, paused);
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
@@ -525,14 +730,12 @@ int MixerImpl::getSoundID(SoundHandle handle) {
 }
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
-	const int index = handle._val % NUM_CHANNELS;
-	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
+	Common::StackLock commandLock(_commandMutex);
+	return findChannel(handle) != -1;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
@@ -553,6 +756,8 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 	// scaling? See also Player_V2::setMasterVolume
 
 	Common::StackLock lock(_mutex);
+	Common::StackLock commandLock(_commandMutex);
+	processCommands();
 	_soundTypeSettings[type].volume = volume;
 
 	for (int i = 0; i != NUM_CHANNELS; ++i) {
@@ -652,52 +857,24 @@ void Channel::updateChannelVolumes() {
 	}
 }
 
-void Channel::pause(bool paused) {
+void Channel::pause(bool paused, uint32 time) {
 	//assert((paused && _pauseLevel >= 0) || (!paused && _pauseLevel));
 
 	if (paused) {
 		_pauseLevel++;
 
 		if (_pauseLevel == 1)
-			_pauseStartTime = g_system->getMillis(true);
+			_pauseStartTime = time;
 	} else if (_pauseLevel > 0) {
 		_pauseLevel--;
 
 		if (!_pauseLevel) {
-			_pauseTime = (g_system->getMillis(true) - _pauseStartTime);
+			_pauseTime = (time - _pauseStartTime);
 			_pauseStartTime = 0;
 		}
 	}
 }
 
-Timestamp Channel::getElapsedTime() {
-	const uint32 rate = _mixer->getOutputRate();
-	uint32 delta = 0;
-
-	Audio::Timestamp ts(0, rate);
-
-	if (_mixerTimeStamp == 0)
-		return ts;
-
-	if (isPaused())
-		delta = _pauseStartTime - _mixerTimeStamp;
-	else
-		delta = g_system->getMillis(true) - _mixerTimeStamp - _pauseTime;
-
-	// Convert the number of samples into a time duration.
-
-	ts = ts.addFrames(_samplesConsumed);
-	ts = ts.addMsecs(delta);
-
-	// In theory it would seem like a good idea to limit the approximation
-	// so that it never exceeds the theoretical upper bound set by
-	// _samplesDecoded. Meanwhile, back in the real world, doing so makes
-	// the Broken Sword cutscenes noticeably jerkier. I guess the mixer
-	// isn't invoked at the regular intervals that I first imagined.
-
-	return ts;
-}
-
 void Channel::loop() {
 	assert(_stream);
 
@@ -707,15 +884,17 @@ void Channel::loop() {
 	}
 }
 
-int Channel::mix(int16 *data, uint len) {
+int Channel::mix(int32 *data, uint len, bool firstBlock) {
 	assert(_stream);
 	assert(_converter);
 
 	int res = 0;
 	if (!_stream->endOfData() || _converter->needsDraining()) {
-		_samplesConsumed = _samplesDecoded;
-		_mixerTimeStamp = g_system->getMillis(true);
-		_pauseTime = 0;
+		if (firstBlock) {
+			_samplesConsumed = _samplesDecoded;
+			_mixerTimeStamp = g_system->getMillis(true);
+			_pauseTime = 0;
+		}
 		res = _converter->convert(*_stream, data, len, _volL, _volR);
 		_samplesDecoded += res;
 	}
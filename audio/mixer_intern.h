@@ -23,9 +23,12 @@
 #define AUDIO_MIXER_INTERN_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
 #include "common/mutex.h"
 #include "audio/mixer.h"
 
+#include <atomic>
+
 namespace Audio {
 
 /**
@@ -58,11 +61,88 @@ namespace Audio {
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 32
+		NUM_CHANNELS = 32,
+		COMMAND_QUEUE_SIZE = 256,
+		DEFAULT_MIX_FRAMES = 2048
+	};
+
+	/**
+	 * A channel setting change requested by an engine thread. These are
+	 * applied by the audio callback, so setting them never has to wait
+	 * for the mixer to finish mixing.
+	 */
+	struct Command {
+		enum Type {
+			kSetVolume,
+			kSetBalance,
+			kSetRate,
+			kResetRate,
+			kPause
+		};
+
+		Type type;
+		uint32 handle;
+		int32 value;
+		uint32 time;
+	};
+
+	/**
+	 * The state of a channel as seen by the getters. It already includes
+	 * the queued commands, so a getter returns what a setter just set.
+	 */
+	struct ChannelState {
+		uint32 handle; ///< Handle of the channel in the slot, or 0xffffffff if unused
+		byte volume;
+		int8 balance;
+		uint32 rate;
+		uint32 nativeRate;
+
+		// The timing state used by getElapsedTime()
+		uint32 samplesConsumed;
+		uint32 mixerTimeStamp;
+		uint32 pauseStartTime;
+		uint32 pauseTime;
+		int pauseLevel;
 	};
 
+	/**
+	 * Protects the channels. Held by the audio callback while mixing, and
+	 * by engine threads for operations that must complete synchronously,
+	 * like starting or stopping a sound.
+	 */
 	Common::Mutex _mutex;
 
+	/**
+	 * Serializes the engine threads queueing commands, and protects
+	 * _overflowCommands and _channelStates. Only ever held for a short time,
+	 * and never while mixing. The audio callback locks it once per callback
+	 * to publish the channel states. When both mutexes are needed, _mutex
+	 * has to be locked first.
+	 */
+	Common::Mutex _commandMutex;
+
+	/**
+	 * Single producer, single consumer ring of queued commands. Engine
+	 * threads write it while holding _commandMutex, and the thread holding
+	 * _mutex reads it, so the audio callback never waits for an engine
+	 * thread to apply the commands. Only the producer advances
+	 * _commandWrite, and only the consumer advances _commandRead.
+	 */
+	Command _commands[COMMAND_QUEUE_SIZE];
+	std::atomic<uint> _commandRead;
+	std::atomic<uint> _commandWrite;
+
+	/**
+	 * Commands queued while the ring was full. They come after all the
+	 * commands in the ring, so new commands are added here until the
+	 * audio callback applied them.
+	 */
+	Common::Array<Command> _overflowCommands;
+	/** Tells the audio callback to lock _commandMutex before mixing. */
+	std::atomic<bool> _commandsOverflowed;
+
+	ChannelState _channelStates[NUM_CHANNELS];
+
 	const uint _sampleRate;
 	const bool _stereo;
 	const uint _outBufSize;
@@ -79,6 +159,14 @@ private:
 	SoundTypeSettings _soundTypeSettings[4];
 	Channel *_channels[NUM_CHANNELS];
 
+	/**
+	 * 32-bit buffer the channels are mixed into before being clamped. It is
+	 * allocated once and holds as many frames as the backend's buffer, or
+	 * DEFAULT_MIX_FRAMES if the backend does not tell. Longer callbacks are
+	 * mixed in several blocks.
+	 */
+	Common::Array<int32> _mixBuffer;
+
 
 public:
 
@@ -137,7 +225,32 @@ public:
 	virtual uint getOutputBufSize() const;
 
 protected:
+	/** Must hold _mutex and _commandMutex. */
 	void insertChannel(SoundHandle *handle, Channel *chan);
+	/** Must hold _mutex and _commandMutex. */
+	void removeChannel(int index);
+
+	/** Find the slot of an active channel, or -1. Must hold _commandMutex. */
+	int findChannel(SoundHandle handle) const;
+
+	/**
+	 * Queue a command for the audio callback, and update the state seen by
+	 * the getters. Never locks _mutex, so it does not wait for the mixing.
+	 * Must not hold either mutex.
+	 */
+	void queueCommand(Command::Type type, SoundHandle handle, int32 value);
+
+	/** Apply a command to its channel. Must hold _mutex. */
+	void applyCommand(const Command &cmd);
+
+	/** Apply the commands in the ring. Must hold _mutex. */
+	void processQueuedCommands();
+
+	/** Apply all queued commands. Must hold _mutex and _commandMutex. */
+	void processCommands();
+
+	/** Copy the timing state of a channel. Must hold _mutex and _commandMutex. */
+	void publishElapsedTime(int index);
 
 public:
 	/**
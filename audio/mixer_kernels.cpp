@@ -0,0 +1,126 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audio/mixer_kernels.h"
+#include "audio/mixer.h"
+#include "common/system.h"
+
+namespace Audio {
+
+// Start with the generic versions, init() replaces them with faster ones
+MixerKernels::MixStereoFunc MixerKernels::mixStereoFunc = MixerKernels::mixStereoGeneric;
+MixerKernels::ClampFunc MixerKernels::clampFunc = MixerKernels::clampGeneric;
+MixerKernels::ConvolveFunc MixerKernels::convolveFunc = MixerKernels::convolveGeneric;
+
+void MixerKernels::init() {
+	// The SIMD kernels divide by the mixer volume range with a shift
+	STATIC_ASSERT(Mixer::kMaxMixerVolume == 256, SIMD_mixer_kernels_assume_a_volume_range_of_256);
+
+	mixStereoFunc = mixStereoGeneric;
+	clampFunc = clampGeneric;
+	convolveFunc = convolveGeneric;
+
+	// The vectorized versions only produce signed output
+#ifndef OUTPUT_UNSIGNED_AUDIO
+#ifdef SCUMMVM_SSE2
+	if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) {
+		mixStereoFunc = mixStereoSSE2;
+		clampFunc = clampSSE2;
+		convolveFunc = convolveSSE2;
+	}
+#endif
+#ifdef SCUMMVM_AVX2
+	if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) {
+		mixStereoFunc = mixStereoAVX2;
+		clampFunc = clampAVX2;
+		convolveFunc = convolveAVX2;
+	}
+#endif
+#endif
+}
+
+void MixerKernels::mixStereo(int32 *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR) {
+	mixStereoFunc(dst, src, numFrames, volL, volR);
+}
+
+void MixerKernels::mixMono(int32 *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR) {
+	while (numFrames--) {
+		const int outL = (src[0] * (int)volL) / Mixer::kMaxMixerVolume;
+		const int outR = (src[1] * (int)volR) / Mixer::kMaxMixerVolume;
+		*dst++ += (outL + outR) / 2;
+		src += 2;
+	}
+}
+
+void MixerKernels::clamp(st_sample_t *dst, const int32 *src, uint numSamples) {
+	clampFunc(dst, src, numSamples);
+}
+
+int32 MixerKernels::convolve(const st_sample_t *samples, const int16 *taps, uint numTaps) {
+	return convolveFunc(samples, taps, numTaps);
+}
+
+void MixerKernels::widen(int32 *dst, const st_sample_t *src, uint numSamples) {
+	while (numSamples--) {
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		*dst++ = (st_sample_t)(*src++ ^ 0x8000);
+#else
+		*dst++ = *src++;
+#endif
+	}
+}
+
+void MixerKernels::mixStereoGeneric(int32 *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR) {
+	while (numFrames--) {
+		dst[0] += (src[0] * (int)volL) / Mixer::kMaxMixerVolume;
+		dst[1] += (src[1] * (int)volR) / Mixer::kMaxMixerVolume;
+		dst += 2;
+		src += 2;
+	}
+}
+
+void MixerKernels::clampGeneric(st_sample_t *dst, const int32 *src, uint numSamples) {
+	while (numSamples--) {
+		int32 val = *src++;
+
+		if (val > ST_SAMPLE_MAX)
+			val = ST_SAMPLE_MAX;
+		else if (val < ST_SAMPLE_MIN)
+			val = ST_SAMPLE_MIN;
+
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		*dst++ = ((st_sample_t)val) ^ 0x8000;
+#else
+		*dst++ = val;
+#endif
+	}
+}
+
+int32 MixerKernels::convolveGeneric(const st_sample_t *samples, const int16 *taps, uint numTaps) {
+	int32 sum = 0;
+
+	while (numTaps--)
+		sum += *samples++ * *taps++;
+
+	return sum;
+}
+
+} // End of namespace Audio
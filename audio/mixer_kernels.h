@@ -0,0 +1,139 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AUDIO_MIXER_KERNELS_H
+#define AUDIO_MIXER_KERNELS_H
+
+#include "audio/rate.h"
+
+class MixerKernelsTestSuite;
+
+namespace Audio {
+
+/**
+ * @defgroup audio_mixer_kernels Mixing kernels
+ * @ingroup audio
+ *
+ * @brief Block operations used by the mixer to accumulate and clamp samples.
+ * @{
+ */
+
+/**
+ * Block mixing primitives shared by the rate converters and the mixer.
+ *
+ * Channels are mixed into a 32-bit accumulation buffer, so no clamping is
+ * needed while adding them up. The final result is then saturated to 16-bit
+ * samples once per mixer callback.
+ *
+ * The functions dispatch at runtime to SSE2 or AVX2 versions when the
+ * CPU supports them. The versions are selected by init(), until then the
+ * generic ones are used.
+ */
+class MixerKernels {
+public:
+	/**
+	 * Select the fastest versions of the kernels for the CPU.
+	 *
+	 * This is not thread safe. MixerImpl calls it when it is created, before
+	 * the backend starts the audio callback.
+	 */
+	static void init();
+
+	/**
+	 * Scale a block of interleaved stereo frames and add them to the
+	 * accumulation buffer.
+	 *
+	 * Each sample is scaled as (sample * volume) / Mixer::kMaxMixerVolume,
+	 * rounding towards zero.
+	 *
+	 * @param dst        Accumulation buffer, receives 2 * @p numFrames samples.
+	 * @param src        Interleaved stereo frames.
+	 * @param numFrames  Number of frames (sample pairs) to mix.
+	 * @param volL       Volume applied to the first sample of each frame.
+	 * @param volR       Volume applied to the second sample of each frame.
+	 */
+	static void mixStereo(int32 *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR);
+
+	/**
+	 * Scale a block of interleaved stereo frames, downmix them to mono and
+	 * add them to the accumulation buffer.
+	 *
+	 * @param dst        Accumulation buffer, receives @p numFrames samples.
+	 * @param src        Interleaved stereo frames.
+	 * @param numFrames  Number of frames (sample pairs) to mix.
+	 * @param volL       Volume applied to the first sample of each frame.
+	 * @param volR       Volume applied to the second sample of each frame.
+	 */
+	static void mixMono(int32 *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR);
+
+	/**
+	 * Saturate accumulated samples to the 16-bit output range.
+	 *
+	 * @param dst         Output buffer.
+	 * @param src         Accumulation buffer.
+	 * @param numSamples  Number of samples (not frames) to convert.
+	 */
+	static void clamp(st_sample_t *dst, const int32 *src, uint numSamples);
+
+	/**
+	 * Widen 16-bit samples into an accumulation buffer. This is the inverse
+	 * of clamp() and is used to mix on top of an existing 16-bit buffer.
+	 */
+	static void widen(int32 *dst, const st_sample_t *src, uint numSamples);
+
+	/**
+	 * Compute the dot product of a block of samples and filter coefficients.
+	 *
+	 * @param samples  The samples.
+	 * @param taps     The filter coefficients.
+	 * @param numTaps  Number of samples and coefficients, must be a multiple of 16.
+	 */
+	static int32 convolve(const st_sample_t *samples, const int16 *taps, uint numTaps);
+
+private:
+	static void mixStereoGeneric(int32 *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR);
+	static void clampGeneric(st_sample_t *dst, const int32 *src, uint numSamples);
+	static int32 convolveGeneric(const st_sample_t *samples, const int16 *taps, uint numTaps);
+#ifdef SCUMMVM_SSE2
+	static void mixStereoSSE2(int32 *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR);
+	static void clampSSE2(st_sample_t *dst, const int32 *src, uint numSamples);
+	static int32 convolveSSE2(const st_sample_t *samples, const int16 *taps, uint numTaps);
+#endif
+#ifdef SCUMMVM_AVX2
+	static void mixStereoAVX2(int32 *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR);
+	static void clampAVX2(st_sample_t *dst, const int32 *src, uint numSamples);
+	static int32 convolveAVX2(const st_sample_t *samples, const int16 *taps, uint numTaps);
+#endif
+
+	typedef void(*MixStereoFunc)(int32 *, const st_sample_t *, uint, st_volume_t, st_volume_t);
+	typedef void(*ClampFunc)(st_sample_t *, const int32 *, uint);
+	typedef int32(*ConvolveFunc)(const st_sample_t *, const int16 *, uint);
+	static MixStereoFunc mixStereoFunc;
+	static ClampFunc clampFunc;
+	static ConvolveFunc convolveFunc;
+
+	friend class ::MixerKernelsTestSuite;
+};
+
+/** @} */
+} // End of namespace Audio
+
+#endif
@@ -0,0 +1,87 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+#include <immintrin.h>
+
+#include "audio/mixer_kernels.h"
+
+namespace Audio {
+
+/**
+ * Divide 32-bit products by 256, rounding towards zero like the
+ * scalar code does.
+ */
+static FORCEINLINE __m256i avx2_scaleDown(__m256i p) {
+	__m256i bias = _mm256_srli_epi32(_mm256_srai_epi32(p, 31), 24);
+	return _mm256_srai_epi32(_mm256_add_epi32(p, bias), 8);
+}
+
+void MixerKernels::mixStereoAVX2(int32 *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR) {
+	const __m256i vol = _mm256_set_epi32(volR, volL, volR, volL, volR, volL, volR, volL);
+
+	for (; numFrames >= 8; numFrames -= 8) {
+		__m256i in0 = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)src));
+		__m256i in1 = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(src + 8)));
+		__m256i p0 = avx2_scaleDown(_mm256_mullo_epi32(in0, vol));
+		__m256i p1 = avx2_scaleDown(_mm256_mullo_epi32(in1, vol));
+
+		_mm256_storeu_si256((__m256i *)dst, _mm256_add_epi32(_mm256_loadu_si256((const __m256i *)dst), p0));
+		_mm256_storeu_si256((__m256i *)(dst + 8), _mm256_add_epi32(_mm256_loadu_si256((const __m256i *)(dst + 8)), p1));
+
+		src += 16;
+		dst += 16;
+	}
+
+	mixStereoGeneric(dst, src, numFrames, volL, volR);
+}
+
+void MixerKernels::clampAVX2(st_sample_t *dst, const int32 *src, uint numSamples) {
+	for (; numSamples >= 16; numSamples -= 16) {
+		__m256i a = _mm256_loadu_si256((const __m256i *)src);
+		__m256i b = _mm256_loadu_si256((const __m256i *)(src + 8));
+		// The pack works per 128-bit lane, so restore the sample order afterwards
+		__m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+		_mm256_storeu_si256((__m256i *)dst, packed);
+
+		src += 16;
+		dst += 16;
+	}
+
+	clampGeneric(dst, src, numSamples);
+}
+
+int32 MixerKernels::convolveAVX2(const st_sample_t *samples, const int16 *taps, uint numTaps) {
+	__m256i sum = _mm256_setzero_si256();
+
+	for (uint i = 0; i < numTaps; i += 16) {
+		__m256i s = _mm256_loadu_si256((const __m256i *)(samples + i));
+		__m256i t = _mm256_loadu_si256((const __m256i *)(taps + i));
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(s, t));
+	}
+
+	__m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum128);
+}
+
+} // End of namespace Audio
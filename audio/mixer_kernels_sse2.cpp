@@ -0,0 +1,85 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+#include <immintrin.h>
+
+#include "audio/mixer_kernels.h"
+
+namespace Audio {
+
+/**
+ * Divide 32-bit products by 256, rounding towards zero like the
+ * scalar code does.
+ */
+static FORCEINLINE __m128i sse2_scaleDown(__m128i p) {
+	__m128i bias = _mm_srli_epi32(_mm_srai_epi32(p, 31), 24);
+	return _mm_srai_epi32(_mm_add_epi32(p, bias), 8);
+}
+
+void MixerKernels::mixStereoSSE2(int32 *dst, const st_sample_t *src, uint numFrames, st_volume_t volL, st_volume_t volR) {
+	const __m128i vol = _mm_set_epi16(volR, volL, volR, volL, volR, volL, volR, volL);
+
+	for (; numFrames >= 4; numFrames -= 4) {
+		__m128i in = _mm_loadu_si128((const __m128i *)src);
+		__m128i lo = _mm_mullo_epi16(in, vol);
+		__m128i hi = _mm_mulhi_epi16(in, vol);
+		__m128i p0 = sse2_scaleDown(_mm_unpacklo_epi16(lo, hi));
+		__m128i p1 = sse2_scaleDown(_mm_unpackhi_epi16(lo, hi));
+
+		_mm_storeu_si128((__m128i *)dst, _mm_add_epi32(_mm_loadu_si128((const __m128i *)dst), p0));
+		_mm_storeu_si128((__m128i *)(dst + 4), _mm_add_epi32(_mm_loadu_si128((const __m128i *)(dst + 4)), p1));
+
+		src += 8;
+		dst += 8;
+	}
+
+	mixStereoGeneric(dst, src, numFrames, volL, volR);
+}
+
+void MixerKernels::clampSSE2(st_sample_t *dst, const int32 *src, uint numSamples) {
+	for (; numSamples >= 8; numSamples -= 8) {
+		__m128i a = _mm_loadu_si128((const __m128i *)src);
+		__m128i b = _mm_loadu_si128((const __m128i *)(src + 4));
+		_mm_storeu_si128((__m128i *)dst, _mm_packs_epi32(a, b));
+
+		src += 8;
+		dst += 8;
+	}
+
+	clampGeneric(dst, src, numSamples);
+}
+
+int32 MixerKernels::convolveSSE2(const st_sample_t *samples, const int16 *taps, uint numTaps) {
+	__m128i sum = _mm_setzero_si128();
+
+	for (uint i = 0; i < numTaps; i += 8) {
+		__m128i s = _mm_loadu_si128((const __m128i *)(samples + i));
+		__m128i t = _mm_loadu_si128((const __m128i *)(taps + i));
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(s, t));
+	}
+
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+}
+
+} // End of namespace Audio
@@ -17,11 +17,14 @@ MODULE_OBJS := \
 	miles_adlib.o \
 	miles_midi.o \
 	mixer.o \
+	mixer_kernels.o \
 	mpu401.o \
 	mt32gm.o \
 	musicplugin.o \
 	null.o \
+	prefetchingstream.o \
 	rate.o \
+	sinc_filter.o \
 	timestamp.o \
 	decoders/3do.o \
 	decoders/aac.o \
@@ -109,5 +112,16 @@ MODULE_OBJS += \
 	rwopl3.o
 endif
 
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	mixer_kernels_sse2.o
+$(MODULE)/mixer_kernels_sse2.o: CXXFLAGS += -msse2
+endif
+ifdef SCUMMVM_AVX2
+MODULE_OBJS += \
+	mixer_kernels_avx2.o
+$(MODULE)/mixer_kernels_avx2.o: CXXFLAGS += -mavx2
+endif
+
 # Include common rules
 include $(srcdir)/rules.mk
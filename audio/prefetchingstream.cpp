@@ -0,0 +1,303 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "audio/prefetchingstream.h"
+
+#include "common/system.h"
+#include "common/timer.h"
+#include "common/util.h"
+
+namespace Common {
+DECLARE_SINGLETON(Audio::PrefetchManager);
+}
+
+namespace Audio {
+
+PrefetchBuffer::PrefetchBuffer(AudioStream *stream, DisposeAfterUse::Flag disposeAfterUse, uint32 bufferMillis)
+	: _source(stream, disposeAfterUse), _seekable(dynamic_cast<SeekableAudioStream *>(stream)), _isStereo(stream->isStereo()), _rate(stream->getRate()),
+	  _readPos(0), _writePos(0), _sourceEndOfData(stream->endOfData()), _sourceEndOfStream(stream->endOfStream()),
+	  _hasWorker(false), _refCount(1) {
+
+	// Round the ring up to a power of two, so the free running counters
+	// can wrap around without breaking the modulo
+	const uint samples = MAX<uint>(bufferMillis * _rate / 1000 * (_isStereo ? 2 : 1), kChunkSamples);
+	uint size = 1;
+	while (size < samples)
+		size <<= 1;
+
+	_ring.resize(size);
+	_ringMask = size - 1;
+}
+
+int PrefetchBuffer::read(int16 *buffer, int numSamples) {
+	int samples = readFromRing(buffer, numSamples);
+	if (samples == numSamples)
+		return samples;
+
+	if (!_hasWorker.load(std::memory_order_relaxed)) {
+		// Nothing decodes on another thread, so this does not wait, and
+		// decoding directly into the output keeps the samples in order
+		Common::StackLock lock(_decodeMutex);
+		bool endOfData, endOfStream;
+		samples += readFromSource(buffer + samples, numSamples - samples, endOfData, endOfStream);
+		setSourceEnd(endOfData, endOfStream);
+		return samples;
+	}
+
+	// The samples decoded before the end of the source are in the ring by
+	// the time the flag is set
+	if (_sourceEndOfData.load(std::memory_order_acquire))
+		return samples + readFromRing(buffer + samples, numSamples - samples);
+
+	// The worker is behind. Waiting for it could make the mixer miss its
+	// deadline, so play silence until it catches up.
+	memset(buffer + samples, 0, (numSamples - samples) * sizeof(int16));
+	return numSamples;
+}
+
+bool PrefetchBuffer::endOfData() const {
+	// Check the flag first, see read()
+	const bool ended = _sourceEndOfData.load(std::memory_order_acquire);
+	return ended && _readPos.load(std::memory_order_acquire) == _writePos.load(std::memory_order_acquire);
+}
+
+bool PrefetchBuffer::endOfStream() const {
+	const bool ended = _sourceEndOfStream.load(std::memory_order_acquire);
+	return ended && _readPos.load(std::memory_order_acquire) == _writePos.load(std::memory_order_acquire);
+}
+
+bool PrefetchBuffer::seek(const Timestamp &where) {
+	if (!_seekable)
+		return false;
+
+	Common::StackLock lock(_decodeMutex);
+
+	const bool result = _seekable->seek(where);
+
+	// Drop whatever was decoded from the old position. The mixer does not
+	// read meanwhile, see PrefetchingSeekableAudioStream.
+	_readPos.store(_writePos.load(std::memory_order_relaxed), std::memory_order_release);
+	setSourceEnd(_source->endOfData(), _source->endOfStream());
+
+	return result;
+}
+
+Timestamp PrefetchBuffer::getLength() const {
+	return _seekable ? _seekable->getLength() : Timestamp(0, _rate);
+}
+
+void PrefetchBuffer::prefetch() {
+	const uint size = _ring.size();
+
+	while (true) {
+		Common::StackLock lock(_decodeMutex);
+
+		if (_sourceEndOfStream.load(std::memory_order_relaxed))
+			break;
+
+		// The reader is done with the samples before _readPos, and never
+		// touches the ones past _writePos
+		const uint writePos = _writePos.load(std::memory_order_relaxed);
+		const uint used = writePos - _readPos.load(std::memory_order_acquire);
+
+		// Only fill the contiguous part up to the end of the ring
+		const uint offset = writePos & _ringMask;
+		uint chunk = MIN<uint>(MIN<uint>(size - used, size - offset), kChunkSamples);
+		if (_isStereo)
+			chunk &= ~1;
+		if (!chunk)
+			break;
+
+		bool endOfData, endOfStream;
+		const int samples = readFromSource(&_ring[offset], chunk, endOfData, endOfStream);
+		_writePos.store(writePos + samples, std::memory_order_release);
+		setSourceEnd(endOfData, endOfStream);
+
+		if ((uint)samples < chunk)
+			break;
+	}
+}
+
+int PrefetchBuffer::readFromRing(int16 *buffer, int numSamples) {
+	const uint readPos = _readPos.load(std::memory_order_relaxed);
+	const uint samples = MIN<uint>(_writePos.load(std::memory_order_acquire) - readPos, numSamples);
+	const uint offset = readPos & _ringMask;
+	const uint first = MIN<uint>(samples, _ring.size() - offset);
+
+	memcpy(buffer, &_ring[offset], first * sizeof(int16));
+	memcpy(buffer + first, &_ring[0], (samples - first) * sizeof(int16));
+
+	// Hand the samples back to the decoding side only once copied
+	_readPos.store(readPos + samples, std::memory_order_release);
+	return samples;
+}
+
+int PrefetchBuffer::readFromSource(int16 *buffer, int numSamples, bool &endOfData, bool &endOfStream) {
+	int samples = _source->readBuffer(buffer, numSamples);
+
+	if (samples < 0) {
+		// Treat decoding errors as the end of the stream, as the mixer does
+		samples = 0;
+		endOfData = endOfStream = true;
+	} else {
+		endOfData = _source->endOfData();
+		endOfStream = _source->endOfStream();
+	}
+
+	return samples;
+}
+
+void PrefetchBuffer::setSourceEnd(bool endOfData, bool endOfStream) {
+	_sourceEndOfData.store(endOfData, std::memory_order_release);
+	_sourceEndOfStream.store(endOfStream, std::memory_order_release);
+}
+
+/** Hand a buffer over to the manager, or delete it if the manager is gone. */
+static void releasePrefetchBuffer(PrefetchBuffer *buffer) {
+	// The manager is destroyed at shutdown, possibly before the last streams
+	if (PrefetchManager::hasInstance())
+		PrefetchMan.releaseBuffer(buffer);
+	else
+		delete buffer;
+}
+
+PrefetchingAudioStream::PrefetchingAudioStream(AudioStream *stream, DisposeAfterUse::Flag disposeAfterUse, uint32 bufferMillis)
+	: _buffer(new PrefetchBuffer(stream, disposeAfterUse, bufferMillis)) {
+	PrefetchMan.registerBuffer(_buffer);
+}
+
+PrefetchingAudioStream::~PrefetchingAudioStream() {
+	releasePrefetchBuffer(_buffer);
+}
+
+PrefetchingSeekableAudioStream::PrefetchingSeekableAudioStream(SeekableAudioStream *stream, DisposeAfterUse::Flag disposeAfterUse, uint32 bufferMillis)
+	: _buffer(new PrefetchBuffer(stream, disposeAfterUse, bufferMillis)) {
+	PrefetchMan.registerBuffer(_buffer);
+}
+
+PrefetchingSeekableAudioStream::~PrefetchingSeekableAudioStream() {
+	releasePrefetchBuffer(_buffer);
+}
+
+PrefetchManager::~PrefetchManager() {
+	// Waits for the worker to finish, so it holds no more references
+	if (_workerStarted) {
+		if (_usesThread)
+			g_system->stopBackgroundThread(&workerProc, this);
+		else
+			g_system->getTimerManager()->removeTimerProc(&workerProc);
+	}
+}
+
+void PrefetchManager::registerBuffer(PrefetchBuffer *buffer) {
+	bool startWorker;
+
+	{
+		Common::StackLock lock(_mutex);
+		_buffers.push_back(buffer);
+		startWorker = !_workerStarted;
+		_workerStarted = true;
+		buffer->_hasWorker.store(true, std::memory_order_relaxed);
+	}
+
+	if (!startWorker)
+		return;
+
+	// Decoding can take a while, so prefer a thread of its own to the timer
+	// thread, which would delay every other timer callback. Without a timer
+	// manager either, the streams are simply decoded on demand.
+	_usesThread = g_system->startBackgroundThread(&workerProc, this, kPrefetchInterval);
+	if (!_usesThread) {
+		Common::TimerManager *timerManager = g_system->getTimerManager();
+		if (timerManager) {
+			timerManager->installTimerProc(&workerProc, kPrefetchInterval, this, "AudioPrefetch");
+		} else {
+			// Let read() decode the buffers registered meanwhile
+			Common::StackLock lock(_mutex);
+			_workerStarted = false;
+			for (uint i = 0; i < _buffers.size(); ++i)
+				_buffers[i]->_hasWorker.store(false, std::memory_order_relaxed);
+		}
+	}
+}
+
+void PrefetchManager::releaseBuffer(PrefetchBuffer *buffer) {
+	bool unused;
+
+	{
+		Common::StackLock lock(_mutex);
+
+		for (uint i = 0; i < _buffers.size(); ++i) {
+			if (_buffers[i] == buffer) {
+				_buffers.remove_at(i);
+				break;
+			}
+		}
+
+		unused = (--buffer->_refCount == 0);
+	}
+
+	// Otherwise the worker deletes it once done with it
+	if (unused)
+		delete buffer;
+}
+
+void PrefetchManager::workerProc(void *refCon) {
+	((PrefetchManager *)refCon)->prefetchAll();
+}
+
+void PrefetchManager::prefetchAll() {
+	// Decode without holding the lock, so that streams can be deleted in
+	// the meantime without waiting for a whole pass
+	{
+		Common::StackLock lock(_mutex);
+		_pending = _buffers;
+		for (uint i = 0; i < _pending.size(); ++i)
+			_pending[i]->_refCount++;
+	}
+
+	for (uint i = 0; i < _pending.size(); ++i)
+		_pending[i]->prefetch();
+
+	{
+		Common::StackLock lock(_mutex);
+		for (uint i = 0; i < _pending.size(); ++i) {
+			if (--_pending[i]->_refCount != 0)
+				_pending[i] = nullptr;
+		}
+	}
+
+	// Delete the buffers whose streams were deleted while decoding
+	for (uint i = 0; i < _pending.size(); ++i)
+		delete _pending[i];
+	_pending.clear();
+}
+
+AudioStream *makePrefetchingAudioStream(AudioStream *stream, DisposeAfterUse::Flag disposeAfterUse, uint32 bufferMillis) {
+	return new PrefetchingAudioStream(stream, disposeAfterUse, bufferMillis);
+}
+
+SeekableAudioStream *makePrefetchingAudioStream(SeekableAudioStream *stream, DisposeAfterUse::Flag disposeAfterUse, uint32 bufferMillis) {
+	return new PrefetchingSeekableAudioStream(stream, disposeAfterUse, bufferMillis);
+}
+
+} // End of namespace Audio
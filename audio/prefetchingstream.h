@@ -0,0 +1,270 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef AUDIO_PREFETCHINGSTREAM_H
+#define AUDIO_PREFETCHINGSTREAM_H
+
+#include "common/array.h"
+#include "common/mutex.h"
+#include "common/singleton.h"
+#include "common/types.h"
+
+#include "audio/audiostream.h"
+
+#include <atomic>
+
+class PrefetchingAudioStreamTestSuite;
+
+namespace Audio {
+
+/**
+ * @defgroup audio_prefetchingstream Prefetching audio stream
+ * @ingroup audio
+ *
+ * @brief Decode compressed audio ahead of the mixer.
+ * @{
+ */
+
+/**
+ * A bounded ring buffer of samples decoded ahead from a source stream.
+ *
+ * The ring is filled by the PrefetchManager from its worker, and read by
+ * the mixer. There is one writer and one reader, so the ring positions are
+ * atomic and the mixer never locks anything. If the mixer ever catches up
+ * with the worker, it gets silence instead of waiting for the decoding, and
+ * the missing samples follow once they are decoded. Without a worker,
+ * read() decodes the missing samples itself.
+ *
+ * The buffer is shared by the stream wrapping it and the worker, and it is
+ * deleted by whichever of both releases it last. This way, deleting the
+ * stream never has to wait for the worker to finish decoding.
+ */
+class PrefetchBuffer {
+public:
+	PrefetchBuffer(AudioStream *stream, DisposeAfterUse::Flag disposeAfterUse, uint32 bufferMillis);
+
+	int read(int16 *buffer, int numSamples);
+	bool isStereo() const { return _isStereo; }
+	int getRate() const { return _rate; }
+	bool endOfData() const;
+	bool endOfStream() const;
+
+	/**
+	 * Seek the source stream and discard the buffered samples. This fails
+	 * if the source stream is not seekable.
+	 */
+	bool seek(const Timestamp &where);
+	Timestamp getLength() const;
+
+	/** Decode until the ring is full or the source stream has ended. */
+	void prefetch();
+
+private:
+	friend class PrefetchManager;
+
+	friend class ::PrefetchingAudioStreamTestSuite;
+
+	enum {
+		/**
+		 * Maximum number of samples decoded while holding the decoder lock.
+		 * This bounds the time seek() may wait for the worker.
+		 */
+		kChunkSamples = 2048
+	};
+
+	/** Copy buffered samples out of the ring, returns the number copied. */
+	int readFromRing(int16 *buffer, int numSamples);
+
+	/**
+	 * Read from the source stream and return its end flags. Must be called
+	 * with _decodeMutex held.
+	 */
+	int readFromSource(int16 *buffer, int numSamples, bool &endOfData, bool &endOfStream);
+
+	/** Publish the end flags of the source stream. */
+	void setSourceEnd(bool endOfData, bool endOfStream);
+
+	Common::DisposablePtr<AudioStream> _source;
+	SeekableAudioStream *const _seekable;
+	const bool _isStereo;
+	const int _rate;
+
+	/**
+	 * Serializes every access to the source stream. Samples are only written
+	 * to the ring, or decoded past it, while this is held. The mixer only
+	 * takes it when there is no worker, so it never waits for another
+	 * thread on it.
+	 */
+	Common::Mutex _decodeMutex;
+
+	Common::Array<int16> _ring;
+	uint _ringMask;
+
+	/**
+	 * Free running sample counters. The ring holds _writePos - _readPos
+	 * samples, _writePos is only advanced by the decoding side and
+	 * _readPos only by the reading side.
+	 */
+	std::atomic<uint> _readPos;
+	std::atomic<uint> _writePos;
+
+	/**
+	 * The end flags of the source stream. They are set after the samples
+	 * decoded before reaching the end are added to the ring.
+	 */
+	std::atomic<bool> _sourceEndOfData;
+	std::atomic<bool> _sourceEndOfStream;
+
+	/** Whether the PrefetchManager decodes into the buffer. */
+	std::atomic<bool> _hasWorker;
+
+	/** Number of users of the buffer, guarded by the manager's mutex. */
+	int _refCount;
+};
+
+/**
+ * A wrapper that decodes its source stream ahead of time, so that the mixer
+ * callback only has to copy samples. See PrefetchBuffer.
+ */
+class PrefetchingAudioStream : public AudioStream {
+public:
+	enum {
+		/** Default amount of audio decoded ahead, in milliseconds. */
+		kDefaultBufferMillis = 500
+	};
+
+	/**
+	 * Wrap an audio stream.
+	 *
+	 * @param stream           The stream to decode ahead.
+	 * @param disposeAfterUse  Whether to delete @p stream with this stream.
+	 * @param bufferMillis     The amount of audio to keep decoded.
+	 */
+	PrefetchingAudioStream(AudioStream *stream, DisposeAfterUse::Flag disposeAfterUse, uint32 bufferMillis = kDefaultBufferMillis);
+	~PrefetchingAudioStream() override;
+
+	int readBuffer(int16 *buffer, const int numSamples) override { return _buffer->read(buffer, numSamples); }
+	bool isStereo() const override { return _buffer->isStereo(); }
+	int getRate() const override { return _buffer->getRate(); }
+	bool endOfData() const override { return _buffer->endOfData(); }
+	bool endOfStream() const override { return _buffer->endOfStream(); }
+
+	/** Fill the buffer. This is normally done by the PrefetchManager. */
+	void prefetch() { _buffer->prefetch(); }
+
+private:
+	friend class ::PrefetchingAudioStreamTestSuite;
+
+	PrefetchBuffer *_buffer;
+};
+
+/**
+ * The seekable variant of PrefetchingAudioStream.
+ *
+ * Seeking and rewinding flush the buffered samples. Like for any other
+ * stream, they must not be called while the mixer reads from it unless
+ * the mixer is locked, e.g. by pausing the channel.
+ */
+class PrefetchingSeekableAudioStream : public SeekableAudioStream {
+public:
+	PrefetchingSeekableAudioStream(SeekableAudioStream *stream, DisposeAfterUse::Flag disposeAfterUse, uint32 bufferMillis = PrefetchingAudioStream::kDefaultBufferMillis);
+	~PrefetchingSeekableAudioStream() override;
+
+	int readBuffer(int16 *buffer, const int numSamples) override { return _buffer->read(buffer, numSamples); }
+	bool isStereo() const override { return _buffer->isStereo(); }
+	int getRate() const override { return _buffer->getRate(); }
+	bool endOfData() const override { return _buffer->endOfData(); }
+	bool endOfStream() const override { return _buffer->endOfStream(); }
+
+	bool seek(const Timestamp &where) override { return _buffer->seek(where); }
+	Timestamp getLength() const override { return _buffer->getLength(); }
+
+	/** Fill the buffer. This is normally done by the PrefetchManager. */
+	void prefetch() { _buffer->prefetch(); }
+
+private:
+	friend class ::PrefetchingAudioStreamTestSuite;
+
+	PrefetchBuffer *_buffer;
+};
+
+/**
+ * Runs the decoding of all prefetch buffers.
+ *
+ * The decoding runs on a background thread of the backend, see
+ * OSystem::startBackgroundThread(). Backends without threads get a timer
+ * callback instead. The worker is started when the first buffer is
+ * registered and stopped when the manager is destroyed.
+ */
+class PrefetchManager : public Common::Singleton<PrefetchManager> {
+public:
+	enum {
+		/** Interval between two decoding passes, in microseconds. */
+		kPrefetchInterval = 10000
+	};
+
+	~PrefetchManager() override;
+
+	/** Start decoding into a new buffer, which has one reference. */
+	void registerBuffer(PrefetchBuffer *buffer);
+
+	/** Drop a reference, and stop decoding into the buffer. */
+	void releaseBuffer(PrefetchBuffer *buffer);
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	PrefetchManager() : _workerStarted(false), _usesThread(false) {}
+
+	static void workerProc(void *refCon);
+	void prefetchAll();
+
+	/** Guards _buffers and the reference counts. */
+	Common::Mutex _mutex;
+	Common::Array<PrefetchBuffer *> _buffers;
+
+	/** The buffers the worker currently decodes into, only used by the worker. */
+	Common::Array<PrefetchBuffer *> _pending;
+
+	bool _workerStarted;
+	bool _usesThread;
+};
+
+/**
+ * Wrap a stream in a PrefetchingAudioStream.
+ *
+ * @param stream           The stream to decode ahead.
+ * @param disposeAfterUse  Whether to delete @p stream with the new stream.
+ * @param bufferMillis     The amount of audio to keep decoded.
+ */
+AudioStream *makePrefetchingAudioStream(AudioStream *stream, DisposeAfterUse::Flag disposeAfterUse, uint32 bufferMillis = PrefetchingAudioStream::kDefaultBufferMillis);
+
+/**
+ * Wrap a seekable stream in a PrefetchingSeekableAudioStream.
+ */
+SeekableAudioStream *makePrefetchingAudioStream(SeekableAudioStream *stream, DisposeAfterUse::Flag disposeAfterUse, uint32 bufferMillis = PrefetchingAudioStream::kDefaultBufferMillis);
+
+/** @} */
+} // End of namespace Audio
+
+#define PrefetchMan (::Audio::PrefetchManager::instance())
+
+#endif
@@ -30,6 +30,9 @@
 #include "audio/audiostream.h"
 #include "audio/rate.h"
 #include "audio/mixer.h"
+#include "audio/mixer_kernels.h"
+#include "audio/sinc_filter.h"
+#include "common/config-manager.h"
 #include "common/util.h"
 
 namespace Audio {
@@ -51,6 +54,9 @@ private:
 	/** Input and output rates */
 	st_rate_t _inRate, _outRate;
 
+	/** Requested resampling algorithm */
+	const ResamplerQuality _quality;
+
 	/**
 	 * The intermediate input cache. Bigger values may increase performance,
 	 * but only until some point (depends largely on cache size, target
@@ -64,6 +70,13 @@ private:
 	/** Size of data currently loaded into the buffer */
 	int _bufferSize;
 
+	/**
+	 * Resampled output frames, before volume is applied. These are stored
+	 * as interleaved pairs in output channel order and handed over to the
+	 * mixing kernels in blocks.
+	 */
+	st_sample_t _frames[512];
+
 	/** How far output is ahead of input when doing simple conversion */
 	frac_t _outPos;
 
@@ -76,15 +89,51 @@ private:
 	/** Current sample(s) in the input stream (left/right channel) */
 	st_sample_t _inCurL, _inCurR;
 
-	int copyConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
-	int simpleConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
-	int interpolateConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
+	/** Filter bank used by the sinc converter, and the rates it was made for */
+	const SincFilter *_filter;
+	st_rate_t _filterInRate, _filterOutRate;
+
+	/**
+	 * Number of silent samples the sinc converter still has to push once
+	 * the input stream ended, so the samples delayed by the filter come out.
+	 */
+	uint _sincTail;
+
+	/**
+	 * The last input samples seen by the sinc converter (left/right channel).
+	 * Each sample is stored twice, so the filter window is always contiguous.
+	 */
+	st_sample_t _historyL[2 * SincFilter::kMaxTaps];
+	st_sample_t _historyR[2 * SincFilter::kMaxTaps];
+
+	/** Position of the oldest sample inside the history */
+	uint _historyPos;
+
+	int copyConvert(AudioStream &input, int32 *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
+	int simpleConvert(AudioStream &input, int32 *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
+	template<bool nearest>
+	int interpolateConvert(AudioStream &input, int32 *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
+	int sincConvert(AudioStream &input, int32 *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r);
+
+	/** Make sure the sinc filter matches the current rates */
+	void updateFilter();
+
+	/** Store one resampled frame in the frame block */
+	inline void putFrame(st_sample_t *&frame, st_sample_t inL, st_sample_t inR) {
+		frame[reverseStereo    ] = inL;
+		frame[reverseStereo ^ 1] = inR;
+		frame += 2;
+	}
+
+	/** Scale the pending frames and add them to the output buffer */
+	void flushFrames(int32 *&outBuffer, st_sample_t *&frame, st_volume_t vol_l, st_volume_t vol_r);
 
 public:
-	RateConverter_Impl(st_rate_t inputRate, st_rate_t outputRate);
+	RateConverter_Impl(st_rate_t inputRate, st_rate_t outputRate, ResamplerQuality quality);
 	virtual ~RateConverter_Impl() {}
 
 	int convert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r) override;
+	int convert(AudioStream &input, int32 *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r) override;
 
 	void setInputRate(st_rate_t inputRate) override { _inRate = inputRate; }
 	void setOutputRate(st_rate_t outputRate) override { _outRate = outputRate; }
@@ -92,66 +141,82 @@ public:
 	st_rate_t getInputRate() const override { return _inRate; }
 	st_rate_t getOutputRate() const override { return _outRate; }
 
-	bool needsDraining() const override { return _bufferSize != 0; }
+	bool needsDraining() const override { return _bufferSize != 0 || _sincTail != 0; }
 };
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
-int RateConverter_Impl<inStereo, outStereo, reverseStereo>::copyConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
-	st_sample_t *outStart, *outEnd;
+void RateConverter_Impl<inStereo, outStereo, reverseStereo>::flushFrames(int32 *&outBuffer, st_sample_t *&frame, st_volume_t volL, st_volume_t volR) {
+	const uint numFrames = (frame - _frames) / 2;
+
+	if (outStereo) {
+		// The frames are already swapped for reverse stereo, so swap the volumes too
+		if (reverseStereo)
+			MixerKernels::mixStereo(outBuffer, _frames, numFrames, volR, volL);
+		else
+			MixerKernels::mixStereo(outBuffer, _frames, numFrames, volL, volR);
+		outBuffer += numFrames * 2;
+	} else {
+		MixerKernels::mixMono(outBuffer, _frames, numFrames, volL, volR);
+		outBuffer += numFrames;
+	}
+
+	frame = _frames;
+}
 
-	outStart = outBuffer;
-	outEnd = outBuffer + numSamples * (outStereo ? 2 : 1);
+template<bool inStereo, bool outStereo, bool reverseStereo>
+int RateConverter_Impl<inStereo, outStereo, reverseStereo>::copyConvert(AudioStream &input, int32 *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
+	st_sample_t *frame = _frames;
+	const st_sample_t *framesEnd = _frames + ARRAYSIZE(_frames);
+	st_size_t produced = 0;
 
-	while (outBuffer < outEnd) {
+	while (produced < numSamples) {
 		// Check if we have to refill the buffer
 		if (_bufferSize == 0) {
 			_bufferPos = _buffer;
 			_bufferSize = input.readBuffer(_buffer, ARRAYSIZE(_buffer));
 
 			if (_bufferSize <= 0)
-				return (outBuffer - outStart) / (outStereo ? 2 : 1);
+				break;
+		}
+
+		if (inStereo && outStereo && !reverseStereo) {
+			// The input is already laid out like the output, so mix it
+			// directly from the input buffer
+			const st_size_t count = MIN<st_size_t>(_bufferSize / 2, numSamples - produced);
+			MixerKernels::mixStereo(outBuffer, _bufferPos, count, volL, volR);
+			outBuffer += count * 2;
+			_bufferPos += count * 2;
+			_bufferSize -= count * 2;
+			produced += count;
+			continue;
 		}
 
-		// Mix the data into the output buffer
 		st_sample_t inL, inR;
 		inL = *_bufferPos++;
 		inR = (inStereo ? *_bufferPos++ : inL);
 		_bufferSize -= (inStereo ? 2 : 1);
 
-		st_sample_t outL, outR;
-		outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
-		outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
-
-		if (outStereo) {
-			// Output left channel
-			clampedAdd(outBuffer[reverseStereo    ], outL);
+		putFrame(frame, inL, inR);
+		produced++;
 
-			// Output right channel
-			clampedAdd(outBuffer[reverseStereo ^ 1], outR);
-
-			outBuffer += 2;
-		} else {
-			// Output mono channel
-			clampedAdd(outBuffer[0], (outL + outR) / 2);
-
-			outBuffer += 1;
-		}
+		if (frame == framesEnd)
+			flushFrames(outBuffer, frame, volL, volR);
 	}
 
-	return (outBuffer - outStart) / (outStereo ? 2 : 1);
+	flushFrames(outBuffer, frame, volL, volR);
+	return produced;
 }
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
-int RateConverter_Impl<inStereo, outStereo, reverseStereo>::simpleConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
+int RateConverter_Impl<inStereo, outStereo, reverseStereo>::simpleConvert(AudioStream &input, int32 *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
 	// How much to increment _outPos by
 	frac_t outPos_inc = _inRate / _outRate;
 
-	st_sample_t *outStart, *outEnd;
-
-	outStart = outBuffer;
-	outEnd = outBuffer + numSamples * (outStereo ? 2 : 1);
+	st_sample_t *frame = _frames;
+	const st_sample_t *framesEnd = _frames + ARRAYSIZE(_frames);
+	st_size_t produced = 0;
 
-	while (outBuffer < outEnd) {
+	while (produced < numSamples) {
 		// Read enough input samples so that _outPos >= 0
 		do {
 			// Check if we have to refill the buffer
@@ -159,8 +224,10 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::simpleConvert(AudioS
 				_bufferPos = _buffer;
 				_bufferSize = input.readBuffer(_buffer, ARRAYSIZE(_buffer));
 
-				if (_bufferSize <= 0)
-					return (outBuffer - outStart) / (outStereo ? 2 : 1);
+				if (_bufferSize <= 0) {
+					flushFrames(outBuffer, frame, volL, volR);
+					return produced;
+				}
 			}
 
 			_bufferSize -= (inStereo ? 2 : 1);
@@ -178,38 +245,28 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::simpleConvert(AudioS
 		// Increment output position
 		_outPos += outPos_inc;
 
-		st_sample_t outL, outR;
-		outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
-		outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
-
-		if (outStereo) {
-			// output left channel
-			clampedAdd(outBuffer[reverseStereo    ], outL);
-
-			// output right channel
-			clampedAdd(outBuffer[reverseStereo ^ 1], outR);
+		putFrame(frame, inL, inR);
+		produced++;
 
-			outBuffer += 2;
-		} else {
-			// output mono channel
-			clampedAdd(outBuffer[0], (outL + outR) / 2);
-
-			outBuffer += 1;
-		}
+		if (frame == framesEnd)
+			flushFrames(outBuffer, frame, volL, volR);
 	}
-	return (outBuffer - outStart) / (outStereo ? 2 : 1);
+
+	flushFrames(outBuffer, frame, volL, volR);
+	return produced;
 }
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
-int RateConverter_Impl<inStereo, outStereo, reverseStereo>::interpolateConvert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
+template<bool nearest>
+int RateConverter_Impl<inStereo, outStereo, reverseStereo>::interpolateConvert(AudioStream &input, int32 *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
 	// How much to increment _outPosFrac by
 	frac_t outPos_inc = (_inRate << FRAC_BITS_LOW) / _outRate;
 
-	st_sample_t *outStart, *outEnd;
-	outStart = outBuffer;
-	outEnd = outBuffer + numSamples * (outStereo ? 2 : 1);
+	st_sample_t *frame = _frames;
+	const st_sample_t *framesEnd = _frames + ARRAYSIZE(_frames);
+	st_size_t produced = 0;
 
-	while (outBuffer < outEnd) {
+	while (produced < numSamples) {
 		// Read enough input samples so that _outPosFrac < 0
 		while ((frac_t)FRAC_ONE_LOW <= _outPosFrac) {
 			// Check if we have to refill the buffer
@@ -217,8 +274,10 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::interpolateConvert(A
 				_bufferPos = _buffer;
 				_bufferSize = input.readBuffer(_buffer, ARRAYSIZE(_buffer));
 
-				if (_bufferSize <= 0)
-					return (outBuffer - outStart) / (outStereo ? 2 : 1);
+				if (_bufferSize <= 0) {
+					flushFrames(outBuffer, frame, volL, volR);
+					return produced;
+				}
 			}
 
 			_bufferSize -= (inStereo ? 2 : 1);
@@ -235,44 +294,146 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::interpolateConvert(A
 
 		// Loop as long as the _outPos trails behind, and as long as there is
 		// still space in the output buffer.
-		while (_outPosFrac < (frac_t)FRAC_ONE_LOW && outBuffer < outEnd) {
-			// Interpolate
+		while (_outPosFrac < (frac_t)FRAC_ONE_LOW && produced < numSamples) {
 			st_sample_t inL, inR;
-			inL = (st_sample_t)(_inLastL + (((_inCurL - _inLastL) * _outPosFrac + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
-			inR = (inStereo ?
-						(st_sample_t)(_inLastR + (((_inCurR - _inLastR) * _outPosFrac + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
-						inL);
+			if (nearest) {
+				// Pick the closest input sample
+				const bool useCur = (_outPosFrac >= (frac_t)FRAC_HALF_LOW);
+				inL = useCur ? _inCurL : _inLastL;
+				inR = (inStereo ? (useCur ? _inCurR : _inLastR) : inL);
+			} else {
+				// Interpolate
+				inL = (st_sample_t)(_inLastL + (((_inCurL - _inLastL) * _outPosFrac + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+				inR = (inStereo ?
+							(st_sample_t)(_inLastR + (((_inCurR - _inLastR) * _outPosFrac + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
+							inL);
+			}
 
-			st_sample_t outL, outR;
-			outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
-			outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
+			putFrame(frame, inL, inR);
+			produced++;
 
-			if (outStereo) {
-				// Output left channel
-				clampedAdd(outBuffer[reverseStereo    ], outL);
+			if (frame == framesEnd)
+				flushFrames(outBuffer, frame, volL, volR);
 
-				// Output right channel
-				clampedAdd(outBuffer[reverseStereo ^ 1], outR);
+			// Increment output position
+			_outPosFrac += outPos_inc;
+		}
+	}
 
-				outBuffer += 2;
-			} else {
-				// Output mono channel
-				clampedAdd(outBuffer[0], (outL + outR) / 2);
+	flushFrames(outBuffer, frame, volL, volR);
+	return produced;
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+void RateConverter_Impl<inStereo, outStereo, reverseStereo>::updateFilter() {
+	if (_filterInRate == _inRate && _filterOutRate == _outRate)
+		return;
+
+	// This runs in the audio callback, so only use filters which were
+	// computed beforehand, see prepareRateConversion(). Otherwise keep the
+	// current filter, which still works, if with a less fitting cut off.
+	const SincFilter *filter = SincFilterMan.findFilter(_inRate, _outRate);
+	if (!filter)
+		return;
+
+	const uint oldTaps = _filter->getNumTaps();
+
+	_filter = filter;
+	_filterInRate = _inRate;
+	_filterOutRate = _outRate;
+
+	// The history layout depends on the filter length
+	if (_filter->getNumTaps() != oldTaps) {
+		memset(_historyL, 0, sizeof(_historyL));
+		memset(_historyR, 0, sizeof(_historyR));
+		_historyPos = 0;
+		_sincTail = 0;
+	}
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+int RateConverter_Impl<inStereo, outStereo, reverseStereo>::sincConvert(AudioStream &input, int32 *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
+	updateFilter();
+
+	const uint numTaps = _filter->getNumTaps();
+	const int phaseShift = FRAC_BITS_LOW - SincFilter::kPhaseBits;
+
+	// How much to increment _outPosFrac by
+	frac_t outPos_inc = (_inRate << FRAC_BITS_LOW) / _outRate;
+
+	st_sample_t *frame = _frames;
+	const st_sample_t *framesEnd = _frames + ARRAYSIZE(_frames);
+	st_size_t produced = 0;
 
-				outBuffer += 1;
+	while (produced < numSamples) {
+		// Push input samples into the history until the output position
+		// lies within the current filter window
+		while ((frac_t)FRAC_ONE_LOW <= _outPosFrac) {
+			// Check if we have to refill the buffer
+			if (_bufferSize == 0) {
+				_bufferPos = _buffer;
+				_bufferSize = input.readBuffer(_buffer, ARRAYSIZE(_buffer));
+
+				if (_bufferSize > 0) {
+					_sincTail = numTaps / 2;
+				} else if (_sincTail && input.endOfStream()) {
+					// The output lags half a filter behind the input, so
+					// push silence to get the last samples out
+					_sincTail--;
+					_buffer[0] = _buffer[1] = 0;
+					_bufferSize = (inStereo ? 2 : 1);
+				} else {
+					flushFrames(outBuffer, frame, volL, volR);
+					return produced;
+				}
 			}
 
+			_bufferSize -= (inStereo ? 2 : 1);
+			_historyL[_historyPos] = _historyL[_historyPos + numTaps] = *_bufferPos++;
+			if (inStereo)
+				_historyR[_historyPos] = _historyR[_historyPos + numTaps] = *_bufferPos++;
+
+			if (++_historyPos == numTaps)
+				_historyPos = 0;
+
+			_outPosFrac -= FRAC_ONE_LOW;
+		}
+
+		while (_outPosFrac < (frac_t)FRAC_ONE_LOW && produced < numSamples) {
+			const int16 *taps = _filter->getTaps(_outPosFrac >> phaseShift);
+			const int round = 1 << (SincFilter::kCoeffBits - 1);
+
+			st_sample_t inL, inR;
+			inL = (st_sample_t)CLIP<int32>((MixerKernels::convolve(_historyL + _historyPos, taps, numTaps) + round) >> SincFilter::kCoeffBits, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+			inR = (inStereo ?
+						(st_sample_t)CLIP<int32>((MixerKernels::convolve(_historyR + _historyPos, taps, numTaps) + round) >> SincFilter::kCoeffBits, ST_SAMPLE_MIN, ST_SAMPLE_MAX) :
+						inL);
+
+			putFrame(frame, inL, inR);
+			produced++;
+
+			if (frame == framesEnd)
+				flushFrames(outBuffer, frame, volL, volR);
+
 			// Increment output position
 			_outPosFrac += outPos_inc;
 		}
 	}
-	return (outBuffer - outStart) / (outStereo ? 2 : 1);
+
+	flushFrames(outBuffer, frame, volL, volR);
+	return produced;
 }
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
-RateConverter_Impl<inStereo, outStereo, reverseStereo>::RateConverter_Impl(st_rate_t inputRate, st_rate_t outputRate) :
+RateConverter_Impl<inStereo, outStereo, reverseStereo>::RateConverter_Impl(st_rate_t inputRate, st_rate_t outputRate, ResamplerQuality quality) :
 	_inRate(inputRate),
 	_outRate(outputRate),
+	_quality(quality),
+	_filter(nullptr),
+	_filterInRate(0),
+	_filterOutRate(0),
+	_sincTail(0),
+	_historyPos(0),
 	_outPos(1),
 	_outPosFrac(FRAC_ONE_LOW),
 	_inLastL(0),
@@ -280,37 +441,98 @@ RateConverter_Impl<inStereo, outStereo, reverseStereo>::RateConverter_Impl(st_ra
 	_inCurL(0),
 	_inCurR(0),
 	_bufferSize(0),
-	_bufferPos(nullptr) {}
+	_bufferPos(nullptr) {
+
+	// Compute the filter tables now rather than in the audio callback. This
+	// is also done when the rates match, as they may change later on.
+	if (_quality == kResamplerSinc) {
+		_filter = SincFilterMan.getFilter(_inRate, _outRate);
+		_filterInRate = _inRate;
+		_filterOutRate = _outRate;
+		memset(_historyL, 0, sizeof(_historyL));
+		memset(_historyR, 0, sizeof(_historyR));
+	}
+}
 
 template<bool inStereo, bool outStereo, bool reverseStereo>
-int RateConverter_Impl<inStereo, outStereo, reverseStereo>::convert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
+int RateConverter_Impl<inStereo, outStereo, reverseStereo>::convert(AudioStream &input, int32 *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
 	assert(input.isStereo() == inStereo);
 
 	if (_inRate == _outRate) {
 		return copyConvert(input, outBuffer, numSamples, volL, volR);
+	} else if (_quality == kResamplerSinc) {
+		return sincConvert(input, outBuffer, numSamples, volL, volR);
 	} else {
 		if ((_inRate % _outRate) == 0 && (_inRate < 65536)) {
 			return simpleConvert(input, outBuffer, numSamples, volL, volR);
+		} else if (_quality == kResamplerFast) {
+			return interpolateConvert<true>(input, outBuffer, numSamples, volL, volR);
 		} else {
-			return interpolateConvert(input, outBuffer, numSamples, volL, volR);
+			return interpolateConvert<false>(input, outBuffer, numSamples, volL, volR);
 		}
 	}
 }
 
-RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo) {
+template<bool inStereo, bool outStereo, bool reverseStereo>
+int RateConverter_Impl<inStereo, outStereo, reverseStereo>::convert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
+	// Mix on top of the existing 16-bit samples through a small accumulation
+	// buffer, one block at a time
+	const st_size_t outChannels = (outStereo ? 2 : 1);
+	int32 accum[512];
+	st_size_t total = 0;
+
+	while (total < numSamples) {
+		const st_size_t count = MIN<st_size_t>(numSamples - total, ARRAYSIZE(accum) / outChannels);
+		st_sample_t *out = outBuffer + total * outChannels;
+
+		MixerKernels::widen(accum, out, count * outChannels);
+		const int res = convert(input, accum, count, volL, volR);
+		MixerKernels::clamp(out, accum, res * outChannels);
+
+		total += res;
+		if ((st_size_t)res < count)
+			break;
+	}
+
+	return total;
+}
+
+ResamplerQuality getConfiguredResamplerQuality() {
+	const Common::String quality = ConfMan.get("resampler_quality");
+
+	if (quality.equalsIgnoreCase("fast"))
+		return kResamplerFast;
+	else if (quality.equalsIgnoreCase("sinc"))
+		return kResamplerSinc;
+	else
+		return kResamplerLinear;
+}
+
+void prepareRateConversion(st_rate_t inRate, st_rate_t outRate, ResamplerQuality quality) {
+	if (quality == kResamplerDefault)
+		quality = getConfiguredResamplerQuality();
+
+	if (quality == kResamplerSinc && inRate != outRate)
+		SincFilterMan.getFilter(inRate, outRate);
+}
+
+RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo, ResamplerQuality quality) {
+	if (quality == kResamplerDefault)
+		quality = getConfiguredResamplerQuality();
+
 	if (inStereo) {
 		if (outStereo) {
 			if (reverseStereo)
-				return new RateConverter_Impl<true, true, true>(inRate, outRate);
+				return new RateConverter_Impl<true, true, true>(inRate, outRate, quality);
 			else
-				return new RateConverter_Impl<true, true, false>(inRate, outRate);
+				return new RateConverter_Impl<true, true, false>(inRate, outRate, quality);
 		} else
-			return new RateConverter_Impl<true, false, false>(inRate, outRate);
+			return new RateConverter_Impl<true, false, false>(inRate, outRate, quality);
 	} else {
 		if (outStereo) {
-			return new RateConverter_Impl<false, true, false>(inRate, outRate);
+			return new RateConverter_Impl<false, true, false>(inRate, outRate, quality);
 		} else
-			return new RateConverter_Impl<false, false, false>(inRate, outRate);
+			return new RateConverter_Impl<false, false, false>(inRate, outRate, quality);
 	}
 }
 
@@ -90,6 +90,22 @@ public:
 	 */
 	virtual int convert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r) = 0;
 
+	/**
+	 * Convert the provided AudioStream to the target sample rate, adding the
+	 * result to a 32-bit accumulation buffer. Unlike the 16-bit version, no
+	 * clamping takes place, which allows mixing several streams and saturating
+	 * the sum only once.
+	 *
+	 * @param input			The AudioStream to read data from.
+	 * @param outBuffer		The accumulation buffer. Must have size of at least @p numSamples.
+	 * @param numSamples	The desired number of samples to be added to the buffer.
+	 * @param vol_l			Volume for left channel.
+	 * @param vol_r			Volume for right channel.
+	 *
+	 * @return Number of sample pairs written into the buffer.
+	 */
+	virtual int convert(AudioStream &input, int32 *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r) = 0;
+
 	virtual void setInputRate(st_rate_t inputRate) = 0;
 	virtual void setOutputRate(st_rate_t outputRate) = 0;
 
@@ -104,7 +120,30 @@ public:
 	virtual bool needsDraining() const = 0;
 };
 
-RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo);
+/**
+ * Resampling algorithms, selected with the "resampler_quality" config key.
+ */
+enum ResamplerQuality {
+	kResamplerDefault = -1, /*!< Use the algorithm set in the configuration. */
+	kResamplerFast = 0,     /*!< Nearest neighbour, the cheapest. */
+	kResamplerLinear = 1,   /*!< Linear interpolation. */
+	kResamplerSinc = 2      /*!< Windowed sinc filter, the best quality. */
+};
+
+/**
+ * Return the resampling algorithm set with the "resampler_quality" config key.
+ * Valid values are "fast", "linear" and "sinc".
+ */
+ResamplerQuality getConfiguredResamplerQuality();
+
+/**
+ * Compute the tables a converter between the given rates needs, so that
+ * setInputRate() can switch to these rates from within the audio callback
+ * without having to compute them there.
+ */
+void prepareRateConversion(st_rate_t inRate, st_rate_t outRate, ResamplerQuality quality = kResamplerDefault);
+
+RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo, ResamplerQuality quality = kResamplerDefault);
 
 /** @} */
 } // End of namespace Audio
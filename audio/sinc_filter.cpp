@@ -0,0 +1,138 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audio/sinc_filter.h"
+
+#include "common/util.h"
+
+namespace Common {
+DECLARE_SINGLETON(Audio::SincFilterManager);
+}
+
+namespace Audio {
+
+/** Zeroth order modified Bessel function of the first kind, used by the Kaiser window. */
+static double besselI0(double x) {
+	double sum = 1.0, term = 1.0;
+	const double halfX = x / 2.0;
+
+	for (int k = 1; k < 32; k++) {
+		term *= (halfX / k) * (halfX / k);
+		sum += term;
+		if (term < sum * 1e-12)
+			break;
+	}
+
+	return sum;
+}
+
+uint SincFilter::getRatioKey(st_rate_t inRate, st_rate_t outRate) {
+	if (outRate >= inRate)
+		return kRatioScale;
+
+	return MAX<uint>(1, ((uint64)outRate * kRatioScale) / inRate);
+}
+
+SincFilter::SincFilter(uint ratioKey) : _ratioKey(ratioKey) {
+	// Shape of the Kaiser window, about 70dB of stop band attenuation
+	const double beta = 7.0;
+
+	// Cut off a bit below the lower of both Nyquist frequencies, to leave
+	// room for the transition band
+	const double ratio = (double)ratioKey / kRatioScale;
+	const double cutoff = 0.91 * ratio;
+
+	// When downsampling the pass band shrinks, so widen the filter to keep
+	// the transition band equally steep
+	uint numTaps = (uint)ceil(kBaseTaps / ratio);
+	_numTaps = MIN<uint>((numTaps + 15) & ~15, kMaxTaps);
+
+	_taps.resize(kNumPhases * _numTaps);
+
+	const double halfWidth = _numTaps / 2.0;
+	const double window0 = besselI0(beta);
+	double *coeffs = new double[_numTaps];
+
+	for (uint phase = 0; phase < kNumPhases; phase++) {
+		const double frac = (double)phase / kNumPhases;
+		double sum = 0.0;
+
+		for (uint k = 0; k < _numTaps; k++) {
+			// Distance of the sample from the output position
+			const double t = (double)k - halfWidth + 1.0 - frac;
+			const double x = cutoff * t * M_PI;
+			const double sinc = (x == 0.0) ? 1.0 : sin(x) / x;
+			const double w = t / halfWidth;
+			const double window = (w <= -1.0 || w >= 1.0) ? 0.0 : besselI0(beta * sqrt(1.0 - w * w)) / window0;
+
+			coeffs[k] = sinc * window;
+			sum += coeffs[k];
+		}
+
+		// Normalize to unity gain and quantize. Any rounding error is folded
+		// into the largest tap so constant signals pass through unchanged.
+		int16 *taps = &_taps[phase * _numTaps];
+		int total = 0;
+		uint largest = 0;
+
+		for (uint k = 0; k < _numTaps; k++) {
+			taps[k] = (int16)floor(coeffs[k] / sum * (1 << kCoeffBits) + 0.5);
+			total += taps[k];
+			if (ABS(taps[k]) > ABS(taps[largest]))
+				largest = k;
+		}
+
+		taps[largest] += (1 << kCoeffBits) - total;
+	}
+
+	delete[] coeffs;
+}
+
+SincFilterManager::SincFilterManager() {
+	for (uint i = 0; i <= SincFilter::kRatioScale; i++)
+		_filters[i].store(nullptr, std::memory_order_relaxed);
+}
+
+SincFilterManager::~SincFilterManager() {
+	for (uint i = 0; i <= SincFilter::kRatioScale; i++)
+		delete _filters[i].load(std::memory_order_relaxed);
+}
+
+const SincFilter *SincFilterManager::getFilter(st_rate_t inRate, st_rate_t outRate) {
+	const uint ratioKey = SincFilter::getRatioKey(inRate, outRate);
+
+	Common::StackLock lock(_mutex);
+
+	const SincFilter *filter = _filters[ratioKey].load(std::memory_order_relaxed);
+	if (!filter) {
+		// Publish the filter only once its tables are filled in
+		filter = new SincFilter(ratioKey);
+		_filters[ratioKey].store(filter, std::memory_order_release);
+	}
+
+	return filter;
+}
+
+const SincFilter *SincFilterManager::findFilter(st_rate_t inRate, st_rate_t outRate) const {
+	return _filters[SincFilter::getRatioKey(inRate, outRate)].load(std::memory_order_acquire);
+}
+
+} // End of namespace Audio
@@ -0,0 +1,123 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AUDIO_SINC_FILTER_H
+#define AUDIO_SINC_FILTER_H
+
+#include "common/array.h"
+#include "common/mutex.h"
+#include "common/singleton.h"
+
+#include "audio/rate.h"
+
+#include <atomic>
+
+namespace Audio {
+
+/**
+ * @defgroup audio_sinc_filter Sinc filter
+ * @ingroup audio
+ *
+ * @brief Polyphase filter bank used by the windowed sinc resampler.
+ * @{
+ */
+
+/**
+ * A Kaiser windowed sinc low-pass filter, precomputed for a fixed number
+ * of fractional positions (phases) between two input samples.
+ *
+ * The coefficients are stored as fixed point numbers with kCoeffBits
+ * fractional bits. Tap 0 applies to the oldest sample of the window.
+ *
+ * The filter only depends on the ratio between the output and the input
+ * rate, quantized to 1/kRatioScale, and it is the same for all ratios
+ * above one. So all upsampling conversions share a single filter.
+ */
+class SincFilter {
+public:
+	enum {
+		kPhaseBits = 8,
+		kNumPhases = 1 << kPhaseBits,
+		kCoeffBits = 14,
+		kBaseTaps = 32,
+		kMaxTaps = 128,
+		kRatioScale = 256
+	};
+
+	/** The quantized ratio used for a conversion between the given rates. */
+	static uint getRatioKey(st_rate_t inRate, st_rate_t outRate);
+
+	explicit SincFilter(uint ratioKey);
+
+	uint getRatioKey() const { return _ratioKey; }
+
+	/** The number of taps per phase, always a multiple of 16. */
+	uint getNumTaps() const { return _numTaps; }
+
+	/** The coefficients for the given phase, in the range [0, kNumPhases). */
+	const int16 *getTaps(uint phase) const { return &_taps[phase * _numTaps]; }
+
+private:
+	uint _ratioKey;
+	uint _numTaps;
+	Common::Array<int16> _taps;
+};
+
+/**
+ * Cache of the filter banks in use, so that channels playing at the same
+ * rates share their tables instead of computing them again.
+ *
+ * Filters are never freed before the manager itself, so there is at most
+ * one per quantized ratio. They are published atomically, which lets the
+ * audio callback look them up without locking. Only engine threads compute
+ * them.
+ */
+class SincFilterManager : public Common::Singleton<SincFilterManager> {
+public:
+	~SincFilterManager();
+
+	/**
+	 * Return the filter for the given rates, computing it if needed. This
+	 * allocates memory, so it must not be called from the audio callback.
+	 */
+	const SincFilter *getFilter(st_rate_t inRate, st_rate_t outRate);
+
+	/**
+	 * Return the filter for the given rates if it has already been computed,
+	 * or nullptr otherwise. This neither locks nor allocates, so it is safe
+	 * to call from the audio callback.
+	 */
+	const SincFilter *findFilter(st_rate_t inRate, st_rate_t outRate) const;
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	SincFilterManager();
+
+	Common::Mutex _mutex; ///< Serializes getFilter()
+	std::atomic<const SincFilter *> _filters[SincFilter::kRatioScale + 1];
+};
+
+/** @} */
+} // End of namespace Audio
+
+#define SincFilterMan (::Audio::SincFilterManager::instance())
+
+#endif
@@ -21,6 +21,7 @@
 
 #include "backends/audiocd/default/default-audiocd.h"
 #include "audio/audiostream.h"
+#include "audio/prefetchingstream.h"
 #include "common/config-manager.h"
 #include "common/file.h"
 #include "common/system.h"
@@ -126,8 +127,12 @@ bool DefaultAudioCDManager::play(int track, int numLoops, int startFrame, int du
 			repetitions. Finally, -1 means infinitely many
 			*/
 			_emulating = true;
+
+			// Decode the looped track ahead, so the loop points are prefetched
+			// as well and the mixer callback never has to decode a frame
+			Audio::AudioStream *loopStream = Audio::makeLoopingAudioStream(stream, start, end, (numLoops < 1) ? numLoops + 1 : numLoops);
 			_mixer->playStream(soundType, &_handle,
-			                        Audio::makeLoopingAudioStream(stream, start, end, (numLoops < 1) ? numLoops + 1 : numLoops), -1, _cd.volume, _cd.balance);
+			                        Audio::makePrefetchingAudioStream(loopStream, DisposeAfterUse::YES), -1, _cd.volume, _cd.balance);
 			return true;
 		}
 	}
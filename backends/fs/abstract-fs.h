@@ -62,6 +62,14 @@ protected:
 	 */
 	virtual AbstractFSNode *getChild(const Common::String &name) const = 0;
 
+	/**
+	 * Returns the child node with the given name, when it is already known
+	 * whether it is a directory, e.g. from a cached directory listing.
+	 * Backends where getChild() queries the file system should override this
+	 * to create the node without doing so. By default, getChild() is used.
+	 */
+	virtual AbstractFSNode *getKnownChild(const Common::String &name, bool isDirectory) const { return getChild(name); }
+
 	/**
 	 * The parent node of this directory.
 	 * The parent of the root is the root itself.
@@ -172,6 +180,19 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Returns the last modification time of the object referred by this node
+	 * in nanoseconds, as precise as the file system keeps it, or -1 if it is
+	 * not known. By default, it is not known.
+	 */
+	virtual int64 getModificationTime() const { return -1; }
+
+	/**
+	 * Returns the size of the file referred by this node, or -1 if it is
+	 * not known or the node is not a file. By default, it is not known.
+	 */
+	virtual int64 getFileSize() const { return -1; }
+
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
@@ -192,6 +213,15 @@ public:
 	 */
 	virtual Common::SeekableReadStream *createReadStreamForAltStream(Common::AltStreamType altStreamType);
 
+	/**
+	 * Creates a SeekableReadStream instance corresponding to the file
+	 * referred by this node, which may read the file through a memory
+	 * mapping. The default implementation uses createReadStream().
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	virtual Common::SeekableReadStream *createMappedReadStream();
+
 	/**
 	 * Creates a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -68,6 +68,7 @@ public:
 	Common::SeekableReadStream *createReadStream() override;
 	Common::SeekableWriteStream *createWriteStream() override;
 	AbstractFSNode *getChild(const Common::String &n) const override;
+	AbstractFSNode *getKnownChild(const Common::String &n, bool isDirectory) const override;
 	bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const override;
 	AbstractFSNode *getParent() const override;
 
@@ -67,6 +67,27 @@ bool POSIXFilesystemNode::isWritable() const {
 	return access(_path.c_str(), W_OK) == 0;
 }
 
+int64 POSIXFilesystemNode::getModificationTime() const {
+	struct stat st;
+	if (stat(_path.c_str(), &st) != 0)
+		return -1;
+
+#ifdef HAS_STAT_MTIM
+	// A change within the same second still has to be noticed
+	return (int64)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#else
+	return (int64)st.st_mtime * 1000000000;
+#endif
+}
+
+int64 POSIXFilesystemNode::getFileSize() const {
+	struct stat st;
+	if (stat(_path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+		return -1;
+
+	return st.st_size;
+}
+
 void POSIXFilesystemNode::setFlags() {
 	struct stat st;
 
@@ -137,6 +158,25 @@ AbstractFSNode *POSIXFilesystemNode::getChild(const Common::String &n) const {
 	return makeNode(newPath);
 }
 
+AbstractFSNode *POSIXFilesystemNode::getKnownChild(const Common::String &n, bool isDirectory) const {
+	assert(!_path.empty());
+	assert(_isDirectory);
+
+	// Make sure the string contains no slashes
+	assert(!n.contains('/'));
+
+	// Set up the node like getChildren() does, to avoid a stat() call
+	POSIXFilesystemNode *entry = new POSIXFilesystemNode(*this);
+	entry->_displayName = n;
+	if (_path.lastChar() != '/')
+		entry->_path += '/';
+	entry->_path += n;
+	entry->_isDirectory = isDirectory;
+	entry->_isValid = true;
+
+	return entry;
+}
+
 bool POSIXFilesystemNode::getChildren(AbstractFSList &myList, ListMode mode, bool hidden) const {
 	assert(_isDirectory);
 
@@ -269,6 +309,10 @@ Common::SeekableReadStream *POSIXFilesystemNode::createReadStream() {
 	return PosixIoStream::makeFromPath(getPath(), false);
 }
 
+Common::SeekableReadStream *POSIXFilesystemNode::createMappedReadStream() {
+	return PosixIoStream::makeMappedFromPath(getPath());
+}
+
 Common::SeekableReadStream *POSIXFilesystemNode::createReadStreamForAltStream(Common::AltStreamType altStreamType) {
 #ifdef MACOSX
 	if (altStreamType == Common::AltStreamType::MacResourceFork) {
@@ -60,13 +60,17 @@ public:
 	bool isDirectory() const override { return _isDirectory; }
 	bool isReadable() const override;
 	bool isWritable() const override;
+	int64 getModificationTime() const override;
+	int64 getFileSize() const override;
 
 	AbstractFSNode *getChild(const Common::String &n) const override;
+	AbstractFSNode *getKnownChild(const Common::String &n, bool isDirectory) const override;
 	bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const override;
 	AbstractFSNode *getParent() const override;
 
 	Common::SeekableReadStream *createReadStream() override;
 	Common::SeekableReadStream *createReadStreamForAltStream(Common::AltStreamType altStreamType) override;
+	Common::SeekableReadStream *createMappedReadStream() override;
 	Common::SeekableWriteStream *createWriteStream() override;
 	bool createDirectory() override;
 
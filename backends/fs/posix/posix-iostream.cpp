@@ -23,7 +23,38 @@
 
 #include "backends/fs/posix/posix-iostream.h"
 
+#include "common/memstream.h"
+#include "common/ptr.h"
+
 #include <sys/stat.h>
+#ifdef HAS_MMAP
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef HAS_MMAP
+namespace {
+
+// Smaller files are cheaper to read than to map
+const int64 kMinMappedSize = 256 * 1024;
+
+// Limit the address space used by mappings on 32-bit systems. The size of
+// a MemoryReadStream is also limited to 32 bits.
+const int64 kMaxMappedSize = sizeof(void *) >= 8 ? 0xFFFFFFFFLL : 256 * 1024 * 1024;
+
+struct MunmapDeleter {
+	size_t _size;
+
+	explicit MunmapDeleter(size_t size) : _size(size) {}
+
+	void operator()(byte *data) {
+		munmap(data, _size);
+	}
+};
+
+} // End of anonymous namespace
+#endif
 
 PosixIoStream *PosixIoStream::makeFromPath(const Common::String &path, bool writeMode) {
 #if defined(HAS_FSEEKO64)
@@ -38,6 +69,31 @@ PosixIoStream *PosixIoStream::makeFromPath(const Common::String &path, bool writ
 	return nullptr;
 }
 
+Common::SeekableReadStream *PosixIoStream::makeMappedFromPath(const Common::String &path) {
+#ifdef HAS_MMAP
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd == -1)
+		return nullptr;
+
+	struct stat st;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size >= kMinMappedSize && st.st_size <= kMaxMappedSize) {
+		void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		// The mapping stays valid after the descriptor is closed
+		close(fd);
+
+		if (data != MAP_FAILED) {
+			Common::SharedPtr<byte> mapping((byte *)data, MunmapDeleter(st.st_size));
+			return new Common::MemoryReadStream(mapping, st.st_size);
+		}
+	} else {
+		close(fd);
+	}
+#endif
+
+	return makeFromPath(path, false);
+}
+
 
 PosixIoStream::PosixIoStream(void *handle) :
 		StdioStream(handle) {
@@ -30,6 +30,18 @@
 class PosixIoStream final : public StdioStream {
 public:
 	static PosixIoStream *makeFromPath(const Common::String &path, bool writeMode);
+
+	/**
+	 * Open a file for reading. Large regular files are memory mapped when
+	 * the system supports it, and returned as a Common::MemoryReadStream,
+	 * so they are read without buffering and can be accessed in place.
+	 * Other files are opened as a PosixIoStream.
+	 *
+	 * Accessing a mapping raises SIGBUS once the file is truncated, so
+	 * this is only used for files which are not expected to change, see
+	 * Common::FSNode::createMappedReadStream().
+	 */
+	static Common::SeekableReadStream *makeMappedFromPath(const Common::String &path);
 	PosixIoStream(void *handle);
 
 	int64 size() const override;
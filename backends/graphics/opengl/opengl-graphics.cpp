@@ -72,7 +72,7 @@ OpenGLGraphicsManager::OpenGLGraphicsManager()
 	: _currentState(), _oldState(), _transactionMode(kTransactionNone), _screenChangeID(1 << (sizeof(int) * 8 - 2)),
 	  _pipeline(nullptr), _stretchMode(STRETCH_FIT),
 	  _defaultFormat(), _defaultFormatAlpha(), _targetBuffer(nullptr),
-	  _gameScreen(nullptr), _overlay(nullptr),
+	  _gameScreen(nullptr), _diffScreenUpdates(false), _overlay(nullptr),
 	  _cursor(nullptr), _cursorMask(nullptr),
 	  _cursorHotspotX(0), _cursorHotspotY(0),
 	  _cursorHotspotXScaled(0), _cursorHotspotYScaled(0), _cursorWidthScaled(0), _cursorHeightScaled(0),
@@ -90,6 +90,8 @@ OpenGLGraphicsManager::OpenGLGraphicsManager()
 	{
 	memset(_gamePalette, 0, sizeof(_gamePalette));
 	OpenGLContext.reset();
+
+	_diffScreenUpdates = ConfMan.getBool("diff_screen_updates");
 }
 
 OpenGLGraphicsManager::~OpenGLGraphicsManager() {
@@ -586,7 +588,10 @@ int16 OpenGLGraphicsManager::getHeight() const {
 }
 
 void OpenGLGraphicsManager::copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) {
-	_gameScreen->copyRectToTexture(x, y, w, h, buf, pitch);
+	if (_diffScreenUpdates)
+		_gameScreen->copyChangedRectToTexture(x, y, w, h, buf, pitch);
+	else
+		_gameScreen->copyRectToTexture(x, y, w, h, buf, pitch);
 }
 
 void OpenGLGraphicsManager::fillScreen(uint32 col) {
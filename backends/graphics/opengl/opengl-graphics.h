@@ -350,6 +350,12 @@ protected:
 	 */
 	Surface *_gameScreen;
 
+	/**
+	 * Whether only the changed areas of the game screen updates are
+	 * uploaded to the texture.
+	 */
+	bool _diffScreenUpdates;
+
 	/**
 	 * The game palette if in CLUT8 mode.
 	 */
@@ -43,12 +43,14 @@ GLTexture::GLTexture(GLenum glIntFormat, GLenum glFormat, GLenum glType)
 	: _glIntFormat(glIntFormat), _glFormat(glFormat), _glType(glType),
 	  _width(0), _height(0), _logicalWidth(0), _logicalHeight(0),
 	  _texCoords(), _glFilter(GL_NEAREST),
-	  _glTexture(0) {
+	  _glTexture(0), _pixelBuffers(), _pixelBufferSizes(), _nextPixelBuffer(0),
+	  _mappedArea(), _mappedBuffer(0) {
 	create();
 }
 
 GLTexture::~GLTexture() {
 	GL_CALL_SAFE(glDeleteTextures, (1, &_glTexture));
+	destroyPixelBuffers();
 }
 
 void GLTexture::enableLinearFiltering(bool enable) {
@@ -113,6 +115,22 @@ void GLTexture::setWrapMode(WrapMode wrapMode) {
 void GLTexture::destroy() {
 	GL_CALL(glDeleteTextures(1, &_glTexture));
 	_glTexture = 0;
+	destroyPixelBuffers();
+}
+
+void GLTexture::destroyPixelBuffers() {
+#if !USE_FORCED_GLES && !USE_FORCED_GLES2
+	// The flag is reset when the context goes away, and the buffers with it.
+	if (OpenGLContext.pixelBufferObjectSupported) {
+		GL_CALL(glDeleteBuffers(kPixelBufferCount, _pixelBuffers));
+	}
+#endif
+
+	for (uint i = 0; i < kPixelBufferCount; ++i) {
+		_pixelBuffers[i] = 0;
+		_pixelBufferSizes[i] = 0;
+	}
+	_mappedArea = Common::Rect();
 }
 
 void GLTexture::create() {
@@ -196,16 +214,28 @@ bool GLTexture::setSize(uint width, uint height) {
 }
 
 void GLTexture::updateArea(const Common::Rect &area, const Graphics::Surface &src) {
+	const uint bpp = src.format.bytesPerPixel;
+
+	// Stream the data through a pixel buffer when possible, so that the
+	// upload does not stall until the GPU is done with the texture.
+	uint pitch;
+	byte *dst = mapArea(area, bpp, pitch);
+	if (dst) {
+		Graphics::copyBlit(dst, (const byte *)src.getBasePtr(area.left, area.top),
+		                   pitch, src.pitch, area.width(), area.height(), bpp);
+		if (unmapArea()) {
+			return;
+		}
+	}
+
 	// Set the texture on the active texture unit.
 	bind();
 
 	// Update the actual texture.
-	// Although we have the area of the texture buffer we want to update we
-	// cannot take advantage of the left/right boundaries here because it is
-	// not possible to specify a pitch to glTexSubImage2D. To be precise, with
-	// plain OpenGL we could set GL_UNPACK_ROW_LENGTH to achieve this. However,
-	// OpenGL ES 1.0 does not support GL_UNPACK_ROW_LENGTH. Thus, we are left
-	// with the following options:
+	// When GL_UNPACK_ROW_LENGTH is available we can tell OpenGL the pitch of
+	// the surface and only upload the area itself. OpenGL ES 1.0 and plain
+	// OpenGL ES 2.0 do not support it though. Thus, we are left with the
+	// following options there:
 	//
 	// 1) (As we do right now) Simply always update the whole texture lines of
 	//    rect changed. This is simplest to implement. In case performance is
@@ -217,10 +247,91 @@ void GLTexture::updateArea(const Common::Rect &area, const Graphics::Surface &sr
 	//
 	// 3) Use glTexSubImage2D per line changed. This is what the old OpenGL
 	//    graphics manager did but it is much slower! Thus, we do not use it.
+#if !USE_FORCED_GLES
+	if (OpenGLContext.unpackSubImageSupported) {
+		GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, src.pitch / bpp));
+		GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, area.left, area.top, area.width(), area.height(),
+		                       _glFormat, _glType, src.getBasePtr(area.left, area.top)));
+		GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+		return;
+	}
+#endif
+
 	GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, area.top, src.w, area.height(),
 	                       _glFormat, _glType, src.getBasePtr(0, area.top)));
 }
 
+byte *GLTexture::mapArea(const Common::Rect &area, uint bytesPerPixel, uint &pitch) {
+#if !USE_FORCED_GLES && !USE_FORCED_GLES2
+	if (!OpenGLContext.pixelBufferObjectSupported || area.isEmpty()) {
+		return nullptr;
+	}
+
+	const uint index = _nextPixelBuffer;
+	pitch = area.width() * bytesPerPixel;
+	const uint size = pitch * area.height();
+
+	if (!_pixelBuffers[index]) {
+		GL_CALL(glGenBuffers(1, &_pixelBuffers[index]));
+	}
+
+	GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pixelBuffers[index]));
+	if (size > _pixelBufferSizes[index]) {
+		GL_CALL(glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW));
+		_pixelBufferSizes[index] = size;
+	}
+
+	// Invalidating the buffer lets the driver hand out fresh memory instead
+	// of waiting for a pending upload from the old contents to finish. This
+	// gives what a persistently mapped buffer (ARB_buffer_storage) would,
+	// without fences to track the buffers the GPU still reads from. GLAD
+	// does not load glBufferStorage anyway.
+	void *data;
+	GL_ASSIGN(data, glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+
+	// Unbind the buffer again, so that uploads to other textures are not
+	// taken from it while this one is being written.
+	GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+	if (!data) {
+		return nullptr;
+	}
+
+	_nextPixelBuffer = (index + 1) % kPixelBufferCount;
+	_mappedBuffer = index;
+	_mappedArea = area;
+	return (byte *)data;
+#else
+	return nullptr;
+#endif
+}
+
+bool GLTexture::unmapArea() {
+#if !USE_FORCED_GLES && !USE_FORCED_GLES2
+	if (_mappedArea.isEmpty()) {
+		return false;
+	}
+
+	const Common::Rect area = _mappedArea;
+	_mappedArea = Common::Rect();
+
+	GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pixelBuffers[_mappedBuffer]));
+
+	GLboolean valid;
+	GL_ASSIGN(valid, glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+	if (valid) {
+		bind();
+		GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, area.left, area.top, area.width(), area.height(),
+		                       _glFormat, _glType, nullptr));
+	}
+
+	GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+	return valid == GL_TRUE;
+#else
+	return false;
+#endif
+}
+
 //
 // Surface
 //
@@ -252,6 +363,21 @@ void Surface::copyRectToTexture(uint x, uint y, uint w, uint h, const void *srcP
 	}
 }
 
+void Surface::copyChangedRectToTexture(uint x, uint y, uint w, uint h, const void *srcPtr, uint srcPitch) {
+	Graphics::Surface *dstSurf = getSurface();
+	assert(x + w <= (uint)dstSurf->w);
+	assert(y + h <= (uint)dstSurf->h);
+
+	Graphics::copyBlitChanged((byte *)dstSurf->getBasePtr(x, y), (const byte *)srcPtr,
+	                          dstSurf->pitch, srcPitch, w, h, dstSurf->format.bytesPerPixel, _changedAreas);
+
+	for (uint i = 0; i < _changedAreas.size(); ++i) {
+		Common::Rect area = _changedAreas[i];
+		area.translate(x, y);
+		addDirtyArea(area);
+	}
+}
+
 void Surface::fill(uint32 color) {
 	Graphics::Surface *dst = getSurface();
 	dst->fillRect(Common::Rect(dst->w, dst->h), color);
@@ -348,6 +474,14 @@ void Texture::updateGLTexture() {
 	updateGLTexture(dirtyArea);
 }
 
+byte *Texture::beginUpdate(const Common::Rect &area, uint &pitch) {
+	// The converted data is kept in the texture data rather than written
+	// straight to a mapped pixel buffer. It is what the edge duplication for
+	// linear filtering reads, and what is left once the buffers are gone.
+	pitch = _textureData.pitch;
+	return (byte *)_textureData.getBasePtr(area.left, area.top);
+}
+
 void Texture::updateGLTexture(Common::Rect &dirtyArea) {
 	// In case we use linear filtering we might need to duplicate the last
 	// pixel row/column to avoid glitches with filtering.
@@ -461,17 +595,16 @@ void FakeTexture::updateGLTexture() {
 	}
 
 	// Convert color space.
-	Graphics::Surface *outSurf = Texture::getSurface();
-
-	const Common::Rect dirtyArea = getDirtyArea();
+	Common::Rect dirtyArea = getDirtyArea();
 
-	byte *dst = (byte *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top);
+	uint dstPitch;
+	byte *dst = beginUpdate(dirtyArea, dstPitch);
 	const byte *src = (const byte *)_rgbData.getBasePtr(dirtyArea.left, dirtyArea.top);
 
-	applyPaletteAndMask(dst, src, outSurf->pitch, _rgbData.pitch, _rgbData.w, dirtyArea, outSurf->format, _rgbData.format);
+	applyPaletteAndMask(dst, src, dstPitch, _rgbData.pitch, _rgbData.w, dirtyArea, _format, _rgbData.format);
 
 	// Do generic handling of updating the texture.
-	Texture::updateGLTexture();
+	Texture::updateGLTexture(dirtyArea);
 }
 
 void FakeTexture::applyPaletteAndMask(byte *dst, const byte *src, uint dstPitch, uint srcPitch, uint srcWidth, const Common::Rect &dirtyArea, const Graphics::PixelFormat &dstFormat, const Graphics::PixelFormat &srcFormat) const {
@@ -518,12 +651,11 @@ void TextureRGB555::updateGLTexture() {
 	}
 
 	// Convert color space.
-	Graphics::Surface *outSurf = Texture::getSurface();
-
-	const Common::Rect dirtyArea = getDirtyArea();
+	Common::Rect dirtyArea = getDirtyArea();
 
-	uint16 *dst = (uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top);
-	const uint dstAdd = outSurf->pitch - 2 * dirtyArea.width();
+	uint dstPitch;
+	uint16 *dst = (uint16 *)beginUpdate(dirtyArea, dstPitch);
+	const uint dstAdd = dstPitch - 2 * dirtyArea.width();
 
 	const uint16 *src = (const uint16 *)_rgbData.getBasePtr(dirtyArea.left, dirtyArea.top);
 	const uint srcAdd = _rgbData.pitch - 2 * dirtyArea.width();
@@ -542,7 +674,7 @@ void TextureRGB555::updateGLTexture() {
 	}
 
 	// Do generic handling of updating the texture.
-	Texture::updateGLTexture();
+	Texture::updateGLTexture(dirtyArea);
 }
 
 TextureRGBA8888Swap::TextureRGBA8888Swap()
@@ -560,12 +692,11 @@ void TextureRGBA8888Swap::updateGLTexture() {
 	}
 
 	// Convert color space.
-	Graphics::Surface *outSurf = Texture::getSurface();
-
-	const Common::Rect dirtyArea = getDirtyArea();
+	Common::Rect dirtyArea = getDirtyArea();
 
-	uint32 *dst = (uint32 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top);
-	const uint dstAdd = outSurf->pitch - 4 * dirtyArea.width();
+	uint dstPitch;
+	uint32 *dst = (uint32 *)beginUpdate(dirtyArea, dstPitch);
+	const uint dstAdd = dstPitch - 4 * dirtyArea.width();
 
 	const uint32 *src = (const uint32 *)_rgbData.getBasePtr(dirtyArea.left, dirtyArea.top);
 	const uint srcAdd = _rgbData.pitch - 4 * dirtyArea.width();
@@ -582,7 +713,7 @@ void TextureRGBA8888Swap::updateGLTexture() {
 	}
 
 	// Do generic handling of updating the texture.
-	Texture::updateGLTexture();
+	Texture::updateGLTexture(dirtyArea);
 }
 
 #ifdef USE_SCALERS
@@ -627,8 +758,6 @@ void ScaledTexture::updateGLTexture() {
 	}
 
 	// Convert color space.
-	Graphics::Surface *outSurf = Texture::getSurface();
-
 	Common::Rect dirtyArea = getDirtyArea();
 
 	// Extend the dirty region for scalers
@@ -651,24 +780,21 @@ void ScaledTexture::updateGLTexture() {
 		srcPitch = dstPitch;
 	}
 
-	dst = (byte *)outSurf->getBasePtr(dirtyArea.left * _scaleFactor, dirtyArea.top * _scaleFactor);
-	dstPitch = outSurf->pitch;
+	Common::Rect scaledArea(dirtyArea.left * _scaleFactor, dirtyArea.top * _scaleFactor,
+	                        dirtyArea.right * _scaleFactor, dirtyArea.bottom * _scaleFactor);
+
+	dst = beginUpdate(scaledArea, dstPitch);
 
 	if (_scaler && (uint)dirtyArea.height() >= _extraPixels) {
 		_scaler->scale(src, srcPitch, dst, dstPitch, dirtyArea.width(), dirtyArea.height(), dirtyArea.left, dirtyArea.top);
 	} else {
 		Graphics::scaleBlit(dst, src, dstPitch, srcPitch,
-		                    dirtyArea.width() * _scaleFactor, dirtyArea.height() * _scaleFactor,
-		                    dirtyArea.width(), dirtyArea.height(), outSurf->format);
+		                    scaledArea.width(), scaledArea.height(),
+		                    dirtyArea.width(), dirtyArea.height(), _format);
 	}
 
-	dirtyArea.left   *= _scaleFactor;
-	dirtyArea.right  *= _scaleFactor;
-	dirtyArea.top    *= _scaleFactor;
-	dirtyArea.bottom *= _scaleFactor;
-
 	// Do generic handling of updating the texture.
-	Texture::updateGLTexture(dirtyArea);
+	Texture::updateGLTexture(scaledArea);
 }
 
 void ScaledTexture::setScaler(uint scalerIndex, int scaleFactor) {
@@ -28,6 +28,7 @@
 #include "graphics/pixelformat.h"
 #include "graphics/surface.h"
 
+#include "common/array.h"
 #include "common/rect.h"
 
 class Scaler;
@@ -114,6 +115,29 @@ public:
 	 */
 	void updateArea(const Common::Rect &area, const Graphics::Surface &src);
 
+	/**
+	 * Map memory to write the pixel data for an area of the texture to.
+	 *
+	 * The data is stored in a pixel buffer object, which is uploaded by
+	 * unmapArea() without waiting for the GPU to finish rendering. The
+	 * rows of the area are packed tightly, starting at its top left pixel.
+	 *
+	 * @param area          The area to update.
+	 * @param bytesPerPixel The size of a pixel in the input format.
+	 * @param pitch         Receives the number of bytes in a row of the area.
+	 * @return The mapped memory, or nullptr if pixel buffer objects are
+	 *         not available. updateArea has to be used in that case.
+	 */
+	byte *mapArea(const Common::Rect &area, uint bytesPerPixel, uint &pitch);
+
+	/**
+	 * Upload the area mapped by mapArea() to the texture.
+	 *
+	 * @return Whether the call was successful. If not, the contents of the
+	 *         mapped memory were lost and the area has to be updated again.
+	 */
+	bool unmapArea();
+
 	/**
 	 * Query the GL texture's width.
 	 */
@@ -147,6 +171,8 @@ public:
 	 */
 	GLuint getGLTexture() const { return _glTexture; }
 private:
+	void destroyPixelBuffers();
+
 	const GLenum _glIntFormat;
 	const GLenum _glFormat;
 	const GLenum _glType;
@@ -158,6 +184,19 @@ private:
 	GLint _glFilter;
 
 	GLuint _glTexture;
+
+	/**
+	 * The pixel buffers used by mapArea. They are used in turn, so that
+	 * uploads from one buffer can go on while the next one is written.
+	 */
+	enum { kPixelBufferCount = 3 };
+	GLuint _pixelBuffers[kPixelBufferCount];
+	uint _pixelBufferSizes[kPixelBufferCount];
+	uint _nextPixelBuffer;
+
+	/** The currently mapped area, empty when nothing is mapped. */
+	Common::Rect _mappedArea;
+	uint _mappedBuffer;
 };
 
 /**
@@ -215,6 +254,15 @@ public:
 	 */
 	void copyRectToTexture(uint x, uint y, uint w, uint h, const void *src, uint srcPitch);
 
+	/**
+	 * Copy image data to the surface like copyRectToTexture, but only mark
+	 * the areas which differ from the current contents as dirty.
+	 *
+	 * This costs a comparison of the image data, but saves uploading the
+	 * unchanged areas to the GL texture.
+	 */
+	void copyChangedRectToTexture(uint x, uint y, uint w, uint h, const void *src, uint srcPitch);
+
 	/**
 	 * Fill the surface with a fixed color.
 	 *
@@ -271,6 +319,8 @@ protected:
 private:
 	bool _allDirty;
 	Common::Rect _dirtyArea;
+
+	Common::Array<Common::Rect> _changedAreas;
 };
 
 /**
@@ -314,6 +364,19 @@ public:
 protected:
 	const Graphics::PixelFormat _format;
 
+	/**
+	 * Obtain the memory to write the texture data of an area to.
+	 *
+	 * This points into the texture data, which always holds the whole
+	 * texture. The area has to be passed on to updateGLTexture(dirtyArea)
+	 * afterwards, which streams it through a pixel buffer when possible.
+	 *
+	 * @param area  The area to update, in texture pixels.
+	 * @param pitch Receives the number of bytes in a row of the returned memory.
+	 * @return The memory for the top left pixel of the area.
+	 */
+	byte *beginUpdate(const Common::Rect &area, uint &pitch);
+
 	void updateGLTexture(Common::Rect &dirtyArea);
 
 private:
@@ -136,7 +136,8 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 #endif
 	_transactionMode(kTransactionNone),
 	_scalerPlugins(ScalerMan.getPlugins()), _scalerPlugin(nullptr), _scaler(nullptr),
-	_needRestoreAfterOverlay(false), _isInOverlayPalette(false), _isDoubleBuf(false), _prevForceRedraw(false), _numPrevDirtyRects(0),
+	_diffScreenUpdates(false),
+	_needRestoreAfterOverlay(false), _isInOverlayPalette(false), _isDoubleBuf(false), _prevForceRedraw(false),
 	_prevCursorNeedsRedraw(false),
 	_mouseKeyColor(0) {
 
@@ -179,6 +180,7 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 	_videoMode.stretchMode = STRETCH_FIT;
 #endif
 	_videoMode.vsync = ConfMan.getBool("vsync");
+	_diffScreenUpdates = ConfMan.getBool("diff_screen_updates");
 
 	_videoMode.scalerIndex = getDefaultScaler();
 	_videoMode.scaleFactor = getDefaultScaleFactor();
@@ -1306,40 +1308,53 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 
 	// In case of double buferring partially good version may be on another page,
 	// so we need to fully redraw
-	if (_isDoubleBuf && _numDirtyRects)
+	if (_isDoubleBuf && !_dirtyTiles.isEmpty())
 		_forceRedraw = true;
 
 	bool doRedraw = _forceRedraw || (_prevForceRedraw && _isDoubleBuf);
-	int actualDirtyRects = _numDirtyRects;
-	if (_isDoubleBuf && _numPrevDirtyRects > 0) {
-		memcpy(_dirtyRectList + _numDirtyRects, _prevDirtyRectList, _numPrevDirtyRects * sizeof(_dirtyRectList[0]));
-		actualDirtyRects += _numPrevDirtyRects;
-	}
 
 	// Force a full redraw if requested.
 	// If _useOldSrc, the scaler will do its own partial updates.
 	if (doRedraw) {
-		actualDirtyRects = 1;
+		_dirtyRectList.resize(1);
 		_dirtyRectList[0].x = 0;
 		_dirtyRectList[0].y = 0;
 		_dirtyRectList[0].w = width;
 		_dirtyRectList[0].h = height;
+	} else {
+		_dirtyTiles.getRects(_dirtyTileRects);
+		_dirtyRectList.resize(_dirtyTileRects.size());
+
+		for (uint i = 0; i < _dirtyTileRects.size(); ++i) {
+			int x = _dirtyTileRects[i].left;
+			int y = _dirtyTileRects[i].top;
+			int w = _dirtyTileRects[i].width();
+			int h = _dirtyTileRects[i].height();
+
+#ifdef USE_ASPECT
+			// The tiles do not keep the alignment of the rects that were added
+			if (_videoMode.aspectRatioCorrection && !_overlayInGUI)
+				makeRectStretchable(x, y, w, h, _videoMode.filtering);
+#endif
+
+			_dirtyRectList[i].x = x;
+			_dirtyRectList[i].y = y;
+			_dirtyRectList[i].w = w;
+			_dirtyRectList[i].h = h;
+		}
 	}
+	const int actualDirtyRects = _dirtyRectList.size();
 
 	_prevForceRedraw = _forceRedraw;
-	if (!_prevForceRedraw && _numDirtyRects && _isDoubleBuf) {
-		memcpy(_prevDirtyRectList, _dirtyRectList, _numDirtyRects * sizeof(_dirtyRectList[0]));
-		_numPrevDirtyRects = _numDirtyRects;
-	}
 
 	// Only draw anything if necessary
 	if (actualDirtyRects > 0 || _cursorNeedsRedraw) {
 		SDL_Rect *r;
 		SDL_Rect dst;
 		uint32 bpp, srcPitch, dstPitch;
-		SDL_Rect *lastRect = _dirtyRectList + actualDirtyRects;
+		SDL_Rect *lastRect = _dirtyRectList.data() + actualDirtyRects;
 
-		for (r = _dirtyRectList; r != lastRect; ++r) {
+		for (r = _dirtyRectList.data(); r != lastRect; ++r) {
 			dst = *r;
 			dst.x += _maxExtraPixels;	// Shift rect since some scalers need to access the data around
 			dst.y += _maxExtraPixels;	// any pixel to scale it, and we want to avoid mem access crashes.
@@ -1355,7 +1370,7 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		srcPitch = srcSurf->pitch;
 		dstPitch = _hwScreen->pitch;
 
-		for (r = _dirtyRectList; r != lastRect; ++r) {
+		for (r = _dirtyRectList.data(); r != lastRect; ++r) {
 			int src_x = r->x;
 			int src_y = r->y;
 			int dst_x = r->x;
@@ -1399,8 +1414,10 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 				if (_videoMode.aspectRatioCorrection && !_overlayInGUI)
 					dst_y = real2Aspect(dst_y);
 
-				_scaler->scale((byte *)srcSurf->pixels + (src_x + _maxExtraPixels) * bpp + (src_y + _maxExtraPixels) * srcPitch, srcPitch,
-						(byte *)_hwScreen->pixels + dst_x * bpp + dst_y * dstPitch, dstPitch, dst_w, dst_h, src_x, src_y);
+				const byte *srcPtr = (const byte *)srcSurf->pixels + (src_x + _maxExtraPixels) * bpp + (src_y + _maxExtraPixels) * srcPitch;
+				byte *dstPtr = (byte *)_hwScreen->pixels + dst_x * bpp + dst_y * dstPitch;
+
+				_scaler->scaleInBands(srcPtr, srcPitch, dstPtr, dstPitch, dst_w, dst_h, src_x, src_y);
 
 				r->x = dst_x;
 				r->y = dst_y;
@@ -1510,14 +1527,14 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 
 		// Finally, blit all our changes to the screen
 		if (!_displayDisabled) {
-			updateScreen(_dirtyRectList, actualDirtyRects);
+			updateScreen(_dirtyRectList.data(), actualDirtyRects);
 		}
 	}
 
 	// Set up the old scale factor
 	_scaler->setFactor(oldScaleFactor);
 
-	_numDirtyRects = 0;
+	_dirtyTiles.clear();
 	_forceRedraw = false;
 	_cursorNeedsRedraw = false;
 #if !SDL_VERSION_ATLEAST(2, 0, 0)
@@ -1647,16 +1664,23 @@ void SurfaceSdlGraphicsManager::copyRectToScreen(const void *buf, int pitch, int
 	assert(h > 0 && y + h <= _videoMode.screenHeight);
 	assert(w > 0 && x + w <= _videoMode.screenWidth);
 
-	addDirtyRect(x, y, w, h, false);
-
 	// Try to lock the screen surface
 	if (SDL_LockSurface(_screen) == -1)
 		error("SDL_LockSurface failed: %s", SDL_GetError());
 
 	byte *dst = (byte *)_screen->pixels + y * _screen->pitch + x * _screenFormat.bytesPerPixel;
-	if (_videoMode.screenWidth == w && pitch == _screen->pitch) {
+	if (_diffScreenUpdates) {
+		// Only redraw the areas which differ from what is on the screen
+		Graphics::copyBlitChanged(dst, (const byte *)buf, _screen->pitch, pitch, w, h, _screenFormat.bytesPerPixel, _changedAreas);
+		for (uint i = 0; i < _changedAreas.size(); ++i) {
+			const Common::Rect &r = _changedAreas[i];
+			addDirtyRect(x + r.left, y + r.top, r.width(), r.height(), false);
+		}
+	} else if (_videoMode.screenWidth == w && pitch == _screen->pitch) {
+		addDirtyRect(x, y, w, h, false);
 		memcpy(dst, buf, h*pitch);
 	} else {
+		addDirtyRect(x, y, w, h, false);
 		const byte *src = (const byte *)buf;
 		do {
 			memcpy(dst, src, w * _screenFormat.bytesPerPixel);
@@ -1723,7 +1747,11 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool in
 	if (_forceRedraw)
 		return;
 
-	if (_numDirtyRects == NUM_DIRTY_RECT) {
+	// The same tiles are used for the game screen and the overlay
+	const int tilesWidth = MAX<int>(_videoMode.screenWidth, _videoMode.overlayWidth);
+	const int tilesHeight = MAX<int>(_videoMode.screenHeight, _videoMode.overlayHeight);
+	if (_dirtyTiles.getWidth() != tilesWidth || _dirtyTiles.getHeight() != tilesHeight) {
+		_dirtyTiles.resize(tilesWidth, tilesHeight);
 		_forceRedraw = true;
 		return;
 	}
@@ -1778,14 +1806,8 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool in
 		return;
 	}
 
-	if (w > 0 && h > 0) {
-		SDL_Rect *r = &_dirtyRectList[_numDirtyRects++];
-
-		r->x = x;
-		r->y = y;
-		r->w = w;
-		r->h = h;
-	}
+	if (w > 0 && h > 0)
+		_dirtyTiles.addRect(Common::Rect(x, y, x + w, y + h));
 }
 
 int16 SurfaceSdlGraphicsManager::getHeight() const {
@@ -1922,14 +1944,12 @@ void SurfaceSdlGraphicsManager::clearOverlay() {
 	// Transpose from game palette to RGB332 (overlay palette)
 	if (_isHwPalette) {
 		byte *p = (byte *)(_tmpscreen->pixels) + _maxExtraPixels * _tmpscreen->pitch + _maxExtraPixels * _tmpscreen->format->BytesPerPixel;
-		int pitchSkip = _tmpscreen->pitch - _videoMode.screenWidth;
-		for (int y = 0; y < _videoMode.screenHeight; y++) {
-			for (int x = 0; x < _videoMode.screenWidth; x++, p++) {
-				const SDL_Color &col = _currentPalette[*p];
-				*p = (col.r & 0xe0) | ((col.g >> 3) & 0x1c) | ((col.b >> 6) & 0x03);
-			}
-			p += pitchSkip;
+		uint32 map[256];
+		for (int i = 0; i < 256; i++) {
+			const SDL_Color &col = _currentPalette[i];
+			map[i] = (col.r & 0xe0) | ((col.g >> 3) & 0x1c) | ((col.b >> 6) & 0x03);
 		}
+		Graphics::crossBlitMap(p, p, _tmpscreen->pitch, _tmpscreen->pitch, _videoMode.screenWidth, _videoMode.screenHeight, 1, map);
 	}
 
 	_scaler->scale((byte *)(_tmpscreen->pixels) + _maxExtraPixels * _tmpscreen->pitch + _maxExtraPixels * _tmpscreen->format->BytesPerPixel, _tmpscreen->pitch,
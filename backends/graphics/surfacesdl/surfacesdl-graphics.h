@@ -24,6 +24,7 @@
 
 #include "backends/graphics/graphics.h"
 #include "backends/graphics/sdl/sdl-graphics.h"
+#include "graphics/dirty_tile_map.h"
 #include "graphics/pixelformat.h"
 #include "graphics/scaler.h"
 #include "graphics/scalerplugin.h"
@@ -44,6 +45,7 @@ enum {
 };
 
 
+
 /**
  * SDL graphics manager
  */
@@ -333,6 +335,11 @@ protected:
 	const PluginList &_scalerPlugins;
 	ScalerPluginObject *_scalerPlugin;
 	Scaler *_scaler, *_mouseScaler;
+
+	// Compare the game screen updates with the current contents, and only
+	// redraw the areas which have changed
+	bool _diffScreenUpdates;
+	Common::Array<Common::Rect> _changedAreas;
 	uint _maxExtraPixels;
 	uint _extraPixels;
 
@@ -342,19 +349,15 @@ protected:
 	int _screenChangeCount;
 
 	enum {
-		NUM_DIRTY_RECT = 100,
 		MAX_SCALING = 3
 	};
 
 	// Dirty rect management
-	// When double-buffering we need to redraw both updates from
-	// current frame and previous frame. For convenience we copy
-	// them here before traversing the list.
-	SDL_Rect _dirtyRectList[2 * NUM_DIRTY_RECT];
-	int _numDirtyRects;
-
-	SDL_Rect _prevDirtyRectList[NUM_DIRTY_RECT];
-	int _numPrevDirtyRects;
+	// The dirty areas are collected as tiles, in game or overlay
+	// coordinates, and turned into a list of rects when updating the screen.
+	Graphics::DirtyTileMap _dirtyTiles;
+	Common::Array<Common::Rect> _dirtyTileRects;
+	Common::Array<SDL_Rect> _dirtyRectList;
 
 	struct MousePos {
 		// The size and hotspot of the original cursor image.
@@ -56,9 +56,9 @@ typedef void (*sighandler_t)(int);
 #include "backends/timer/default/default-timer.h"
 #include "backends/events/default/default-events.h"
 #include "backends/mixer/null/null-mixer.h"
-#include "backends/graphics/null/null-graphics.h"
 #include "gui/debugger.h"
 #endif
+#include "backends/graphics/null/null-graphics.h"
 
 /*
  * Include header files needed for the getFilesystemFactory() method.
@@ -95,6 +95,12 @@ public:
 
 	virtual void addSysArchivesToSearchSet(Common::SearchSet &s, int priority);
 
+#ifdef NULL_DRIVER_USE_FOR_TEST
+	virtual bool hasFeature(Feature f);
+	virtual int getParallelJobCount();
+	virtual void runParallel(ParallelJobFunc func, void *data, int numJobs);
+#endif
+
 private:
 #ifdef POSIX
 	timeval _startTime;
@@ -119,6 +125,11 @@ OSystem_NULL::OSystem_NULL(bool silenceLogs) :
 	#else
 		#error Unknown and unsupported FS backend
 	#endif
+
+#ifdef NULL_DRIVER_USE_FOR_TEST
+	// Let the code under test ask for the screen format
+	_graphicsManager = new NullGraphicsManager();
+#endif
 }
 
 OSystem_NULL::~OSystem_NULL() {
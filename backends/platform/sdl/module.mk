@@ -2,6 +2,7 @@ MODULE := backends/platform/sdl
 
 MODULE_OBJS := \
 	sdl.o \
+	sdl-threadpool.o \
 	sdl-window.o
 
 ifdef KOLIBRIOS
@@ -0,0 +1,198 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/platform/sdl/sdl-threadpool.h"
+#include "common/config-manager.h"
+#include "common/textconsole.h"
+
+SdlThreadPool::SdlThreadPool(int numThreads) :
+	_func(nullptr), _data(nullptr), _numJobs(0), _nextJob(0), _jobsDone(0), _batch(0), _quit(false) {
+
+	_mutex = SDL_CreateMutex();
+	_workCond = SDL_CreateCond();
+	_doneCond = SDL_CreateCond();
+
+	for (int i = 0; i < numThreads; ++i) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+		SDL_Thread *thread = SDL_CreateThread(threadProc, "ScummVM worker", this);
+#else
+		SDL_Thread *thread = SDL_CreateThread(threadProc, this);
+#endif
+		if (!thread) {
+			warning("Could not create a worker thread: %s", SDL_GetError());
+			break;
+		}
+		_threads.push_back(thread);
+	}
+}
+
+SdlThreadPool::~SdlThreadPool() {
+	SDL_LockMutex(_mutex);
+	_quit = true;
+	SDL_CondBroadcast(_workCond);
+	SDL_UnlockMutex(_mutex);
+
+	for (uint i = 0; i < _threads.size(); ++i)
+		SDL_WaitThread(_threads[i], nullptr);
+
+	SDL_DestroyCond(_doneCond);
+	SDL_DestroyCond(_workCond);
+	SDL_DestroyMutex(_mutex);
+}
+
+int SdlThreadPool::getConfiguredThreads() {
+	int threads = ConfMan.hasKey("render_threads") ? ConfMan.getInt("render_threads") : 2;
+
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	// More threads than cores only add switching between them
+	const int cores = MAX(SDL_GetCPUCount(), 1);
+	if (threads <= 0 || threads > cores)
+		threads = cores;
+#else
+	if (threads <= 0)
+		threads = 1;
+#endif
+
+	return threads - 1;
+}
+
+void SdlThreadPool::run(OSystem::ParallelJobFunc func, void *data, int numJobs) {
+	SDL_LockMutex(_mutex);
+
+	// The threads are busy with the jobs of another call, which may be the
+	// caller of this one. Run these jobs here instead of waiting for them.
+	if (_func) {
+		SDL_UnlockMutex(_mutex);
+		for (int i = 0; i < numJobs; i++)
+			func(data, i);
+		return;
+	}
+
+	_func = func;
+	_data = data;
+	_numJobs = numJobs;
+	_nextJob = 0;
+	_jobsDone = 0;
+	_batch++;
+	SDL_CondBroadcast(_workCond);
+
+	runJobs();
+
+	while (_jobsDone < _numJobs)
+		SDL_CondWait(_doneCond, _mutex);
+
+	_func = nullptr;
+	SDL_UnlockMutex(_mutex);
+}
+
+void SdlThreadPool::runJobs() {
+	while (_nextJob < _numJobs) {
+		const int job = _nextJob++;
+
+		SDL_UnlockMutex(_mutex);
+		_func(_data, job);
+		SDL_LockMutex(_mutex);
+
+		if (++_jobsDone == _numJobs)
+			SDL_CondSignal(_doneCond);
+	}
+}
+
+int SDLCALL SdlThreadPool::threadProc(void *pool) {
+	((SdlThreadPool *)pool)->work();
+	return 0;
+}
+
+void SdlThreadPool::work() {
+	SDL_LockMutex(_mutex);
+
+	uint lastBatch = _batch;
+	while (true) {
+		while (!_quit && _batch == lastBatch)
+			SDL_CondWait(_workCond, _mutex);
+
+		if (_quit)
+			break;
+
+		lastBatch = _batch;
+		if (_func)
+			runJobs();
+	}
+
+	SDL_UnlockMutex(_mutex);
+}
+
+SdlBackgroundThread::SdlBackgroundThread(OSystem::BackgroundThreadProc proc, void *data, int32 interval) :
+	_proc(proc), _data(data), _intervalMillis(MAX<int32>(interval / 1000, 1)), _quit(false) {
+
+	_mutex = SDL_CreateMutex();
+	_quitCond = SDL_CreateCond();
+
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	_thread = SDL_CreateThread(threadProc, "ScummVM background", this);
+#else
+	_thread = SDL_CreateThread(threadProc, this);
+#endif
+	if (!_thread)
+		warning("Could not create a background thread: %s", SDL_GetError());
+}
+
+SdlBackgroundThread::~SdlBackgroundThread() {
+	if (_thread) {
+		SDL_LockMutex(_mutex);
+		_quit = true;
+		SDL_CondSignal(_quitCond);
+		SDL_UnlockMutex(_mutex);
+
+		SDL_WaitThread(_thread, nullptr);
+	}
+
+	SDL_DestroyCond(_quitCond);
+	SDL_DestroyMutex(_mutex);
+}
+
+int SDLCALL SdlBackgroundThread::threadProc(void *thread) {
+	((SdlBackgroundThread *)thread)->work();
+	return 0;
+}
+
+void SdlBackgroundThread::work() {
+	SDL_LockMutex(_mutex);
+
+	while (!_quit) {
+		SDL_UnlockMutex(_mutex);
+		_proc(_data);
+		SDL_LockMutex(_mutex);
+
+		// Sleep, unless the thread is being stopped
+		if (!_quit)
+			SDL_CondWaitTimeout(_quitCond, _mutex, _intervalMillis);
+	}
+
+	SDL_UnlockMutex(_mutex);
+}
+
+#endif
@@ -0,0 +1,118 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef BACKENDS_PLATFORM_SDL_THREADPOOL_H
+#define BACKENDS_PLATFORM_SDL_THREADPOOL_H
+
+#include "backends/platform/sdl/sdl-sys.h"
+#include "common/array.h"
+#include "common/system.h"
+
+/**
+ * A small pool of SDL threads which runs the jobs of OSystem::runParallel(),
+ * such as scaling horizontal bands of the screen.
+ *
+ * The calling thread takes part in the work, so a pool with N threads keeps
+ * N + 1 cores busy. Jobs are handed out one at a time, which balances the
+ * load when some jobs are cheaper than others.
+ */
+class SdlThreadPool {
+public:
+	/**
+	 * @param numThreads  The number of worker threads to start, in addition
+	 *                    to the calling thread.
+	 */
+	SdlThreadPool(int numThreads);
+	~SdlThreadPool();
+
+	/** Get the number of threads working on the jobs, including the caller. */
+	int getNumThreads() const { return _threads.size() + 1; }
+
+	/**
+	 * Call @p func for each job in [0, numJobs) and return when all of
+	 * them are done. The jobs may run in any order and concurrently.
+	 */
+	void run(OSystem::ParallelJobFunc func, void *data, int numJobs);
+
+	/**
+	 * Get the number of worker threads to start, from the "render_threads"
+	 * setting. The setting counts the calling thread too, and is limited
+	 * to the number of CPU cores. 0 picks one thread per core.
+	 */
+	static int getConfiguredThreads();
+
+private:
+	static int SDLCALL threadProc(void *pool);
+	void work();
+
+	/** Run the jobs left of the current batch. Must be called with the mutex locked. */
+	void runJobs();
+
+	Common::Array<SDL_Thread *> _threads;
+	SDL_mutex *_mutex;
+	SDL_cond *_workCond;
+	SDL_cond *_doneCond;
+
+	OSystem::ParallelJobFunc _func;
+	void *_data;
+	int _numJobs;
+	int _nextJob;
+	int _jobsDone;
+	uint _batch;
+	bool _quit;
+};
+
+/**
+ * An SDL thread which calls a function periodically, for the background
+ * work of OSystem::startBackgroundThread().
+ */
+class SdlBackgroundThread {
+public:
+	/**
+	 * @param interval  The time to wait between two calls, in microseconds.
+	 */
+	SdlBackgroundThread(OSystem::BackgroundThreadProc proc, void *data, int32 interval);
+
+	/** Stop the thread, after waiting for the current call to return. */
+	~SdlBackgroundThread();
+
+	/** Check whether the thread could be started. */
+	bool isRunning() const { return _thread != nullptr; }
+
+	OSystem::BackgroundThreadProc getProc() const { return _proc; }
+	void *getData() const { return _data; }
+
+private:
+	static int SDLCALL threadProc(void *thread);
+	void work();
+
+	SDL_Thread *_thread;
+	SDL_mutex *_mutex;
+	SDL_cond *_quitCond;
+
+	OSystem::BackgroundThreadProc _proc;
+	void *_data;
+	uint32 _intervalMillis;
+	bool _quit;
+};
+
+#endif
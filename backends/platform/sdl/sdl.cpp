@@ -94,7 +94,8 @@ OSystem_SDL::OSystem_SDL()
 	_logger(nullptr),
 	_eventSource(nullptr),
 	_eventSourceWrapper(nullptr),
-	_window(nullptr) {
+	_window(nullptr),
+	_threadPool(nullptr) {
 #if defined(USE_SCUMMVMDLC) && defined(USE_LIBCURL)
 	_dlcStore = new DLC::ScummVMCloud::ScummVMCloud();
 #endif
@@ -118,6 +119,11 @@ OSystem_SDL::~OSystem_SDL() {
 	}
 	delete _graphicsManager;
 	_graphicsManager = nullptr;
+	delete _threadPool;
+	_threadPool = nullptr;
+	for (uint i = 0; i < _backgroundThreads.size(); ++i)
+		delete _backgroundThreads[i];
+	_backgroundThreads.clear();
 	delete _window;
 	_window = nullptr;
 	delete _eventManager;
@@ -261,6 +267,10 @@ void OSystem_SDL::initBackend() {
 	// Search for legacy gfx_mode and replace it
 	ScalerMan.updateOldSettings();
 
+	int workerThreads = SdlThreadPool::getConfiguredThreads();
+	if (workerThreads > 0)
+		_threadPool = new SdlThreadPool(workerThreads);
+
 	if (_graphicsManager == nullptr) {
 #ifdef USE_OPENGL
 		// Setup a list with both SDL and OpenGL graphics modes. We only do
@@ -724,6 +734,38 @@ Common::MutexInternal *OSystem_SDL::createMutex() {
 	return createSdlMutexInternal();
 }
 
+int OSystem_SDL::getParallelJobCount() {
+	return _threadPool ? _threadPool->getNumThreads() : 1;
+}
+
+void OSystem_SDL::runParallel(ParallelJobFunc func, void *data, int numJobs) {
+	if (_threadPool)
+		_threadPool->run(func, data, numJobs);
+	else
+		OSystem::runParallel(func, data, numJobs);
+}
+
+bool OSystem_SDL::startBackgroundThread(BackgroundThreadProc proc, void *data, int32 interval) {
+	SdlBackgroundThread *thread = new SdlBackgroundThread(proc, data, interval);
+	if (!thread->isRunning()) {
+		delete thread;
+		return false;
+	}
+
+	_backgroundThreads.push_back(thread);
+	return true;
+}
+
+void OSystem_SDL::stopBackgroundThread(BackgroundThreadProc proc, void *data) {
+	for (uint i = 0; i < _backgroundThreads.size(); ++i) {
+		if (_backgroundThreads[i]->getProc() == proc && _backgroundThreads[i]->getData() == data) {
+			delete _backgroundThreads[i];
+			_backgroundThreads.remove_at(i);
+			return;
+		}
+	}
+}
+
 uint32 OSystem_SDL::getMillis(bool skipRecord) {
 	uint32 millis = SDL_GetTicks();
 
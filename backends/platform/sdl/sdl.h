@@ -29,6 +29,7 @@
 #include "backends/events/sdl/sdl-events.h"
 #include "backends/log/log.h"
 #include "backends/platform/sdl/sdl-window.h"
+#include "backends/platform/sdl/sdl-threadpool.h"
 
 #include "common/array.h"
 
@@ -83,6 +84,10 @@ public:
 	void setWindowCaption(const Common::U32String &caption) override;
 	void addSysArchivesToSearchSet(Common::SearchSet &s, int priority = 0) override;
 	Common::MutexInternal *createMutex() override;
+	int getParallelJobCount() override;
+	void runParallel(ParallelJobFunc func, void *data, int numJobs) override;
+	bool startBackgroundThread(BackgroundThreadProc proc, void *data, int32 interval) override;
+	void stopBackgroundThread(BackgroundThreadProc proc, void *data) override;
 	uint32 getMillis(bool skipRecord = false) override;
 	void delayMillis(uint msecs) override;
 	void getTimeAndDate(TimeDate &td, bool skipRecord = false) const override;
@@ -138,6 +143,15 @@ protected:
 
 	SdlGraphicsManager::State _gfxManagerState;
 
+	/**
+	 * The threads running the jobs of runParallel(), or null when the
+	 * jobs run on the calling thread only.
+	 */
+	SdlThreadPool *_threadPool;
+
+	/** The threads started by startBackgroundThread(). */
+	Common::Array<SdlBackgroundThread *> _backgroundThreads;
+
 #if defined(USE_OPENGL_GAME) || defined(USE_OPENGL_SHADERS)
 	// Graphics capabilities
 	void detectOpenGLFeaturesSupport();
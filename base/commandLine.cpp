@@ -250,6 +250,9 @@ static const char HELP_STRING4[] =
 	"  --md5-engine=ENGINE_ID   Used with --md5 to specify the engine for which number of bytes\n"
 	"                           to be hashed must be calculated. This option overrides --md5-length\n"
 	"                           if used along with it. Use --list-engines to find all engineIds\n"
+	"  --[no-]md5-cache         Keep the MD5s computed during game detection in\n"
+	"                           scummvm-md5cache.dat next to the config file\n"
+	"                           (default: disabled)\n"
 	"\n"
 	"The meaning of boolean long options can be inverted by prefixing them with\n"
 	"\"no-\", e.g. \"--no-aspect-ratio\".\n"
@@ -294,6 +297,7 @@ void registerDefaults() {
 	ConfMan.registerDefault("aspect_ratio", false);
 	ConfMan.registerDefault("gfx_mode", "normal");
 	ConfMan.registerDefault("render_mode", "default");
+	ConfMan.registerDefault("render_threads", 2);
 	ConfMan.registerDefault("desired_screen_aspect_ratio", "auto");
 	ConfMan.registerDefault("stretch_mode", "default");
 	ConfMan.registerDefault("scaler", "default");
@@ -301,6 +305,7 @@ void registerDefaults() {
 	ConfMan.registerDefault("shader", Common::Path("default", Common::Path::kNoSeparator));
 	ConfMan.registerDefault("show_fps", false);
 	ConfMan.registerDefault("dirtyrects", true);
+	ConfMan.registerDefault("diff_screen_updates", false);
 	ConfMan.registerDefault("vsync", true);
 
 	// Sound & Music
@@ -312,6 +317,7 @@ void registerDefaults() {
 	ConfMan.registerDefault("sfx_mute", false);
 	ConfMan.registerDefault("speech_mute", false);
 	ConfMan.registerDefault("mute", false);
+	ConfMan.registerDefault("resampler_quality", "linear");
 
 	ConfMan.registerDefault("multi_midi", false);
 	ConfMan.registerDefault("native_mt32", false);
@@ -370,6 +376,8 @@ void registerDefaults() {
 	ConfMan.registerDefault("disable_sdl_parachute", false);
 	ConfMan.registerDefault("disable_sdl_audio", false);
 
+	ConfMan.registerDefault("dir_index", false);
+	ConfMan.registerDefault("md5_cache", false);
 	ConfMan.registerDefault("disable_display", false);
 	ConfMan.registerDefault("record_mode", "none");
 	ConfMan.registerDefault("record_file_name", "record.bin");
@@ -903,6 +911,9 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_OPTION("md5-engine")
 			END_OPTION
 
+			DO_LONG_OPTION_BOOL("md5-cache")
+			END_OPTION
+
 			DO_LONG_OPTION_INT("talkspeed")
 			END_OPTION
 
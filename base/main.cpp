@@ -30,6 +30,7 @@
 // FIXME: Avoid using printf
 #define FORBIDDEN_SYMBOL_EXCEPTION_printf
 
+#include "engines/advancedDetector.h"
 #include "engines/engine.h"
 #include "engines/metaengine.h"
 #include "base/commandLine.h"
@@ -40,6 +41,7 @@
 #include "common/config-manager.h"
 #include "common/debug.h"
 #include "common/debug-channels.h" /* for debug manager */
+#include "common/dirindex.h"
 #include "common/events.h"
 #include "gui/EventRecorder.h"
 #include "common/fs.h"
@@ -59,6 +61,8 @@
 
 #include "audio/mididrv.h"
 #include "audio/musicplugin.h"  /* for music manager */
+#include "audio/prefetchingstream.h"
+#include "audio/sinc_filter.h"
 
 #include "graphics/cursorman.h"
 #include "graphics/fontman.h"
@@ -540,6 +544,10 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 		PluginManager::instance().unloadAllPlugins();
 		PluginManager::destroy();
 
+		// Write out what commands like --detect added to the caches
+		AdvancedDetectorCacheManager::destroy();
+		Common::DirectoryIndex::destroy();
+
 		return res.getCode();
 	}
 
@@ -900,6 +908,8 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	PluginManager::instance().unloadAllPlugins();
 	PluginManager::destroy();
 	GUI::GuiManager::destroy();
+	AdvancedDetectorCacheManager::destroy();
+	Common::DirectoryIndex::destroy();
 	Common::ConfigManager::destroy();
 	Common::DebugManager::destroy();
 	Common::OSDMessageQueue::destroy();
@@ -911,6 +921,8 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	Common::MainTranslationManager::destroy();
 #endif
 	MusicManager::destroy();
+	Audio::PrefetchManager::destroy();
+	Audio::SincFilterManager::destroy();
 	Graphics::CursorManager::destroy();
 	Graphics::FontManager::destroy();
 #ifdef USE_FREETYPE2
@@ -723,8 +723,9 @@ DetectionResults EngineManager::detectGames(const Common::FSList &fslist, uint32
 	// run detection for all of them.
 	plugins = getPlugins(PLUGIN_TYPE_ENGINE_DETECTION);
 
-	// Clear md5 cache before each detection starts, just in case.
-	ADCacheMan.clear();
+	// Clear md5 cache before each detection starts, unless a batch of
+	// directories is being scanned.
+	ADCacheMan.startDetection();
 
 	// Iterate over all known games and for each check if it might be
 	// the game in the presented directory.
@@ -0,0 +1,89 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "common/cachefile.h"
+#include "common/config-manager.h"
+#include "common/debug.h"
+#include "common/fs.h"
+#include "common/system.h"
+
+namespace Common {
+
+Path CacheFile::getPath(const String &fileName) {
+	Path configFile = ConfMan.getCustomConfigFileName();
+	if (configFile.empty())
+		configFile = g_system->getDefaultConfigFileName();
+
+	return configFile.getParent().appendComponent(fileName);
+}
+
+SeekableReadStream *CacheFile::openForReading(const String &fileName, uint32 magic, uint32 version) {
+	FSNode file(getPath(fileName));
+	if (!file.exists())
+		return nullptr;
+
+	SeekableReadStream *stream = file.createReadStream();
+	if (!stream)
+		return nullptr;
+
+	if (stream->readUint32BE() != magic || stream->readUint32LE() != version) {
+		debug(2, "CacheFile: Ignoring %s of an unknown version", fileName.c_str());
+		delete stream;
+		return nullptr;
+	}
+
+	return stream;
+}
+
+WriteStream *CacheFile::openForWriting(const String &fileName, uint32 magic, uint32 version) {
+	FSNode file(getPath(fileName));
+	WriteStream *stream = file.createWriteStream();
+	if (!stream)
+		return nullptr;
+
+	stream->writeUint32BE(magic);
+	stream->writeUint32LE(version);
+	return stream;
+}
+
+bool CacheFile::close(WriteStream *stream) {
+	stream->finalize();
+	const bool result = !stream->err();
+	delete stream;
+	return result;
+}
+
+void CacheFile::writeString(WriteStream &stream, const String &str) {
+	stream.writeUint32LE(str.size());
+	stream.write(str.c_str(), str.size());
+}
+
+bool CacheFile::readString(ReadStream &stream, String &str) {
+	const uint32 size = stream.readUint32LE();
+	if (stream.eos() || size > 0xFFFF)
+		return false;
+
+	str = stream.readString(0, size);
+	return !stream.eos() && !stream.err();
+}
+
+} // End of namespace Common
@@ -0,0 +1,100 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef COMMON_CACHEFILE_H
+#define COMMON_CACHEFILE_H
+
+#include "common/path.h"
+#include "common/str.h"
+#include "common/stream.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_cachefile Cache files
+ * @ingroup common
+ *
+ * @brief Helpers for the caches kept next to the configuration file.
+ * @{
+ */
+
+/**
+ * Caches which survive between runs, such as the directory index, are
+ * stored in small binary files next to the configuration file. Such a file
+ * starts with a magic and a version, and strings in it are stored with
+ * their length.
+ */
+class CacheFile {
+public:
+	/** Get the path of the cache file with the given name. */
+	static Path getPath(const String &fileName);
+
+	/**
+	 * Open a cache file for reading.
+	 *
+	 * @return The stream, positioned after the header, or nullptr if the
+	 *         file does not exist or has another magic or version.
+	 */
+	static SeekableReadStream *openForReading(const String &fileName, uint32 magic, uint32 version);
+
+	/**
+	 * Create a cache file and write its header.
+	 *
+	 * @return The stream, or nullptr if the file could not be created.
+	 */
+	static WriteStream *openForWriting(const String &fileName, uint32 magic, uint32 version);
+
+	/**
+	 * Finish writing a cache file, and delete the stream.
+	 *
+	 * @return Whether all of the file could be written.
+	 */
+	static bool close(WriteStream *stream);
+
+	static void writeString(WriteStream &stream, const String &str);
+	static bool readString(ReadStream &stream, String &str);
+
+	/**
+	 * Drop the entries of @p map which were not used during this run, once
+	 * there are more than @p maxEntries. This keeps caches from growing
+	 * forever with files that are gone. The values need a "used" member.
+	 *
+	 * @return Whether entries were dropped.
+	 */
+	template<class Map>
+	static bool pruneUnused(Map &map, uint maxEntries) {
+		if (map.size() <= maxEntries)
+			return false;
+
+		for (typename Map::iterator i = map.begin(); i != map.end(); ++i) {
+			if (!i->_value.used)
+				map.erase(i);
+		}
+		return true;
+	}
+};
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
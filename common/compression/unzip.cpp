@@ -96,6 +96,7 @@ typedef Byte Bytef;
 #include "common/compression/unzip.h"
 #include "common/memstream.h"
 
+#include "common/flathashmap.h"
 #include "common/hashmap.h"
 #include "common/hash-str.h"
 
@@ -237,6 +238,13 @@ Common::SharedArchiveContents unzOpenCurrentFile(unzFile file
   If there is no error, the return value is UNZ_OK.
 */
 
+bool unzGetCurrentFileStoredRange(unzFile file, uint32 *offset, uint32 *size, uint32 *crc);
+/*
+  Get the location of the data of the current file in the zipfile, if it is
+  stored without compression. This allows reading it directly from memory.
+  Return false if the file is compressed or its header is invalid.
+*/
+
 int unzCloseCurrentFile(unzFile file);
 /*
   Close the file in zip opened with unzOpenCurrentFile
@@ -1018,9 +1026,48 @@ Common::SharedArchiveContents unzOpenCurrentFile (unzFile file
 	return Common::SharedArchiveContents(uncompressedBuffer, s->cur_file_info.uncompressed_size);
 }
 
+bool unzGetCurrentFileStoredRange(unzFile file, uint32 *offset, uint32 *size, uint32 *crc) {
+	uInt iSizeVar;
+	unz_s *s;
+	uLong offset_local_extrafield;  /* offset of the local extra field */
+	uInt  size_local_extrafield;    /* size of the local extra field */
+
+	if (file == nullptr)
+		return false;
+	s = (unz_s *)file;
+	if (!s->current_file_ok || s->cur_file_info.compression_method != 0)
+		return false;
+
+	if (unzlocal_CheckCurrentFileCoherencyHeader(s, &iSizeVar,
+				&offset_local_extrafield, &size_local_extrafield) != UNZ_OK)
+		return false;
+
+	const uint64 dataOffset = s->cur_file_info_internal.offset_curfile + SIZEZIPLOCALHEADER + iSizeVar;
+	if (s->cur_file_info.compressed_size != s->cur_file_info.uncompressed_size ||
+	    dataOffset + s->cur_file_info.uncompressed_size > (uint64)s->_stream->size())
+		return false;
+
+	*offset = dataOffset;
+	*size = s->cur_file_info.uncompressed_size;
+	*crc = s->cur_file_info.crc;
+	return true;
+}
+
 
 namespace Common {
 
+/**
+ * A stored member read in place from the memory of its archive, which it
+ * keeps alive, so that it can outlive the archive like the other members.
+ */
+class StoredZipMemberStream : public MemoryReadStream {
+public:
+	StoredZipMemberStream(const SharedPtr<const byte> &archiveData, uint32 offset, uint32 size) :
+		MemoryReadStream(archiveData.get() + offset, size), _archiveData(archiveData) {}
+
+private:
+	SharedPtr<const byte> _archiveData;
+};
 
 class ZipArchive : public MemcachingCaseInsensitiveArchive {
 	unzFile _zipFile;
@@ -1029,8 +1076,18 @@ class ZipArchive : public MemcachingCaseInsensitiveArchive {
 #endif
 	bool _flattenTree;
 
+	/**
+	 * The whole archive, if it is held in shared memory (e.g. a memory
+	 * mapped file). Stored members are then read in place instead of being
+	 * copied.
+	 */
+	SharedPtr<const byte> _archiveData;
+
+	/** Offsets of the stored members whose checksum was already verified. */
+	mutable FlatHashMap<uint32, bool> _verifiedMembers;
+
 public:
-	ZipArchive(unzFile zipFile, bool flattenTree);
+	ZipArchive(unzFile zipFile, bool flattenTree, const SharedPtr<const byte> &archiveData);
 
 
 	~ZipArchive();
@@ -1063,7 +1120,7 @@ public:
 };
 */
 
-ZipArchive::ZipArchive(unzFile zipFile, bool flattenTree) : _zipFile(zipFile), _flattenTree(flattenTree) {
+ZipArchive::ZipArchive(unzFile zipFile, bool flattenTree, const SharedPtr<const byte> &archiveData) : _zipFile(zipFile), _flattenTree(flattenTree), _archiveData(archiveData) {
 	assert(_zipFile);
 }
 
@@ -1109,6 +1166,29 @@ const ArchiveMemberPtr ZipArchive::getMember(const Path &path) const {
 Common::SharedArchiveContents ZipArchive::readContentsForPath(const Common::Path &path) const {
 	if (unzLocateFile(_zipFile, path, 2) != UNZ_OK)
 		return Common::SharedArchiveContents();
+
+	uint32 offset, size, crc;
+	if (_archiveData && unzGetCurrentFileStoredRange(_zipFile, &offset, &size, &crc)) {
+		const byte *data = _archiveData.get() + offset;
+
+		// Only verify the checksum on the first access, so that
+		// later accesses do not have to touch the whole member
+		if (!_verifiedMembers.contains(offset)) {
+#ifndef USE_ZLIB
+			uint32 crc32_data = _crc.crcFast(data, size);
+#else
+			uint32 crc32_data = crc32(0, data, size);
+#endif
+			if (crc32_data != crc) {
+				warning("CRC32 mismatch: %08x, %08x", crc32_data, crc);
+				return Common::SharedArchiveContents();
+			}
+			_verifiedMembers[offset] = true;
+		}
+
+		return Common::SharedArchiveContents::bypass(new StoredZipMemberStream(_archiveData, offset, size));
+	}
+
 #ifndef USE_ZLIB
 	return unzOpenCurrentFile(_zipFile, _crc);
 #else
@@ -1121,19 +1201,27 @@ Archive *makeZipArchive(const Path &name, bool flattenTree) {
 }
 
 Archive *makeZipArchive(const FSNode &node, bool flattenTree) {
-	return makeZipArchive(node.createReadStream(), flattenTree);
+	// Archives do not change while they are open, so they can be mapped
+	return makeZipArchive(node.createMappedReadStream(), flattenTree);
 }
 
 Archive *makeZipArchive(SeekableReadStream *stream, bool flattenTree) {
 	if (!stream)
 		return nullptr;
+	// Shared memory streams, which include memory mapped files, can be
+	// read in place
+	MemoryReadStream *memStream = dynamic_cast<MemoryReadStream *>(stream);
+	SharedPtr<const byte> archiveData;
+	if (memStream)
+		archiveData = memStream->getSharedData();
+
 	unzFile zipFile = unzOpen(stream, flattenTree);
 	if (!zipFile) {
 		// stream gets deleted by unzOpen() call if something
 		// goes wrong.
 		return nullptr;
 	}
-	return new ZipArchive(zipFile, flattenTree);
+	return new ZipArchive(zipFile, flattenTree, archiveData);
 }
 
 } // End of namespace Common
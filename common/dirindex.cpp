@@ -0,0 +1,166 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "common/dirindex.h"
+#include "common/cachefile.h"
+#include "common/config-manager.h"
+#include "common/debug.h"
+
+namespace Common {
+
+DECLARE_SINGLETON(DirectoryIndex);
+
+// Format of the index file: after the header, the number of listings and
+// the listings. A listing is the directory path, its modification time and
+// its entries.
+static const char *const kIndexFileName = "scummvm-dirindex.dat";
+static const uint32 kIndexMagic = MKTAG('S', 'V', 'D', 'I');
+static const uint32 kIndexVersion = 2;
+
+DirectoryIndex::DirectoryIndex() : _loaded(false), _dirty(false) {
+}
+
+DirectoryIndex::~DirectoryIndex() {
+	flush();
+}
+
+bool DirectoryIndex::isEnabled() const {
+	return ConfMan.hasKey("dir_index") && ConfMan.getBool("dir_index");
+}
+
+bool DirectoryIndex::getChildren(const FSNode &dir, FSList &list) {
+	if (!isEnabled())
+		return dir.getChildren(list, FSNode::kListAll);
+
+	const int64 modificationTime = dir.getModificationTime();
+	if (modificationTime < 0)
+		return dir.getChildren(list, FSNode::kListAll);
+
+	if (!_loaded)
+		load();
+
+	const String key = dir.getPath().toConfig();
+	ListingMap::iterator i = _listings.find(key);
+	if (i != _listings.end() && i->_value.modificationTime == modificationTime) {
+		Listing &listing = i->_value;
+		listing.used = true;
+
+		list.clear();
+		list.reserve(listing.entries.size());
+		for (uint j = 0; j < listing.entries.size(); ++j)
+			list.push_back(dir.getKnownChild(listing.entries[j].name, listing.entries[j].isDirectory));
+		return true;
+	}
+
+	if (!dir.getChildren(list, FSNode::kListAll))
+		return false;
+
+	Listing &listing = _listings[key];
+	listing.modificationTime = modificationTime;
+	listing.used = true;
+	listing.entries.resize(list.size());
+	for (uint j = 0; j < list.size(); ++j) {
+		listing.entries[j].name = list[j].getRealName();
+		listing.entries[j].isDirectory = list[j].isDirectory();
+	}
+	_dirty = true;
+
+	return true;
+}
+
+void DirectoryIndex::load() {
+	_loaded = true;
+
+	SeekableReadStream *stream = CacheFile::openForReading(kIndexFileName, kIndexMagic, kIndexVersion);
+	if (!stream)
+		return;
+
+	const uint32 count = stream->readUint32LE();
+	for (uint32 i = 0; i < count && !stream->eos(); ++i) {
+		String key;
+		Listing listing;
+		listing.used = false;
+
+		if (!CacheFile::readString(*stream, key))
+			break;
+
+		listing.modificationTime = (int64)stream->readUint64LE();
+
+		// Each entry takes at least a flag byte and a string length, so a
+		// larger count can only come from a damaged file
+		const uint32 numEntries = stream->readUint32LE();
+		if (stream->eos() || numEntries > (stream->size() - stream->pos()) / 5) {
+			warning("DirectoryIndex: The index file is truncated");
+			break;
+		}
+		listing.entries.resize(numEntries);
+
+		bool valid = true;
+		for (uint j = 0; valid && j < listing.entries.size(); ++j) {
+			listing.entries[j].isDirectory = stream->readByte() != 0;
+			valid = CacheFile::readString(*stream, listing.entries[j].name);
+		}
+
+		if (!valid) {
+			warning("DirectoryIndex: The index file is truncated");
+			break;
+		}
+
+		_listings[key] = listing;
+	}
+
+	delete stream;
+}
+
+void DirectoryIndex::flush() {
+	if (!_dirty)
+		return;
+
+	CacheFile::pruneUnused(_listings, kMaxListings);
+
+	WriteStream *stream = CacheFile::openForWriting(kIndexFileName, kIndexMagic, kIndexVersion);
+	if (!stream) {
+		warning("DirectoryIndex: Could not write the index file");
+		return;
+	}
+
+	stream->writeUint32LE(_listings.size());
+
+	for (ListingMap::const_iterator i = _listings.begin(); i != _listings.end(); ++i) {
+		const Listing &listing = i->_value;
+
+		CacheFile::writeString(*stream, i->_key);
+		stream->writeUint64LE((uint64)listing.modificationTime);
+		stream->writeUint32LE(listing.entries.size());
+		for (uint j = 0; j < listing.entries.size(); ++j) {
+			stream->writeByte(listing.entries[j].isDirectory ? 1 : 0);
+			CacheFile::writeString(*stream, listing.entries[j].name);
+		}
+	}
+
+	if (!CacheFile::close(stream))
+		warning("DirectoryIndex: Could not write the index file");
+
+	_dirty = false;
+}
+
+} // End of namespace Common
@@ -0,0 +1,105 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef COMMON_DIRINDEX_H
+#define COMMON_DIRINDEX_H
+
+#include "common/array.h"
+#include "common/fs.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/singleton.h"
+#include "common/str.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_dirindex Directory index
+ * @ingroup common
+ *
+ * @brief Persistent cache of directory listings.
+ * @{
+ */
+
+/**
+ * A cache of the directory listings made by FSDirectory, stored next to
+ * the configuration file so that they survive between runs.
+ *
+ * Every listing is keyed by the path of the directory, and it is only used
+ * while the modification time of the directory is unchanged. This costs one
+ * query of the modification time per directory instead of reading all its
+ * entries, which makes a difference for large game directories on slow
+ * media or network shares.
+ *
+ * The index is only used when the "dir_index" setting is enabled and the
+ * file system backend reports modification times.
+ */
+class DirectoryIndex : public Singleton<DirectoryIndex> {
+public:
+	enum {
+		/** Listings not used during a run are dropped beyond this number. */
+		kMaxListings = 20000
+	};
+
+	/**
+	 * List all files and directories in @p dir, including hidden ones.
+	 * This is equivalent to FSNode::getChildren() with FSNode::kListAll.
+	 */
+	bool getChildren(const FSNode &dir, FSList &list);
+
+	/** Write the index to disk if it changed. */
+	void flush();
+
+private:
+	friend class Singleton<SingletonBaseType>;
+	DirectoryIndex();
+	~DirectoryIndex() override;
+
+	struct Entry {
+		String name;
+		bool isDirectory;
+	};
+
+	struct Listing {
+		int64 modificationTime;
+		Array<Entry> entries;
+		bool used;
+	};
+
+	typedef HashMap<String, Listing> ListingMap;
+
+	bool isEnabled() const;
+	void load();
+
+	ListingMap _listings;
+	bool _loaded;
+	bool _dirty;
+};
+
+/** @} */
+
+} // End of namespace Common
+
+/** Shortcut for accessing the directory index. */
+#define DirIndex		Common::DirectoryIndex::instance()
+
+#endif
@@ -21,6 +21,7 @@
 
 #include "common/system.h"
 #include "common/debug.h"
+#include "common/dirindex.h"
 #include "common/punycode.h"
 #include "common/textconsole.h"
 #include "backends/fs/abstract-fs.h"
@@ -145,6 +146,15 @@ FSNode FSNode::getChild(const String &n) const {
 	return FSNode(node);
 }
 
+FSNode FSNode::getKnownChild(const String &n, bool isDirectory) const {
+	// If this node is invalid or not a directory, return an invalid node
+	if (_realNode == nullptr || !_realNode->isDirectory())
+		return FSNode();
+
+	AbstractFSNode *node = _realNode->getKnownChild(n, isDirectory);
+	return FSNode(node);
+}
+
 bool FSNode::getChildren(FSList &fslist, ListMode mode, bool hidden) const {
 	if (!_realNode || !_realNode->isDirectory())
 		return false;
@@ -233,6 +243,14 @@ bool FSNode::isWritable() const {
 	return _realNode && _realNode->isWritable();
 }
 
+int64 FSNode::getModificationTime() const {
+	return _realNode ? _realNode->getModificationTime() : -1;
+}
+
+int64 FSNode::getFileSize() const {
+	return _realNode ? _realNode->getFileSize() : -1;
+}
+
 SeekableReadStream *FSNode::createReadStream() const {
 	if (_realNode == nullptr)
 		return nullptr;
@@ -263,6 +281,21 @@ SeekableReadStream *FSNode::createReadStreamForAltStream(AltStreamType altStream
 	return _realNode->createReadStreamForAltStream(altStreamType);
 }
 
+SeekableReadStream *FSNode::createMappedReadStream() const {
+	if (_realNode == nullptr)
+		return nullptr;
+
+	if (!_realNode->exists()) {
+		warning("FSNode::createMappedReadStream: '%s' does not exist", getName().c_str());
+		return nullptr;
+	} else if (_realNode->isDirectory()) {
+		warning("FSNode::createMappedReadStream: '%s' is a directory", getName().c_str());
+		return nullptr;
+	}
+
+	return _realNode->createMappedReadStream();
+}
+
 SeekableWriteStream *FSNode::createWriteStream() const {
 	if (_realNode == nullptr)
 		return nullptr;
@@ -428,7 +461,7 @@ void FSDirectory::cacheDirectoryRecursive(FSNode node, int depth, const Path& pr
 		return;
 
 	FSList list;
-	node.getChildren(list, FSNode::kListAll);
+	DirIndex.getChildren(node, list);
 
 	FSList::iterator it = list.begin();
 	for ( ; it != list.end(); ++it) {
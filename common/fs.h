@@ -70,6 +70,7 @@ class FSNode : public ArchiveMember {
 private:
 	friend class ::AbstractFSNode;
 	friend class FSDirectory;
+	friend class DirectoryIndex;
 	SharedPtr<AbstractFSNode>	_realNode;
 	/**
 	 * Construct an FSNode from a backend's AbstractFSNode implementation.
@@ -79,6 +80,12 @@ private:
 	 */
 	FSNode(AbstractFSNode *realNode);
 
+	/**
+	 * Get a child of this directory whose type is already known, e.g. from
+	 * a cached listing, without querying the file system when possible.
+	 */
+	FSNode getKnownChild(const String &name, bool isDirectory) const;
+
 public:
 	/**
 	 * Flag to tell listDir() which kind of files to list.
@@ -252,6 +259,26 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Get the time the object referred by this node was last modified.
+	 *
+	 * For a directory, this changes when entries are added, removed or
+	 * renamed. The value is only meant to be compared with values
+	 * returned earlier for the same node. It is in nanoseconds, though
+	 * many file systems only keep seconds.
+	 *
+	 * @return The modification time, or -1 if it is not known.
+	 */
+	int64 getModificationTime() const;
+
+	/**
+	 * Get the size in bytes of the file referred by this node, without
+	 * opening it.
+	 *
+	 * @return The size, or -1 if it is not known or the node is not a file.
+	 */
+	int64 getFileSize() const;
+
 	/**
 	 * Create a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -271,6 +298,19 @@ public:
 	 */
 	SeekableReadStream *createReadStreamForAltStream(AltStreamType altStreamType) const override;
 
+	/**
+	 * Create a SeekableReadStream instance corresponding to the file
+	 * referred by this node, like createReadStream(). Where the system
+	 * supports it, large files are memory mapped and returned as a
+	 * MemoryReadStream, so they can be accessed in place.
+	 *
+	 * A mapped file must not be truncated while the stream exists, so this
+	 * is meant for archives and other game data which never change.
+	 *
+	 * @return Pointer to the stream object, nullptr in case of a failure.
+	 */
+	SeekableReadStream *createMappedReadStream() const;
+
 	/**
 	 * Create a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
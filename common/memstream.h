@@ -93,6 +93,20 @@ public:
 	int64 size() const { return _size; }
 
 	bool seek(int64 offs, int whence = SEEK_SET);
+
+	/**
+	 * Return the start of the memory block this stream reads from, so that
+	 * it can be accessed without copying. The pointer is valid as long as
+	 * the stream exists.
+	 */
+	const byte *getData() const { return _ptrOrig.get(); }
+
+	/**
+	 * Return the owner of the memory block if the stream was created from a
+	 * SharedPtr, or a null pointer otherwise. Holding it keeps the memory
+	 * valid after the stream is destroyed.
+	 */
+	const SharedPtr<const byte> &getSharedData() const { return _ptrOrig.getShared(); }
 };
 
 
@@ -2,11 +2,13 @@ MODULE := common
 
 MODULE_OBJS := \
 	archive.o \
+	cachefile.o \
 	concatstream.o \
 	config-manager.o \
 	coroutines.o \
 	dbcs-str.o \
 	debug.o \
+	dirindex.o \
 	error.o \
 	events.o \
 	file.o \
@@ -723,6 +723,13 @@ public:
 	 */
 	PointerType get() const { return _pointer; }
 
+	/**
+	 * Returns the shared pointer the DisposablePtr was created from.
+	 *
+	 * @return the SharedPtr, or a null SharedPtr if it was created from a plain pointer
+	 */
+	const SharedPtr<T> &getShared() const { return _shared; }
+
 	template <class T2, class DL2>
 	friend class DisposablePtr;
 
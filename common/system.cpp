@@ -255,6 +255,18 @@ bool OSystem::isConnectionLimited() {
 	return false;
 }
 
+void OSystem::runParallel(ParallelJobFunc func, void *data, int numJobs) {
+	for (int i = 0; i < numJobs; i++)
+		func(data, i);
+}
+
+bool OSystem::startBackgroundThread(BackgroundThreadProc proc, void *data, int32 interval) {
+	return false;
+}
+
+void OSystem::stopBackgroundThread(BackgroundThreadProc proc, void *data) {
+}
+
 Common::TimerManager *OSystem::getTimerManager() {
 	return _timerManager;
 }
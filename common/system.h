@@ -1581,6 +1581,10 @@ public:
 	 *
 	 * Hence, backends that do not use threads to implement the timers can simply
 	 * use dummy implementations for these methods.
+	 *
+	 * Backends that have threads can also offer them for splitting up
+	 * expensive work, such as software rendering, with runParallel(), and
+	 * for long running work with startBackgroundThread().
 	 */
 
 	/**
@@ -1590,6 +1594,70 @@ public:
 	 */
 	virtual Common::MutexInternal *createMutex() = 0;
 
+	/**
+	 * A job started by runParallel().
+	 *
+	 * @param data The pointer passed to runParallel().
+	 * @param job  The number of the job, from 0 to the number of jobs minus one.
+	 */
+	typedef void (*ParallelJobFunc)(void *data, int job);
+
+	/**
+	 * Return how many jobs runParallel() can run at the same time.
+	 *
+	 * Work that is split into this many jobs keeps all the threads busy.
+	 * Backends that do not run jobs on threads return 1.
+	 */
+	virtual int getParallelJobCount() { return 1; }
+
+	/**
+	 * Run a number of jobs and wait until all of them have finished.
+	 *
+	 * The jobs may run at the same time on other threads, in any order, so
+	 * they must only write to memory which no other job uses and must not
+	 * call any other OSystem methods. The default implementation runs the
+	 * jobs one after the other on the calling thread.
+	 *
+	 * Calls are not nested: when the threads are already busy, because a
+	 * job calls runParallel() or another thread does at the same time, the
+	 * jobs of the new call run one after the other on its calling thread.
+	 *
+	 * @param func    The function to call for each job.
+	 * @param data    The pointer to pass to @p func.
+	 * @param numJobs The number of jobs.
+	 */
+	virtual void runParallel(ParallelJobFunc func, void *data, int numJobs);
+
+	/**
+	 * A function called by a background thread.
+	 *
+	 * @param data The pointer passed to startBackgroundThread().
+	 */
+	typedef void (*BackgroundThreadProc)(void *data);
+
+	/**
+	 * Start a thread of its own which calls a function periodically, until
+	 * stopBackgroundThread() is called.
+	 *
+	 * Unlike a timer callback, the function may take a long time, such as
+	 * for decoding audio ahead of the mixer, without delaying other work.
+	 * It must not call any OSystem methods other than the mutex ones.
+	 *
+	 * @param proc     The function to call.
+	 * @param data     The pointer to pass to @p proc.
+	 * @param interval The time to wait between two calls, in microseconds.
+	 *
+	 * @return True if the thread was started. Backends without threads
+	 *         return false, the caller then has to fall back to a timer.
+	 */
+	virtual bool startBackgroundThread(BackgroundThreadProc proc, void *data, int32 interval);
+
+	/**
+	 * Stop a thread started by startBackgroundThread() with the same
+	 * @p proc and @p data, and wait until its last call has returned.
+	 */
+	virtual void stopBackgroundThread(BackgroundThreadProc proc, void *data);
+
 	/** @} */
 
 
@@ -21,6 +21,7 @@
 
 #define FORBIDDEN_SYMBOL_EXCEPTION_printf
 
+#include "common/cachefile.h"
 #include "common/debug.h"
 #include "common/util.h"
 #include "common/file.h"
@@ -373,13 +374,14 @@ Common::Error AdvancedMetaEngineDetection::createInstance(OSystem *syst, Engine
 	// the _directoryGlobsMap
 	preprocessDescriptions();
 
+	// Clear md5 cache before each detection starts, just in case. This also
+	// drops the directory listings, which composeFileHashMap() reuses.
+	ADCacheMan.startDetection();
+
 	// Compose a hashmap of all files in fslist.
 	FileMap allFiles;
 	composeFileHashMap(allFiles, files, (_maxScanDepth == 0 ? 1 : _maxScanDepth));
 
-	// Clear md5 cache before each detection starts, just in case.
-	ADCacheMan.clear();
-
 	// Run the detector on this
 	ADDetectedGames matches = detectGame(files.begin()->getParent(), allFiles, language, platform, extra);
 
@@ -491,7 +493,7 @@ void AdvancedMetaEngineDetection::composeFileHashMap(FileMap &allFiles, const Co
 				continue;
 
 			Common::FSList files;
-			if (!file->getChildren(files, Common::FSNode::kListAll))
+			if (!ADCacheMan.getChildren(*file, files))
 				continue;
 
 			composeFileHashMap(allFiles, files, depth - 1, tstr);
@@ -517,6 +519,118 @@ namespace Common {
 	DECLARE_SINGLETON(AdvancedDetectorCacheManager);
 }
 
+// Format of the persistent MD5 cache: after the header, the number of
+// entries and the entries. An entry is the cache name of the file, its
+// size, its modification time and its MD5.
+static const char *const kStoredMD5FileName = "scummvm-md5cache.dat";
+static const uint32 kStoredMD5Magic = MKTAG('S', 'V', 'M', '5');
+static const uint32 kStoredMD5Version = 2;
+
+bool AdvancedDetectorCacheManager::isStoredMD5Enabled() const {
+	return ConfMan.hasKey("md5_cache") && ConfMan.getBool("md5_cache");
+}
+
+bool AdvancedDetectorCacheManager::getStoredMD5(const Common::String &fname, const Common::FSNode &node, FileProperties &fileProps) {
+	if (!isStoredMD5Enabled())
+		return false;
+
+	if (!storedMD5sLoaded)
+		loadStoredMD5s();
+
+	StoredMD5HashMap::iterator i = storedMD5HashMap.find(fname);
+	if (i == storedMD5HashMap.end())
+		return false;
+
+	StoredMD5 &entry = i->_value;
+	if (entry.size != node.getFileSize() || entry.modificationTime != node.getModificationTime()) {
+		storedMD5HashMap.erase(i);
+		storedMD5sDirty = true;
+		return false;
+	}
+
+	entry.used = true;
+	fileProps.md5 = entry.md5;
+	fileProps.size = entry.size;
+	return true;
+}
+
+void AdvancedDetectorCacheManager::storeMD5(const Common::String &fname, const Common::FSNode &node, const FileProperties &fileProps) {
+	if (!isStoredMD5Enabled())
+		return;
+
+	StoredMD5 entry;
+	entry.size = node.getFileSize();
+	entry.modificationTime = node.getModificationTime();
+	entry.md5 = fileProps.md5;
+	entry.used = true;
+
+	// Without both, changes to the file could not be noticed
+	if (entry.size < 0 || entry.modificationTime < 0 || entry.size != fileProps.size)
+		return;
+
+	if (!storedMD5sLoaded)
+		loadStoredMD5s();
+
+	storedMD5HashMap.setVal(fname, entry);
+	storedMD5sDirty = true;
+}
+
+void AdvancedDetectorCacheManager::loadStoredMD5s() {
+	storedMD5sLoaded = true;
+
+	Common::SeekableReadStream *stream = Common::CacheFile::openForReading(kStoredMD5FileName, kStoredMD5Magic, kStoredMD5Version);
+	if (!stream)
+		return;
+
+	const uint32 count = stream->readUint32LE();
+	for (uint32 i = 0; i < count && !stream->eos(); ++i) {
+		Common::String fname;
+		StoredMD5 entry;
+		entry.used = false;
+
+		if (!Common::CacheFile::readString(*stream, fname))
+			break;
+
+		entry.size = stream->readSint64LE();
+		entry.modificationTime = stream->readSint64LE();
+		if (!Common::CacheFile::readString(*stream, entry.md5)) {
+			warning("The MD5 cache file is truncated");
+			break;
+		}
+
+		storedMD5HashMap.setVal(fname, entry);
+	}
+
+	delete stream;
+}
+
+void AdvancedDetectorCacheManager::flushStoredMD5s() {
+	if (!storedMD5sDirty)
+		return;
+
+	Common::CacheFile::pruneUnused(storedMD5HashMap, kMaxStoredMD5s);
+
+	Common::WriteStream *stream = Common::CacheFile::openForWriting(kStoredMD5FileName, kStoredMD5Magic, kStoredMD5Version);
+	if (!stream) {
+		warning("Could not write the MD5 cache file");
+		return;
+	}
+
+	stream->writeUint32LE(storedMD5HashMap.size());
+
+	for (StoredMD5HashMap::const_iterator i = storedMD5HashMap.begin(); i != storedMD5HashMap.end(); ++i) {
+		Common::CacheFile::writeString(*stream, i->_key);
+		stream->writeSint64LE(i->_value.size);
+		stream->writeSint64LE(i->_value.modificationTime);
+		Common::CacheFile::writeString(*stream, i->_value.md5);
+	}
+
+	if (!Common::CacheFile::close(stream))
+		warning("Could not write the MD5 cache file");
+
+	storedMD5sDirty = false;
+}
+
 
 static MD5Properties gameFileToMD5Props(const ADGameFileDescription *fileEntry, uint32 gameFlags) {
 	MD5Properties ret = kMD5Head;
@@ -581,10 +695,38 @@ Common::String md5PropToGameFile(MD5Properties flags) {
 
 static bool getFilePropertiesIntern(uint md5Bytes, const AdvancedMetaEngine::FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname, FileProperties &fileProps);
 
+/**
+ * Get the name under which the properties of a file are cached. Files
+ * are identified by their full path when possible, so that the cache can be
+ * shared by the detection runs of several directories. Returns false if
+ * only the name relative to the detected directory is known.
+ */
+static bool getFilePropertiesCacheName(const AdvancedMetaEngine::FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname, Common::String &name) {
+	if (md5prop & kMD5Archive) {
+		Common::StringTokenizer tok(fname.toString(), ":");
+		Common::String archiveType = tok.nextToken();
+		Common::Path archiveName(tok.nextToken());
+
+		if (allFiles.contains(archiveName)) {
+			name = archiveType + ':' + allFiles[archiveName].getPath().toString('/') + ':' + tok.nextToken();
+			return true;
+		}
+	} else if (allFiles.contains(fname)) {
+		name = allFiles[fname].getPath().toString('/');
+		return true;
+	}
+
+	name = fname.toString('/');
+	return false;
+}
+
 bool AdvancedMetaEngineDetection::getFileProperties(const FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname, FileProperties &fileProps) const {
+	Common::String name;
+	bool fullPath = getFilePropertiesCacheName(allFiles, md5prop, fname, name);
+
 	Common::String hashname = md5PropToCachePrefix(md5prop);
 		hashname += ':';
-		hashname += fname.toString('/');
+		hashname += name;
 		hashname += ':';
 		hashname += Common::String::format("%d", _md5Bytes);
 
@@ -594,11 +736,26 @@ bool AdvancedMetaEngineDetection::getFileProperties(const FileMap &allFiles, MD5
 		return true;
 	}
 
-	bool res = getFilePropertiesIntern(_md5Bytes, allFiles, md5prop, fname, fileProps);
+	// Plain files can also be found in the persistent cache. Resource forks
+	// and archive members may come from other files than the one named.
+	bool storable = fullPath && !(md5prop & (kMD5MacMask | kMD5Archive));
+
+	bool res = false;
+	if (storable && ADCacheMan.getStoredMD5(hashname, allFiles[fname], fileProps)) {
+		fileProps.md5prop = (MD5Properties)(md5prop & kMD5Tail);
+		res = true;
+	} else {
+		res = getFilePropertiesIntern(_md5Bytes, allFiles, md5prop, fname, fileProps);
+
+		if (res && storable)
+			ADCacheMan.storeMD5(hashname, allFiles[fname], fileProps);
+	}
 
 	if (res) {
 		ADCacheMan.setMD5(hashname, fileProps.md5);
 		ADCacheMan.setSize(hashname, fileProps.size);
+		if (!fullPath)
+			ADCacheMan.markLocal(hashname);
 	}
 
 	return res;
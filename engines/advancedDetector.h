@@ -595,6 +595,69 @@ public:
 		return (md5HashMap.contains(fname) && sizeHashMap.contains(fname));
 	}
 
+	/**
+	 * Remember that the MD5 stored under @p fname was computed for a file name
+	 * relative to the directory being detected, rather than for a full path.
+	 * Such entries are dropped by startDetection() even during a batch.
+	 */
+	void markLocal(const Common::String &fname) {
+		localKeys.push_back(fname);
+	}
+
+	/**
+	 * List the contents of a directory, reusing the listing if the same
+	 * directory was already listed since the cache was last cleared.
+	 */
+	bool getChildren(const Common::FSNode &node, Common::FSList &list) {
+		DirectoryHashMap::const_iterator i = directoryHashMap.find(node.getPath());
+		if (i != directoryHashMap.end()) {
+			list = i->_value;
+			return true;
+		}
+
+		if (!node.getChildren(list, Common::FSNode::kListAll))
+			return false;
+
+		directoryHashMap.setVal(node.getPath(), list);
+		return true;
+	}
+
+	/**
+	 * Keep the computed MD5s and directory listings until endBatch() is
+	 * called, instead of dropping them when the next detection starts.
+	 *
+	 * This is meant for scanning many directories in a row, like the mass
+	 * add dialog does: files and directories seen from several detection
+	 * runs are then only read once.
+	 */
+	void beginBatch() {
+		clear();
+		batchDepth++;
+	}
+
+	void endBatch() {
+		assert(batchDepth > 0);
+		if (--batchDepth == 0) {
+			clear();
+			flushStoredMD5s();
+		}
+	}
+
+	/** Drop the state of the previous detection run. */
+	void startDetection() {
+		if (batchDepth == 0) {
+			clear();
+			return;
+		}
+
+		for (uint i = 0; i < localKeys.size(); i++) {
+			md5HashMap.erase(localKeys[i]);
+			sizeHashMap.erase(localKeys[i]);
+		}
+		localKeys.clear();
+		clearArchives();
+	}
+
 	void addArchive(const Common::FSNode &node, Common::Archive *archivePtr) {
 		if (!archivePtr)
 			return;
@@ -612,10 +675,32 @@ public:
 		return archiveHashMap.getValOrDefault(node.getPath(), nullptr);
 	}
 
-	AdvancedDetectorCacheManager() {
+	/**
+	 * Look up the MD5 of a file in the persistent cache, which is kept
+	 * between runs. The entry is only used if the size and the modification
+	 * time of @p node did not change since it was stored.
+	 *
+	 * The persistent cache is stored in scummvm-md5cache.dat next to the
+	 * configuration file. It is only used when the "md5_cache" setting is
+	 * enabled.
+	 */
+	bool getStoredMD5(const Common::String &fname, const Common::FSNode &node, FileProperties &fileProps);
+
+	/** Add the MD5 of a file to the persistent cache. */
+	void storeMD5(const Common::String &fname, const Common::FSNode &node, const FileProperties &fileProps);
+
+	/** Write the persistent cache to disk if it changed. */
+	void flushStoredMD5s();
+
+	AdvancedDetectorCacheManager() : batchDepth(0), storedMD5sLoaded(false), storedMD5sDirty(false) {
 		clear();
 	}
 
+	~AdvancedDetectorCacheManager() {
+		flushStoredMD5s();
+		clearArchives();
+	}
+
 	void clearArchives() {
 		for (auto &entry : archiveHashMap) {
 			delete entry._value;
@@ -626,6 +711,8 @@ public:
 	void clear() {
 		md5HashMap.clear(true);
 		sizeHashMap.clear(true);
+		directoryHashMap.clear(true);
+		localKeys.clear();
 		clearArchives();
 	}
 
@@ -635,9 +722,33 @@ private:
 	typedef Common::HashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> FileHashMap;
 	typedef Common::HashMap<Common::String, int64, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> SizeHashMap;
 	typedef Common::HashMap<Common::Path, Common::Archive *, Common::Path::IgnoreCase_Hash, Common::Path::IgnoreCase_EqualTo> ArchiveHashMap;
+	typedef Common::HashMap<Common::Path, Common::FSList, Common::Path::Hash, Common::Path::EqualTo> DirectoryHashMap;
 	FileHashMap md5HashMap;
 	SizeHashMap sizeHashMap;
 	ArchiveHashMap archiveHashMap;
+	DirectoryHashMap directoryHashMap;
+	Common::StringArray localKeys;
+	int batchDepth;
+
+	enum {
+		/** Entries not used during a run are dropped beyond this number. */
+		kMaxStoredMD5s = 50000
+	};
+
+	struct StoredMD5 {
+		int64 size;
+		int64 modificationTime;
+		Common::String md5;
+		bool used;
+	};
+
+	typedef Common::HashMap<Common::String, StoredMD5> StoredMD5HashMap;
+	StoredMD5HashMap storedMD5HashMap;
+	bool storedMD5sLoaded;
+	bool storedMD5sDirty;
+
+	bool isStoredMD5Enabled() const;
+	void loadStoredMD5s();
 };
 
 /** Convenience shortcut for accessing the MD5CacheManager. */
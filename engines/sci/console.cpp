@@ -115,6 +115,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("resource_id",		WRAP_METHOD(Console, cmdResourceId));
 	registerCmd("resource_info",		WRAP_METHOD(Console, cmdResourceInfo));
 	registerCmd("resource_types",		WRAP_METHOD(Console, cmdResourceTypes));
+	registerCmd("resource_cache",		WRAP_METHOD(Console, cmdResourceCache));
 	registerCmd("list",				WRAP_METHOD(Console, cmdList));
 	registerCmd("alloc_list",				WRAP_METHOD(Console, cmdAllocList));
 	registerCmd("hexgrep",			WRAP_METHOD(Console, cmdHexgrep));
@@ -238,6 +239,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("script_strings",   WRAP_METHOD(Console, cmdScriptStrings));
 	registerCmd("scrs",             WRAP_METHOD(Console, cmdScriptStrings));
 	registerCmd("script_said",      WRAP_METHOD(Console, cmdScriptSaid));
+	registerCmd("verify_decoding",  WRAP_METHOD(Console, cmdVerifyDecoding));
 	registerCmd("vm_varlist",			WRAP_METHOD(Console, cmdVMVarlist));
 	registerCmd("vmvarlist",			WRAP_METHOD(Console, cmdVMVarlist));				// alias
 	registerCmd("vl",					WRAP_METHOD(Console, cmdVMVarlist));				// alias
@@ -267,6 +269,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	_debugState.breakpointWasHit = false;
 	_debugState._breakpoints.clear(); // No breakpoints defined
 	_debugState._activeBreakpointTypes = 0;
+	_debugState.verifyDecoding = false;
 }
 
 Console::~Console() {
@@ -355,6 +358,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" resource_id - Identifies a resource number by splitting it up in resource type and resource number\n");
 	debugPrintf(" resource_info - Shows info about a resource\n");
 	debugPrintf(" resource_types - Shows the valid resource types\n");
+	debugPrintf(" resource_cache - Shows statistics of the resource cache, or changes its size\n");
 	debugPrintf(" list - Lists all the resources of a given type\n");
 	debugPrintf(" alloc_list - Lists all allocated resources\n");
 	debugPrintf(" hexgrep - Searches some resources for a particular sequence of bytes, represented as hexadecimal numbers\n");
@@ -450,6 +454,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" script_objects / scro - Shows all objects inside a specified script\n");
 	debugPrintf(" script_strings / scrs - Shows all strings inside a specified script\n");
 	debugPrintf(" script_said - Shows all said - strings inside a specified script\n");
+	debugPrintf(" verify_decoding - Compares the instructions executed by the VM with the script code\n");
 	debugPrintf(" vm_varlist / vmvarlist / vl - Shows the addresses of variables in the VM\n");
 	debugPrintf(" vm_vars / vmvars / vv - Displays or changes variables in the VM\n");
 	debugPrintf(" locals / l - Displays or changes local variables in the VM\n");
@@ -1201,6 +1206,47 @@ bool Console::cmdResourceTypes(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdResourceCache(int argc, const char **argv) {
+	ResourceManager *resMan = _engine->getResMan();
+
+	if (argc > 2) {
+		debugPrintf("Shows statistics of the cache of unlocked resources\n");
+		debugPrintf("Usage: %s [<size in KiB> | reset]\n", argv[0]);
+		debugPrintf("A size changes the budget of the cache, \"reset\" clears the statistics\n");
+		return true;
+	}
+
+	if (argc == 2) {
+		if (!scumm_stricmp(argv[1], "reset")) {
+			resMan->resetCacheStats();
+		} else {
+			const int size = atoi(argv[1]);
+			if (size <= 0) {
+				debugPrintf("Invalid cache size %s\n", argv[1]);
+				return true;
+			}
+			resMan->setMaxMemoryLRU(size * 1024);
+		}
+	}
+
+	const ResourceCacheStats &stats = resMan->getCacheStats();
+	const uint32 requests = stats.hits + stats.misses;
+	debugPrintf("Cache: %d of %d KiB, locked resources: %d KiB\n",
+	            resMan->getMemoryLRU() / 1024, resMan->getMaxMemoryLRU() / 1024, resMan->getMemoryLocked() / 1024);
+	debugPrintf("Requests: %u, hits: %u (%u%%), misses: %u\n",
+	            requests, stats.hits, requests ? (uint)((uint64)stats.hits * 100 / requests) : 0, stats.misses);
+	debugPrintf("Prefetched: %u, requested afterwards: %u\n", stats.prefetched, stats.prefetchHits);
+	for (int i = 0; i < kResourceCacheClassCount; i++) {
+		const ResourceCacheClass cacheClass = (ResourceCacheClass)i;
+		debugPrintf(" %-8s: %u resources, %d of %d KiB, %u evicted (%u KiB)\n",
+		            getResourceCacheClassName(cacheClass), resMan->getLRUCount(cacheClass),
+		            resMan->getLRUMemory(cacheClass) / 1024, resMan->getLRUBudget(cacheClass) / 1024,
+		            stats.evictions[i], (uint)(stats.evictedBytes[i] / 1024));
+	}
+
+	return true;
+}
+
 bool Console::cmdHexgrep(int argc, const char **argv) {
 	if (argc < 4) {
 		debugPrintf("Searches some resources for a particular sequence of bytes, represented as decimal or hexadecimal numbers.\n");
@@ -2938,6 +2984,29 @@ bool Console::cmdGCNormalize(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdVerifyDecoding(int argc, const char **argv) {
+	if (argc != 2) {
+		debugPrintf("Compares each instruction executed by the VM, which is decoded\n");
+		debugPrintf("only the first time it is run, with the code of the script.\n");
+		debugPrintf("Execution stops with an error on the first difference.\n");
+		debugPrintf("Usage: %s on|off\n", argv[0]);
+		debugPrintf("Verification is currently %s\n", _debugState.verifyDecoding ? "on" : "off");
+		return true;
+	}
+
+	if (!scumm_stricmp(argv[1], "on")) {
+		_debugState.verifyDecoding = true;
+	} else if (!scumm_stricmp(argv[1], "off")) {
+		_debugState.verifyDecoding = false;
+	} else {
+		debugPrintf("Invalid argument %s\n", argv[1]);
+		return true;
+	}
+
+	debugPrintf("Verification is now %s\n", _debugState.verifyDecoding ? "on" : "off");
+	return true;
+}
+
 bool Console::cmdVMVarlist(int argc, const char **argv) {
 	EngineState *s = _engine->_gamestate;
 	const char *varnames[] = {"global", "local", "temp", "param"};
@@ -49,16 +49,53 @@ const char *segmentTypeNames[] = {
 };
 #endif
 
+void GCMarkSet::addTo(AddrSet &set) const {
+	for (uint segment = 0; segment < _bits.size(); segment++) {
+		const Common::Array<uint32> &bits = _bits[segment];
+		for (uint word = 0; word < bits.size(); word++) {
+			for (uint bit = 0; bit < 32; bit++) {
+				if (bits[word] & (1u << bit)) {
+					reg_t reg = make_reg(segment, 0);
+					reg.setOffset(word * 32 + bit);
+					set.setVal(reg, true);
+				}
+			}
+		}
+	}
+}
+
+void GCMarkSet::addSegmentTo(SegmentId segment, Common::Array<reg_t> &regs) const {
+	if (segment >= _bits.size())
+		return;
+
+	const Common::Array<uint32> &bits = _bits[segment];
+	for (uint word = 0; word < bits.size(); word++) {
+		for (uint bit = 0; bit < 32; bit++) {
+			if (bits[word] & (1u << bit)) {
+				reg_t reg = make_reg(segment, 0);
+				reg.setOffset(word * 32 + bit);
+				regs.push_back(reg);
+			}
+		}
+	}
+}
+
 void WorklistManager::push(reg_t reg) {
 	if (!reg.getSegment()) // No numbers
 		return;
 
 	debugC(kDebugLevelGC, "[GC] Adding %04x:%04x", PRINT_REG(reg));
 
-	if (_map.contains(reg))
+	// References to segments which do not exist can be ignored, as there is
+	// nothing to keep alive or to follow
+	SegmentObj *mobj = _segMan->getSegmentObj(reg.getSegment());
+	if (!mobj)
+		return;
+
+	if (!_reached.mark(reg))
 		return; // already dealt with it
 
-	_map.setVal(reg, true);
+	_canonical.mark(mobj->findCanonicAddress(_segMan, reg));
 	_worklist.push_back(reg);
 }
 
@@ -67,42 +104,67 @@ void WorklistManager::pushArray(const Common::Array<reg_t> &tmp) {
 		push(*it);
 }
 
-static AddrSet *normalizeAddresses(SegManager *segMan, const AddrSet &nonnormal_map) {
-	AddrSet *normal_map = new AddrSet();
+void WorklistManager::markChanged(reg_t reg) {
+	// Objects which were not reached yet are scanned when they are reached
+	if (_reached.isMarked(reg) && _changedSet.mark(reg))
+		_changed.push_back(reg);
+}
+
+void WorklistManager::markAllocated(reg_t reg) {
+	// The address may have been reached already if it belonged to an object
+	// which was freed, so the new object has to be scanned again in any case
+	SegmentObj *mobj = _segMan->getSegmentObj(reg.getSegment());
+	_reached.mark(reg);
+	_canonical.mark(mobj->findCanonicAddress(_segMan, reg));
+	if (_changedSet.mark(reg))
+		_changed.push_back(reg);
+}
 
-	for (AddrSet::const_iterator i = nonnormal_map.begin(); i != nonnormal_map.end(); ++i) {
-		reg_t reg = i->_key;
-		SegmentObj *mobj = segMan->getSegmentObj(reg.getSegment());
+void WorklistManager::forgetSegment(SegmentId segment) {
+	// The segment ID may be reused, and nothing in the new segment has been
+	// reached yet
+	_reached.clearSegment(segment);
+	_canonical.clearSegment(segment);
+	_changedSet.clearSegment(segment);
+}
 
-		if (mobj) {
-			reg = mobj->findCanonicAddress(segMan, reg);
-			normal_map->setVal(reg, true);
-		}
-	}
+static void scanObject(SegManager *segMan, WorklistManager &wm, reg_t reg) {
+	debugC(kDebugLevelGC, "[GC] Checking %04x:%04x", PRINT_REG(reg));
+	SegmentObj *mobj = segMan->getSegmentObj(reg.getSegment());
 
-	return normal_map;
+	// Valid heap object? Find its outgoing references! The object may have
+	// been freed while an incremental collection was in progress.
+	if (mobj && mobj->isValidOffset(reg.getOffset()))
+		wm.pushArray(mobj->listAllOutgoingReferences(reg));
 }
 
-static void processWorkList(SegManager *segMan, WorklistManager &wm, const Common::Array<SegmentObj *> &heap) {
+/**
+ * Scans the objects on the worklist for further references.
+ * @param budget	The maximum number of objects to scan, or 0 to scan until
+ *					the worklist is empty
+ * @return true if the worklist is empty
+ */
+static bool processWorkList(SegManager *segMan, WorklistManager &wm, uint budget) {
 	SegmentId stackSegment = segMan->findSegmentByType(SEG_TYPE_STACK);
+	uint scanned = 0;
 	while (!wm._worklist.empty()) {
+		if (budget && scanned == budget)
+			return false;
+
 		reg_t reg = wm._worklist.back();
 		wm._worklist.pop_back();
 		if (reg.getSegment() != stackSegment) { // No need to repeat this one
-			debugC(kDebugLevelGC, "[GC] Checking %04x:%04x", PRINT_REG(reg));
-			if (reg.getSegment() < heap.size() && heap[reg.getSegment()]) {
-				// Valid heap object? Find its outgoing references!
-				wm.pushArray(heap[reg.getSegment()]->listAllOutgoingReferences(reg));
-			}
+			scanObject(segMan, wm, reg);
+			scanned++;
 		}
 	}
+
+	return true;
 }
 
-AddrSet *findAllActiveReferences(EngineState *s) {
+static void markRoots(EngineState *s, WorklistManager &wm) {
 	assert(!s->_executionStack.empty());
 
-	WorklistManager wm;
-
 	// Initialize registers
 	wm.push(s->r_acc);
 	wm.push(s->r_prev);
@@ -169,20 +231,61 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	}
 
 	debugC(kDebugLevelGC, "[GC] -- Finished explicitly loaded scripts, done with root set");
+}
 
-	processWorkList(s->_segMan, wm, heap);
-
+static void markEngineReferences(WorklistManager &wm) {
 	if (g_sci->_gfxPorts)
 		g_sci->_gfxPorts->processEngineHunkList(wm);
+}
 
-	return normalizeAddresses(s->_segMan, wm._map);
+static void markAllActiveReferences(EngineState *s, WorklistManager &wm) {
+	markRoots(s, wm);
+	processWorkList(s->_segMan, wm, 0);
+	markEngineReferences(wm);
 }
 
-void run_gc(EngineState *s) {
+/**
+ * Completes the marking of an incremental collection. The scripts may have
+ * changed the heap since the marking started, so the roots are marked again,
+ * and the changed objects are scanned again.
+ */
+static void finishMarking(EngineState *s, WorklistManager &wm) {
 	SegManager *segMan = s->_segMan;
+	markRoots(s, wm);
 
-	// Some debug stuff
-	debugC(kDebugLevelGC, "[GC] Running...");
+	// Objects and local variables are changed by the VM without telling the
+	// collector, so all reached ones are scanned again. They are few compared
+	// to the lists, nodes and arrays of a game.
+	Common::Array<reg_t> changed;
+	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
+	for (uint seg = 1; seg < heap.size(); seg++) {
+		if (heap[seg]) {
+			const SegmentType type = heap[seg]->getType();
+			if (type == SEG_TYPE_SCRIPT || type == SEG_TYPE_CLONES || type == SEG_TYPE_LOCALS)
+				wm._reached.addSegmentTo(seg, changed);
+		}
+	}
+
+	for (uint i = 0; i < changed.size(); i++)
+		scanObject(segMan, wm, changed[i]);
+	for (uint i = 0; i < wm._changed.size(); i++)
+		scanObject(segMan, wm, wm._changed[i]);
+	wm._changed.clear();
+
+	processWorkList(segMan, wm, 0);
+	markEngineReferences(wm);
+}
+
+AddrSet *findAllActiveReferences(EngineState *s) {
+	WorklistManager wm(s->_segMan);
+	markAllActiveReferences(s, wm);
+
+	AddrSet *activeRefs = new AddrSet();
+	wm._canonical.addTo(*activeRefs);
+	return activeRefs;
+}
+
+static void freeUnusedObjects(SegManager *segMan, const GCMarkSet &activeRefs) {
 #ifdef GC_DEBUG_CODE
 	const char *segnames[SEG_TYPE_MAX + 1];
 	int segcount[SEG_TYPE_MAX + 1];
@@ -190,9 +293,6 @@ void run_gc(EngineState *s) {
 	memset(segcount, 0, sizeof(segcount));
 #endif
 
-	// Compute the set of all segments references currently in use.
-	AddrSet *activeRefs = findAllActiveReferences(s);
-
 	// Iterate over all segments, and check for each whether it
 	// contains stuff that can be collected.
 	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
@@ -210,7 +310,7 @@ void run_gc(EngineState *s) {
 			const Common::Array<reg_t> tmp = mobj->listAllDeallocatable(seg);
 			for (Common::Array<reg_t>::const_iterator it = tmp.begin(); it != tmp.end(); ++it) {
 				const reg_t addr = *it;
-				if (!activeRefs->contains(addr)) {
+				if (!activeRefs.isMarked(addr)) {
 					// Not found -> we can free it
 					mobj->freeAtAddress(segMan, addr);
 					debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
@@ -223,8 +323,6 @@ void run_gc(EngineState *s) {
 		}
 	}
 
-	delete activeRefs;
-
 #ifdef GC_DEBUG_CODE
 	// Output debug summary of garbage collection
 	debugC(kDebugLevelGC, "[GC] Summary:");
@@ -234,4 +332,87 @@ void run_gc(EngineState *s) {
 #endif
 }
 
+void run_gc(EngineState *s) {
+	SegManager *segMan = s->_segMan;
+
+	debugC(kDebugLevelGC, "[GC] Running...");
+
+	WorklistManager *incremental = segMan->getIncrementalGC();
+	if (incremental) {
+		segMan->setIncrementalGC(nullptr);
+		if (!incremental->_sweeping)
+			finishMarking(s, *incremental);
+		freeUnusedObjects(segMan, incremental->_canonical);
+		delete incremental;
+		return;
+	}
+
+	// Compute the set of all segments references currently in use.
+	WorklistManager wm(segMan);
+	markAllActiveReferences(s, wm);
+	freeUnusedObjects(segMan, wm._canonical);
+}
+
+void start_gc(EngineState *s) {
+	SegManager *segMan = s->_segMan;
+	if (segMan->getIncrementalGC())
+		return;
+
+	debugC(kDebugLevelGC, "[GC] Starting...");
+
+	WorklistManager *wm = new WorklistManager(segMan);
+	markRoots(s, *wm);
+	segMan->setIncrementalGC(wm);
+}
+
+/**
+ * Frees up to GC_STEP_SIZE unused objects of an incremental collection.
+ * @return true if all segments are swept
+ */
+static bool sweepStep(SegManager *segMan, WorklistManager &wm) {
+	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
+	for (uint checked = 0; checked < GC_STEP_SIZE; checked++) {
+		while (wm._sweepPos == wm._sweepList.size()) {
+			if (++wm._sweepSegment >= heap.size())
+				return true;
+
+			wm._sweepPos = 0;
+			wm._sweepList.clear();
+			if (heap[wm._sweepSegment])
+				wm._sweepList = heap[wm._sweepSegment]->listAllDeallocatable(wm._sweepSegment);
+		}
+
+		const reg_t addr = wm._sweepList[wm._sweepPos++];
+		SegmentObj *mobj = segMan->getSegmentObj(addr.getSegment());
+
+		// The scripts may have freed the object since the segment was listed.
+		// Objects they allocated since then are marked.
+		if (mobj && mobj->isValidOffset(addr.getOffset()) && !wm._canonical.isMarked(addr)) {
+			mobj->freeAtAddress(segMan, addr);
+			debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
+		}
+	}
+
+	return false;
+}
+
+bool run_gc_step(EngineState *s) {
+	SegManager *segMan = s->_segMan;
+	WorklistManager *wm = segMan->getIncrementalGC();
+	if (!wm)
+		return false;
+
+	if (!wm->_sweeping) {
+		if (processWorkList(segMan, *wm, GC_STEP_SIZE)) {
+			finishMarking(s, *wm);
+			wm->_sweeping = true;
+		}
+	} else if (sweepStep(segMan, *wm)) {
+		segMan->setIncrementalGC(nullptr);
+		delete wm;
+	}
+
+	return true;
+}
+
 } // End of namespace Sci
@@ -49,17 +49,115 @@ typedef Common::HashMap<reg_t, bool, reg_t_Hash> AddrSet;
 AddrSet *findAllActiveReferences(EngineState *s);
 
 /**
- * Runs garbage collection on the current system state
+ * Runs garbage collection on the current system state. If an incremental
+ * collection is in progress, it is finished instead.
  * @param s The state in which we should gc
  */
 void run_gc(EngineState *s);
 
+/**
+ * Starts an incremental garbage collection, unless one is in progress
+ * already. Its marking is then done in steps by run_gc_step().
+ * @param s The state in which we should gc
+ */
+void start_gc(EngineState *s);
+
+/**
+ * Marks up to GC_STEP_SIZE objects of the incremental garbage collection in
+ * progress. Once all active objects are marked, the unused ones are freed in
+ * steps of the same size.
+ * @param s The state in which we should gc
+ * @return false if no incremental collection is in progress
+ */
+bool run_gc_step(EngineState *s);
+
+/**
+ * A set of addresses, stored as a bitmap of offsets for each segment. This
+ * is much cheaper to fill than an AddrSet, as the garbage collector adds
+ * every address it reaches.
+ */
+class GCMarkSet {
+public:
+	/**
+	 * Adds an address to the set.
+	 * @return false if the address was in the set already
+	 */
+	bool mark(reg_t reg) {
+		const SegmentId segment = reg.getSegment();
+		const uint32 offset = reg.getOffset();
+		if (segment >= _bits.size())
+			_bits.resize(segment + 1);
+
+		Common::Array<uint32> &bits = _bits[segment];
+		const uint32 word = offset >> 5;
+		if (word >= bits.size())
+			bits.resize(MAX<uint32>(word + 1, bits.size() * 2));
+
+		const uint32 bit = 1u << (offset & 31);
+		if (bits[word] & bit)
+			return false;
+
+		bits[word] |= bit;
+		return true;
+	}
+
+	bool isMarked(reg_t reg) const {
+		const SegmentId segment = reg.getSegment();
+		const uint32 word = reg.getOffset() >> 5;
+		return segment < _bits.size() && word < _bits[segment].size() &&
+			(_bits[segment][word] & (1u << (reg.getOffset() & 31)));
+	}
+
+	/** Removes all addresses in the given segment from the set. */
+	void clearSegment(SegmentId segment) {
+		if (segment < _bits.size())
+			_bits[segment].clear();
+	}
+
+	/** Adds all addresses in the set to an AddrSet. */
+	void addTo(AddrSet &set) const;
+
+	/** Appends all addresses in the given segment to an array. */
+	void addSegmentTo(SegmentId segment, Common::Array<reg_t> &regs) const;
+
+private:
+	Common::Array<Common::Array<uint32> > _bits;
+};
+
 struct WorklistManager {
+	WorklistManager(SegManager *segMan) : _sweeping(false), _sweepSegment(0), _sweepPos(0), _segMan(segMan) {}
+
 	Common::Array<reg_t> _worklist;
-	AddrSet _map;	// used for 2 contains() calls, inside push() and run_gc()
+	GCMarkSet _reached;   ///< All addresses pushed so far
+	GCMarkSet _canonical; ///< The canonical addresses of the pushed addresses
+
+	/**
+	 * Lists, nodes and arrays which were changed or allocated while an
+	 * incremental collection was in progress. They are scanned again when
+	 * the marking is finished.
+	 */
+	Common::Array<reg_t> _changed;
+	GCMarkSet _changedSet;
+
+	bool _sweeping;                  ///< Whether the marking is finished
+	SegmentId _sweepSegment;         ///< The segment being swept
+	Common::Array<reg_t> _sweepList; ///< The deallocatable objects of the segment
+	uint _sweepPos;                  ///< The next object of _sweepList to check
 
 	void push(reg_t reg);
 	void pushArray(const Common::Array<reg_t> &tmp);
+
+	/** Records that references may be stored in an object. */
+	void markChanged(reg_t reg);
+
+	/** Marks an object which was allocated during the collection as active. */
+	void markAllocated(reg_t reg);
+
+	/** Forgets the addresses in a segment which was freed. */
+	void forgetSegment(SegmentId segment);
+
+private:
+	SegManager *_segMan;
 };
 
 
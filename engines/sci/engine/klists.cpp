@@ -207,6 +207,8 @@ static void addToFront(EngineState *s, reg_t listRef, reg_t nodeRef) {
 	checkListPointer(s->_segMan, listRef);
 #endif
 
+	s->_segMan->gcWriteBarrier(listRef);
+	s->_segMan->gcWriteBarrier(nodeRef);
 	newNode->pred = NULL_REG;
 	newNode->succ = list->first;
 
@@ -214,6 +216,7 @@ static void addToFront(EngineState *s, reg_t listRef, reg_t nodeRef) {
 	if (list->first.isNull())
 		list->last = nodeRef;
 	else {
+		s->_segMan->gcWriteBarrier(list->first);
 		Node *oldNode = s->_segMan->lookupNode(list->first);
 		oldNode->pred = nodeRef;
 	}
@@ -233,6 +236,8 @@ static void addToEnd(EngineState *s, reg_t listRef, reg_t nodeRef) {
 	checkListPointer(s->_segMan, listRef);
 #endif
 
+	s->_segMan->gcWriteBarrier(listRef);
+	s->_segMan->gcWriteBarrier(nodeRef);
 	newNode->pred = list->last;
 	newNode->succ = NULL_REG;
 
@@ -240,6 +245,7 @@ static void addToEnd(EngineState *s, reg_t listRef, reg_t nodeRef) {
 	if (list->last.isNull())
 		list->first = nodeRef;
 	else {
+		s->_segMan->gcWriteBarrier(list->last);
 		Node *old_n = s->_segMan->lookupNode(list->last);
 		old_n->succ = nodeRef;
 	}
@@ -318,21 +324,26 @@ reg_t kAddAfter(EngineState *s, int argc, reg_t *argv) {
 		return NULL_REG;
 	}
 
+	s->_segMan->gcWriteBarrier(argv[2]);
 	if (argc == 4)
 		newNode->key = argv[3];
 
 	if (firstNode) { // We're really appending after
 		const reg_t oldNext = firstNode->succ;
 
+		s->_segMan->gcWriteBarrier(argv[1]);
 		newNode->pred = argv[1];
 		firstNode->succ = argv[2];
 		newNode->succ = oldNext;
 
-		if (oldNext.isNull())  // Appended after last node?
+		if (oldNext.isNull()) { // Appended after last node?
 			// Set new node as last list node
+			s->_segMan->gcWriteBarrier(argv[0]);
 			list->last = argv[2];
-		else
+		} else {
+			s->_segMan->gcWriteBarrier(oldNext);
 			s->_segMan->lookupNode(oldNext)->pred = argv[2];
+		}
 
 	} else {
 		addToFront(s, argv[0], argv[2]); // Set as initial list node
@@ -360,21 +371,26 @@ reg_t kAddBefore(EngineState *s, int argc, reg_t *argv) {
 		return NULL_REG;
 	}
 
+	s->_segMan->gcWriteBarrier(argv[2]);
 	if (argc == 4)
 		newNode->key = argv[3];
 
 	if (firstNode) { // We're really appending before
 		const reg_t oldPred = firstNode->pred;
 
+		s->_segMan->gcWriteBarrier(argv[1]);
 		newNode->succ = argv[1];
 		firstNode->pred = argv[2];
 		newNode->pred = oldPred;
 
-		if (oldPred.isNull())  // Appended before first node?
+		if (oldPred.isNull()) { // Appended before first node?
 			// Set new node as first list node
+			s->_segMan->gcWriteBarrier(argv[0]);
 			list->first = argv[2];
-		else
+		} else {
+			s->_segMan->gcWriteBarrier(oldPred);
 			s->_segMan->lookupNode(oldPred)->succ = argv[2];
+		}
 
 	} else {
 		addToFront(s, argv[0], argv[2]); // Set as initial list node
@@ -430,15 +446,20 @@ reg_t kDeleteKey(EngineState *s, int argc, reg_t *argv) {
 	}
 #endif
 
+	s->_segMan->gcWriteBarrier(argv[0]);
 	if (list->first == node_pos)
 		list->first = n->succ;
 	if (list->last == node_pos)
 		list->last = n->pred;
 
-	if (!n->pred.isNull())
+	if (!n->pred.isNull()) {
+		s->_segMan->gcWriteBarrier(n->pred);
 		s->_segMan->lookupNode(n->pred)->succ = n->succ;
-	if (!n->succ.isNull())
+	}
+	if (!n->succ.isNull()) {
+		s->_segMan->gcWriteBarrier(n->succ);
 		s->_segMan->lookupNode(n->succ)->pred = n->pred;
+	}
 
 	// Erase references to the predecessor and successor nodes, as the game
 	// scripts could reference the node itself again.
@@ -844,6 +865,7 @@ reg_t kArrayGetElement(EngineState *s, int argc, reg_t *argv) {
 
 reg_t kArraySetElements(EngineState *s, int argc, reg_t *argv) {
 	SciArray &array = *s->_segMan->lookupArray(argv[0]);
+	s->_segMan->gcWriteBarrier(argv[0]);
 	array.setElements(argv[1].toUint16(), argc - 2, argv + 2);
 	return argv[0];
 }
@@ -859,6 +881,7 @@ reg_t kArrayFree(EngineState *s, int argc, reg_t *argv) {
 
 reg_t kArrayFill(EngineState *s, int argc, reg_t *argv) {
 	SciArray &array = *s->_segMan->lookupArray(argv[0]);
+	s->_segMan->gcWriteBarrier(argv[0]);
 	array.fill(argv[1].toUint16(), argv[2].toUint16(), argv[3]);
 	return argv[0];
 }
@@ -873,6 +896,7 @@ reg_t kArrayCopy(EngineState *s, int argc, reg_t *argv) {
 		return argv[0];
 	}
 
+	s->_segMan->gcWriteBarrier(argv[0]);
 	if (!s->_segMan->isArray(argv[2])) {
 		// String copies may be made from static script data
 		SciArray source;
@@ -918,6 +942,7 @@ reg_t kArrayByteCopy(EngineState *s, int argc, reg_t *argv) {
 	const uint16 sourceOffset = argv[3].toUint16();
 	const uint16 count = argv[4].toUint16();
 
+	s->_segMan->gcWriteBarrier(argv[0]);
 	target.byteCopy(source, sourceOffset, targetOffset, count);
 	return argv[0];
 }
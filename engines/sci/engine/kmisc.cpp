@@ -242,7 +242,9 @@ reg_t kMemorySegment(EngineState *s, int argc, reg_t *argv) {
 }
 
 reg_t kFlushResources(EngineState *s, int argc, reg_t *argv) {
-	run_gc(s);
+	// The objects of the previous room are collected during the next kernel
+	// calls, instead of stalling the room change
+	start_gc(s);
 	debugC(kDebugLevelRoom, "Entering room number %d", argv[0].toUint16());
 	return s->r_acc;
 }
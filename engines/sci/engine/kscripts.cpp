@@ -271,6 +271,11 @@ reg_t kScriptID(EngineState *s, int argc, reg_t *argv) {
 	if (argv[0].getSegment())
 		return argv[0];
 
+	// Rooms are started by loading the script with the number of the new
+	// room, so have the resources of the room loaded along with it
+	if (script == s->currentRoomNumber())
+		g_sci->getResMan()->prefetchRoomResources(script);
+
 	SegmentId scriptSeg = s->_segMan->getScriptSegment(script, SCRIPT_GET_LOAD);
 
 	if (!scriptSeg)
@@ -74,6 +74,43 @@ void Script::freeScript(const bool keepLocalsSegment) {
 	_offsetLookupObjectCount = 0;
 	_offsetLookupStringCount = 0;
 	_offsetLookupSaidCount = 0;
+
+	freeDecodedInstructions();
+}
+
+const Script::DecodedInstruction &Script::decodeInstruction(uint32 offset) {
+	DecodedInstruction instruction;
+	int16 opparams[4];
+	instruction.size = readPMachineInstruction(getBuf(offset), instruction.extOpcode, opparams);
+	memcpy(instruction.opparams, opparams, sizeof(instruction.opparams));
+
+	// The index only has room for 65535 instructions. A script with more
+	// gets the ones past that decoded each time they are executed.
+	if (_decodedInstructions.size() >= 0xFFFF) {
+		_uncachedInstruction = instruction;
+		return _uncachedInstruction;
+	}
+
+	const uint32 page = offset >> kDecodedPageBits;
+	if (page >= _decodedIndex.size())
+		_decodedIndex.resize((_buf->size() >> kDecodedPageBits) + 1);
+
+	if (!_decodedIndex[page]) {
+		_decodedIndex[page] = new uint16[kDecodedPageSize];
+		memset(_decodedIndex[page], 0, kDecodedPageSize * sizeof(uint16));
+	}
+
+	_decodedInstructions.push_back(instruction);
+	_decodedIndex[page][offset & (kDecodedPageSize - 1)] = _decodedInstructions.size();
+	return _decodedInstructions.back();
+}
+
+void Script::freeDecodedInstructions() {
+	for (uint i = 0; i < _decodedIndex.size(); i++)
+		delete[] _decodedIndex[i];
+
+	_decodedIndex.clear();
+	_decodedInstructions.clear();
 }
 
 enum {
@@ -817,6 +854,8 @@ void Script::relocateSci0Sci21(const SegmentId segmentId) {
 					break;
 		}
 	}
+
+	freeDecodedInstructions();
 }
 
 #ifdef ENABLE_SCI32
@@ -839,6 +878,8 @@ void Script::relocateSci3(const SegmentId segmentId) {
 
 		relocEntry += 10;
 	}
+
+	freeDecodedInstructions();
 }
 #endif
 
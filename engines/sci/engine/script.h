@@ -131,6 +131,32 @@ public:
 		return _buf->getUint16SEAt(offset + SCRIPT_OBJECT_MAGIC_OFFSET) == SCRIPT_OBJECT_MAGIC_NUMBER;
 	}
 
+	/**
+	 * An instruction of the script's code, as decoded by
+	 * readPMachineInstruction(), which reads at most three operands.
+	 */
+	struct DecodedInstruction {
+		int16 opparams[3];
+		byte extOpcode;
+		uint16 size; /**< Length of the instruction in bytes */
+	};
+
+	/**
+	 * Returns the decoded instruction at the given offset. Instructions are
+	 * decoded the first time they are executed, and kept until the script is
+	 * freed or relocated. The reference is only valid until the next call.
+	 */
+	const DecodedInstruction &getDecodedInstruction(uint32 offset) {
+		const uint32 page = offset >> kDecodedPageBits;
+		if (page < _decodedIndex.size() && _decodedIndex[page]) {
+			const uint16 index = _decodedIndex[page][offset & (kDecodedPageSize - 1)];
+			if (index)
+				return _decodedInstructions[index - 1];
+		}
+
+		return decodeInstruction(offset);
+	}
+
 public:
 	Script();
 	~Script() override;
@@ -367,6 +393,36 @@ private:
 	 * Apply workarounds to known broken Said strings
 	 */
 	void applySaidWorkarounds();
+
+	enum {
+		kDecodedPageBits = 8,
+		kDecodedPageSize = 1 << kDecodedPageBits
+	};
+
+	/**
+	 * The decoded instructions, in the order they were first executed. This
+	 * takes 10 bytes per instruction, rather than per byte of code.
+	 */
+	Common::Array<DecodedInstruction> _decodedInstructions;
+
+	/**
+	 * For every offset, the index of the instruction there in
+	 * _decodedInstructions plus one, or 0 if it has not been decoded. It is
+	 * split in pages of kDecodedPageSize offsets, which are allocated when
+	 * code within them is first executed.
+	 */
+	Common::Array<uint16 *> _decodedIndex;
+
+	/** Instructions decoded once there are too many to be indexed */
+	DecodedInstruction _uncachedInstruction;
+
+	const DecodedInstruction &decodeInstruction(uint32 offset);
+
+	/**
+	 * Discards all decoded instructions. This has to be done whenever the
+	 * code of the script changes.
+	 */
+	void freeDecodedInstructions();
 };
 
 } // End of namespace Sci
@@ -20,6 +20,7 @@
  */
 
 #include "sci/sci.h"
+#include "sci/engine/gc.h"
 #include "sci/engine/seg_manager.h"
 #include "sci/engine/state.h"
 #include "sci/engine/script.h"
@@ -31,9 +32,13 @@ namespace Sci {
 
 
 SegManager::SegManager(ResourceManager *resMan, ScriptPatcher *scriptPatcher)
-	: _resMan(resMan), _scriptPatcher(scriptPatcher) {
+	: _resMan(resMan), _scriptPatcher(scriptPatcher), _incrementalGC(nullptr) {
 	_heap.push_back(0);
 
+	// Generation 0 is never current, so the cache starts out empty
+	memset(_selectorCache, 0, sizeof(_selectorCache));
+	_selectorCacheGeneration = 1;
+
 	_clonesSegId = 0;
 	_listsSegId = 0;
 	_nodesSegId = 0;
@@ -55,6 +60,10 @@ SegManager::~SegManager() {
 }
 
 void SegManager::resetSegMan() {
+	// A collection in progress would refer to the old objects
+	delete _incrementalGC;
+	_incrementalGC = nullptr;
+
 	// Free memory
 	for (uint i = 0; i < _heap.size(); i++) {
 		if (_heap[i])
@@ -140,6 +149,7 @@ Script *SegManager::allocateScript(int script_nr, SegmentId &segid) {
 
 	// Add the script to the "script id -> segment id" hashmap
 	_scriptSegMap[script_nr] = segid;
+	markAllocatedForGC(make_reg(segid, 0));
 
 	return script;
 }
@@ -180,6 +190,19 @@ void SegManager::deallocate(SegmentId seg) {
 
 	delete mobj;
 	_heap[actualSegment] = nullptr;
+	if (_incrementalGC)
+		_incrementalGC->forgetSegment(actualSegment);
+
+	invalidateSelectorCache();
+}
+
+void SegManager::markChangedForGC(reg_t addr) {
+	_incrementalGC->markChanged(addr);
+}
+
+void SegManager::markAllocatedForGC(reg_t addr) {
+	if (_incrementalGC)
+		_incrementalGC->markAllocated(addr);
 }
 
 bool SegManager::isHeapObject(reg_t pos) const {
@@ -461,6 +484,7 @@ reg_t SegManager::allocateHunkEntry(const char *hunk_type, int size) {
 	int offset = table->allocEntry();
 
 	reg_t addr = make_reg(_hunksSegId, offset);
+	markAllocatedForGC(addr);
 	Hunk &h = table->at(offset);
 
 	h.mem = malloc(size);
@@ -494,6 +518,7 @@ Clone *SegManager::allocateClone(reg_t *addr) {
 	int offset = table->allocEntry();
 
 	*addr = make_reg(_clonesSegId, offset);
+	markAllocatedForGC(*addr);
 	return &table->at(offset);
 }
 
@@ -510,6 +535,7 @@ List *SegManager::allocateList(reg_t *addr) {
 	int offset = table->allocEntry();
 
 	*addr = make_reg(_listsSegId, offset);
+	markAllocatedForGC(*addr);
 	return &table->at(offset);
 }
 
@@ -526,6 +552,7 @@ Node *SegManager::allocateNode(reg_t *addr) {
 	int offset = table->allocEntry();
 
 	*addr = make_reg(_nodesSegId, offset);
+	markAllocatedForGC(*addr);
 	return &table->at(offset);
 }
 
@@ -589,6 +616,12 @@ SegmentRef SegManager::dereference(reg_t pointer) {
 	}
 
 	SegmentObj *mobj = _heap[pointer.getSegment()];
+#ifdef ENABLE_SCI32
+	// The caller may store references in the array through the returned
+	// pointer, e.g. in kMemory
+	if (mobj->getType() == SEG_TYPE_ARRAY)
+		gcWriteBarrier(pointer);
+#endif
 	return mobj->dereference(pointer);
 }
 
@@ -909,6 +942,7 @@ byte *SegManager::allocDynmem(int size, const char *descr, reg_t *addr) {
 	DynMem *dynmem = new DynMem();
 	SegmentId segid = allocSegment(dynmem);
 	*addr = make_reg(segid, 0);
+	markAllocatedForGC(*addr);
 
 	dynmem->_size = size;
 
@@ -952,6 +986,7 @@ SciArray *SegManager::allocateArray(SciArrayType type, uint16 size, reg_t *addr)
 	int offset = table->allocEntry();
 
 	*addr = make_reg(_arraysSegId, offset);
+	markAllocatedForGC(*addr);
 
 	SciArray *array = &table->at(offset);
 	array->setType(type);
@@ -1008,6 +1043,7 @@ SciBitmap *SegManager::allocateBitmap(reg_t *addr, const int16 width, const int1
 	int offset = table->allocEntry();
 
 	*addr = make_reg(_bitmapSegId, offset);
+	markAllocatedForGC(*addr);
 	SciBitmap &bitmap = table->at(offset);
 
 	bitmap.create(width, height, skipColor, originX, originY, xResolution, yResolution, paletteSize, remap, gc);
@@ -1107,6 +1143,8 @@ int SegManager::instantiateScript(int scriptNum, bool applyScriptPatches) {
 	g_sci->_guestAdditions->instantiateScriptHook(*scr);
 #endif
 
+	invalidateSelectorCache();
+
 	return segmentId;
 }
 
@@ -1137,6 +1175,7 @@ void SegManager::uninstantiateScript(int script_nr) {
 	if (!scr->getLockers()) {
 		// The actual script deletion seems to be done by SCI scripts themselves
 		scr->markDeleted();
+		invalidateSelectorCache();
 		debugC(kDebugLevelScripts, "Unloaded script 0x%x.", script_nr);
 	}
 }
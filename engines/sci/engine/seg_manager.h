@@ -44,6 +44,7 @@ enum ScriptLoadType {
 };
 
 class Script;
+struct WorklistManager;
 
 class SegManager : public Common::Serializable {
 	friend class Console;
@@ -460,7 +461,76 @@ public:
 
 	const Common::Array<SegmentObj *> &getSegments() const { return _heap; }
 
+	/**
+	 * A cached result of lookupSelector().
+	 *
+	 * The result of a lookup only depends on the object's own methods, which
+	 * clones share with the object they were cloned from and which is given
+	 * by the object's position, on its class and superclass chain, and on the
+	 * selector, so this is what the entries are keyed by.
+	 */
+	struct SelectorCacheEntry {
+		uint32 generation; ///< The cache generation the entry belongs to
+		reg_t pos;
+		reg_t superClass;
+		Selector selector;
+		bool isClass;
+
+		SelectorType type;
+		int varIndex;
+		reg_t function;
+	};
+
+	/**
+	 * Returns the cache slot of a lookup. The slot may hold the result of
+	 * another lookup, or of an earlier cache generation.
+	 */
+	SelectorCacheEntry &getSelectorCacheEntry(reg_t pos, reg_t superClass, Selector selector) {
+		uint32 hash = (pos.getSegment() * 0x9E3779B1) ^ (pos.getOffset() * 0x85EBCA77) ^ (superClass.getOffset() * 0xC2B2AE3D) ^ selector;
+		return _selectorCache[(hash ^ (hash >> 15)) & (kSelectorCacheSize - 1)];
+	}
+
+	uint32 getSelectorCacheGeneration() const { return _selectorCacheGeneration; }
+
+	/**
+	 * Invalidates all cached selector lookups. This has to be done whenever
+	 * scripts are loaded or unloaded, as these change the superclass chains
+	 * of the objects.
+	 */
+	void invalidateSelectorCache() { _selectorCacheGeneration++; }
+
+	/**
+	 * Returns the incremental garbage collection in progress, or nullptr if
+	 * there is none.
+	 */
+	WorklistManager *getIncrementalGC() const { return _incrementalGC; }
+	void setIncrementalGC(WorklistManager *gc) { _incrementalGC = gc; }
+
+	/**
+	 * Tells an incremental garbage collection in progress that references
+	 * are about to be stored in the given list, node or array. This has to
+	 * be done for every change of these objects after their allocation, as
+	 * the collection may have scanned them already.
+	 */
+	void gcWriteBarrier(reg_t addr) {
+		if (_incrementalGC)
+			markChangedForGC(addr);
+	}
+
 private:
+	void markChangedForGC(reg_t addr);
+	void markAllocatedForGC(reg_t addr);
+
+	WorklistManager *_incrementalGC;
+
+
+	enum {
+		kSelectorCacheSize = 1024 ///< Number of cached selector lookups, must be a power of two
+	};
+
+	SelectorCacheEntry _selectorCache[kSelectorCacheSize];
+	uint32 _selectorCacheGeneration;
+
 	Common::Array<SegmentObj *> _heap;
 	Common::Array<Class> _classTable; /**< Table of all classes */
 	/** Map script ids to segment ids. */
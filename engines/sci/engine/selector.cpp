@@ -323,37 +323,19 @@ void invokeSelector(EngineState *s, reg_t object, int selectorId,
 	run_vm(s); // Start a new vm
 }
 
-SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector selectorId, ObjVarRef *varp, reg_t *fptr) {
-	const Object *obj = segMan->getObject(obj_location);
-	int index;
-	bool oldScriptHeader = (getSciVersion() == SCI_VERSION_0_EARLY);
-
-	// Early SCI versions used the LSB in the selector ID as a read/write
-	// toggle, meaning that we must remove it for selector lookup.
-	if (oldScriptHeader)
-		selectorId &= ~1;
-
-	if (!obj) {
-		error("lookupSelector: Attempt to send to non-object or invalid script. Address %04x:%04x", PRINT_REG(obj_location));
-	}
-
-	index = obj->locateVarSelector(segMan, selectorId);
+static SelectorType lookupSelectorUncached(SegManager *segMan, const Object *obj, Selector selectorId, int *varIndex, reg_t *fptr) {
+	int index = obj->locateVarSelector(segMan, selectorId);
 
 	if (index >= 0) {
 		// Found it as a variable
-		if (varp) {
-			varp->obj = obj_location;
-			varp->varindex = index;
-		}
+		*varIndex = index;
 		return kSelectorVariable;
 	} else {
 		// Check if it's a method, with recursive lookup in superclasses
 		while (obj) {
 			index = obj->funcSelectorPosition(selectorId);
 			if (index >= 0) {
-				if (fptr)
-					*fptr = obj->getFunction(index);
-
+				*fptr = obj->getFunction(index);
 				return kSelectorMethod;
 			} else {
 				obj = segMan->getObject(obj->getSuperClassSelector());
@@ -362,9 +344,47 @@ SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector sel
 
 		return kSelectorNone;
 	}
+}
 
+SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector selectorId, ObjVarRef *varp, reg_t *fptr) {
+	const Object *obj = segMan->getObject(obj_location);
+	bool oldScriptHeader = (getSciVersion() == SCI_VERSION_0_EARLY);
+
+	// Early SCI versions used the LSB in the selector ID as a read/write
+	// toggle, meaning that we must remove it for selector lookup.
+	if (oldScriptHeader)
+		selectorId &= ~1;
+
+	if (!obj) {
+		error("lookupSelector: Attempt to send to non-object or invalid script. Address %04x:%04x", PRINT_REG(obj_location));
+	}
+
+	const reg_t pos = obj->getPos();
+	const reg_t superClass = obj->getSuperClassSelector();
+	const bool isClass = obj->isClass();
+	SegManager::SelectorCacheEntry &entry = segMan->getSelectorCacheEntry(pos, superClass, selectorId);
+
+	if (entry.generation != segMan->getSelectorCacheGeneration() || entry.selector != selectorId ||
+		entry.pos != pos || entry.superClass != superClass || entry.isClass != isClass) {
+		entry.generation = segMan->getSelectorCacheGeneration();
+		entry.pos = pos;
+		entry.superClass = superClass;
+		entry.selector = selectorId;
+		entry.isClass = isClass;
+		entry.type = lookupSelectorUncached(segMan, obj, selectorId, &entry.varIndex, &entry.function);
+	}
+
+	if (entry.type == kSelectorVariable) {
+		if (varp) {
+			varp->obj = obj_location;
+			varp->varindex = entry.varIndex;
+		}
+	} else if (entry.type == kSelectorMethod) {
+		if (fptr)
+			*fptr = entry.function;
+	}
 
-//	return _lookupSelector_function(segMan, obj, selectorId, fptr);
+	return entry.type;
 }
 
 } // End of namespace Sci
@@ -510,6 +510,15 @@ int readPMachineInstruction(const byte *src, byte &extOpcode, int16 opparams[4])
 	return offset;
 }
 
+static void verifyDecodedInstruction(const Script *scr, reg_t pc, const Script::DecodedInstruction &instruction) {
+	byte extOpcode;
+	int16 opparams[4];
+	const int size = readPMachineInstruction(scr->getBuf(pc.getOffset()), extOpcode, opparams);
+
+	if (size != instruction.size || extOpcode != instruction.extOpcode || memcmp(opparams, instruction.opparams, sizeof(instruction.opparams)) || opparams[3])
+		error("Decoded instruction at %04x:%04x in script %d differs from the script code", PRINT_REG(pc), scr->getScriptNumber());
+}
+
 uint32 findOffset(const int16 relOffset, const Script *scr, const uint32 pcOffset) {
 	uint32 offset;
 
@@ -620,9 +629,15 @@ void run_vm(EngineState *s) {
 			error("run_vm(): program counter gone astray, addr: %d, code buffer size: %d",
 			s->xs->addr.pc.getOffset(), scr->getBufSize());
 
-		// Get opcode
-		byte extOpcode;
-		s->xs->addr.pc.incOffset(readPMachineInstruction(scr->getBuf(s->xs->addr.pc.getOffset()), extOpcode, opparams));
+		// Get opcode. The instruction is copied, as the script may be freed
+		// while it is executed.
+		const Script::DecodedInstruction &instruction = scr->getDecodedInstruction(s->xs->addr.pc.getOffset());
+		if (g_sci->_debugState.verifyDecoding)
+			verifyDecodedInstruction(scr, s->xs->addr.pc, instruction);
+		const byte extOpcode = instruction.extOpcode;
+		memcpy(opparams, instruction.opparams, sizeof(instruction.opparams));
+		opparams[3] = 0;
+		s->xs->addr.pc.incOffset(instruction.size);
 		const byte opcode = extOpcode >> 1;
 		//debug("%s: %d, %d, %d, %d, acc = %04x:%04x, script %d, local script %d", opcodeNames[opcode], opparams[0], opparams[1], opparams[2], opparams[3], PRINT_REG(s->r_acc), scr->getScriptNumber(), local_script->getScriptNumber());
 
@@ -847,10 +862,11 @@ void run_vm(EngineState *s) {
 		}
 
 		case op_callk: { // 0x21 (33)
-			// Run the garbage collector, if needed
-			if (s->gcCountDown-- <= 0) {
+			// Run the garbage collector, if needed. Its work is spread
+			// over several kernel calls, so that it does not stall the game.
+			if (!run_gc_step(s) && s->gcCountDown-- <= 0) {
 				s->gcCountDown = s->scriptGCInterval;
-				run_gc(s);
+				start_gc(s);
 			}
 
 			// Call kernel function
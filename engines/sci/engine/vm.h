@@ -187,9 +187,11 @@ enum GlobalVar {
 	kGlobalVarHoyle5MusicVolume    = 897
 };
 
-/** Number of kernel calls in between gcs; should be < 50000 */
 enum {
-	GC_INTERVAL = 0x8000
+	/** Number of kernel calls in between gcs; should be < 50000 */
+	GC_INTERVAL = 0x8000,
+	/** Number of objects an incremental gc marks or sweeps in each kernel call */
+	GC_STEP_SIZE = 0x200
 };
 
 enum SciOpcodes {
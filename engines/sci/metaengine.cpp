@@ -757,6 +757,9 @@ void SciMetaEngine::registerDefaultSettings(const Common::String &target) const
 
 	for (const PopUpOptionsMap *entry = popUpOptionsList; entry->guioFlag; ++entry)
 		ConfMan.registerDefault(entry->configOption, entry->defaultState);
+
+	// Size of the resource cache in KiB, 0 uses the size picked for the SCI version
+	ConfMan.registerDefault("sci_resource_cache_size", 0);
 }
 
 GUI::OptionsContainerWidget *SciMetaEngine::buildEngineOptionsWidget(GUI::GuiObject *boss, const Common::String &name, const Common::String &target) const {
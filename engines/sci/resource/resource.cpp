@@ -25,6 +25,7 @@
 #include "common/file.h"
 #include "common/fs.h"
 #include "common/macresman.h"
+#include "common/system.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
 #ifdef ENABLE_SCI32
@@ -152,6 +153,36 @@ const char *getResourceTypeExtension(ResourceType restype) {
 		return "";
 }
 
+ResourceCacheClass getResourceCacheClass(ResourceType restype) {
+	switch (restype) {
+	case kResourceTypeView:
+	case kResourceTypePic:
+	case kResourceTypePalette:
+		return kResourceCacheGraphics;
+	case kResourceTypeCdAudio:
+	case kResourceTypeAudio:
+	case kResourceTypeSync:
+	case kResourceTypeAudio36:
+	case kResourceTypeSync36:
+	case kResourceTypeRave:
+		return kResourceCacheStreamed;
+	default:
+		return kResourceCacheDefault;
+	}
+}
+
+// Share of the LRU cache budget of each class, in eighths. Graphics get the
+// largest one, streamed audio the smallest one.
+static const int s_resourceCacheClassShares[kResourceCacheClassCount] = { 1, 3, 4 };
+
+const char *getResourceCacheClassName(ResourceCacheClass cacheClass) {
+	static const char *const names[] = { "streamed", "default", "graphics" };
+	if (cacheClass < ARRAYSIZE(names))
+		return names[cacheClass];
+	else
+		return "invalid";
+}
+
 static const ResourceType s_resTypeMapSci0[] = {
 	kResourceTypeView, kResourceTypePic, kResourceTypeScript, kResourceTypeText,          // 0x00-0x03
 	kResourceTypeSound, kResourceTypeMemory, kResourceTypeVocab, kResourceTypeFont,       // 0x04-0x07
@@ -210,6 +241,8 @@ Resource::Resource(ResourceManager *resMan, ResourceId id) : SciSpan<const byte>
 	_source = nullptr;
 	_header = nullptr;
 	_headerSize = 0;
+	_lruPrev = nullptr;
+	_lruNext = nullptr;
 }
 
 Resource::~Resource() {
@@ -425,6 +458,225 @@ void ResourceManager::loadResource(Resource *res) {
 	};
 }
 
+static Decompressor *createDecompressor(ResourceCompression compression) {
+	switch (compression) {
+	case kCompNone:
+		return new Decompressor;
+	case kCompHuffman:
+		return new DecompressorHuffman;
+	case kCompLZW:
+	case kCompLZW1:
+	case kCompLZW1View:
+	case kCompLZW1Pic:
+		return new DecompressorLZW(compression);
+	case kCompDCL:
+		return new DecompressorDCL;
+#ifdef ENABLE_SCI32
+	case kCompSTACpack:
+		return new DecompressorLZS;
+#endif
+	default:
+		return nullptr;
+	}
+}
+
+bool ResourceManager::isPrefetchable(const Resource *res) const {
+	// Only resources in volumes are loaded by ResourceSource::loadResource,
+	// which prefetchResources() splits up. Audio is streamed, and texts are
+	// read with a different volume version in Korean games.
+	const ResourceType type = res->getType();
+	return res->_source->getSourceType() == kSourceVolume &&
+		getResourceCacheClass(type) != kResourceCacheStreamed &&
+		type != kResourceTypeMessage && type != kResourceTypeText;
+}
+
+void ResourceManager::prefetchRoomResources(uint16 roomNumber) {
+	if (_prefetchRoom == roomNumber)
+		return;
+	_prefetchRoom = roomNumber;
+
+	// Whatever the previous room did not request, it will not request now
+	discardPrefetchJobs();
+
+	// Without a thread, decompressing the resources now would stall the
+	// room change just as long as decompressing them when they are requested
+	if (!_prefetchThread) {
+		_prefetchThread = g_system->startBackgroundThread(&prefetchThreadProc, this, 10000);
+		if (!_prefetchThread)
+			return;
+	}
+
+	// The script and the pic of a room usually have the number of the room
+	Common::Array<ResourceId> ids;
+	ids.push_back(ResourceId(kResourceTypeScript, roomNumber));
+	ids.push_back(ResourceId(kResourceTypeHeap, roomNumber));
+	ids.push_back(ResourceId(kResourceTypePic, roomNumber));
+
+	prefetchResources(ids);
+}
+
+void ResourceManager::prefetchResources(const Common::Array<ResourceId> &ids) {
+	// Volume files are shared, so the packed data is read here, and only the
+	// decompression is left to the thread. The resources are limited to half
+	// of the cache, so that they do not evict each other once requested.
+	Common::Array<PrefetchJob *> jobs;
+	uint32 prefetchSize = 0;
+
+	for (uint i = 0; i < ids.size(); i++) {
+		Resource *res = testResource(ids[i]);
+		if (!res || res->_status != kResStatusNoMalloc || !isPrefetchable(res))
+			continue;
+
+		bool queued = false;
+		for (uint j = 0; j < jobs.size() && !queued; j++)
+			queued = (jobs[j]->id == res->_id);
+		if (queued)
+			continue;
+
+		Common::SeekableReadStream *fileStream = getVolumeFile(res->_source);
+		if (!fileStream)
+			continue;
+
+		// The header is read once more by Resource::decompress() in the
+		// thread, which fills in the staging resource
+		Resource *staging = new Resource(this, res->_id);
+		uint32 packedSize = 0;
+		ResourceCompression compression = kCompUnknown;
+		fileStream->seek(res->_fileOffset, SEEK_SET);
+		if (!staging->readResourceInfo(_volVersion, fileStream, packedSize, compression) &&
+			prefetchSize + staging->size() <= (uint32)_maxMemoryLRU / 2) {
+			PrefetchJob *job = new PrefetchJob();
+			job->id = res->_id;
+			job->volVersion = _volVersion;
+			job->packedSize = (uint32)(fileStream->pos() - res->_fileOffset) + packedSize;
+			job->packed = new byte[job->packedSize];
+			job->staging = staging;
+			job->errorNum = 0;
+			job->done = false;
+			job->cancelled = false;
+
+			fileStream->seek(res->_fileOffset, SEEK_SET);
+			if (fileStream->read(job->packed, job->packedSize) == job->packedSize) {
+				prefetchSize += staging->size();
+				jobs.push_back(job);
+				staging = nullptr;
+			} else {
+				delete[] job->packed;
+				delete job;
+			}
+		}
+
+		delete staging;
+		disposeVolumeFileStream(fileStream, res->_source);
+	}
+
+	if (jobs.empty())
+		return;
+
+	debugC(2, kDebugLevelResMan, "resMan: Prefetching %u resources (%u bytes)", jobs.size(), prefetchSize);
+	_cacheStats.prefetched += jobs.size();
+
+	Common::StackLock lock(_prefetchMutex);
+	for (uint i = 0; i < jobs.size(); i++)
+		_prefetchJobs.push_back(jobs[i]);
+}
+
+void ResourceManager::prefetchThreadProc(void *data) {
+	((ResourceManager *)data)->decompressPrefetchJobs();
+}
+
+void ResourceManager::decompressPrefetchJobs() {
+	for (;;) {
+		PrefetchJob *job = nullptr;
+		{
+			Common::StackLock lock(_prefetchMutex);
+			for (uint i = 0; i < _prefetchJobs.size() && !job; i++) {
+				if (!_prefetchJobs[i]->done)
+					job = _prefetchJobs[i];
+			}
+			if (!job)
+				return;
+			_prefetchBusy = job;
+		}
+
+		// The staging resource belongs to the job alone, so it is filled in
+		// without holding the lock
+		Common::MemoryReadStream stream(job->packed, job->packedSize);
+		const int errorNum = job->staging->decompress(job->volVersion, &stream);
+
+		Common::StackLock lock(_prefetchMutex);
+		_prefetchBusy = nullptr;
+		job->errorNum = errorNum;
+		job->done = true;
+		delete[] job->packed;
+		job->packed = nullptr;
+		if (job->cancelled) {
+			delete job->staging;
+			delete job;
+		}
+	}
+}
+
+bool ResourceManager::claimPrefetchedResource(Resource *res) {
+	if (!_prefetchThread)
+		return false;
+
+	PrefetchJob *job = nullptr;
+	{
+		Common::StackLock lock(_prefetchMutex);
+		for (uint i = 0; i < _prefetchJobs.size() && !job; i++) {
+			if (_prefetchJobs[i]->id == res->_id) {
+				job = _prefetchJobs[i];
+				_prefetchJobs.remove_at(i);
+			}
+		}
+		if (!job)
+			return false;
+
+		// Rather than waiting for the thread, the resource is loaded again
+		if (!job->done) {
+			if (job == _prefetchBusy) {
+				job->cancelled = true;
+			} else {
+				delete[] job->packed;
+				delete job->staging;
+				delete job;
+			}
+			return false;
+		}
+	}
+
+	// Failed resources are loaded again, so that the error is reported
+	const bool claimed = !job->errorNum;
+	if (claimed) {
+		res->_data = job->staging->_data;
+		res->_size = job->staging->_size;
+		res->_status = kResStatusAllocated;
+		job->staging->_data = nullptr;
+		if (_patcher)
+			_patcher->applyPatch(*res);
+	}
+
+	delete job->staging;
+	delete job;
+	return claimed;
+}
+
+void ResourceManager::discardPrefetchJobs() {
+	Common::StackLock lock(_prefetchMutex);
+	for (uint i = 0; i < _prefetchJobs.size(); i++) {
+		PrefetchJob *job = _prefetchJobs[i];
+		if (job == _prefetchBusy) {
+			job->cancelled = true;
+		} else {
+			delete[] job->packed;
+			delete job->staging;
+			delete job;
+		}
+	}
+	_prefetchJobs.clear();
+}
+
 
 void PatchResourceSource::loadResource(ResourceManager *resMan, Resource *res) {
 	bool result = res->loadFromPatchFile();
@@ -1003,13 +1255,15 @@ void ResourceManager::freeResourceSources() {
 }
 
 ResourceManager::ResourceManager(const bool detectionMode) :
-	_detectionMode(detectionMode) {}
+	_detectionMode(detectionMode), _prefetchBusy(nullptr), _prefetchThread(false) {}
 
 void ResourceManager::init() {
 	_maxMemoryLRU = 256 * 1024; // 256KiB
 	_memoryLocked = 0;
 	_memoryLRU = 0;
-	_LRU.clear();
+	memset(_LRU, 0, sizeof(_LRU));
+	resetCacheStats();
+	_prefetchRoom = -1;
 	_resMap.clear();
 	_audioMapSCI1 = nullptr;
 #ifdef ENABLE_SCI32
@@ -1083,6 +1337,14 @@ void ResourceManager::init() {
 		_maxMemoryLRU = 4096 * 1024; // 4MiB
 	}
 
+	// Allow the budget to be raised for large games, or lowered on
+	// devices with little memory
+	if (!_detectionMode) {
+		const int cacheSize = ConfMan.getInt("sci_resource_cache_size");
+		if (cacheSize > 0)
+			_maxMemoryLRU = cacheSize * 1024;
+	}
+
 	switch (_viewType) {
 	case kViewEga:
 		debugC(1, kDebugLevelResMan, "resMan: Detected EGA graphic resources");
@@ -1109,6 +1371,10 @@ void ResourceManager::init() {
 }
 
 ResourceManager::~ResourceManager() {
+	if (_prefetchThread)
+		g_system->stopBackgroundThread(&prefetchThreadProc, this);
+	discardPrefetchJobs();
+
 	// freeing resources
 	ResourceMap::iterator itr = _resMap.begin();
 	while (itr != _resMap.end()) {
@@ -1129,7 +1395,18 @@ void ResourceManager::removeFromLRU(Resource *res) {
 		warning("resMan: trying to remove resource that isn't enqueued");
 		return;
 	}
-	_LRU.remove(res);
+	LRUList &list = _LRU[getResourceCacheClass(res->getType())];
+	if (res->_lruPrev)
+		res->_lruPrev->_lruNext = res->_lruNext;
+	else
+		list.head = res->_lruNext;
+	if (res->_lruNext)
+		res->_lruNext->_lruPrev = res->_lruPrev;
+	else
+		list.tail = res->_lruPrev;
+	res->_lruPrev = res->_lruNext = nullptr;
+	list.count--;
+	list.memory -= res->size();
 	_memoryLRU -= res->size();
 	res->_status = kResStatusAllocated;
 }
@@ -1139,7 +1416,16 @@ void ResourceManager::addToLRU(Resource *res) {
 		warning("resMan: trying to enqueue resource with state %d", res->_status);
 		return;
 	}
-	_LRU.push_front(res);
+	LRUList &list = _LRU[getResourceCacheClass(res->getType())];
+	res->_lruPrev = nullptr;
+	res->_lruNext = list.head;
+	if (list.head)
+		list.head->_lruPrev = res;
+	else
+		list.tail = res;
+	list.head = res;
+	list.count++;
+	list.memory += res->size();
 	_memoryLRU += res->size();
 #ifdef SCI_VERBOSE_RESMAN
 	debug("Adding %s (%d bytes) to lru control: %d bytes total",
@@ -1149,11 +1435,30 @@ void ResourceManager::addToLRU(Resource *res) {
 	res->_status = kResStatusEnqueued;
 }
 
+int ResourceManager::getLRUBudget(ResourceCacheClass cacheClass) const {
+	return (int)((int64)_maxMemoryLRU * s_resourceCacheClassShares[cacheClass] / 8);
+}
+
 void ResourceManager::freeOldResources() {
+	// A class may use the budget the others leave unused, but once the cache
+	// is full, the least recently used resource of the class that exceeds its
+	// own budget the most is evicted. This way, a class which is used a lot
+	// cannot push the others out of memory entirely.
 	while (_maxMemoryLRU < _memoryLRU) {
-		assert(!_LRU.empty());
-		Resource *goner = _LRU.back();
+		int cacheClass = -1;
+		int excess = 0;
+		for (int i = 0; i < kResourceCacheClassCount; i++) {
+			const int classExcess = _LRU[i].memory - getLRUBudget((ResourceCacheClass)i);
+			if (_LRU[i].tail && (cacheClass == -1 || classExcess > excess)) {
+				cacheClass = i;
+				excess = classExcess;
+			}
+		}
+		assert(cacheClass != -1);
+		Resource *goner = _LRU[cacheClass].tail;
 		removeFromLRU(goner);
+		_cacheStats.evictions[cacheClass]++;
+		_cacheStats.evictedBytes[cacheClass] += goner->size();
 		goner->unalloc();
 #ifdef SCI_VERBOSE_RESMAN
 		debug("resMan-debug: LRU: Freeing %s (%d bytes)", goner->_id.toString().c_str(), goner->size);
@@ -1161,6 +1466,15 @@ void ResourceManager::freeOldResources() {
 	}
 }
 
+void ResourceManager::setMaxMemoryLRU(int maxMemory) {
+	_maxMemoryLRU = maxMemory;
+	freeOldResources();
+}
+
+void ResourceManager::resetCacheStats() {
+	memset(&_cacheStats, 0, sizeof(_cacheStats));
+}
+
 Common::List<ResourceId> ResourceManager::listResources(ResourceType type, int mapNumber) {
 	Common::List<ResourceId> resources;
 
@@ -1197,9 +1511,19 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	if (!retval)
 		return nullptr;
 
-	if (retval->_status == kResStatusNoMalloc)
-		loadResource(retval);
-	else if (retval->_status == kResStatusEnqueued)
+	if (retval->_status == kResStatusNoMalloc) {
+		if (claimPrefetchedResource(retval)) {
+			_cacheStats.hits++;
+			_cacheStats.prefetchHits++;
+		} else {
+			_cacheStats.misses++;
+			loadResource(retval);
+		}
+	} else {
+		_cacheStats.hits++;
+	}
+
+	if (retval->_status == kResStatusEnqueued)
 		// The resource is removed from its current position
 		// in the LRU list because it has been requested
 		// again. Below, it will either be locked, or it
@@ -2241,6 +2565,11 @@ Resource *ResourceManager::updateResource(ResourceId resId, ResourceSource *src,
 		if (res == nullptr) {
 			res = new Resource(this, resId);
 			_resMap.setVal(resId, res);
+		} else if (res->_status == kResStatusEnqueued) {
+			// Drop the data of the replaced resource, rather than leaving
+			// it behind in the LRU cache
+			removeFromLRU(res);
+			res->unalloc();
 		}
 
 		res->_status = kResStatusNoMalloc;
@@ -2369,29 +2698,8 @@ int Resource::decompress(ResVersion volVersion, Common::SeekableReadStream *file
 		return errorNum;
 
 	// getting a decompressor
-	Decompressor *dec = nullptr;
-	switch (compression) {
-	case kCompNone:
-		dec = new Decompressor;
-		break;
-	case kCompHuffman:
-		dec = new DecompressorHuffman;
-		break;
-	case kCompLZW:
-	case kCompLZW1:
-	case kCompLZW1View:
-	case kCompLZW1Pic:
-		dec = new DecompressorLZW(compression);
-		break;
-	case kCompDCL:
-		dec = new DecompressorDCL;
-		break;
-#ifdef ENABLE_SCI32
-	case kCompSTACpack:
-		dec = new DecompressorLZS;
-		break;
-#endif
-	default:
+	Decompressor *dec = createDecompressor(compression);
+	if (!dec) {
 		error("Resource %s: Compression method %d not supported", _id.toString().c_str(), compression);
 		return SCI_ERROR_UNKNOWN_COMPRESSION;
 	}
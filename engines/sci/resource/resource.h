@@ -25,6 +25,7 @@
 #include "common/str.h"
 #include "common/list.h"
 #include "common/hashmap.h"
+#include "common/mutex.h"
 
 #include "sci/graphics/helpers.h"		// for ViewType
 #include "sci/resource/decompressor.h"
@@ -131,6 +132,30 @@ enum ResourceType {
 const char *getResourceTypeName(ResourceType restype);
 const char *getResourceTypeExtension(ResourceType restype);
 
+/**
+ * Classes of unlocked resources in the LRU cache. Each class has its own
+ * share of the cache budget.
+ */
+enum ResourceCacheClass {
+	kResourceCacheStreamed = 0, ///< Audio and sync data, which is played once and cheap to reload
+	kResourceCacheDefault,      ///< Everything else
+	kResourceCacheGraphics,     ///< Views, pics and palettes, which are expensive to decompress and reused often
+	kResourceCacheClassCount
+};
+
+ResourceCacheClass getResourceCacheClass(ResourceType restype);
+const char *getResourceCacheClassName(ResourceCacheClass cacheClass);
+
+/** Statistics of the LRU resource cache, shown by the resource_cache debugger command */
+struct ResourceCacheStats {
+	uint32 hits;       ///< Requests for resources which were already in memory
+	uint32 misses;     ///< Requests which had to load the resource
+	uint32 evictions[kResourceCacheClassCount];    ///< Resources freed to stay within the budget
+	uint64 evictedBytes[kResourceCacheClassCount]; ///< Bytes freed to stay within the budget
+	uint32 prefetched;   ///< Resources queued for decompression before they were requested
+	uint32 prefetchHits; ///< Prefetched resources which were requested afterwards
+};
+
 enum ResVersion {
 	kResVersionUnknown,
 	kResVersionSci0Sci1Early,
@@ -311,6 +336,8 @@ protected:
 	uint16 _lockers; /**< Number of places where this resource was locked */
 	ResourceSource *_source;
 	ResourceManager *_resMan;
+	Resource *_lruPrev; ///< The next more recently used resource, while in the LRU cache
+	Resource *_lruNext; ///< The next less recently used resource, while in the LRU cache
 
 	bool loadPatch(Common::SeekableReadStream *file);
 	bool loadFromPatchFile();
@@ -407,6 +434,28 @@ public:
 	 */
 	bool hasResourceType(ResourceType type);
 
+	/**
+	 * Sets the maximum number of bytes of unlocked resources to keep in
+	 * memory, and frees resources as needed to stay within it.
+	 */
+	void setMaxMemoryLRU(int maxMemory);
+	int getMaxMemoryLRU() const { return _maxMemoryLRU; }
+	int getMemoryLocked() const { return _memoryLocked; }
+	int getMemoryLRU() const { return _memoryLRU; }
+	uint getLRUCount(ResourceCacheClass cacheClass) const { return _LRU[cacheClass].count; }
+	int getLRUMemory(ResourceCacheClass cacheClass) const { return _LRU[cacheClass].memory; }
+	int getLRUBudget(ResourceCacheClass cacheClass) const;
+	const ResourceCacheStats &getCacheStats() const { return _cacheStats; }
+	void resetCacheStats();
+
+	/**
+	 * Reads the script, heap and pic with the number of a room, and has them
+	 * decompressed by a background thread, so that they are ready by the time
+	 * the room requests them. Does nothing if the backend has no threads.
+	 * @param roomNumber	The room which is being started
+	 */
+	void prefetchRoomResources(uint16 roomNumber);
+
 	void setAudioLanguage(int language);
 	int getAudioLanguage() const;
 	void changeAudioDirectory(const Common::Path &path);
@@ -500,7 +549,47 @@ protected:
 	SourcesList _sources;
 	int _memoryLocked;	///< Amount of resource bytes in locked memory
 	int _memoryLRU;		///< Amount of resource bytes under LRU control
-	Common::List<Resource *> _LRU; ///< Last Resource Used list
+
+	/**
+	 * Last Resource Used list of one cache class. The resources are linked
+	 * through their _lruPrev and _lruNext members, from the most recently
+	 * used one at the head to the least recently used one at the tail.
+	 */
+	struct LRUList {
+		Resource *head;
+		Resource *tail;
+		uint count;
+		int memory;
+	};
+
+	LRUList _LRU[kResourceCacheClassCount];
+	ResourceCacheStats _cacheStats;
+
+	int _prefetchRoom; ///< The room whose resources were prefetched last, or -1
+
+	/**
+	 * A resource read from its volume, which the prefetch thread decompresses
+	 * into a resource of its own.
+	 */
+	struct PrefetchJob {
+		ResourceId id;
+		ResVersion volVersion;
+		byte *packed;      ///< The header and the packed data from the volume
+		uint32 packedSize;
+		Resource *staging; ///< Receives the decompressed data
+		int errorNum;
+		bool done;
+		bool cancelled;    ///< Deleted by the thread once it is done with it
+	};
+
+	/**
+	 * The resources queued for the prefetch thread, or decompressed by it and
+	 * not requested yet. Guarded by _prefetchMutex.
+	 */
+	Common::Array<PrefetchJob *> _prefetchJobs;
+	PrefetchJob *_prefetchBusy; ///< The job the prefetch thread is decompressing
+	Common::Mutex _prefetchMutex;
+	bool _prefetchThread; ///< Whether the prefetch thread was started
 	ResourceMap _resMap;
 	Common::List<Common::File *> _volumeFiles; ///< list of opened volume files
 	ResourceSource *_audioMapSCI1; ///< Currently loaded audio map for SCI1
@@ -646,6 +735,21 @@ protected:
 	void addToLRU(Resource *res);
 	void removeFromLRU(Resource *res);
 
+	bool isPrefetchable(const Resource *res) const;
+	void prefetchResources(const Common::Array<ResourceId> &ids);
+	static void prefetchThreadProc(void *data);
+	void decompressPrefetchJobs();
+
+	/**
+	 * Takes the data of a resource from the prefetch thread.
+	 * @return false if the thread did not decompress it (yet), in which case
+	 *         the resource has to be loaded as usual
+	 */
+	bool claimPrefetchedResource(Resource *res);
+
+	/** Drops the prefetched resources which were not requested */
+	void discardPrefetchJobs();
+
 	ResourceCompression getViewCompression();
 	ViewType detectViewType();
 	bool hasSci0Voc999();
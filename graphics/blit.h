@@ -27,6 +27,8 @@
 
 namespace Common {
 struct Point;
+struct Rect;
+template<class T> class Array;
 }
 
 class BlendBlitUnfilteredTestSuite;
@@ -68,6 +70,29 @@ void copyBlit(byte *dst, const byte *src,
 			   const uint w, const uint h,
 			   const uint bytesPerPixel);
 
+/**
+ * Blits a rectangle, and finds the areas in which it differs from the
+ * previous contents of the destination. Only these areas are written.
+ *
+ * Rows which changed and follow each other are reported as a single area,
+ * which covers the changed pixels of all of them.
+ *
+ * @param dst			the buffer which will receive the graphics data
+ * @param src			the buffer containing the new graphics data
+ * @param dstPitch		width in bytes of one full line of the dest buffer
+ * @param srcPitch		width in bytes of one full line of the source buffer
+ * @param w				the width of the graphics data
+ * @param h				the height of the graphics data
+ * @param bytesPerPixel	the number of bytes per pixel
+ * @param changed		receives the changed areas, relative to the top left
+ *						corner of the blitted rectangle
+ * @return				true if anything changed
+ */
+bool copyBlitChanged(byte *dst, const byte *src,
+			   const uint dstPitch, const uint srcPitch,
+			   const uint w, const uint h,
+			   const uint bytesPerPixel, Common::Array<Common::Rect> &changed);
+
 /**
  * Blits a rectangle with a transparent color key.
  *
@@ -23,6 +23,7 @@
 #include <immintrin.h>
 
 #include "graphics/blit/blit-alpha.h"
+#include "graphics/blit/blit-clut.h"
 #include "graphics/pixelformat.h"
 
 namespace Graphics {
@@ -299,4 +300,136 @@ void BlendBlit::blitAVX2(Args &args, const TSpriteBlendMode &blendMode, const Al
 	blitT<BlendBlitImpl_AVX2>(args, blendMode, alphaType);
 }
 
+// Interleave the byte planes of 32 pixels and store them.
+template<typename T>
+static FORCEINLINE void clutStore(byte *dst, const __m256i *b) {
+	if (sizeof(T) == 1) {
+		_mm256_storeu_si256((__m256i *)dst, b[0]);
+	} else if (sizeof(T) == 2) {
+		// The unpacks work within 128-bit lanes, so they give pixels 0-7
+		// and 16-23, and 8-15 and 24-31.
+		const __m256i lo = _mm256_unpacklo_epi8(b[0], b[1]);
+		const __m256i hi = _mm256_unpackhi_epi8(b[0], b[1]);
+		_mm256_storeu_si256((__m256i *)dst, _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256((__m256i *)(dst + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+	} else {
+		const __m256i lo01 = _mm256_unpacklo_epi8(b[0], b[1]);
+		const __m256i hi01 = _mm256_unpackhi_epi8(b[0], b[1]);
+		const __m256i lo23 = _mm256_unpacklo_epi8(b[2], b[3]);
+		const __m256i hi23 = _mm256_unpackhi_epi8(b[2], b[3]);
+		const __m256i p0 = _mm256_unpacklo_epi16(lo01, lo23); // 0-3, 16-19
+		const __m256i p1 = _mm256_unpackhi_epi16(lo01, lo23); // 4-7, 20-23
+		const __m256i p2 = _mm256_unpacklo_epi16(hi01, hi23); // 8-11, 24-27
+		const __m256i p3 = _mm256_unpackhi_epi16(hi01, hi23); // 12-15, 28-31
+		_mm256_storeu_si256((__m256i *)dst, _mm256_permute2x128_si256(p0, p1, 0x20));
+		_mm256_storeu_si256((__m256i *)(dst + 32), _mm256_permute2x128_si256(p2, p3, 0x20));
+		_mm256_storeu_si256((__m256i *)(dst + 64), _mm256_permute2x128_si256(p0, p1, 0x31));
+		_mm256_storeu_si256((__m256i *)(dst + 96), _mm256_permute2x128_si256(p2, p3, 0x31));
+	}
+}
+
+// Fill 32 pixels with one color.
+template<typename T>
+static FORCEINLINE void clutFill(byte *dst, uint32 color) {
+	__m256i c;
+	if (sizeof(T) == 1)
+		c = _mm256_set1_epi8((char)color);
+	else if (sizeof(T) == 2)
+		c = _mm256_set1_epi16((short)color);
+	else
+		c = _mm256_set1_epi32((int)color);
+
+	for (uint i = 0; i < sizeof(T); i++)
+		_mm256_storeu_si256((__m256i *)dst + i, c);
+}
+
+// Look up 32 pixels in the whole palette, eight at a time.
+template<typename T>
+static FORCEINLINE void clutGather(byte *dst, __m256i idx, const uint32 *map) {
+	const __m128i lo = _mm256_castsi256_si128(idx);
+	const __m128i hi = _mm256_extracti128_si256(idx, 1);
+	__m256i c[4];
+	c[0] = _mm256_i32gather_epi32((const int *)map, _mm256_cvtepu8_epi32(lo), 4);
+	c[1] = _mm256_i32gather_epi32((const int *)map, _mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8)), 4);
+	c[2] = _mm256_i32gather_epi32((const int *)map, _mm256_cvtepu8_epi32(hi), 4);
+	c[3] = _mm256_i32gather_epi32((const int *)map, _mm256_cvtepu8_epi32(_mm_srli_si128(hi, 8)), 4);
+
+	if (sizeof(T) == 4) {
+		for (int i = 0; i < 4; i++)
+			_mm256_storeu_si256((__m256i *)dst + i, c[i]);
+		return;
+	}
+
+	// Truncate like the scalar code, so that the packs do not saturate.
+	// The packs work within 128-bit lanes, the permutes put the pixels
+	// back in order.
+	const __m256i mask = _mm256_set1_epi32(sizeof(T) == 2 ? 0xFFFF : 0xFF);
+	for (int i = 0; i < 4; i++)
+		c[i] = _mm256_and_si256(c[i], mask);
+
+	const __m256i w01 = _mm256_permute4x64_epi64(_mm256_packus_epi32(c[0], c[1]), 0xD8);
+	const __m256i w23 = _mm256_permute4x64_epi64(_mm256_packus_epi32(c[2], c[3]), 0xD8);
+	if (sizeof(T) == 2) {
+		_mm256_storeu_si256((__m256i *)dst, w01);
+		_mm256_storeu_si256((__m256i *)dst + 1, w23);
+	} else {
+		_mm256_storeu_si256((__m256i *)dst, _mm256_permute4x64_epi64(_mm256_packus_epi16(w01, w23), 0xD8));
+	}
+}
+
+template<typename T>
+static void clutConvertAVX2(byte *dst, const byte *src, const uint dstPitch, const uint srcPitch,
+                            const uint w, const uint h, const uint32 *map) {
+	const int planeCount = sizeof(T);
+
+	// The byte planes of the first 16 palette entries, in both lanes
+	__m256i planes[4];
+	for (int p = 0; p < planeCount; p++) {
+		uint8 plane[16];
+		for (int i = 0; i < 16; i++)
+			plane[i] = (uint8)(map[i] >> (p * 8));
+		planes[p] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)plane));
+	}
+
+	for (uint y = 0; y < h; y++) {
+		uint x = 0;
+		for (; x + 32 <= w; x += 32) {
+			const __m256i idx = _mm256_loadu_si256((const __m256i *)(src + x));
+
+			// Looking up more than 16 entries takes a shuffle per 16
+			// entries and plane, which is slower than gathering them.
+			// Only the first 16 are used in EGA graphics though.
+			if (_mm256_testz_si256(idx, _mm256_set1_epi8((char)0xF0))) {
+				__m256i b[4];
+				for (int p = 0; p < planeCount; p++)
+					b[p] = _mm256_shuffle_epi8(planes[p], idx);
+
+				clutStore<T>(dst + x * sizeof(T), b);
+			} else if ((uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(idx, _mm256_set1_epi8((char)src[x]))) == 0xFFFFFFFF) {
+				clutFill<T>(dst + x * sizeof(T), map[src[x]]);
+			} else {
+				clutGather<T>(dst + x * sizeof(T), idx, map);
+			}
+		}
+		clutLookup<T>(dst + x * sizeof(T), src + x, w - x, map);
+
+		dst += dstPitch;
+		src += srcPitch;
+	}
+}
+
+bool CLUT8Blit::convertAVX2(byte *dst, const byte *src, const uint dstPitch, const uint srcPitch,
+                            const uint w, const uint h, const uint bytesPerPixel, const uint32 *map) {
+	if (bytesPerPixel == 1) {
+		clutConvertAVX2<uint8>(dst, src, dstPitch, srcPitch, w, h, map);
+	} else if (bytesPerPixel == 2) {
+		clutConvertAVX2<uint16>(dst, src, dstPitch, srcPitch, w, h, map);
+	} else if (bytesPerPixel == 4) {
+		clutConvertAVX2<uint32>(dst, src, dstPitch, srcPitch, w, h, map);
+	} else {
+		return false;
+	}
+	return true;
+}
+
 } // End of namespace Graphics
@@ -0,0 +1,88 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_BLIT_CLUT_H
+#define GRAPHICS_BLIT_CLUT_H
+
+#include "common/scummsys.h"
+
+class BlitTestSuite;
+
+namespace Graphics {
+
+/**
+ * Vector versions of the palette lookup done by crossBlitMap().
+ *
+ * Runs of pixels of the same color, such as backgrounds and borders, are
+ * filled with a single vector; SSE2 only does so for 8 and 16 bpp. AVX2
+ * also looks up runs using only the first 16 colors, as in EGA graphics,
+ * with byte shuffles, and gathers the other runs from the whole palette.
+ *
+ * The functions dispatch at runtime to SSE2 or AVX2 versions when the CPU
+ * supports them, in the same way as BlendBlit does.
+ */
+class CLUT8Blit {
+public:
+	/**
+	 * Convert a rectangle of CLUT8 pixels using a palette map.
+	 *
+	 * The rows are converted from top to bottom and left to right, so the
+	 * destination must not overlap the source, unless both are the same
+	 * 1 byte per pixel buffer.
+	 *
+	 * @return False if there is no vector version for this CPU or pixel
+	 *         size. Nothing has been converted then.
+	 */
+	static bool convert(byte *dst, const byte *src,
+	                    const uint dstPitch, const uint srcPitch,
+	                    const uint w, const uint h,
+	                    const uint bytesPerPixel, const uint32 *map);
+
+private:
+	typedef bool (*ConvertFunc)(byte *dst, const byte *src, const uint dstPitch, const uint srcPitch,
+	                            const uint w, const uint h, const uint bytesPerPixel, const uint32 *map);
+
+	static bool convertGeneric(byte *dst, const byte *src, const uint dstPitch, const uint srcPitch,
+	                           const uint w, const uint h, const uint bytesPerPixel, const uint32 *map);
+#ifdef SCUMMVM_SSE2
+	static bool convertSSE2(byte *dst, const byte *src, const uint dstPitch, const uint srcPitch,
+	                        const uint w, const uint h, const uint bytesPerPixel, const uint32 *map);
+#endif
+#ifdef SCUMMVM_AVX2
+	static bool convertAVX2(byte *dst, const byte *src, const uint dstPitch, const uint srcPitch,
+	                        const uint w, const uint h, const uint bytesPerPixel, const uint32 *map);
+#endif
+
+	static ConvertFunc convertFunc;
+	friend class ::BlitTestSuite;
+};
+
+/** Look up a run of pixels one at a time, for the pixels left over by the vector code. */
+template<typename T>
+static inline void clutLookup(byte *dst, const byte *src, uint w, const uint32 *map) {
+	T *out = (T *)dst;
+	for (uint x = 0; x < w; x++)
+		out[x] = (T)map[src[x]];
+}
+
+} // End of namespace Graphics
+
+#endif
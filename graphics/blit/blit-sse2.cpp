@@ -23,6 +23,7 @@
 #include <immintrin.h>
 
 #include "graphics/blit/blit-alpha.h"
+#include "graphics/blit/blit-clut.h"
 #include "graphics/pixelformat.h"
 
 namespace Graphics {
@@ -300,4 +301,55 @@ void BlendBlit::blitSSE2(Args &args, const TSpriteBlendMode &blendMode, const Al
 	blitT<BlendBlitImpl_SSE2>(args, blendMode, alphaType);
 }
 
+template<typename T>
+static void clutConvertSSE2(byte *dst, const byte *src, const uint dstPitch, const uint srcPitch,
+                            const uint w, const uint h, const uint32 *map) {
+	for (uint y = 0; y < h; y++) {
+		uint x = 0;
+		for (; x + 16 <= w; x += 16) {
+			// SSE2 has no byte shuffle to look up several colors at once,
+			// but runs of a single color only need one lookup.
+			const __m128i idx = _mm_loadu_si128((const __m128i *)(src + x));
+			const __m128i first = _mm_set1_epi8((char)src[x]);
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(idx, first)) != 0xFFFF) {
+				// Look up a copy of the indices, which the stores to the
+				// destination can not overwrite, so that they are not
+				// loaded again after each store.
+				byte indices[16];
+				_mm_storeu_si128((__m128i *)indices, idx);
+				clutLookup<T>(dst + x * sizeof(T), indices, 16, map);
+				continue;
+			}
+
+			__m128i color;
+			if (sizeof(T) == 1)
+				color = _mm_set1_epi8((char)map[src[x]]);
+			else
+				color = _mm_set1_epi16((short)map[src[x]]);
+
+			__m128i *out = (__m128i *)(dst + x * sizeof(T));
+			for (uint i = 0; i < sizeof(T); i++)
+				_mm_storeu_si128(out + i, color);
+		}
+		clutLookup<T>(dst + x * sizeof(T), src + x, w - x, map);
+
+		dst += dstPitch;
+		src += srcPitch;
+	}
+}
+
+bool CLUT8Blit::convertSSE2(byte *dst, const byte *src, const uint dstPitch, const uint srcPitch,
+                            const uint w, const uint h, const uint bytesPerPixel, const uint32 *map) {
+	// The scalar loop of crossBlitMap() is faster for 32 bpp unless the
+	// runs are long, so leave those to it.
+	if (bytesPerPixel == 1) {
+		clutConvertSSE2<uint8>(dst, src, dstPitch, srcPitch, w, h, map);
+	} else if (bytesPerPixel == 2) {
+		clutConvertSSE2<uint16>(dst, src, dstPitch, srcPitch, w, h, map);
+	} else {
+		return false;
+	}
+	return true;
+}
+
 } // End of namespace Graphics
@@ -20,8 +20,12 @@
  */
 
 #include "graphics/blit.h"
+#include "graphics/blit/blit-clut.h"
 #include "graphics/pixelformat.h"
+#include "common/array.h"
 #include "common/endian.h"
+#include "common/rect.h"
+#include "common/system.h"
 
 namespace Graphics {
 
@@ -49,6 +53,82 @@ void copyBlit(byte *dst, const byte *src,
 
 namespace {
 
+/** Return the number of bytes at the start of two rows which are equal. */
+inline uint equalBytesAtStart(const byte *a, const byte *b, const uint size) {
+	uint i = 0;
+
+	for (; i + 8 <= size; i += 8) {
+		uint64 wordA, wordB;
+		memcpy(&wordA, a + i, 8);
+		memcpy(&wordB, b + i, 8);
+		if (wordA != wordB)
+			break;
+	}
+
+	while (i < size && a[i] == b[i])
+		++i;
+	return i;
+}
+
+/** Return the number of bytes at the end of two rows which are equal. */
+inline uint equalBytesAtEnd(const byte *a, const byte *b, const uint size) {
+	uint i = size;
+
+	for (; i >= 8; i -= 8) {
+		uint64 wordA, wordB;
+		memcpy(&wordA, a + i - 8, 8);
+		memcpy(&wordB, b + i - 8, 8);
+		if (wordA != wordB)
+			break;
+	}
+
+	while (i > 0 && a[i - 1] == b[i - 1])
+		--i;
+	return size - i;
+}
+
+} // End of anonymous namespace
+
+bool copyBlitChanged(byte *dst, const byte *src,
+			   const uint dstPitch, const uint srcPitch,
+			   const uint w, const uint h,
+			   const uint bytesPerPixel, Common::Array<Common::Rect> &changed) {
+	const uint rowSize = w * bytesPerPixel;
+	bool previousRowChanged = false;
+
+	changed.clear();
+	if (dst == src)
+		return false;
+
+	for (uint y = 0; y < h; ++y) {
+		if (memcmp(dst, src, rowSize) == 0) {
+			previousRowChanged = false;
+		} else {
+			// Only the pixels between the first and the last change are copied
+			const int left = equalBytesAtStart(dst, src, rowSize) / bytesPerPixel;
+			const int right = w - equalBytesAtEnd(dst, src, rowSize) / bytesPerPixel;
+			memcpy(dst + left * bytesPerPixel, src + left * bytesPerPixel, (right - left) * bytesPerPixel);
+
+			if (previousRowChanged) {
+				Common::Rect &area = changed.back();
+				area.left = MIN<int>(area.left, left);
+				area.right = MAX<int>(area.right, right);
+				area.bottom = y + 1;
+			} else {
+				changed.push_back(Common::Rect(left, y, right, y + 1));
+			}
+			previousRowChanged = true;
+		}
+
+		dst += dstPitch;
+		src += srcPitch;
+	}
+
+	return !changed.empty();
+}
+
+namespace {
+
 template<typename Color, int Size>
 inline void keyBlitLogic(byte *dst, const byte *src, const uint w, const uint h,
 						 const uint srcDelta, const uint dstDelta, const uint32 key) {
@@ -482,6 +562,33 @@ bool crossMaskBlit(byte *dst, const byte *src, const byte *mask,
 	return true;
 }
 
+// Initialize this to nullptr at the start
+CLUT8Blit::ConvertFunc CLUT8Blit::convertFunc = nullptr;
+
+bool CLUT8Blit::convertGeneric(byte *dst, const byte *src, const uint dstPitch, const uint srcPitch,
+                               const uint w, const uint h, const uint bytesPerPixel, const uint32 *map) {
+	// crossBlitMap() falls back to its own loops
+	return false;
+}
+
+bool CLUT8Blit::convert(byte *dst, const byte *src,
+                        const uint dstPitch, const uint srcPitch,
+                        const uint w, const uint h,
+                        const uint bytesPerPixel, const uint32 *map) {
+	// If no function has been selected yet, detect and select
+	if (!convertFunc) {
+		convertFunc = convertGeneric;
+#ifdef SCUMMVM_SSE2
+		if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) convertFunc = convertSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+		if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) convertFunc = convertAVX2;
+#endif
+	}
+
+	return convertFunc(dst, src, dstPitch, srcPitch, w, h, bytesPerPixel, map);
+}
+
 // Function to blit a rect from one color format to another using a map
 bool crossBlitMap(byte *dst, const byte *src,
 			   const uint dstPitch, const uint srcPitch,
@@ -491,6 +598,14 @@ bool crossBlitMap(byte *dst, const byte *src,
 	if (!bytesPerPixel)
 		return false;
 
+	// The vector versions work forwards, so they can only be used when
+	// they do not overwrite source pixels before reading them.
+	const bool overlap = (dst < src + h * srcPitch) && (src < dst + h * dstPitch);
+	if (!overlap || (dst == src && dstPitch == srcPitch && bytesPerPixel == 1)) {
+		if (CLUT8Blit::convert(dst, src, dstPitch, srcPitch, w, h, bytesPerPixel, map))
+			return true;
+	}
+
 	// Faster, but larger, to provide optimized handling for each case.
 	const uint srcDelta = (srcPitch - w);
 	const uint dstDelta = (dstPitch - w * bytesPerPixel);
@@ -0,0 +1,166 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "graphics/dirty_tile_map.h"
+#include "common/util.h"
+
+namespace Graphics {
+
+/**
+ * Find the first span of set bits in a row of tiles, starting at tile
+ * @p start. On success, @p start and @p end are the first tile of the
+ * span and the tile after its end.
+ */
+static bool findSpan(const uint32 *row, uint numTiles, uint &start, uint &end) {
+	uint x = start;
+
+	// Skip the clean tiles, a whole word at a time where possible
+	while (x < numTiles) {
+		uint32 word = row[x >> 5] >> (x & 31);
+		if (!word) {
+			x = (x | 31) + 1;
+			continue;
+		}
+		while (!(word & 1)) {
+			word >>= 1;
+			x++;
+		}
+		break;
+	}
+	if (x >= numTiles)
+		return false;
+	start = x;
+
+	// The bits past the last tile are never set, so the span ends there
+	// at the latest
+	while (x < numTiles) {
+		uint32 word = ~row[x >> 5] >> (x & 31);
+		if (!word) {
+			x = (x | 31) + 1;
+			continue;
+		}
+		while (!(word & 1)) {
+			word >>= 1;
+			x++;
+		}
+		break;
+	}
+	end = MIN(x, numTiles);
+	return true;
+}
+
+DirtyTileMap::DirtyTileMap(uint tileShift) : _tileShift(tileShift), _width(0), _height(0),
+	_tilesWide(0), _tilesHigh(0), _wordsPerRow(0), _empty(true) {
+}
+
+void DirtyTileMap::resize(int width, int height) {
+	_width = MAX(width, 0);
+	_height = MAX(height, 0);
+	_tilesWide = (_width + (1 << _tileShift) - 1) >> _tileShift;
+	_tilesHigh = (_height + (1 << _tileShift) - 1) >> _tileShift;
+	_wordsPerRow = (_tilesWide + 31) / 32;
+
+	_bits.resize(_wordsPerRow * _tilesHigh);
+	clear();
+}
+
+void DirtyTileMap::clear() {
+	if (!_bits.empty())
+		memset(_bits.data(), 0, _bits.size() * sizeof(uint32));
+	_empty = true;
+}
+
+void DirtyTileMap::setSpan(uint32 *row, uint first, uint last) {
+	const uint firstWord = first >> 5;
+	const uint lastWord = last >> 5;
+
+	for (uint w = firstWord; w <= lastWord; w++) {
+		uint32 mask = 0xFFFFFFFF;
+		if (w == firstWord)
+			mask &= 0xFFFFFFFF << (first & 31);
+		if (w == lastWord)
+			mask &= 0xFFFFFFFF >> (31 - (last & 31));
+		row[w] |= mask;
+	}
+}
+
+void DirtyTileMap::addRect(const Common::Rect &r) {
+	Common::Rect bounds = r;
+	bounds.clip(Common::Rect(_width, _height));
+	if (bounds.isEmpty())
+		return;
+
+	const uint firstTile = bounds.left >> _tileShift;
+	const uint lastTile = (bounds.right - 1) >> _tileShift;
+	const uint lastRow = (bounds.bottom - 1) >> _tileShift;
+
+	for (uint y = bounds.top >> _tileShift; y <= lastRow; y++)
+		setSpan(&_bits[y * _wordsPerRow], firstTile, lastTile);
+
+	_empty = false;
+}
+
+void DirtyTileMap::markAll() {
+	addRect(Common::Rect(_width, _height));
+}
+
+void DirtyTileMap::getRects(Common::Array<Common::Rect> &rects) const {
+	rects.clear();
+	if (_empty)
+		return;
+
+	// The rectangles which reach down to the previous row of tiles, in
+	// the order of their spans, and the same for the current row
+	Common::Array<uint> open, nextOpen;
+
+	for (uint y = 0; y < _tilesHigh; y++) {
+		const uint32 *row = &_bits[y * _wordsPerRow];
+		const int top = y << _tileShift;
+		const int bottom = MIN<int>((y + 1) << _tileShift, _height);
+		uint o = 0;
+		uint start = 0, end;
+
+		nextOpen.clear();
+		while (findSpan(row, _tilesWide, start, end)) {
+			const int left = start << _tileShift;
+			const int right = MIN<int>(end << _tileShift, _width);
+
+			while (o < open.size() && rects[open[o]].left < left)
+				o++;
+
+			if (o < open.size() && rects[open[o]].left == left && rects[open[o]].right == right) {
+				// Same span as in the row above, extend that rectangle
+				rects[open[o]].bottom = bottom;
+				nextOpen.push_back(open[o]);
+				o++;
+			} else {
+				rects.push_back(Common::Rect(left, top, right, bottom));
+				nextOpen.push_back(rects.size() - 1);
+			}
+
+			start = end;
+		}
+
+		open.swap(nextOpen);
+	}
+}
+
+} // End of namespace Graphics
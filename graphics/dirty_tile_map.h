@@ -0,0 +1,111 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_DIRTY_TILE_MAP_H
+#define GRAPHICS_DIRTY_TILE_MAP_H
+
+#include "common/array.h"
+#include "common/rect.h"
+
+namespace Graphics {
+
+/**
+ * @defgroup graphics_dirty_tile_map Dirty tile map
+ * @ingroup graphics
+ *
+ * @brief Tracks the modified areas of a screen.
+ *
+ * @{
+ */
+
+/**
+ * Keeps track of the modified areas of a screen as a grid of tiles.
+ *
+ * Marking an area costs the same however many areas have been marked
+ * before, and overlapping areas are merged for free. When the screen is
+ * updated, getRects() returns the dirty tiles as a short list of
+ * rectangles which do not overlap, built from the spans of dirty tiles
+ * in each row of tiles.
+ */
+class DirtyTileMap {
+public:
+	/**
+	 * Create an empty map.
+	 *
+	 * @param tileShift  The tiles are (1 << tileShift) pixels wide and high.
+	 */
+	DirtyTileMap(uint tileShift = 4);
+
+	/**
+	 * Set the size of the tracked area in pixels. This clears the map.
+	 */
+	void resize(int width, int height);
+
+	int getWidth() const { return _width; }
+	int getHeight() const { return _height; }
+
+	/**
+	 * Return true if no area has been marked since the last clear().
+	 */
+	bool isEmpty() const { return _empty; }
+
+	/**
+	 * Mark all the tiles that overlap with the given rectangle as dirty.
+	 * The rectangle is clipped to the tracked area.
+	 */
+	void addRect(const Common::Rect &r);
+
+	/**
+	 * Mark the whole tracked area as dirty.
+	 */
+	void markAll();
+
+	/**
+	 * Mark all the tiles as clean.
+	 */
+	void clear();
+
+	/**
+	 * Replace the contents of @p rects with rectangles covering the dirty
+	 * tiles, clipped to the tracked area.
+	 *
+	 * Neighbouring tiles in a row are combined into one rectangle, which
+	 * is extended downwards for as long as the rows below have a span of
+	 * dirty tiles with the same start and end.
+	 */
+	void getRects(Common::Array<Common::Rect> &rects) const;
+
+private:
+	void setSpan(uint32 *row, uint first, uint last);
+
+	uint _tileShift;
+	int _width, _height;
+	uint _tilesWide, _tilesHigh;
+	uint _wordsPerRow;
+	bool _empty;
+	Common::Array<uint32> _bits;
+};
+
+/** @} */
+
+} // End of namespace Graphics
+
+#endif
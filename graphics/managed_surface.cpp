@@ -305,6 +305,29 @@ void ManagedSurface::blitFromInner(const Surface &src, const Common::Rect &srcRe
 		alphaMask = (((static_cast<uint32>(1) << (srcFormat.aBits() - 1)) - 1) * 2 + 1) << srcFormat.aShift;
 
 	const bool noScale = scaleX == SCALE_THRESHOLD && scaleY == SCALE_THRESHOLD;
+
+	// Paletted pixels are always opaque, so converting them is a plain
+	// lookup which crossBlitMap() can do a whole rectangle at a time
+	if (srcFormat.isCLUT8() && !destFormat.isCLUT8() && noScale) {
+		const int left = MAX<int>(destRect.left, 0);
+		const int top = MAX<int>(destRect.top, 0);
+		const int right = MIN<int>(destRect.right, w);
+		const int bottom = MIN<int>(destRect.bottom, h);
+
+		if (left < right && top < bottom) {
+			uint32 map[256];
+			convertPaletteToMap(map, srcPalette, 256, destFormat);
+
+			const byte *srcP = (const byte *)src.getBasePtr(srcRect.left + left - destRect.left,
+				srcRect.top + top - destRect.top);
+			crossBlitMap((byte *)getBasePtr(left, top), srcP, pitch, src.pitch,
+				right - left, bottom - top, destFormat.bytesPerPixel, map);
+		}
+
+		addDirtyRect(Common::Rect(0, 0, this->w, this->h));
+		return;
+	}
+
 	for (int destY = destRect.top, scaleYCtr = 0; destY < destRect.bottom; ++destY, scaleYCtr += scaleY) {
 		if (destY < 0 || destY >= h)
 			continue;
@@ -7,6 +7,7 @@ MODULE_OBJS := \
 	blit/blit-generic.o \
 	blit/blit-scale.o \
 	cursorman.o \
+	dirty_tile_map.o \
 	font.o \
 	fontman.o \
 	fonts/amigafont.o \
@@ -94,6 +95,12 @@ MODULE_OBJS += \
 	tinygl/ztriangle.o \
 	tinygl/zblit.o \
 	tinygl/zdirtyrect.o
+
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	tinygl/zspan-sse2.o
+$(MODULE)/tinygl/zspan-sse2.o: CXXFLAGS += -msse2
+endif
 endif
 
 ifdef USE_ASPECT
@@ -104,6 +111,7 @@ endif
 ifdef USE_SCALERS
 MODULE_OBJS += \
 	scaler/dotmatrix.o \
+	scaler/kernels.o \
 	scaler/sai.o \
 	scaler/pm.o \
 	scaler/scale2x.o \
@@ -134,6 +142,17 @@ MODULE_OBJS += \
 	scaler/edge.o
 endif
 
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	scaler/kernels-sse2.o
+$(MODULE)/scaler/kernels-sse2.o: CXXFLAGS += -msse2
+endif
+ifdef SCUMMVM_AVX2
+MODULE_OBJS += \
+	scaler/kernels-avx2.o
+$(MODULE)/scaler/kernels-avx2.o: CXXFLAGS += -mavx2
+endif
+
 endif
 
 ifdef ATARI
@@ -148,13 +167,17 @@ $(MODULE)/blit/blit-neon.o: CXXFLAGS += $(NEON_CXXFLAGS)
 endif
 ifdef SCUMMVM_SSE2
 MODULE_OBJS += \
-	blit/blit-sse2.o
+	blit/blit-sse2.o \
+	yuv_to_rgb-sse2.o
 $(MODULE)/blit/blit-sse2.o: CXXFLAGS += -msse2
+$(MODULE)/yuv_to_rgb-sse2.o: CXXFLAGS += -msse2
 endif
 ifdef SCUMMVM_AVX2
 MODULE_OBJS += \
-	blit/blit-avx2.o
+	blit/blit-avx2.o \
+	yuv_to_rgb-avx2.o
 $(MODULE)/blit/blit-avx2.o: CXXFLAGS += -mavx2
+$(MODULE)/yuv_to_rgb-avx2.o: CXXFLAGS += -mavx2
 endif
 
 # Include common rules
@@ -72,6 +72,7 @@ void Context::reset() {
 	textureBorderClampSupported = false;
 	textureMirrorRepeatSupported = false;
 	textureMaxLevelSupported = false;
+	pixelBufferObjectSupported = false;
 }
 
 void Context::initialize(ContextType contextType) {
@@ -175,6 +176,8 @@ void Context::initialize(ContextType contextType) {
 	bool ARBFragmentShader = false;
 	bool EXTFramebufferMultisample = false;
 	bool EXTFramebufferBlit = false;
+	bool ARBPixelBufferObject = false;
+	bool ARBMapBufferRange = false;
 
 	Common::StringTokenizer tokenizer(extString, " ");
 	while (!tokenizer.empty()) {
@@ -204,6 +207,10 @@ void Context::initialize(ContextType contextType) {
 			EXTFramebufferMultisample = true;
 		} else if (token == "GL_EXT_framebuffer_blit") {
 			EXTFramebufferBlit = true;
+		} else if (token == "GL_ARB_pixel_buffer_object") {
+			ARBPixelBufferObject = true;
+		} else if (token == "GL_ARB_map_buffer_range") {
+			ARBMapBufferRange = true;
 		} else if (token == "GL_OES_depth24") {
 			OESDepth24 = true;
 		} else if (token == "GL_SGIS_texture_edge_clamp") {
@@ -307,6 +314,12 @@ void Context::initialize(ContextType contextType) {
 		if (isGLVersionOrHigher(1, 4)) {
 			textureMirrorRepeatSupported = true;
 		}
+		// Streaming texture uploads need pixel unpack buffers (OpenGL 2.1) which
+		// can be mapped without synchronization (OpenGL 3.0). GLAD only loads the
+		// GLES 2.0 API, so this stays off with GLES contexts.
+#ifdef USE_GLAD
+		pixelBufferObjectSupported = (isGLVersionOrHigher(2, 1) || ARBPixelBufferObject) && (isGLVersionOrHigher(3, 0) || ARBMapBufferRange);
+#endif
 		debug(5, "OpenGL: GL context initialized");
 	} else {
 		warning("OpenGL: Unknown context initialized");
@@ -337,6 +350,7 @@ void Context::initialize(ContextType contextType) {
 	debug(5, "OpenGL: Texture border clamping support: %d", textureBorderClampSupported);
 	debug(5, "OpenGL: Texture mirror repeat support: %d", textureMirrorRepeatSupported);
 	debug(5, "OpenGL: Texture max level support: %d", textureMaxLevelSupported);
+	debug(5, "OpenGL: Pixel buffer object support: %d", pixelBufferObjectSupported);
 }
 
 int Context::getGLSLVersion() const {
@@ -120,6 +120,9 @@ public:
 	/** Whether texture max level is available or not. */
 	bool textureMaxLevelSupported;
 
+	/** Whether textures can be uploaded from mapped pixel buffer objects or not. */
+	bool pixelBufferObjectSupported;
+
 private:
 	/**
 	 * Returns the native GLSL version supported by the driver.
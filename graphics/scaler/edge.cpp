@@ -97,6 +97,8 @@
 #include "common/system.h"
 #include "graphics/scaler/intern.h"
 #include "graphics/scaler/edge.h"
+#include "graphics/scaler/kernels.h"
+#include "common/util.h"
 
 /* Randomly XORs one of 2x2 or 3x3 resized pixels in order to indicate
  * which pixels have been redrawn.  Useful for seeing which areas of
@@ -3235,27 +3237,16 @@ void EdgeScaler::antiAliasGrid2x(uint8 *dptr, int dstPitch,
 }
 
 
-/* Check for changed pixel grid, return 1 if unchanged. */
-template<typename Pixel>
-int checkUnchangedPixels(const Pixel *old_src_ptr, const Pixel *pixels, int w) {
-	const Pixel *dptr;
-
-	dptr = old_src_ptr - w - 1;
-	if (*dptr++ != pixels[0]) return 0;
-	if (*dptr++ != pixels[1]) return 0;
-	if (*dptr != pixels[2]) return 0;
-
-	dptr += w - 2;
-	if (*dptr != pixels[3]) return 0;
-	dptr += 2;
-	if (*dptr != pixels[5]) return 0;
-
-	dptr += w - 2;
-	if (*dptr++ != pixels[6]) return 0;
-	if (*dptr++ != pixels[7]) return 0;
-	if (*dptr != pixels[8]) return 0;
+/* The number of pixels classified by ScalerKernels at once. */
+static const int kEdgeFlagsRun = 128;
 
-	return 1;
+/* Check for solid and unchanged 3x3 blocks around a run of pixels. */
+template<typename Pixel>
+void getBlockFlags(const Pixel *src, int srcPitch, const Pixel *old_src, int oldPitch, uint8 *flags, int w) {
+	if (sizeof(Pixel) == 2)
+		ScalerKernels::edgeFlags16((const uint8 *)src, srcPitch, (const uint8 *)old_src, oldPitch, flags, w);
+	else
+		ScalerKernels::edgeFlags32((const uint8 *)src, srcPitch, (const uint8 *)old_src, oldPitch, flags, w);
 }
 
 
@@ -3328,6 +3319,7 @@ void EdgeScaler::antiAliasPass3x(const uint8 *src, uint8 *dst,
 	int sub_type;
 	int32 angle;
 	int16 *diffs;
+	uint8 blockFlags[kEdgeFlagsRun];
 	int dstPitch3 = dstPitch * 3;
 	int bufferPitch3 = bufferPitch * 3;
 
@@ -3342,6 +3334,10 @@ void EdgeScaler::antiAliasPass3x(const uint8 *src, uint8 *dst,
 			Pixel pixels[9];
 			char edge_type;
 
+			if (x % kEdgeFlagsRun == 0)
+				getBlockFlags<Pixel>(sptr16, srcPitch, haveOldSrc ? oldSptr : NULL, oldPitch, blockFlags, MIN(w - x, kEdgeFlagsRun));
+			const uint8 flags = blockFlags[x % kEdgeFlagsRun];
+
 			sptr2 = ((const Pixel *)((const uint8 *) sptr16 - srcPitch)) - 1;
 			addr3 = ((const Pixel *)((const uint8 *) sptr16 + srcPitch)) + 1;
 
@@ -3352,11 +3348,11 @@ void EdgeScaler::antiAliasPass3x(const uint8 *src, uint8 *dst,
 
 			if (haveOldSrc) {
 				/* skip interior unchanged 3x3 blocks */
-				if (*sptr16 == *oldSptr &&
+				if ((flags & ScalerKernels::kEdgeUnchanged)
 #if DEBUG_DRAW_REFRESH_BORDERS
-						x > 0 && x < w - 1 && y > 0 && y < h - 1 &&
+						&& x > 0 && x < w - 1 && y > 0 && y < h - 1
 #endif
-						checkUnchangedPixels(oldSptr, pixels, oldPitch / sizeof(Pixel))) {
+						) {
 					drawUnchangedGrid3x<Pixel>((byte *)dptr16, dstPitch, (const byte *)oldDptr, bufferPitch);
 
 #if DEBUG_REFRESH_RANDOM_XOR
@@ -3366,9 +3362,12 @@ void EdgeScaler::antiAliasPass3x(const uint8 *src, uint8 *dst,
 				}
 			}
 
-			diffs = chooseGreyscale<ColorMask>(pixels);
-
 			/* block of solid color */
+			if (flags & ScalerKernels::kEdgeSolid)
+				diffs = NULL;
+			else
+				diffs = chooseGreyscale<ColorMask>(pixels);
+
 			if (!diffs) {
 				antiAliasGridClean3x<ColorMask>((uint8 *) dptr16, dstPitch, pixels,
 				                                    0, NULL);
@@ -3413,6 +3412,7 @@ void EdgeScaler::antiAliasPass2x(const uint8 *src, uint8 *dst,
 	int sub_type;
 	int32 angle;
 	int16 *diffs;
+	uint8 blockFlags[kEdgeFlagsRun];
 	int dstPitch2 = dstPitch << 1;
 	int bufferPitch2 = bufferPitch * 2;
 
@@ -3427,6 +3427,10 @@ void EdgeScaler::antiAliasPass2x(const uint8 *src, uint8 *dst,
 			Pixel pixels[9];
 			char edge_type;
 
+			if (x % kEdgeFlagsRun == 0)
+				getBlockFlags<Pixel>(sptr16, srcPitch, haveOldSrc ? oldSptr : NULL, oldSrcPitch, blockFlags, MIN(w - x, kEdgeFlagsRun));
+			const uint8 flags = blockFlags[x % kEdgeFlagsRun];
+
 			sptr2 = ((const Pixel *)((const uint8 *) sptr16 - srcPitch)) - 1;
 			addr3 = ((const Pixel *)((const uint8 *) sptr16 + srcPitch)) + 1;
 
@@ -3437,11 +3441,11 @@ void EdgeScaler::antiAliasPass2x(const uint8 *src, uint8 *dst,
 
 			if (haveOldSrc) {
 				/* skip interior unchanged 3x3 blocks */
-				if (*sptr16 == *oldSptr &&
+				if ((flags & ScalerKernels::kEdgeUnchanged)
 #if DEBUG_DRAW_REFRESH_BORDERS
-						x > 0 && x < w - 1 && y > 0 && y < h - 1 &&
+						&& x > 0 && x < w - 1 && y > 0 && y < h - 1
 #endif
-						checkUnchangedPixels<Pixel>(oldSptr, pixels, oldSrcPitch / sizeof(Pixel))) {
+						) {
 					drawUnchangedGrid2x<Pixel>((byte *)dptr16, dstPitch, (const byte *)oldDptr, bufferPitch);
 
 #if DEBUG_REFRESH_RANDOM_XOR
@@ -3451,9 +3455,12 @@ void EdgeScaler::antiAliasPass2x(const uint8 *src, uint8 *dst,
 				}
 			}
 
-			diffs = chooseGreyscale<ColorMask>(pixels);
-
 			/* block of solid color */
+			if (flags & ScalerKernels::kEdgeSolid)
+				diffs = NULL;
+			else
+				diffs = chooseGreyscale<ColorMask>(pixels);
+
 			if (!diffs) {
 				antiAliasGrid2x<ColorMask>((uint8 *) dptr16, dstPitch, pixels,
 				                              0, NULL, NULL, 0);
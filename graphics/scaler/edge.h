@@ -30,6 +30,9 @@ public:
 	uint increaseFactor() override;
 	uint decreaseFactor() override;
 
+	// The state of the pixel being scaled is kept in members
+	bool canScaleInBands() const override { return false; }
+
 protected:
 
 	virtual void internScale(const uint8 *srcPtr, uint32 srcPitch,
@@ -21,6 +21,8 @@
 #include "graphics/scaler/hq.h"
 #include "graphics/scaler.h"
 #include "graphics/scaler/intern.h"
+#include "graphics/scaler/kernels.h"
+#include "common/util.h"
 
 // RGB-to-YUV lookup table
 
@@ -193,6 +195,28 @@ static inline uint32 ConvertYUV(uint32 x, const uint32 *RGBtoYUV) {
 	return RGBtoYUV[r | g | b];
 }
 
+/** The number of pixels whose neighbour patterns are computed at once. */
+static const int kHQPatternRun = 128;
+
+/**
+ * Compute the neighbour patterns of a run of pixels. The YUV values of the
+ * three rows are looked up once, so that the comparisons can then be done
+ * for several pixels at once by ScalerKernels.
+ */
+template<typename ColorMask>
+static void HQPatterns(const typename ColorMask::PixelType *p, uint32 nextlineSrc, int width, const uint32 *RGBtoYUV, uint8 *patterns) {
+	typedef typename ColorMask::PixelType Pixel;
+
+	uint32 yuv[3][kHQPatternRun + 2];
+	for (int row = 0; row < 3; row++) {
+		const Pixel *line = p + (row - 1) * (int)nextlineSrc;
+		for (int i = -1; i <= width; i++)
+			yuv[row][i + 1] = sizeof(Pixel) == 2 ? RGBtoYUV[line[i]] : ConvertYUV<ColorMask>(line[i], RGBtoYUV);
+	}
+
+	ScalerKernels::hqPatterns(yuv[0], yuv[1], yuv[2], patterns, width);
+}
+
 /*
  * The HQ2x high quality 2x graphics filter.
  * Original author Maxim Stepin (https://web.archive.org/web/20090204033742/http://www.hiend3d.com/hq2x.html).
@@ -206,6 +230,7 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 
 	const uint32 nextlineSrc = srcPitch / sizeof(Pixel);
 	const Pixel *p = (const Pixel *)srcPtr;
+	uint8 patterns[kHQPatternRun];
 
 	const uint32 nextlineDst = dstPitch / sizeof(Pixel);
 	Pixel *q = (Pixel *)dstPtr;
@@ -230,24 +255,19 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 		w5 = *(p);
 		w8 = *(p + nextlineSrc);
 
-		int tmpWidth = width;
-		while (tmpWidth--) {
+		for (int x = 0; x < width; x++) {
+			// Equal pixels have equal YUV values, so the patterns only
+			// depend on diffYUV()
+			if (x % kHQPatternRun == 0)
+				HQPatterns<ColorMask>(p, nextlineSrc, MIN(width - x, kHQPatternRun), RGBtoYUV, patterns);
+
 			p++;
 
 			w3 = *(p - nextlineSrc);
 			w6 = *(p);
 			w9 = *(p + nextlineSrc);
 
-			int pattern = 0;
-			const int yuv5 = YUV(5);
-			if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
-			if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
-			if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
-			if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
-			if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
-			if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
-			if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
-			if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			const int pattern = patterns[x % kHQPatternRun];
 
 			switch (pattern) {
 			case 0:
@@ -2123,6 +2143,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 
 	const uint32 nextlineSrc = srcPitch / sizeof(Pixel);
 	const Pixel *p = (const Pixel *)srcPtr;
+	uint8 patterns[kHQPatternRun];
 
 	const uint32 nextlineDst = dstPitch / sizeof(Pixel);
 	const uint32 nextlineDst2 = 2 * nextlineDst;
@@ -2148,24 +2169,19 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 		w5 = *(p);
 		w8 = *(p + nextlineSrc);
 
-		int tmpWidth = width;
-		while (tmpWidth--) {
+		for (int x = 0; x < width; x++) {
+			// Equal pixels have equal YUV values, so the patterns only
+			// depend on diffYUV()
+			if (x % kHQPatternRun == 0)
+				HQPatterns<ColorMask>(p, nextlineSrc, MIN(width - x, kHQPatternRun), RGBtoYUV, patterns);
+
 			p++;
 
 			w3 = *(p - nextlineSrc);
 			w6 = *(p);
 			w9 = *(p + nextlineSrc);
 
-			int pattern = 0;
-			const int yuv5 = YUV(5);
-			if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
-			if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
-			if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
-			if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
-			if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
-			if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
-			if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
-			if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			const int pattern = patterns[x % kHQPatternRun];
 
 			switch (pattern) {
 			case 0:
@@ -0,0 +1,281 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+#include <immintrin.h>
+
+#include "graphics/scaler/kernels.h"
+
+namespace {
+
+/** Operations on vectors of 16 or 32 bit pixels. */
+template<int PixelSize>
+struct AVX2Pixels;
+
+template<>
+struct AVX2Pixels<2> {
+	static FORCEINLINE __m256i set1(uint32 v) { return _mm256_set1_epi16((int16)v); }
+	static FORCEINLINE __m256i eq(__m256i a, __m256i b) { return _mm256_cmpeq_epi16(a, b); }
+	static FORCEINLINE __m256i gt(__m256i a, __m256i b) { return _mm256_cmpgt_epi16(a, b); }
+	static FORCEINLINE __m256i add(__m256i a, __m256i b) { return _mm256_add_epi16(a, b); }
+	static FORCEINLINE __m256i sub(__m256i a, __m256i b) { return _mm256_sub_epi16(a, b); }
+	static FORCEINLINE __m256i shr1(__m256i a) { return _mm256_srli_epi16(a, 1); }
+	static FORCEINLINE __m256i shr2(__m256i a) { return _mm256_srli_epi16(a, 2); }
+	static FORCEINLINE __m256i unpacklo(__m256i a, __m256i b) { return _mm256_unpacklo_epi16(a, b); }
+	static FORCEINLINE __m256i unpackhi(__m256i a, __m256i b) { return _mm256_unpackhi_epi16(a, b); }
+
+	/** Store the low byte of each lane. */
+	static FORCEINLINE void storeBytes(uint8 *dst, __m256i v) {
+		_mm_storeu_si128((__m128i *)dst, _mm_packus_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+	}
+};
+
+template<>
+struct AVX2Pixels<4> {
+	static FORCEINLINE __m256i set1(uint32 v) { return _mm256_set1_epi32((int32)v); }
+	static FORCEINLINE __m256i eq(__m256i a, __m256i b) { return _mm256_cmpeq_epi32(a, b); }
+	static FORCEINLINE __m256i gt(__m256i a, __m256i b) { return _mm256_cmpgt_epi32(a, b); }
+	static FORCEINLINE __m256i add(__m256i a, __m256i b) { return _mm256_add_epi32(a, b); }
+	static FORCEINLINE __m256i sub(__m256i a, __m256i b) { return _mm256_sub_epi32(a, b); }
+	static FORCEINLINE __m256i shr1(__m256i a) { return _mm256_srli_epi32(a, 1); }
+	static FORCEINLINE __m256i shr2(__m256i a) { return _mm256_srli_epi32(a, 2); }
+	static FORCEINLINE __m256i unpacklo(__m256i a, __m256i b) { return _mm256_unpacklo_epi32(a, b); }
+	static FORCEINLINE __m256i unpackhi(__m256i a, __m256i b) { return _mm256_unpackhi_epi32(a, b); }
+
+	static FORCEINLINE void storeBytes(uint8 *dst, __m256i v) {
+		__m128i words = _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+		_mm_storel_epi64((__m128i *)dst, _mm_packus_epi16(words, words));
+	}
+};
+
+static FORCEINLINE __m256i avx2_load(const void *p) {
+	return _mm256_loadu_si256((const __m256i *)p);
+}
+
+/** Return b where mask is set, and a elsewhere. */
+static FORCEINLINE __m256i avx2_select(__m256i mask, __m256i b, __m256i a) {
+	return _mm256_or_si256(_mm256_and_si256(mask, b), _mm256_andnot_si256(mask, a));
+}
+
+/** Return bit in the lanes where diffYUV() is true. */
+static FORCEINLINE __m256i avx2_diffYUV(__m256i yuv1, __m256i yuv2, __m256i threshold, int bit) {
+	// All three components are 8 bit wide, so the absolute difference
+	// exceeds the threshold if it does not saturate to zero
+	__m256i diff = _mm256_or_si256(_mm256_subs_epu8(yuv1, yuv2), _mm256_subs_epu8(yuv2, yuv1));
+	__m256i same = _mm256_cmpeq_epi32(_mm256_subs_epu8(diff, threshold), _mm256_setzero_si256());
+	return _mm256_andnot_si256(same, _mm256_set1_epi32(bit));
+}
+
+static FORCEINLINE __m256i avx2_hqPattern(const uint32 *above, const uint32 *center, const uint32 *below, __m256i threshold) {
+	const __m256i yuv5 = avx2_load(center + 1);
+
+	__m256i pattern = avx2_diffYUV(yuv5, avx2_load(above), threshold, 0x01);
+	pattern = _mm256_or_si256(pattern, avx2_diffYUV(yuv5, avx2_load(above + 1), threshold, 0x02));
+	pattern = _mm256_or_si256(pattern, avx2_diffYUV(yuv5, avx2_load(above + 2), threshold, 0x04));
+	pattern = _mm256_or_si256(pattern, avx2_diffYUV(yuv5, avx2_load(center), threshold, 0x08));
+	pattern = _mm256_or_si256(pattern, avx2_diffYUV(yuv5, avx2_load(center + 2), threshold, 0x10));
+	pattern = _mm256_or_si256(pattern, avx2_diffYUV(yuv5, avx2_load(below), threshold, 0x20));
+	pattern = _mm256_or_si256(pattern, avx2_diffYUV(yuv5, avx2_load(below + 1), threshold, 0x40));
+	pattern = _mm256_or_si256(pattern, avx2_diffYUV(yuv5, avx2_load(below + 2), threshold, 0x80));
+	return pattern;
+}
+
+/**
+ * Compute the GetResult() terms of the 2xSaI scaler for p, q, r and s as
+ * the difference of two masks, which is what GetResult() returns.
+ */
+template<typename Ops>
+static FORCEINLINE __m256i avx2_saiResult(__m256i p, __m256i q, __m256i r, __m256i s) {
+	__m256i pr = Ops::eq(p, r);
+	__m256i ps = Ops::eq(p, s);
+	__m256i x = _mm256_and_si256(pr, ps);
+	__m256i y = _mm256_andnot_si256(_mm256_or_si256(pr, ps), _mm256_and_si256(Ops::eq(q, r), Ops::eq(q, s)));
+	return Ops::sub(x, y);
+}
+
+template<typename Pixel>
+static int sai2xAVX2(const uint8 *src, uint32 srcPitch, uint8 *dst, uint32 dstPitch, int width, const ScalerKernels::SAIMasks &masks) {
+	typedef AVX2Pixels<sizeof(Pixel)> Ops;
+	const int step = 32 / sizeof(Pixel);
+
+	const __m256i lowBits = Ops::set1(masks.lowBits);
+	const __m256i highBits = Ops::set1(masks.highBits);
+	const __m256i low2Bits = Ops::set1(masks.low2Bits);
+	const __m256i notLow2Bits = Ops::set1(masks.notLow2Bits);
+	const __m256i zero = _mm256_setzero_si256();
+
+	const Pixel *row0 = (const Pixel *)(src - srcPitch);
+	const Pixel *row1 = (const Pixel *)src;
+	const Pixel *row2 = (const Pixel *)(src + srcPitch);
+	const Pixel *row3 = (const Pixel *)(src + 2 * srcPitch);
+	Pixel *dst0 = (Pixel *)dst;
+	Pixel *dst1 = (Pixel *)(dst + dstPitch);
+
+	int i;
+	for (i = 0; i + step <= width; i += step) {
+		// I|E F|J
+		// G|A B|K
+		// H|C D|L
+		// M|N O|P
+		const __m256i I = avx2_load(row0 + i - 1), E = avx2_load(row0 + i), F = avx2_load(row0 + i + 1), J = avx2_load(row0 + i + 2);
+		const __m256i G = avx2_load(row1 + i - 1), A = avx2_load(row1 + i), B = avx2_load(row1 + i + 1), K = avx2_load(row1 + i + 2);
+		const __m256i H = avx2_load(row2 + i - 1), C = avx2_load(row2 + i), D = avx2_load(row2 + i + 1), L = avx2_load(row2 + i + 2);
+		const __m256i M = avx2_load(row3 + i - 1), N = avx2_load(row3 + i), O = avx2_load(row3 + i + 1);
+
+		const __m256i AB = Ops::eq(A, B), AC = Ops::eq(A, C), AD = Ops::eq(A, D), BC = Ops::eq(B, C);
+		const __m256i AF = Ops::eq(A, F), AH = Ops::eq(A, H), AI = Ops::eq(A, I);
+		const __m256i BE = Ops::eq(B, E), BD = Ops::eq(B, D);
+		const __m256i CD = Ops::eq(C, D), CG = Ops::eq(C, G);
+
+		// The four cases of the scalar code
+		const __m256i case1 = _mm256_andnot_si256(BC, AD);
+		const __m256i case2 = _mm256_andnot_si256(AD, BC);
+		const __m256i case3 = _mm256_and_si256(AD, BC);
+		const __m256i case4 = _mm256_cmpeq_epi8(_mm256_or_si256(AD, BC), zero);
+		// When all four pixels are equal, A is copied instead of interpolated
+		// with itself, which would clear the bits outside of the masks
+		const __m256i allEqual = _mm256_and_si256(case3, AB);
+
+		// Interpolations, see interpolate32_1_1 and interpolate32_1_1_1_1
+		const __m256i interAB = Ops::add(Ops::add(Ops::shr1(_mm256_and_si256(A, highBits)), Ops::shr1(_mm256_and_si256(B, highBits))),
+		                                 _mm256_and_si256(_mm256_and_si256(A, B), lowBits));
+		const __m256i interAC = Ops::add(Ops::add(Ops::shr1(_mm256_and_si256(A, highBits)), Ops::shr1(_mm256_and_si256(C, highBits))),
+		                                 _mm256_and_si256(_mm256_and_si256(A, C), lowBits));
+		__m256i interABCD = Ops::add(Ops::add(Ops::shr2(_mm256_and_si256(A, notLow2Bits)), Ops::shr2(_mm256_and_si256(B, notLow2Bits))),
+		                             Ops::add(Ops::shr2(_mm256_and_si256(C, notLow2Bits)), Ops::shr2(_mm256_and_si256(D, notLow2Bits))));
+		const __m256i low2Sum = Ops::add(Ops::add(_mm256_and_si256(A, low2Bits), _mm256_and_si256(B, low2Bits)),
+		                                 Ops::add(_mm256_and_si256(C, low2Bits), _mm256_and_si256(D, low2Bits)));
+		interABCD = Ops::add(interABCD, _mm256_and_si256(Ops::shr2(low2Sum), low2Bits));
+
+		// product
+		const __m256i productA4 = _mm256_and_si256(_mm256_and_si256(AC, AF), _mm256_andnot_si256(BE, Ops::eq(B, J)));
+		const __m256i productB4 = _mm256_and_si256(_mm256_and_si256(BE, BD), _mm256_andnot_si256(AF, AI));
+		const __m256i productA1 = _mm256_or_si256(_mm256_and_si256(Ops::eq(A, E), Ops::eq(B, L)), productA4);
+		const __m256i productB2 = _mm256_or_si256(_mm256_and_si256(Ops::eq(B, F), AH), productB4);
+		const __m256i productSelA = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(case1, productA1), _mm256_and_si256(case4, productA4)), allEqual);
+		const __m256i productSelB = _mm256_or_si256(_mm256_and_si256(case2, productB2), _mm256_and_si256(case4, _mm256_andnot_si256(productA4, productB4)));
+		const __m256i product = avx2_select(productSelA, A, avx2_select(productSelB, B, interAB));
+
+		// product1
+		const __m256i product1A4 = _mm256_and_si256(_mm256_and_si256(AB, AH), _mm256_andnot_si256(Ops::eq(G, C), Ops::eq(C, M)));
+		const __m256i product1C4 = _mm256_and_si256(_mm256_and_si256(CG, CD), _mm256_andnot_si256(AH, AI));
+		const __m256i product1A1 = _mm256_or_si256(_mm256_and_si256(Ops::eq(A, G), Ops::eq(C, O)), product1A4);
+		const __m256i product1C2 = _mm256_or_si256(_mm256_and_si256(Ops::eq(C, H), AF), product1C4);
+		const __m256i product1SelA = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(case1, product1A1), _mm256_and_si256(case4, product1A4)), allEqual);
+		const __m256i product1SelC = _mm256_or_si256(_mm256_and_si256(case2, product1C2), _mm256_and_si256(case4, _mm256_andnot_si256(product1A4, product1C4)));
+		const __m256i product1 = avx2_select(product1SelA, A, avx2_select(product1SelC, C, interAC));
+
+		// product2
+		__m256i r = avx2_saiResult<Ops>(A, B, G, E);
+		r = Ops::sub(r, avx2_saiResult<Ops>(B, A, K, F));
+		r = Ops::sub(r, avx2_saiResult<Ops>(B, A, H, N));
+		r = Ops::add(r, avx2_saiResult<Ops>(A, B, L, O));
+		const __m256i product2SelA = _mm256_or_si256(case1, _mm256_and_si256(case3, _mm256_or_si256(AB, Ops::gt(r, zero))));
+		const __m256i product2SelB = _mm256_or_si256(case2, _mm256_and_si256(case3, _mm256_andnot_si256(AB, Ops::gt(zero, r))));
+		const __m256i product2 = avx2_select(product2SelA, A, avx2_select(product2SelB, B, interABCD));
+
+		// The unpack instructions work within 128 bit lanes, so the
+		// halves need to be put back in order
+		const __m256i lo0 = Ops::unpacklo(A, product), hi0 = Ops::unpackhi(A, product);
+		const __m256i lo1 = Ops::unpacklo(product1, product2), hi1 = Ops::unpackhi(product1, product2);
+		_mm256_storeu_si256((__m256i *)(dst0 + 2 * i), _mm256_permute2x128_si256(lo0, hi0, 0x20));
+		_mm256_storeu_si256((__m256i *)(dst0 + 2 * i + step), _mm256_permute2x128_si256(lo0, hi0, 0x31));
+		_mm256_storeu_si256((__m256i *)(dst1 + 2 * i), _mm256_permute2x128_si256(lo1, hi1, 0x20));
+		_mm256_storeu_si256((__m256i *)(dst1 + 2 * i + step), _mm256_permute2x128_si256(lo1, hi1, 0x31));
+	}
+
+	return i;
+}
+
+template<typename Pixel>
+static int edgeFlagsAVX2(const uint8 *src, uint32 srcPitch, const uint8 *oldSrc, uint32 oldPitch, uint8 *flags, int width) {
+	typedef AVX2Pixels<sizeof(Pixel)> Ops;
+	const int step = 32 / sizeof(Pixel);
+
+	const Pixel *rows[3] = {
+		(const Pixel *)(src - srcPitch),
+		(const Pixel *)src,
+		(const Pixel *)(src + srcPitch)
+	};
+	const Pixel *oldRows[3] = { nullptr, nullptr, nullptr };
+	if (oldSrc) {
+		oldRows[0] = (const Pixel *)(oldSrc - oldPitch);
+		oldRows[1] = (const Pixel *)oldSrc;
+		oldRows[2] = (const Pixel *)(oldSrc + oldPitch);
+	}
+
+	const __m256i solidFlag = Ops::set1(ScalerKernels::kEdgeSolid);
+	const __m256i unchangedFlag = Ops::set1(ScalerKernels::kEdgeUnchanged);
+
+	int i;
+	for (i = 0; i + step <= width; i += step) {
+		const __m256i center = avx2_load(rows[1] + i);
+		__m256i solid = _mm256_set1_epi32(-1);
+		__m256i unchanged = oldSrc ? _mm256_set1_epi32(-1) : _mm256_setzero_si256();
+
+		for (int r = 0; r < 3; r++) {
+			for (int x = -1; x <= 1; x++) {
+				const __m256i pixel = avx2_load(rows[r] + i + x);
+				solid = _mm256_and_si256(solid, Ops::eq(pixel, center));
+				if (oldSrc)
+					unchanged = _mm256_and_si256(unchanged, Ops::eq(pixel, avx2_load(oldRows[r] + i + x)));
+			}
+		}
+
+		Ops::storeBytes(flags + i, _mm256_or_si256(_mm256_and_si256(solid, solidFlag), _mm256_and_si256(unchanged, unchangedFlag)));
+	}
+
+	return i;
+}
+
+} // End of anonymous namespace
+
+void ScalerKernels::hqPatternsAVX2(const uint32 *above, const uint32 *center, const uint32 *below, uint8 *patterns, int width) {
+	// Y, U and V are allowed to differ by 0x30, 7 and 6
+	const __m256i threshold = _mm256_set1_epi32(0x00300706);
+
+	int i;
+	for (i = 0; i + 8 <= width; i += 8) {
+		__m256i p = avx2_hqPattern(above + i, center + i, below + i, threshold);
+		__m128i words = _mm_packs_epi32(_mm256_castsi256_si128(p), _mm256_extracti128_si256(p, 1));
+		_mm_storel_epi64((__m128i *)(patterns + i), _mm_packus_epi16(words, words));
+	}
+
+	hqPatternsGeneric(above + i, center + i, below + i, patterns + i, width - i);
+}
+
+int ScalerKernels::sai2x16AVX2(const uint8 *src, uint32 srcPitch, uint8 *dst, uint32 dstPitch, int width, const SAIMasks &masks) {
+	return sai2xAVX2<uint16>(src, srcPitch, dst, dstPitch, width, masks);
+}
+
+int ScalerKernels::sai2x32AVX2(const uint8 *src, uint32 srcPitch, uint8 *dst, uint32 dstPitch, int width, const SAIMasks &masks) {
+	return sai2xAVX2<uint32>(src, srcPitch, dst, dstPitch, width, masks);
+}
+
+void ScalerKernels::edgeFlags16AVX2(const uint8 *src, uint32 srcPitch, const uint8 *oldSrc, uint32 oldPitch, uint8 *flags, int width) {
+	int i = edgeFlagsAVX2<uint16>(src, srcPitch, oldSrc, oldPitch, flags, width);
+	edgeFlags16Generic(src + i * 2, srcPitch, oldSrc ? oldSrc + i * 2 : nullptr, oldPitch, flags + i, width - i);
+}
+
+void ScalerKernels::edgeFlags32AVX2(const uint8 *src, uint32 srcPitch, const uint8 *oldSrc, uint32 oldPitch, uint8 *flags, int width) {
+	int i = edgeFlagsAVX2<uint32>(src, srcPitch, oldSrc, oldPitch, flags, width);
+	edgeFlags32Generic(src + i * 4, srcPitch, oldSrc ? oldSrc + i * 4 : nullptr, oldPitch, flags + i, width - i);
+}
@@ -0,0 +1,279 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+#include <immintrin.h>
+
+#include "graphics/scaler/kernels.h"
+
+namespace {
+
+/** Operations on vectors of 16 or 32 bit pixels. */
+template<int PixelSize>
+struct SSE2Pixels;
+
+template<>
+struct SSE2Pixels<2> {
+	static FORCEINLINE __m128i set1(uint32 v) { return _mm_set1_epi16((int16)v); }
+	static FORCEINLINE __m128i eq(__m128i a, __m128i b) { return _mm_cmpeq_epi16(a, b); }
+	static FORCEINLINE __m128i gt(__m128i a, __m128i b) { return _mm_cmpgt_epi16(a, b); }
+	static FORCEINLINE __m128i add(__m128i a, __m128i b) { return _mm_add_epi16(a, b); }
+	static FORCEINLINE __m128i sub(__m128i a, __m128i b) { return _mm_sub_epi16(a, b); }
+	static FORCEINLINE __m128i shr1(__m128i a) { return _mm_srli_epi16(a, 1); }
+	static FORCEINLINE __m128i shr2(__m128i a) { return _mm_srli_epi16(a, 2); }
+	static FORCEINLINE __m128i unpacklo(__m128i a, __m128i b) { return _mm_unpacklo_epi16(a, b); }
+	static FORCEINLINE __m128i unpackhi(__m128i a, __m128i b) { return _mm_unpackhi_epi16(a, b); }
+
+	/** Store the low byte of each lane. */
+	static FORCEINLINE void storeBytes(uint8 *dst, __m128i v) {
+		_mm_storel_epi64((__m128i *)dst, _mm_packus_epi16(v, v));
+	}
+};
+
+template<>
+struct SSE2Pixels<4> {
+	static FORCEINLINE __m128i set1(uint32 v) { return _mm_set1_epi32((int32)v); }
+	static FORCEINLINE __m128i eq(__m128i a, __m128i b) { return _mm_cmpeq_epi32(a, b); }
+	static FORCEINLINE __m128i gt(__m128i a, __m128i b) { return _mm_cmpgt_epi32(a, b); }
+	static FORCEINLINE __m128i add(__m128i a, __m128i b) { return _mm_add_epi32(a, b); }
+	static FORCEINLINE __m128i sub(__m128i a, __m128i b) { return _mm_sub_epi32(a, b); }
+	static FORCEINLINE __m128i shr1(__m128i a) { return _mm_srli_epi32(a, 1); }
+	static FORCEINLINE __m128i shr2(__m128i a) { return _mm_srli_epi32(a, 2); }
+	static FORCEINLINE __m128i unpacklo(__m128i a, __m128i b) { return _mm_unpacklo_epi32(a, b); }
+	static FORCEINLINE __m128i unpackhi(__m128i a, __m128i b) { return _mm_unpackhi_epi32(a, b); }
+
+	static FORCEINLINE void storeBytes(uint8 *dst, __m128i v) {
+		v = _mm_packs_epi32(v, v);
+		int32 bytes = _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+		memcpy(dst, &bytes, sizeof(bytes));
+	}
+};
+
+static FORCEINLINE __m128i sse2_load(const void *p) {
+	return _mm_loadu_si128((const __m128i *)p);
+}
+
+/** Return b where mask is set, and a elsewhere. */
+static FORCEINLINE __m128i sse2_select(__m128i mask, __m128i b, __m128i a) {
+	return _mm_or_si128(_mm_and_si128(mask, b), _mm_andnot_si128(mask, a));
+}
+
+/** Return bit in the lanes where diffYUV() is true. */
+static FORCEINLINE __m128i sse2_diffYUV(__m128i yuv1, __m128i yuv2, __m128i threshold, int bit) {
+	// All three components are 8 bit wide, so the absolute difference
+	// exceeds the threshold if it does not saturate to zero
+	__m128i diff = _mm_or_si128(_mm_subs_epu8(yuv1, yuv2), _mm_subs_epu8(yuv2, yuv1));
+	__m128i same = _mm_cmpeq_epi32(_mm_subs_epu8(diff, threshold), _mm_setzero_si128());
+	return _mm_andnot_si128(same, _mm_set1_epi32(bit));
+}
+
+static FORCEINLINE __m128i sse2_hqPattern(const uint32 *above, const uint32 *center, const uint32 *below, __m128i threshold) {
+	const __m128i yuv5 = sse2_load(center + 1);
+
+	__m128i pattern = sse2_diffYUV(yuv5, sse2_load(above), threshold, 0x01);
+	pattern = _mm_or_si128(pattern, sse2_diffYUV(yuv5, sse2_load(above + 1), threshold, 0x02));
+	pattern = _mm_or_si128(pattern, sse2_diffYUV(yuv5, sse2_load(above + 2), threshold, 0x04));
+	pattern = _mm_or_si128(pattern, sse2_diffYUV(yuv5, sse2_load(center), threshold, 0x08));
+	pattern = _mm_or_si128(pattern, sse2_diffYUV(yuv5, sse2_load(center + 2), threshold, 0x10));
+	pattern = _mm_or_si128(pattern, sse2_diffYUV(yuv5, sse2_load(below), threshold, 0x20));
+	pattern = _mm_or_si128(pattern, sse2_diffYUV(yuv5, sse2_load(below + 1), threshold, 0x40));
+	pattern = _mm_or_si128(pattern, sse2_diffYUV(yuv5, sse2_load(below + 2), threshold, 0x80));
+	return pattern;
+}
+
+/**
+ * Compute the GetResult() terms of the 2xSaI scaler for p, q, r and s as
+ * the difference of two masks, which is what GetResult() returns.
+ */
+template<typename Ops>
+static FORCEINLINE __m128i sse2_saiResult(__m128i p, __m128i q, __m128i r, __m128i s) {
+	__m128i pr = Ops::eq(p, r);
+	__m128i ps = Ops::eq(p, s);
+	__m128i x = _mm_and_si128(pr, ps);
+	__m128i y = _mm_andnot_si128(_mm_or_si128(pr, ps), _mm_and_si128(Ops::eq(q, r), Ops::eq(q, s)));
+	return Ops::sub(x, y);
+}
+
+template<typename Pixel>
+static int sai2xSSE2(const uint8 *src, uint32 srcPitch, uint8 *dst, uint32 dstPitch, int width, const ScalerKernels::SAIMasks &masks) {
+	typedef SSE2Pixels<sizeof(Pixel)> Ops;
+	const int step = 16 / sizeof(Pixel);
+
+	const __m128i lowBits = Ops::set1(masks.lowBits);
+	const __m128i highBits = Ops::set1(masks.highBits);
+	const __m128i low2Bits = Ops::set1(masks.low2Bits);
+	const __m128i notLow2Bits = Ops::set1(masks.notLow2Bits);
+	const __m128i zero = _mm_setzero_si128();
+
+	const Pixel *row0 = (const Pixel *)(src - srcPitch);
+	const Pixel *row1 = (const Pixel *)src;
+	const Pixel *row2 = (const Pixel *)(src + srcPitch);
+	const Pixel *row3 = (const Pixel *)(src + 2 * srcPitch);
+	Pixel *dst0 = (Pixel *)dst;
+	Pixel *dst1 = (Pixel *)(dst + dstPitch);
+
+	int i;
+	for (i = 0; i + step <= width; i += step) {
+		// I|E F|J
+		// G|A B|K
+		// H|C D|L
+		// M|N O|P
+		const __m128i I = sse2_load(row0 + i - 1), E = sse2_load(row0 + i), F = sse2_load(row0 + i + 1), J = sse2_load(row0 + i + 2);
+		const __m128i G = sse2_load(row1 + i - 1), A = sse2_load(row1 + i), B = sse2_load(row1 + i + 1), K = sse2_load(row1 + i + 2);
+		const __m128i H = sse2_load(row2 + i - 1), C = sse2_load(row2 + i), D = sse2_load(row2 + i + 1), L = sse2_load(row2 + i + 2);
+		const __m128i M = sse2_load(row3 + i - 1), N = sse2_load(row3 + i), O = sse2_load(row3 + i + 1);
+
+		const __m128i AB = Ops::eq(A, B), AC = Ops::eq(A, C), AD = Ops::eq(A, D), BC = Ops::eq(B, C);
+		const __m128i AF = Ops::eq(A, F), AH = Ops::eq(A, H), AI = Ops::eq(A, I);
+		const __m128i BE = Ops::eq(B, E), BD = Ops::eq(B, D);
+		const __m128i CD = Ops::eq(C, D), CG = Ops::eq(C, G);
+
+		// The four cases of the scalar code
+		const __m128i case1 = _mm_andnot_si128(BC, AD);
+		const __m128i case2 = _mm_andnot_si128(AD, BC);
+		const __m128i case3 = _mm_and_si128(AD, BC);
+		const __m128i case4 = _mm_cmpeq_epi8(_mm_or_si128(AD, BC), zero);
+		// When all four pixels are equal, A is copied instead of interpolated
+		// with itself, which would clear the bits outside of the masks
+		const __m128i allEqual = _mm_and_si128(case3, AB);
+
+		// Interpolations, see interpolate32_1_1 and interpolate32_1_1_1_1
+		const __m128i interAB = Ops::add(Ops::add(Ops::shr1(_mm_and_si128(A, highBits)), Ops::shr1(_mm_and_si128(B, highBits))),
+		                                 _mm_and_si128(_mm_and_si128(A, B), lowBits));
+		const __m128i interAC = Ops::add(Ops::add(Ops::shr1(_mm_and_si128(A, highBits)), Ops::shr1(_mm_and_si128(C, highBits))),
+		                                 _mm_and_si128(_mm_and_si128(A, C), lowBits));
+		__m128i interABCD = Ops::add(Ops::add(Ops::shr2(_mm_and_si128(A, notLow2Bits)), Ops::shr2(_mm_and_si128(B, notLow2Bits))),
+		                             Ops::add(Ops::shr2(_mm_and_si128(C, notLow2Bits)), Ops::shr2(_mm_and_si128(D, notLow2Bits))));
+		const __m128i low2Sum = Ops::add(Ops::add(_mm_and_si128(A, low2Bits), _mm_and_si128(B, low2Bits)),
+		                                 Ops::add(_mm_and_si128(C, low2Bits), _mm_and_si128(D, low2Bits)));
+		interABCD = Ops::add(interABCD, _mm_and_si128(Ops::shr2(low2Sum), low2Bits));
+
+		// product
+		const __m128i productA4 = _mm_and_si128(_mm_and_si128(AC, AF), _mm_andnot_si128(BE, Ops::eq(B, J)));
+		const __m128i productB4 = _mm_and_si128(_mm_and_si128(BE, BD), _mm_andnot_si128(AF, AI));
+		const __m128i productA1 = _mm_or_si128(_mm_and_si128(Ops::eq(A, E), Ops::eq(B, L)), productA4);
+		const __m128i productB2 = _mm_or_si128(_mm_and_si128(Ops::eq(B, F), AH), productB4);
+		const __m128i productSelA = _mm_or_si128(_mm_or_si128(_mm_and_si128(case1, productA1), _mm_and_si128(case4, productA4)), allEqual);
+		const __m128i productSelB = _mm_or_si128(_mm_and_si128(case2, productB2), _mm_and_si128(case4, _mm_andnot_si128(productA4, productB4)));
+		const __m128i product = sse2_select(productSelA, A, sse2_select(productSelB, B, interAB));
+
+		// product1
+		const __m128i product1A4 = _mm_and_si128(_mm_and_si128(AB, AH), _mm_andnot_si128(Ops::eq(G, C), Ops::eq(C, M)));
+		const __m128i product1C4 = _mm_and_si128(_mm_and_si128(CG, CD), _mm_andnot_si128(AH, AI));
+		const __m128i product1A1 = _mm_or_si128(_mm_and_si128(Ops::eq(A, G), Ops::eq(C, O)), product1A4);
+		const __m128i product1C2 = _mm_or_si128(_mm_and_si128(Ops::eq(C, H), AF), product1C4);
+		const __m128i product1SelA = _mm_or_si128(_mm_or_si128(_mm_and_si128(case1, product1A1), _mm_and_si128(case4, product1A4)), allEqual);
+		const __m128i product1SelC = _mm_or_si128(_mm_and_si128(case2, product1C2), _mm_and_si128(case4, _mm_andnot_si128(product1A4, product1C4)));
+		const __m128i product1 = sse2_select(product1SelA, A, sse2_select(product1SelC, C, interAC));
+
+		// product2
+		__m128i r = sse2_saiResult<Ops>(A, B, G, E);
+		r = Ops::sub(r, sse2_saiResult<Ops>(B, A, K, F));
+		r = Ops::sub(r, sse2_saiResult<Ops>(B, A, H, N));
+		r = Ops::add(r, sse2_saiResult<Ops>(A, B, L, O));
+		const __m128i product2SelA = _mm_or_si128(case1, _mm_and_si128(case3, _mm_or_si128(AB, Ops::gt(r, zero))));
+		const __m128i product2SelB = _mm_or_si128(case2, _mm_and_si128(case3, _mm_andnot_si128(AB, Ops::gt(zero, r))));
+		const __m128i product2 = sse2_select(product2SelA, A, sse2_select(product2SelB, B, interABCD));
+
+		_mm_storeu_si128((__m128i *)(dst0 + 2 * i), Ops::unpacklo(A, product));
+		_mm_storeu_si128((__m128i *)(dst0 + 2 * i + step), Ops::unpackhi(A, product));
+		_mm_storeu_si128((__m128i *)(dst1 + 2 * i), Ops::unpacklo(product1, product2));
+		_mm_storeu_si128((__m128i *)(dst1 + 2 * i + step), Ops::unpackhi(product1, product2));
+	}
+
+	return i;
+}
+
+template<typename Pixel>
+static int edgeFlagsSSE2(const uint8 *src, uint32 srcPitch, const uint8 *oldSrc, uint32 oldPitch, uint8 *flags, int width) {
+	typedef SSE2Pixels<sizeof(Pixel)> Ops;
+	const int step = 16 / sizeof(Pixel);
+
+	const Pixel *rows[3] = {
+		(const Pixel *)(src - srcPitch),
+		(const Pixel *)src,
+		(const Pixel *)(src + srcPitch)
+	};
+	const Pixel *oldRows[3] = { nullptr, nullptr, nullptr };
+	if (oldSrc) {
+		oldRows[0] = (const Pixel *)(oldSrc - oldPitch);
+		oldRows[1] = (const Pixel *)oldSrc;
+		oldRows[2] = (const Pixel *)(oldSrc + oldPitch);
+	}
+
+	const __m128i solidFlag = Ops::set1(ScalerKernels::kEdgeSolid);
+	const __m128i unchangedFlag = Ops::set1(ScalerKernels::kEdgeUnchanged);
+
+	int i;
+	for (i = 0; i + step <= width; i += step) {
+		const __m128i center = sse2_load(rows[1] + i);
+		__m128i solid = _mm_set1_epi32(-1);
+		__m128i unchanged = oldSrc ? _mm_set1_epi32(-1) : _mm_setzero_si128();
+
+		for (int r = 0; r < 3; r++) {
+			for (int x = -1; x <= 1; x++) {
+				const __m128i pixel = sse2_load(rows[r] + i + x);
+				solid = _mm_and_si128(solid, Ops::eq(pixel, center));
+				if (oldSrc)
+					unchanged = _mm_and_si128(unchanged, Ops::eq(pixel, sse2_load(oldRows[r] + i + x)));
+			}
+		}
+
+		Ops::storeBytes(flags + i, _mm_or_si128(_mm_and_si128(solid, solidFlag), _mm_and_si128(unchanged, unchangedFlag)));
+	}
+
+	return i;
+}
+
+} // End of anonymous namespace
+
+void ScalerKernels::hqPatternsSSE2(const uint32 *above, const uint32 *center, const uint32 *below, uint8 *patterns, int width) {
+	// Y, U and V are allowed to differ by 0x30, 7 and 6
+	const __m128i threshold = _mm_set1_epi32(0x00300706);
+
+	int i;
+	for (i = 0; i + 8 <= width; i += 8) {
+		__m128i p0 = sse2_hqPattern(above + i, center + i, below + i, threshold);
+		__m128i p1 = sse2_hqPattern(above + i + 4, center + i + 4, below + i + 4, threshold);
+		__m128i p = _mm_packs_epi32(p0, p1);
+		_mm_storel_epi64((__m128i *)(patterns + i), _mm_packus_epi16(p, p));
+	}
+
+	hqPatternsGeneric(above + i, center + i, below + i, patterns + i, width - i);
+}
+
+int ScalerKernels::sai2x16SSE2(const uint8 *src, uint32 srcPitch, uint8 *dst, uint32 dstPitch, int width, const SAIMasks &masks) {
+	return sai2xSSE2<uint16>(src, srcPitch, dst, dstPitch, width, masks);
+}
+
+int ScalerKernels::sai2x32SSE2(const uint8 *src, uint32 srcPitch, uint8 *dst, uint32 dstPitch, int width, const SAIMasks &masks) {
+	return sai2xSSE2<uint32>(src, srcPitch, dst, dstPitch, width, masks);
+}
+
+void ScalerKernels::edgeFlags16SSE2(const uint8 *src, uint32 srcPitch, const uint8 *oldSrc, uint32 oldPitch, uint8 *flags, int width) {
+	int i = edgeFlagsSSE2<uint16>(src, srcPitch, oldSrc, oldPitch, flags, width);
+	edgeFlags16Generic(src + i * 2, srcPitch, oldSrc ? oldSrc + i * 2 : nullptr, oldPitch, flags + i, width - i);
+}
+
+void ScalerKernels::edgeFlags32SSE2(const uint8 *src, uint32 srcPitch, const uint8 *oldSrc, uint32 oldPitch, uint8 *flags, int width) {
+	int i = edgeFlagsSSE2<uint32>(src, srcPitch, oldSrc, oldPitch, flags, width);
+	edgeFlags32Generic(src + i * 4, srcPitch, oldSrc ? oldSrc + i * 4 : nullptr, oldPitch, flags + i, width - i);
+}
@@ -0,0 +1,154 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "graphics/scaler/kernels.h"
+#include "graphics/scaler/intern.h"
+#include "common/system.h"
+
+// Initialize these to nullptr, the first use selects the implementation
+ScalerKernels::HQPatternsFunc ScalerKernels::hqPatternsFunc = nullptr;
+ScalerKernels::SAI2xFunc ScalerKernels::sai2x16Func = nullptr;
+ScalerKernels::SAI2xFunc ScalerKernels::sai2x32Func = nullptr;
+ScalerKernels::EdgeFlagsFunc ScalerKernels::edgeFlags16Func = nullptr;
+ScalerKernels::EdgeFlagsFunc ScalerKernels::edgeFlags32Func = nullptr;
+
+template<typename Pixel>
+static void edgeFlagsGeneric(const uint8 *src, uint32 srcPitch, const uint8 *oldSrc, uint32 oldPitch, uint8 *flags, int width) {
+	const Pixel *rows[3] = {
+		(const Pixel *)(src - srcPitch),
+		(const Pixel *)src,
+		(const Pixel *)(src + srcPitch)
+	};
+	const Pixel *oldRows[3] = { nullptr, nullptr, nullptr };
+	if (oldSrc) {
+		oldRows[0] = (const Pixel *)(oldSrc - oldPitch);
+		oldRows[1] = (const Pixel *)oldSrc;
+		oldRows[2] = (const Pixel *)(oldSrc + oldPitch);
+	}
+
+	for (int i = 0; i < width; i++) {
+		const Pixel center = rows[1][i];
+		bool solid = true;
+		bool unchanged = oldSrc != nullptr;
+
+		for (int r = 0; r < 3; r++) {
+			for (int x = i - 1; x <= i + 1; x++) {
+				solid = solid && rows[r][x] == center;
+				unchanged = unchanged && rows[r][x] == oldRows[r][x];
+			}
+		}
+
+		flags[i] = (solid ? ScalerKernels::kEdgeSolid : 0) | (unchanged ? ScalerKernels::kEdgeUnchanged : 0);
+	}
+}
+
+void ScalerKernels::selectFuncs() {
+	hqPatternsFunc = hqPatternsGeneric;
+	sai2x16Func = sai2xGeneric;
+	sai2x32Func = sai2xGeneric;
+	edgeFlags16Func = edgeFlags16Generic;
+	edgeFlags32Func = edgeFlags32Generic;
+
+#ifdef SCUMMVM_SSE2
+	if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) {
+		hqPatternsFunc = hqPatternsSSE2;
+		sai2x16Func = sai2x16SSE2;
+		sai2x32Func = sai2x32SSE2;
+		edgeFlags16Func = edgeFlags16SSE2;
+		edgeFlags32Func = edgeFlags32SSE2;
+	}
+#endif
+#ifdef SCUMMVM_AVX2
+	if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) {
+		hqPatternsFunc = hqPatternsAVX2;
+		sai2x16Func = sai2x16AVX2;
+		sai2x32Func = sai2x32AVX2;
+		edgeFlags16Func = edgeFlags16AVX2;
+		edgeFlags32Func = edgeFlags32AVX2;
+	}
+#endif
+}
+
+void ScalerKernels::hqPatterns(const uint32 *above, const uint32 *center, const uint32 *below, uint8 *patterns, int width) {
+	if (!hqPatternsFunc)
+		selectFuncs();
+
+	hqPatternsFunc(above, center, below, patterns, width);
+}
+
+int ScalerKernels::sai2x16(const uint8 *src, uint32 srcPitch, uint8 *dst, uint32 dstPitch, int width, const SAIMasks &masks) {
+	if (!sai2x16Func)
+		selectFuncs();
+
+	return sai2x16Func(src, srcPitch, dst, dstPitch, width, masks);
+}
+
+int ScalerKernels::sai2x32(const uint8 *src, uint32 srcPitch, uint8 *dst, uint32 dstPitch, int width, const SAIMasks &masks) {
+	if (!sai2x32Func)
+		selectFuncs();
+
+	return sai2x32Func(src, srcPitch, dst, dstPitch, width, masks);
+}
+
+void ScalerKernels::edgeFlags16(const uint8 *src, uint32 srcPitch, const uint8 *oldSrc, uint32 oldPitch, uint8 *flags, int width) {
+	if (!edgeFlags16Func)
+		selectFuncs();
+
+	edgeFlags16Func(src, srcPitch, oldSrc, oldPitch, flags, width);
+}
+
+void ScalerKernels::edgeFlags32(const uint8 *src, uint32 srcPitch, const uint8 *oldSrc, uint32 oldPitch, uint8 *flags, int width) {
+	if (!edgeFlags32Func)
+		selectFuncs();
+
+	edgeFlags32Func(src, srcPitch, oldSrc, oldPitch, flags, width);
+}
+
+void ScalerKernels::hqPatternsGeneric(const uint32 *above, const uint32 *center, const uint32 *below, uint8 *patterns, int width) {
+	for (int i = 0; i < width; i++) {
+		const int yuv5 = center[i + 1];
+		int pattern = 0;
+
+		if (diffYUV(yuv5, above[i]))      pattern |= 0x0001;
+		if (diffYUV(yuv5, above[i + 1]))  pattern |= 0x0002;
+		if (diffYUV(yuv5, above[i + 2]))  pattern |= 0x0004;
+		if (diffYUV(yuv5, center[i]))     pattern |= 0x0008;
+		if (diffYUV(yuv5, center[i + 2])) pattern |= 0x0010;
+		if (diffYUV(yuv5, below[i]))      pattern |= 0x0020;
+		if (diffYUV(yuv5, below[i + 1]))  pattern |= 0x0040;
+		if (diffYUV(yuv5, below[i + 2]))  pattern |= 0x0080;
+
+		patterns[i] = pattern;
+	}
+}
+
+int ScalerKernels::sai2xGeneric(const uint8 *src, uint32 srcPitch, uint8 *dst, uint32 dstPitch, int width, const SAIMasks &masks) {
+	// The scaler's own C++ code handles the whole row
+	return 0;
+}
+
+void ScalerKernels::edgeFlags16Generic(const uint8 *src, uint32 srcPitch, const uint8 *oldSrc, uint32 oldPitch, uint8 *flags, int width) {
+	edgeFlagsGeneric<uint16>(src, srcPitch, oldSrc, oldPitch, flags, width);
+}
+
+void ScalerKernels::edgeFlags32Generic(const uint8 *src, uint32 srcPitch, const uint8 *oldSrc, uint32 oldPitch, uint8 *flags, int width) {
+	edgeFlagsGeneric<uint32>(src, srcPitch, oldSrc, oldPitch, flags, width);
+}
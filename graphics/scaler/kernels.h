@@ -0,0 +1,132 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_SCALER_KERNELS_H
+#define GRAPHICS_SCALER_KERNELS_H
+
+#include "common/scummsys.h"
+
+class ScalerKernelsTestSuite;
+
+/**
+ * Per-row building blocks shared by the HQ, 2xSaI and Edge scalers.
+ *
+ * The scalers keep their scalar C++ code for the parts that do not map well
+ * to vector instructions, and use these kernels for the parts that do. The
+ * functions dispatch at runtime to SSE2 or AVX2 versions when the CPU
+ * supports them, in the same way as Graphics::BlendBlit does. All versions
+ * give the same results as the generic C++ code.
+ */
+class ScalerKernels {
+public:
+	/**
+	 * Masks describing the pixel format for the 2xSaI interpolations.
+	 * For 16 bit pixels, the masks must not have any bits above bit 15 set.
+	 */
+	struct SAIMasks {
+		uint32 lowBits;     ///< Lowest bit of each channel
+		uint32 highBits;    ///< Bits of each channel except for the lowest one
+		uint32 low2Bits;    ///< Lowest two bits of each channel
+		uint32 notLow2Bits; ///< Complement of low2Bits
+	};
+
+	/** Flags returned by edgeFlags(). */
+	enum {
+		kEdgeSolid     = 1 << 0, ///< The 3x3 block around the pixel has a single color
+		kEdgeUnchanged = 1 << 1  ///< The 3x3 block around the pixel is the same as in the old source
+	};
+
+	/**
+	 * Compute the HQ neighbour patterns of a run of pixels.
+	 *
+	 * Bit n of each pattern is set when the YUV value of the n-th neighbour
+	 * differs from the center, as decided by diffYUV(). The neighbours are
+	 * numbered from the top left, row by row, skipping the center.
+	 *
+	 * @param above     YUV values of the row above, starting one pixel left of the run.
+	 * @param center    YUV values of the row itself, starting one pixel left of the run.
+	 * @param below     YUV values of the row below, starting one pixel left of the run.
+	 * @param patterns  Receives @p width patterns.
+	 * @param width     Number of pixels in the run.
+	 */
+	static void hqPatterns(const uint32 *above, const uint32 *center, const uint32 *below, uint8 *patterns, int width);
+
+	/**
+	 * Scale a run of pixels of a row with 2xSaI.
+	 *
+	 * The vector versions process as many pixels as they can in full
+	 * vectors and leave the rest to the caller.
+	 *
+	 * @return The number of pixels which have been scaled.
+	 */
+	static int sai2x16(const uint8 *src, uint32 srcPitch, uint8 *dst, uint32 dstPitch, int width, const SAIMasks &masks);
+	static int sai2x32(const uint8 *src, uint32 srcPitch, uint8 *dst, uint32 dstPitch, int width, const SAIMasks &masks);
+
+	/**
+	 * Classify the 3x3 blocks around a run of pixels for the Edge scaler.
+	 *
+	 * @param src       The first pixel of the run.
+	 * @param srcPitch  The number of bytes in a scanline of the source.
+	 * @param oldSrc    The same pixel in the old source, or nullptr to skip
+	 *                  the comparison with it.
+	 * @param oldPitch  The number of bytes in a scanline of the old source.
+	 * @param flags     Receives a combination of kEdgeSolid and kEdgeUnchanged
+	 *                  for each pixel.
+	 * @param width     Number of pixels in the run.
+	 */
+	static void edgeFlags16(const uint8 *src, uint32 srcPitch, const uint8 *oldSrc, uint32 oldPitch, uint8 *flags, int width);
+	static void edgeFlags32(const uint8 *src, uint32 srcPitch, const uint8 *oldSrc, uint32 oldPitch, uint8 *flags, int width);
+
+private:
+	static void hqPatternsGeneric(const uint32 *above, const uint32 *center, const uint32 *below, uint8 *patterns, int width);
+	static int sai2xGeneric(const uint8 *src, uint32 srcPitch, uint8 *dst, uint32 dstPitch, int width, const SAIMasks &masks);
+	static void edgeFlags16Generic(const uint8 *src, uint32 srcPitch, const uint8 *oldSrc, uint32 oldPitch, uint8 *flags, int width);
+	static void edgeFlags32Generic(const uint8 *src, uint32 srcPitch, const uint8 *oldSrc, uint32 oldPitch, uint8 *flags, int width);
+#ifdef SCUMMVM_SSE2
+	static void hqPatternsSSE2(const uint32 *above, const uint32 *center, const uint32 *below, uint8 *patterns, int width);
+	static int sai2x16SSE2(const uint8 *src, uint32 srcPitch, uint8 *dst, uint32 dstPitch, int width, const SAIMasks &masks);
+	static int sai2x32SSE2(const uint8 *src, uint32 srcPitch, uint8 *dst, uint32 dstPitch, int width, const SAIMasks &masks);
+	static void edgeFlags16SSE2(const uint8 *src, uint32 srcPitch, const uint8 *oldSrc, uint32 oldPitch, uint8 *flags, int width);
+	static void edgeFlags32SSE2(const uint8 *src, uint32 srcPitch, const uint8 *oldSrc, uint32 oldPitch, uint8 *flags, int width);
+#endif
+#ifdef SCUMMVM_AVX2
+	static void hqPatternsAVX2(const uint32 *above, const uint32 *center, const uint32 *below, uint8 *patterns, int width);
+	static int sai2x16AVX2(const uint8 *src, uint32 srcPitch, uint8 *dst, uint32 dstPitch, int width, const SAIMasks &masks);
+	static int sai2x32AVX2(const uint8 *src, uint32 srcPitch, uint8 *dst, uint32 dstPitch, int width, const SAIMasks &masks);
+	static void edgeFlags16AVX2(const uint8 *src, uint32 srcPitch, const uint8 *oldSrc, uint32 oldPitch, uint8 *flags, int width);
+	static void edgeFlags32AVX2(const uint8 *src, uint32 srcPitch, const uint8 *oldSrc, uint32 oldPitch, uint8 *flags, int width);
+#endif
+
+	static void selectFuncs();
+
+	typedef void(*HQPatternsFunc)(const uint32 *, const uint32 *, const uint32 *, uint8 *, int);
+	typedef int(*SAI2xFunc)(const uint8 *, uint32, uint8 *, uint32, int, const SAIMasks &);
+	typedef void(*EdgeFlagsFunc)(const uint8 *, uint32, const uint8 *, uint32, uint8 *, int);
+	static HQPatternsFunc hqPatternsFunc;
+	static SAI2xFunc sai2x16Func;
+	static SAI2xFunc sai2x32Func;
+	static EdgeFlagsFunc edgeFlags16Func;
+	static EdgeFlagsFunc edgeFlags32Func;
+
+	friend class ::ScalerKernelsTestSuite;
+};
+
+#endif
@@ -20,6 +20,7 @@
 
 #include "graphics/scaler/sai.h"
 #include "graphics/scaler/intern.h"
+#include "graphics/scaler/kernels.h"
 
 static inline int GetResult(uint32 A, uint32 B, uint32 C, uint32 D) {
 	const bool ac = (A==C);
@@ -254,6 +255,29 @@ void SuperEagleTemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uin
 	}
 }
 
+/**
+ * Get the masks used by the vectorized 2xSaI code, which match the ones
+ * used by the interpolation functions below.
+ */
+template<typename ColorMask>
+static ScalerKernels::SAIMasks getSAIMasks() {
+	ScalerKernels::SAIMasks masks;
+
+	if (ColorMask::kBytesPerPixel == 2) {
+		masks.lowBits = ColorMask::kLowBits;
+		masks.highBits = ~(uint32)ColorMask::kLowBits & 0xFFFF;
+		masks.low2Bits = ColorMask::kLow2Bits;
+		masks.notLow2Bits = ~(uint32)ColorMask::kLow2Bits & 0xFFFF;
+	} else {
+		masks.lowBits = ColorMask::kLowBitsMask;
+		masks.highBits = ColorMask::kHighBitsMask;
+		masks.low2Bits = ColorMask::kLow2Bits;
+		masks.notLow2Bits = ~(uint32)ColorMask::kLow2Bits;
+	}
+
+	return masks;
+}
+
 template<typename ColorMask>
 void _2xSaITemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
 	typedef typename ColorMask::PixelType Pixel;
@@ -261,12 +285,21 @@ void _2xSaITemplate(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32
 	const Pixel *bP;
 	Pixel *dP;
 	const uint32 nextlineSrc = srcPitch / sizeof(Pixel);
+	const ScalerKernels::SAIMasks masks = getSAIMasks<ColorMask>();
 
 	while (height--) {
-		bP = (const Pixel *)srcPtr;
-		dP = (Pixel *)dstPtr;
+		// Scale as much of the row as possible with vector instructions,
+		// and the remaining pixels below
+		int i;
+		if (ColorMask::kBytesPerPixel == 2)
+			i = ScalerKernels::sai2x16(srcPtr, srcPitch, dstPtr, dstPitch, width, masks);
+		else
+			i = ScalerKernels::sai2x32(srcPtr, srcPitch, dstPtr, dstPitch, width, masks);
 
-		for (int i = 0; i < width; ++i) {
+		bP = (const Pixel *)srcPtr + i;
+		dP = (Pixel *)dstPtr + 2 * i;
+
+		for (; i < width; ++i) {
 
 			unsigned colorA, colorB;
 			unsigned colorC, colorD,
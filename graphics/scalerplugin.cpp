@@ -20,6 +20,8 @@
 
 #include "graphics/scalerplugin.h"
 
+#include "common/system.h"
+
 namespace {
 /**
  * Trivial 'scaler' - in fact it doesn't do any scaling but just copies the
@@ -40,6 +42,33 @@ void Normal1x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPit
 		dstPtr += dstPitch;
 	}
 }
+
+/** Smallest number of source rows handed to a job of Scaler::scaleInBands(). */
+const int kMinScalerBandHeight = 8;
+
+struct ScalerBandJob {
+	Scaler *scaler;
+	const uint8 *src;
+	uint32 srcPitch;
+	uint8 *dst;
+	uint32 dstPitch;
+	int width, height;
+	int x, y;
+	int bandHeight;
+	int factor;
+};
+
+void scaleBand(void *data, int band) {
+	const ScalerBandJob *job = (const ScalerBandJob *)data;
+	const int top = band * job->bandHeight;
+	const int h = MIN(job->bandHeight, job->height - top);
+
+	// The scalers only read the rows around each band, which stay
+	// untouched while the bands are being scaled.
+	job->scaler->scale(job->src + top * job->srcPitch, job->srcPitch,
+	                   job->dst + top * job->factor * job->dstPitch, job->dstPitch,
+	                   job->width, h, job->x, job->y + top);
+}
 } // End of anonymous namespace
 
 void Scaler::scale(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
@@ -57,6 +86,32 @@ void Scaler::scale(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
 	}
 }
 
+void Scaler::scaleInBands(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
+                          uint32 dstPitch, int width, int height, int x, int y) {
+	const int numThreads = g_system->getParallelJobCount();
+	if (numThreads <= 1 || _factor <= 1 || height < 2 * kMinScalerBandHeight || !canScaleInBands()) {
+		scale(srcPtr, srcPitch, dstPtr, dstPitch, width, height, x, y);
+		return;
+	}
+
+	ScalerBandJob job;
+	job.scaler = this;
+	job.src = srcPtr;
+	job.srcPitch = srcPitch;
+	job.dst = dstPtr;
+	job.dstPitch = dstPitch;
+	job.width = width;
+	job.height = height;
+	job.x = x;
+	job.y = y;
+	job.factor = _factor;
+
+	// A few more bands than threads, so that a slow band does not hold up the others
+	const int numBands = MIN(numThreads * 2, height / kMinScalerBandHeight);
+	job.bandHeight = (height + numBands - 1) / numBands;
+	g_system->runParallel(scaleBand, &job, (height + job.bandHeight - 1) / job.bandHeight);
+}
+
 SourceScaler::SourceScaler(const Graphics::PixelFormat &format) : Scaler(format), _width(0), _height(0), _oldSrc(NULL), _enable(false) {
 }
 
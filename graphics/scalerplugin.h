@@ -45,6 +45,25 @@ public:
 	void scale(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
 	           uint32 dstPitch, int width, int height, int x, int y);
 
+	/**
+	 * Scale a rect like scale(), split into horizontal bands which are
+	 * scaled at the same time with OSystem::runParallel().
+	 *
+	 * Rects too small to be worth splitting, and scalers which can not be
+	 * split (see canScaleInBands()), are scaled in one go.
+	 *
+	 * @see scale
+	 */
+	void scaleInBands(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
+	                  uint32 dstPitch, int width, int height, int x, int y);
+
+	/**
+	 * Whether the bands of a rect can be scaled at the same time.
+	 * Scalers which compare against the previous frame update it while
+	 * scaling, so they can not.
+	 */
+	virtual bool canScaleInBands() const { return true; }
+
 	/**
 	 * Increase the factor of scaling.
 	 * @return The new factor
@@ -120,6 +139,8 @@ public:
 
 	virtual void enableSource(bool enable) final { _enable = enable; }
 
+	virtual bool canScaleInBands() const override { return !_enable; }
+
 	virtual uint setFactor(uint factor) final;
 
 protected:
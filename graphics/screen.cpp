@@ -54,6 +54,7 @@ void Screen::update() {
 	// Signal the physical screen to update
 	updateScreen();
 	_dirtyRects.clear();
+	_dirtyTiles.clear();
 }
 
 void Screen::updateScreen() {
@@ -66,35 +67,46 @@ void Screen::addDirtyRect(const Common::Rect &r) {
 	bounds.clip(getBounds());
 	bounds.translate(getOffsetFromOwner().x, getOffsetFromOwner().y);
 
-	if (bounds.width() > 0 && bounds.height() > 0)
-		_dirtyRects.push_back(bounds);
+	if (bounds.width() > 0 && bounds.height() > 0) {
+		updateDirtyTilesSize();
+		_dirtyTiles.addRect(bounds);
+	}
 }
 
 void Screen::makeAllDirty() {
 	_dirtyRects.clear();
+	_dirtyTiles.clear();
 	addDirtyRect(Common::Rect(0, 0, this->w, this->h));
 }
 
-void Screen::mergeDirtyRects() {
-	Common::List<Common::Rect>::iterator rOuter, rInner;
+void Screen::updateDirtyTilesSize() {
+	const int width = this->w + getOffsetFromOwner().x;
+	const int height = this->h + getOffsetFromOwner().y;
 
-	// Process the dirty rect list to find any rects to merge
-	for (rOuter = _dirtyRects.begin(); rOuter != _dirtyRects.end(); ++rOuter) {
-		rInner = rOuter;
-		while (++rInner != _dirtyRects.end()) {
+	// Creating the screen with another size marks all of it as dirty,
+	// so nothing is lost by starting over with an empty map
+	if (_dirtyTiles.getWidth() != width || _dirtyTiles.getHeight() != height)
+		_dirtyTiles.resize(width, height);
+}
 
-			if ((*rOuter).intersects(*rInner)) {
-				// These two rectangles overlap, so merge them
-				unionRectangle(*rOuter, *rOuter, *rInner);
+void Screen::mergeDirtyRects() {
+	// Subclasses may have added rects to the list directly, and a previous
+	// call may have left rects there as well
+	if (!_dirtyRects.empty()) {
+		updateDirtyTilesSize();
+		for (Common::List<Common::Rect>::iterator i = _dirtyRects.begin(); i != _dirtyRects.end(); ++i)
+			_dirtyTiles.addRect(*i);
+		_dirtyRects.clear();
+	}
 
-				// remove the inner rect from the list
-				_dirtyRects.erase(rInner);
+	// The tiles are turned into a few rects that don't overlap, no matter
+	// how many areas have been marked as dirty
+	Common::Array<Common::Rect> rects;
+	_dirtyTiles.getRects(rects);
+	for (uint i = 0; i < rects.size(); ++i)
+		_dirtyRects.push_back(rects[i]);
 
-				// move back to beginning of list
-				rInner = rOuter;
-			}
-		}
-	}
+	_dirtyTiles.clear();
 }
 
 bool Screen::unionRectangle(Common::Rect &destRect, const Common::Rect &src1, const Common::Rect &src2) {
@@ -22,6 +22,7 @@
 #ifndef GRAPHICS_SCREEN_H
 #define GRAPHICS_SCREEN_H
 
+#include "graphics/dirty_tile_map.h"
 #include "graphics/managed_surface.h"
 #include "graphics/pixelformat.h"
 #include "common/list.h"
@@ -50,15 +51,26 @@ namespace Graphics {
 class Screen : public ManagedSurface {
 protected:
 	/**
-	 * List of affected areas of the screen
+	 * Affected areas of the screen, as tiles
+	 */
+	DirtyTileMap _dirtyTiles;
+
+	/**
+	 * List of affected areas of the screen, filled in by mergeDirtyRects
 	 */
 	Common::List<Common::Rect> _dirtyRects;
 protected:
 	/**
-	 * Merges together overlapping dirty areas of the screen
+	 * Merges together the dirty areas of the screen, and replaces the
+	 * contents of the dirty rects list with rectangles that don't overlap
 	 */
 	void mergeDirtyRects();
 
+	/**
+	 * Resizes the dirty tile map when the screen size has changed
+	 */
+	void updateDirtyTilesSize();
+
 	/**
 	 * Returns the union of two dirty area rectangles
 	 */
@@ -71,7 +83,7 @@ public:
 	/**
 	 * Returns true if there are any pending screen updates (dirty areas)
 	 */
-	bool isDirty() const { return !_dirtyRects.empty(); }
+	bool isDirty() const { return !_dirtyRects.empty() || !_dirtyTiles.isEmpty(); }
 
 	/**
 	 * Marks the whole screen as dirty. This forces the next call to update
@@ -82,7 +94,7 @@ public:
 	/**
 	 * Clear the current dirty rects list
 	 */
-	virtual void clearDirtyRects() { _dirtyRects.clear(); }
+	virtual void clearDirtyRects() { _dirtyRects.clear(); _dirtyTiles.clear(); }
 
 	/**
 	 * Adds a rectangle to the list of modified areas of the screen during the
@@ -27,6 +27,7 @@
 
 #include "common/singleton.h"
 #include "common/array.h"
+#include "common/system.h"
 
 #include "graphics/tinygl/tinygl.h"
 #include "graphics/tinygl/zgl.h"
@@ -353,6 +354,7 @@ void GLContext::init(int screenW, int screenH, Graphics::PixelFormat pixelFormat
 	_drawCallAllocator[1].initialize(drawCallMemorySize);
 	_debugRectsEnabled = false;
 	_profilingEnabled = false;
+	_renderThreads = g_system->getParallelJobCount();
 
 	TinyGL::Internal::tglBlitResetScissorRect();
 }
@@ -360,6 +362,7 @@ void GLContext::init(int screenW, int screenH, Graphics::PixelFormat pixelFormat
 void GLContext::deinit() {
 	disposeDrawCallLists();
 	disposeResources();
+	disposeRenderThreadContexts();
 
 	specbuf_cleanup();
 	for (int i = 0; i < 3; i++)
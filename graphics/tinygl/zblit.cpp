@@ -163,7 +163,7 @@ public:
 		}
 	};
 
-	bool clipBlitImage(TinyGL::GLContext *c, int &srcX, int &srcY, int &srcWidth, int &srcHeight, int &width, int &height, int &dstX, int &dstY, int &clampWidth, int &clampHeight) {
+	void getBlitSize(int &srcWidth, int &srcHeight, int &width, int &height) {
 		if (srcWidth == 0 || srcHeight == 0) {
 			srcWidth = _surface.w;
 			srcHeight = _surface.h;
@@ -173,6 +173,10 @@ public:
 			width = srcWidth;
 			height = srcHeight;
 		}
+	}
+
+	bool clipBlitImage(TinyGL::GLContext *c, int &srcX, int &srcY, int &srcWidth, int &srcHeight, int &width, int &height, int &dstX, int &dstY, int &clampWidth, int &clampHeight) {
+		getBlitSize(srcWidth, srcHeight, width, height);
 
 		if (dstX >= c->_scissorRect.right || dstY >= c->_scissorRect.bottom)
 			return false;
@@ -212,10 +216,21 @@ public:
 		return true;
 	}
 
+	// Unlike clipBlitImage(), this leaves the image where it is and only returns the part
+	// of the destination inside the scissor rectangle. Flipped, scaled and rotated images
+	// are then drawn the same way whichever part of the screen is being drawn.
+	bool clipTransformedBlitImage(TinyGL::GLContext *c, int dstX, int dstY, int width, int height, Common::Rect &clip) {
+		if (width <= 0 || height <= 0)
+			return false;
+
+		clip = Common::Rect(dstX, dstY, dstX + width, dstY + height);
+		clip.clip(c->_scissorRect);
+		return !clip.isEmpty();
+	}
+
 	// Blits an image to the z buffer.
 	// The function only supports clipped blitting without any type of transformation or tinting.
-	void tglBlitZBuffer(int dstX, int dstY) {
-		TinyGL::GLContext *c = TinyGL::gl_get_context();
+	void tglBlitZBuffer(GLContext *c, int dstX, int dstY) {
 		assert(_zBuffer);
 
 		int clampWidth, clampHeight;
@@ -240,50 +255,50 @@ public:
 		}
 	}
 
-	void tglBlitOpaque(int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight);
+	void tglBlitOpaque(GLContext *c, int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight);
 
 	template <bool kDisableColoring, bool kDisableBlending, bool kEnableAlphaBlending>
-	void tglBlitRLE(int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint);
+	void tglBlitRLE(GLContext *c, int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint);
 
 	template <bool kDisableBlending, bool kDisableColoring, bool kFlipVertical, bool kFlipHorizontal>
-	void tglBlitSimple(int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint);
+	void tglBlitSimple(GLContext *c, int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint);
 
 	template <bool kDisableBlending, bool kDisableColoring, bool kFlipVertical, bool kFlipHorizontal>
-	void tglBlitScale(int dstX, int dstY, int width, int height, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint);
+	void tglBlitScale(GLContext *c, int dstX, int dstY, int width, int height, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint);
 
 	template <bool kDisableBlending, bool kDisableColoring, bool kFlipVertical, bool kFlipHorizontal>
-	void tglBlitRotoScale(int dstX, int dstY, int width, int height, int srcX, int srcY, int srcWidth, int srcHeight, int rotation,
+	void tglBlitRotoScale(GLContext *c, int dstX, int dstY, int width, int height, int srcX, int srcY, int srcWidth, int srcHeight, int rotation,
 	                      int originX, int originY, float aTint, float rTint, float gTint, float bTint);
 
 	//Utility function that calls the correct blitting function.
 	template <bool kDisableBlending, bool kDisableColoring, bool kDisableTransform, bool kFlipVertical, bool kFlipHorizontal, bool kEnableAlphaBlending, bool kEnableOpaqueBlit>
-	void tglBlitGeneric(const BlitTransform &transform) {
+	void tglBlitGeneric(GLContext *c, const BlitTransform &transform) {
 		assert(!_zBuffer);
 
 		if (kDisableTransform) {
 			if (kEnableOpaqueBlit && kDisableColoring && kFlipVertical == false && kFlipHorizontal == false) {
-				tglBlitOpaque(transform._destinationRectangle.left, transform._destinationRectangle.top,
+				tglBlitOpaque(c, transform._destinationRectangle.left, transform._destinationRectangle.top,
 					transform._sourceRectangle.left, transform._sourceRectangle.top,
 					transform._sourceRectangle.width() , transform._sourceRectangle.height());
 			} else if ((kDisableBlending || kEnableAlphaBlending) && kFlipVertical == false && kFlipHorizontal == false) {
-				tglBlitRLE<kDisableColoring, kDisableBlending, kEnableAlphaBlending>(transform._destinationRectangle.left,
+				tglBlitRLE<kDisableColoring, kDisableBlending, kEnableAlphaBlending>(c, transform._destinationRectangle.left,
 					transform._destinationRectangle.top, transform._sourceRectangle.left, transform._sourceRectangle.top,
 					transform._sourceRectangle.width() , transform._sourceRectangle.height(), transform._aTint,
 					transform._rTint, transform._gTint, transform._bTint);
 			} else {
-				tglBlitSimple<kDisableBlending, kDisableColoring, kFlipVertical, kFlipHorizontal>(transform._destinationRectangle.left,
+				tglBlitSimple<kDisableBlending, kDisableColoring, kFlipVertical, kFlipHorizontal>(c, transform._destinationRectangle.left,
 					transform._destinationRectangle.top, transform._sourceRectangle.left, transform._sourceRectangle.top,
 					transform._sourceRectangle.width() , transform._sourceRectangle.height(),
 					transform._aTint, transform._rTint, transform._gTint, transform._bTint);
 			}
 		} else {
 			if (transform._rotation == 0) {
-				tglBlitScale<kDisableBlending, kDisableColoring, kFlipVertical, kFlipHorizontal>(transform._destinationRectangle.left,
+				tglBlitScale<kDisableBlending, kDisableColoring, kFlipVertical, kFlipHorizontal>(c, transform._destinationRectangle.left,
 					transform._destinationRectangle.top, transform._destinationRectangle.width(), transform._destinationRectangle.height(),
 					transform._sourceRectangle.left, transform._sourceRectangle.top, transform._sourceRectangle.width(), transform._sourceRectangle.height(),
 					transform._aTint, transform._rTint, transform._gTint, transform._bTint);
 			} else {
-				tglBlitRotoScale<kDisableBlending, kDisableColoring, kFlipVertical, kFlipHorizontal>(transform._destinationRectangle.left,
+				tglBlitRotoScale<kDisableBlending, kDisableColoring, kFlipVertical, kFlipHorizontal>(c, transform._destinationRectangle.left,
 					transform._destinationRectangle.top, transform._destinationRectangle.width(), transform._destinationRectangle.height(),
 					transform._sourceRectangle.left, transform._sourceRectangle.top, transform._sourceRectangle.width(),
 					transform._sourceRectangle.height(), transform._rotation, transform._originX, transform._originY, transform._aTint,
@@ -346,9 +361,7 @@ void tglDeleteBlitImage(TinyGL::BlitImage *blitImage) {
 
 namespace TinyGL {
 
-void BlitImage::tglBlitOpaque(int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight) {
-	GLContext *c = gl_get_context();
-
+void BlitImage::tglBlitOpaque(GLContext *c, int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight) {
 	int clampWidth, clampHeight;
 	int width = srcWidth, height = srcHeight;
 	if (clipBlitImage(c, srcX, srcY, srcWidth, srcHeight, width, height, dstX, dstY, clampWidth, clampHeight) == false)
@@ -367,9 +380,7 @@ void BlitImage::tglBlitOpaque(int dstX, int dstY, int srcX, int srcY, int srcWid
 // This blit only supports tinting but it will fall back to simpleBlit
 // if flipping is required (or anything more complex than that, including rotationd and scaling).
 template <bool kDisableColoring, bool kDisableBlending, bool kEnableAlphaBlending>
-void BlitImage::tglBlitRLE(int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint) {
-	GLContext *c = gl_get_context();
-
+void BlitImage::tglBlitRLE(GLContext *c, int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint) {
 	int clampWidth, clampHeight;
 	int width = srcWidth, height = srcHeight;
 	if (clipBlitImage(c, srcX, srcY, srcWidth, srcHeight, width, height, dstX, dstY, clampWidth, clampHeight) == false)
@@ -454,33 +465,24 @@ void BlitImage::tglBlitRLE(int dstX, int dstY, int srcX, int srcY, int srcWidth,
 
 // This blit function is called when flipping is needed but transformation isn't.
 template <bool kDisableBlending, bool kDisableColoring, bool kFlipVertical, bool kFlipHorizontal>
-void BlitImage::tglBlitSimple(int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint) {
-	GLContext *c = gl_get_context();
+void BlitImage::tglBlitSimple(GLContext *c, int dstX, int dstY, int srcX, int srcY, int srcWidth, int srcHeight, float aTint, float rTint, float gTint, float bTint) {
+	int width = 0, height = 0;
+	getBlitSize(srcWidth, srcHeight, width, height);
 
-	int clampWidth, clampHeight;
-	int width = srcWidth, height = srcHeight;
-	if (clipBlitImage(c, srcX, srcY, srcWidth, srcHeight, width, height, dstX, dstY, clampWidth, clampHeight) == false)
+	Common::Rect clip;
+	if (clipTransformedBlitImage(c, dstX, dstY, width, height, clip) == false)
 		return;
 
 	Graphics::PixelBuffer srcBuf(_surface.format, (byte *)_surface.getPixels());
-
-	if (kFlipVertical) {
-		srcBuf.shiftBy(((srcHeight - srcY - 1) * _surface.w));
-	} else {
-		srcBuf.shiftBy((srcY * _surface.w));
-	}
-
 	Graphics::PixelBuffer dstBuf(c->fb->getPixelFormat(), c->fb->getPixelBuffer());
 	int fbWidth = c->fb->getPixelBufferWidth();
 
-	for (int y = 0; y < clampHeight; y++) {
-		for (int x = 0; x < clampWidth; ++x) {
+	for (int y = clip.top - dstY; y < clip.bottom - dstY; y++) {
+		int ySource = kFlipVertical ? srcY + height - y - 1 : srcY + y;
+		for (int x = clip.left - dstX; x < clip.right - dstX; ++x) {
 			byte aDst, rDst, gDst, bDst;
-			if (kFlipHorizontal) {
-				srcBuf.getARGBAt(srcX + clampWidth - x, aDst, rDst, gDst, bDst);
-			} else {
-				srcBuf.getARGBAt(srcX + x, aDst, rDst, gDst, bDst);
-			}
+			int xSource = kFlipHorizontal ? srcX + width - x - 1 : srcX + x;
+			srcBuf.getARGBAt(ySource * _surface.w + xSource, aDst, rDst, gDst, bDst);
 
 			// Those branches are needed to favor speed: avoiding writePixel always yield a huge performance boost when blitting images.
 			if (kDisableColoring) {
@@ -497,23 +499,18 @@ void BlitImage::tglBlitSimple(int dstX, int dstY, int srcX, int srcY, int srcWid
 				}
 			}
 		}
-		if (kFlipVertical) {
-			srcBuf.shiftBy(-_surface.w);
-		} else {
-			srcBuf.shiftBy(_surface.w);
-		}
 	}
 }
 
 // This function is called when scale is needed: it uses a simple nearest
 // filter to scale the blit image before copying it to the screen.
 template <bool kDisableBlending, bool kDisableColoring, bool kFlipVertical, bool kFlipHorizontal>
-void BlitImage::tglBlitScale(int dstX, int dstY, int width, int height, int srcX, int srcY, int srcWidth, int srcHeight,
+void BlitImage::tglBlitScale(GLContext *c, int dstX, int dstY, int width, int height, int srcX, int srcY, int srcWidth, int srcHeight,
 	                     float aTint, float rTint, float gTint, float bTint) {
-	GLContext *c = gl_get_context();
+	getBlitSize(srcWidth, srcHeight, width, height);
 
-	int clampWidth, clampHeight;
-	if (clipBlitImage(c, srcX, srcY, srcWidth, srcHeight, width, height, dstX, dstY, clampWidth, clampHeight) == false)
+	Common::Rect clip;
+	if (clipTransformedBlitImage(c, dstX, dstY, width, height, clip) == false)
 		return;
 
 	Graphics::PixelBuffer srcBuf(_surface.format, (byte *)_surface.getPixels());
@@ -522,18 +519,18 @@ void BlitImage::tglBlitScale(int dstX, int dstY, int width, int height, int srcX
 	Graphics::PixelBuffer dstBuf(c->fb->getPixelFormat(), c->fb->getPixelBuffer());
 	int fbWidth = c->fb->getPixelBufferWidth();
 
-	for (int y = 0; y < clampHeight; y++) {
-		for (int x = 0; x < clampWidth; ++x) {
+	for (int y = clip.top - dstY; y < clip.bottom - dstY; y++) {
+		for (int x = clip.left - dstX; x < clip.right - dstX; ++x) {
 			byte aDst, rDst, gDst, bDst;
 			int xSource, ySource;
 			if (kFlipVertical) {
-				ySource = clampHeight - y - 1;
+				ySource = height - y - 1;
 			} else {
 				ySource = y;
 			}
 
 			if (kFlipHorizontal) {
-				xSource = clampWidth - x - 1;
+				xSource = width - x - 1;
 			} else {
 				xSource = x;
 			}
@@ -598,12 +595,15 @@ systems.
 */
 
 template <bool kDisableBlending, bool kDisableColoring, bool kFlipVertical, bool kFlipHorizontal>
-void BlitImage::tglBlitRotoScale(int dstX, int dstY, int width, int height, int srcX, int srcY, int srcWidth, int srcHeight, int rotation,
+void BlitImage::tglBlitRotoScale(GLContext *c, int dstX, int dstY, int width, int height, int srcX, int srcY, int srcWidth, int srcHeight, int rotation,
 	                         int originX, int originY, float aTint, float rTint, float gTint, float bTint) {
-	GLContext *c = gl_get_context();
+	getBlitSize(srcWidth, srcHeight, width, height);
 
-	int clampWidth, clampHeight;
-	if (clipBlitImage(c, srcX, srcY, srcWidth, srcHeight, width, height, dstX, dstY, clampWidth, clampHeight) == false)
+	// Transform destination rectangle accordingly.
+	Common::Rect destinationRectangle = rotateRectangle(dstX, dstY, width, height, rotation, originX, originY);
+
+	Common::Rect clip;
+	if (clipTransformedBlitImage(c, dstX, dstY, destinationRectangle.width(), destinationRectangle.height(), clip) == false)
 		return;
 
 	Graphics::PixelBuffer srcBuf(_surface.format, (byte *)_surface.getPixels());
@@ -612,18 +612,6 @@ void BlitImage::tglBlitRotoScale(int dstX, int dstY, int width, int height, int
 
 	Graphics::PixelBuffer dstBuf(c->fb->getPixelFormat(), c->fb->getPixelBuffer());
 
-	// Transform destination rectangle accordingly.
-	Common::Rect destinationRectangle = rotateRectangle(dstX, dstY, width, height, rotation, originX, originY);
-
-	if (dstX + destinationRectangle.width() > fbWidth)
-		clampWidth = fbWidth - dstX;
-	else
-		clampWidth = destinationRectangle.width();
-	if (dstY + destinationRectangle.height() > c->fb->getPixelBufferHeight())
-		clampHeight = c->fb->getPixelBufferHeight() - dstY;
-	else
-		clampHeight = destinationRectangle.height();
-
 	uint32 invAngle = 360 - (rotation % 360);
 	float invCos = cos(invAngle * (float)M_PI / 180.0f);
 	float invSin = sin(invAngle * (float)M_PI / 180.0f);
@@ -643,11 +631,11 @@ void BlitImage::tglBlitRotoScale(int dstX, int dstY, int width, int height, int
 	int sw = width - 1;
 	int sh = height - 1;
 
-	for (int y = 0; y < clampHeight; y++) {
+	for (int y = clip.top - dstY; y < clip.bottom - dstY; y++) {
 		int t = cy - y;
-		int sdx = ax + (isinx * t) + xd;
-		int sdy = ay - (icosy * t) + yd;
-		for (int x = 0; x < clampWidth; ++x) {
+		int sdx = ax + (isinx * t) + xd + icosx * (clip.left - dstX);
+		int sdy = ay - (icosy * t) + yd + isiny * (clip.left - dstX);
+		for (int x = clip.left - dstX; x < clip.right - dstX; ++x) {
 			byte aDst, rDst, gDst, bDst;
 
 			int dx = (sdx >> 16);
@@ -713,58 +701,57 @@ namespace TinyGL {
 namespace Internal {
 
 template <bool kEnableAlphaBlending, bool kEnableOpaqueBlit, bool kDisableColor, bool kDisableTransform, bool kDisableBlend>
-void tglBlit(BlitImage *blitImage, const BlitTransform &transform) {
+void tglBlit(GLContext *c, BlitImage *blitImage, const BlitTransform &transform) {
 	if (transform._flipHorizontally) {
 		if (transform._flipVertically) {
-			blitImage->tglBlitGeneric<kDisableBlend, kDisableColor, kDisableTransform, true, true, kEnableAlphaBlending, kEnableOpaqueBlit>(transform);
+			blitImage->tglBlitGeneric<kDisableBlend, kDisableColor, kDisableTransform, true, true, kEnableAlphaBlending, kEnableOpaqueBlit>(c, transform);
 		} else {
-			blitImage->tglBlitGeneric<kDisableBlend, kDisableColor, kDisableTransform, false, true, kEnableAlphaBlending, kEnableOpaqueBlit>(transform);
+			blitImage->tglBlitGeneric<kDisableBlend, kDisableColor, kDisableTransform, false, true, kEnableAlphaBlending, kEnableOpaqueBlit>(c, transform);
 		}
 	} else if (transform._flipVertically) {
-		blitImage->tglBlitGeneric<kDisableBlend, kDisableColor, kDisableTransform, true, false, kEnableAlphaBlending, kEnableOpaqueBlit>(transform);
+		blitImage->tglBlitGeneric<kDisableBlend, kDisableColor, kDisableTransform, true, false, kEnableAlphaBlending, kEnableOpaqueBlit>(c, transform);
 	} else {
-		blitImage->tglBlitGeneric<kDisableBlend, kDisableColor, kDisableTransform, false, false, kEnableAlphaBlending, kEnableOpaqueBlit>(transform);
+		blitImage->tglBlitGeneric<kDisableBlend, kDisableColor, kDisableTransform, false, false, kEnableAlphaBlending, kEnableOpaqueBlit>(c, transform);
 	}
 }
 
 template <bool kEnableAlphaBlending, bool kEnableOpaqueBlit, bool kDisableColor, bool kDisableTransform>
-void tglBlit(BlitImage *blitImage, const BlitTransform &transform, bool disableBlend) {
+void tglBlit(GLContext *c, BlitImage *blitImage, const BlitTransform &transform, bool disableBlend) {
 	if (disableBlend) {
-		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, kDisableColor, kDisableTransform, true>(blitImage, transform);
+		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, kDisableColor, kDisableTransform, true>(c, blitImage, transform);
 	} else {
-		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, kDisableColor, kDisableTransform, false>(blitImage, transform);
+		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, kDisableColor, kDisableTransform, false>(c, blitImage, transform);
 	}
 }
 
 template <bool kEnableAlphaBlending, bool kEnableOpaqueBlit, bool kDisableColor>
-void tglBlit(BlitImage *blitImage, const BlitTransform &transform, bool disableTransform, bool disableBlend) {
+void tglBlit(GLContext *c, BlitImage *blitImage, const BlitTransform &transform, bool disableTransform, bool disableBlend) {
 	if (disableTransform) {
-		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, kDisableColor, true>(blitImage, transform, disableBlend);
+		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, kDisableColor, true>(c, blitImage, transform, disableBlend);
 	} else {
-		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, kDisableColor, false>(blitImage, transform, disableBlend);
+		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, kDisableColor, false>(c, blitImage, transform, disableBlend);
 	}
 }
 
 template <bool kEnableAlphaBlending, bool kEnableOpaqueBlit>
-void tglBlit(BlitImage *blitImage, const BlitTransform &transform, bool disableColor, bool disableTransform, bool disableBlend) {
+void tglBlit(GLContext *c, BlitImage *blitImage, const BlitTransform &transform, bool disableColor, bool disableTransform, bool disableBlend) {
 	if (disableColor) {
-		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, true>(blitImage, transform, disableTransform, disableBlend);
+		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, true>(c, blitImage, transform, disableTransform, disableBlend);
 	} else {
-		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, false>(blitImage, transform, disableTransform, disableBlend);
+		tglBlit<kEnableAlphaBlending, kEnableOpaqueBlit, false>(c, blitImage, transform, disableTransform, disableBlend);
 	}
 }
 
 template <bool kEnableAlphaBlending>
-void tglBlit(BlitImage *blitImage, const BlitTransform &transform, bool enableOpaqueBlit, bool disableColor, bool disableTransform, bool disableBlend) {
+void tglBlit(GLContext *c, BlitImage *blitImage, const BlitTransform &transform, bool enableOpaqueBlit, bool disableColor, bool disableTransform, bool disableBlend) {
 	if (enableOpaqueBlit) {
-		tglBlit<kEnableAlphaBlending, true>(blitImage, transform, disableColor, disableTransform, disableBlend);
+		tglBlit<kEnableAlphaBlending, true>(c, blitImage, transform, disableColor, disableTransform, disableBlend);
 	} else {
-		tglBlit<kEnableAlphaBlending, false>(blitImage, transform, disableColor, disableTransform, disableBlend);
+		tglBlit<kEnableAlphaBlending, false>(c, blitImage, transform, disableColor, disableTransform, disableBlend);
 	}
 }
 
-void tglBlit(BlitImage *blitImage, const BlitTransform &transform) {
-	GLContext *c = gl_get_context();
+void tglBlit(GLContext *c, BlitImage *blitImage, const BlitTransform &transform) {
 	bool disableColor = transform._aTint == 1.0f && transform._bTint == 1.0f && transform._gTint == 1.0f && transform._rTint == 1.0f;
 	bool disableTransform = transform._destinationRectangle.width() == 0 && transform._destinationRectangle.height() == 0 && transform._rotation == 0;
 	bool disableBlend = c->blending_enabled == false;
@@ -774,23 +761,23 @@ void tglBlit(BlitImage *blitImage, const BlitTransform &transform) {
 	                    && (c->destination_blending_factor == TGL_ZERO || c->destination_blending_factor == TGL_ONE_MINUS_SRC_ALPHA);
 
 	if (enableAlphaBlending) {
-		tglBlit<true>(blitImage, transform, enableOpaqueBlit, disableColor, disableTransform, disableBlend);
+		tglBlit<true>(c, blitImage, transform, enableOpaqueBlit, disableColor, disableTransform, disableBlend);
 	} else {
-		tglBlit<false>(blitImage, transform, enableOpaqueBlit, disableColor, disableTransform, disableBlend);
+		tglBlit<false>(c, blitImage, transform, enableOpaqueBlit, disableColor, disableTransform, disableBlend);
 	}
 }
 
-void tglBlitFast(BlitImage *blitImage, int x, int y) {
+void tglBlitFast(GLContext *c, BlitImage *blitImage, int x, int y) {
 	BlitTransform transform(x, y);
 	if (blitImage->isOpaque()) {
-		blitImage->tglBlitGeneric<true, true, true, false, false, false, true>(transform);
+		blitImage->tglBlitGeneric<true, true, true, false, false, false, true>(c, transform);
 	} else {
-		blitImage->tglBlitGeneric<true, true, true, false, false, false, false>(transform);
+		blitImage->tglBlitGeneric<true, true, true, false, false, false, false>(c, transform);
 	}
 }
 
-void tglBlitZBuffer(BlitImage *blitImage, int x, int y) {
-	blitImage->tglBlitZBuffer(x, y);
+void tglBlitZBuffer(GLContext *c, BlitImage *blitImage, int x, int y) {
+	blitImage->tglBlitZBuffer(c, x, y);
 }
 
 void tglCleanupImages() {
@@ -53,18 +53,42 @@ FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelFormat &for
 	_offscreenBuffer.pbuf = _pbuf;
 	_offscreenBuffer.zbuf = _zbuf;
 
+	_ownsBuffers = true;
+
+	_currentTexture = nullptr;
+
+	_enableScissor = false;
+
+	// Select the span kernels here, rendering threads only look them up
+	SpanKernels::get(0);
+}
+
+FrameBuffer::FrameBuffer() {
+	_pbuf = nullptr;
+	_zbuf = nullptr;
+	_sbuf = nullptr;
+	_ownsBuffers = false;
+
 	_currentTexture = nullptr;
 
 	_enableScissor = false;
 }
 
 FrameBuffer::~FrameBuffer() {
+	if (!_ownsBuffers)
+		return;
+
 	gl_free(_pbuf);
 	gl_free(_zbuf);
 	if (_sbuf)
 		gl_free(_sbuf);
 }
 
+void FrameBuffer::shareBuffers(const FrameBuffer &other) {
+	*this = other;
+	_ownsBuffers = false;
+}
+
 Buffer *FrameBuffer::genOffscreenBuffer() {
 	Buffer *buf = (Buffer *)gl_malloc(sizeof(Buffer));
 	buf->pbuf = (byte *)gl_zalloc(_pbufHeight * _pbufPitch);
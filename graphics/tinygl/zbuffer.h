@@ -31,6 +31,7 @@
 #include "graphics/surface.h"
 #include "graphics/tinygl/texelbuffer.h"
 #include "graphics/tinygl/gl.h"
+#include "graphics/tinygl/zspan.h"
 
 #include "common/rect.h"
 
@@ -104,8 +105,14 @@ struct ZBufferPoint {
 
 struct FrameBuffer {
 	FrameBuffer(int width, int height, const Graphics::PixelFormat &format, bool enableStencilBuffer);
+	// Creates a frame buffer without buffers, see shareBuffers().
+	FrameBuffer();
 	~FrameBuffer();
 
+	// Draws to the buffers of another frame buffer, starting with a copy of its state.
+	// The buffers stay owned by the other frame buffer.
+	void shareBuffers(const FrameBuffer &other);
+
 	Graphics::PixelFormat getPixelFormat() {
 		return _pbufFormat;
 	}
@@ -372,6 +379,12 @@ private:
 	template <bool kDepthWrite, bool kEnableScissor, bool kStencilEnabled, bool kDepthTestEnabled>
 	void putPixelDepth(uint *pz, byte *ps, int _a, int x, int y, uint &z, int &dzdx);
 
+	template <bool kDepthOnly, bool kTexture, bool kSmoothMode, bool kDepthWrite, bool kEnableAlphaTest, bool kEnableBlending, bool kDepthTestEnabled>
+	SpanFunc getSpanFunc(SpanState &state);
+
+	template <bool kEnableScissor>
+	void drawSpan(SpanFunc func, const SpanState &state, Span &span, int x, int count);
+
 
 	template <bool kEnableAlphaTest>
 	FORCEINLINE void writePixel(int pixel, int value) {
@@ -418,11 +431,11 @@ private:
 
 	template <bool kEnableAlphaTest, bool kBlendingEnabled, bool kDepthWrite>
 	FORCEINLINE void writePixel(int pixel, byte aSrc, byte rSrc, byte gSrc, byte bSrc, uint z) {
-		writePixel<kEnableAlphaTest, kBlendingEnabled, false, false>(pixel, aSrc, rSrc, gSrc, bSrc, z, 0.0f, 0, 0, 0);
+		writePixel<kEnableAlphaTest, kBlendingEnabled, false, false>(pixel, aSrc, rSrc, gSrc, bSrc, z, 0, 0, 0, 0);
 	}
 
 	template <bool kEnableAlphaTest, bool kBlendingEnabled, bool kDepthWrite, bool kFogMode>
-	FORCEINLINE void writePixel(int pixel, byte aSrc, byte rSrc, byte gSrc, byte bSrc, float z, uint fog, byte fog_r, byte fog_g, byte fog_b) {
+	FORCEINLINE void writePixel(int pixel, byte aSrc, byte rSrc, byte gSrc, byte bSrc, uint z, uint fog, byte fog_r, byte fog_g, byte fog_b) {
 		if (kEnableAlphaTest) {
 			if (!checkAlphaTest(aSrc))
 				return;
@@ -750,6 +763,7 @@ private:
 
 	uint *_zbuf;
 	byte *_sbuf;
+	bool _ownsBuffers;
 
 	bool _enableStencil;
 	int _textureSize;
@@ -25,6 +25,7 @@
 
 #include "common/debug.h"
 #include "common/math.h"
+#include "common/system.h"
 
 namespace TinyGL {
 
@@ -193,12 +194,20 @@ void GLContext::presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas)
 		}
 
 		// Execute draw calls.
-		for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
-			Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+		if (canExecuteDrawCallsInParallel()) {
+			Common::Array<Common::Rect> areas;
 			for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
-				Common::Rect dirtyRegion = (*itRect).rectangle;
-				if (dirtyRegion.intersects(drawCallRegion)) {
-					(*it)->execute(dirtyRegion, true);
+				areas.push_back((*itRect).rectangle);
+			}
+			executeDrawCallsInParallel(areas);
+		} else {
+			for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+				Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+				for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
+					Common::Rect dirtyRegion = (*itRect).rectangle;
+					if (dirtyRegion.intersects(drawCallRegion)) {
+						(*it)->execute(dirtyRegion, true);
+					}
 				}
 			}
 		}
@@ -240,9 +249,18 @@ void GLContext::presentBufferSimple(Common::List<Common::Rect> &dirtyAreas) {
 
 	dirtyAreas.push_back(Common::Rect(fb->getPixelBufferWidth(), fb->getPixelBufferHeight()));
 
-	for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
-		(*it)->execute(true);
-		delete *it;
+	if (canExecuteDrawCallsInParallel()) {
+		Common::Array<Common::Rect> areas;
+		areas.push_back(renderRect);
+		executeDrawCallsInParallel(areas);
+		for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+			delete *it;
+		}
+	} else {
+		for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+			(*it)->execute(true);
+			delete *it;
+		}
 	}
 
 	_drawCallsQueue.clear();
@@ -252,6 +270,106 @@ void GLContext::presentBufferSimple(Common::List<Common::Rect> &dirtyAreas) {
 	_drawCallAllocator[_currentAllocatorIndex].reset();
 }
 
+// The frame buffer is split into bands of this many lines which are drawn on
+// several threads. Bands using the full width let the rasterizer skip whole
+// lines of a triangle instead of testing each of its pixels.
+static const int kRenderBandHeight = 32;
+
+struct RenderBandCall {
+	const DrawCall *drawCall;
+	Common::Rect clippingRectangle;
+
+	RenderBandCall() : drawCall(nullptr) { }
+	RenderBandCall(const DrawCall *call, const Common::Rect &rect) : drawCall(call), clippingRectangle(rect) { }
+};
+
+struct RenderBands {
+	Common::Array<Common::Array<RenderBandCall> > bands;
+	const Common::Array<GLContext *> *contexts;
+	int numJobs;
+};
+
+static void renderBands(void *data, int job) {
+	RenderBands *r = (RenderBands *)data;
+	GLContext *c = (*r->contexts)[job];
+
+	// Every job draws every numJobs-th band, so the busy parts of the frame
+	// buffer are spread over all the jobs.
+	for (uint band = job; band < r->bands.size(); band += r->numJobs) {
+		const Common::Array<RenderBandCall> &calls = r->bands[band];
+		for (uint i = 0; i < calls.size(); i++) {
+			calls[i].drawCall->execute(c, calls[i].clippingRectangle);
+		}
+	}
+}
+
+bool GLContext::canExecuteDrawCallsInParallel() const {
+	// Selection and the profiling counters need all the draw calls on one thread
+	return _renderThreads > 1 && render_mode == TGL_RENDER && !_profilingEnabled;
+}
+
+void GLContext::executeDrawCallsInParallel(const Common::Array<Common::Rect> &areas) {
+	typedef Common::List<DrawCall *>::const_iterator DrawCallIterator;
+
+	RenderBands r;
+	r.bands.resize((fb->getPixelBufferHeight() + kRenderBandHeight - 1) / kRenderBandHeight);
+
+	// Sort the draw calls into the bands they are drawn in. The order of the
+	// calls stays the same within each band.
+	for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+		const Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+		for (uint i = 0; i < areas.size(); i++) {
+			const Common::Rect &area = areas[i];
+			if (!area.intersects(drawCallRegion))
+				continue;
+
+			// Only the bands the draw call reaches get it, but it is still
+			// clipped to the whole area within them, as without threads
+			const int top = MAX<int>(area.top, drawCallRegion.top);
+			const int bottom = MIN<int>(area.bottom, drawCallRegion.bottom);
+			for (int band = top / kRenderBandHeight; band * kRenderBandHeight < bottom; band++) {
+				Common::Rect clip(area.left, MAX<int>(area.top, band * kRenderBandHeight),
+				                  area.right, MIN<int>(area.bottom, (band + 1) * kRenderBandHeight));
+				r.bands[band].push_back(RenderBandCall(*it, clip));
+			}
+		}
+	}
+
+	// Every thread draws with a context of its own, using the same buffers
+	int numJobs = MIN<int>(_renderThreads, r.bands.size());
+	while ((int)_renderThreadContexts.size() < numJobs) {
+		GLContext *c = new GLContext();
+		c->fb = new FrameBuffer();
+		c->vertex_max = POLYGON_MAX_VERTEX;
+		c->vertex = (GLVertex *)gl_malloc(POLYGON_MAX_VERTEX * sizeof(GLVertex));
+		_renderThreadContexts.push_back(c);
+	}
+	for (int i = 0; i < numJobs; i++) {
+		GLContext *c = _renderThreadContexts[i];
+		c->fb->shareBuffers(*fb);
+		c->fb->resetScissorRectangle();
+		c->renderRect = renderRect;
+		c->_scissorRect = renderRect;
+		c->render_mode = render_mode;
+		c->current_cull_face = current_cull_face;
+		c->vertex_n = vertex_n;
+	}
+
+	r.contexts = &_renderThreadContexts;
+	r.numJobs = numJobs;
+	g_system->runParallel(renderBands, &r, numJobs);
+}
+
+void GLContext::disposeRenderThreadContexts() {
+	for (uint i = 0; i < _renderThreadContexts.size(); i++) {
+		GLContext *c = _renderThreadContexts[i];
+		gl_free(c->vertex);
+		delete c->fb;
+		delete c;
+	}
+	_renderThreadContexts.clear();
+}
+
 void presentBuffer(Common::List<Common::Rect> &dirtyAreas) {
 	GLContext *c = gl_get_context();
 	if (c->_enableDirtyRectangles) {
@@ -294,8 +412,8 @@ RasterizationDrawCall::RasterizationDrawCall() : DrawCall(DrawCall_Rasterization
 	_drawTriangleFront = c->draw_triangle_front;
 	_drawTriangleBack = c->draw_triangle_back;
 	memcpy(_vertex, c->vertex, sizeof(GLVertex) * _vertexCount);
-	_state = captureState();
-	if (c->_enableDirtyRectangles) {
+	_state = captureState(c);
+	if (c->needsDirtyRegions()) {
 		computeDirtyRegion();
 	}
 }
@@ -338,14 +456,22 @@ void RasterizationDrawCall::execute(bool restoreState) const {
 
 	RasterizationDrawCall::RasterizationState backupState;
 	if (restoreState) {
-		backupState = captureState();
+		backupState = captureState(c);
 	}
-	applyState(_state);
+	applyState(c, _state);
+
+	draw(c, _vertex);
 
+	if (restoreState) {
+		applyState(c, backupState);
+	}
+}
+
+void RasterizationDrawCall::draw(GLContext *c, GLVertex *vertex) const {
 	GLVertex *prevVertex = c->vertex;
 	int prevVertexCount = c->vertex_cnt;
 
-	c->vertex = _vertex;
+	c->vertex = vertex;
 	c->vertex_cnt = _vertexCount;
 	c->draw_triangle_front = (gl_draw_triangle_func)_drawTriangleFront;
 	c->draw_triangle_back = (gl_draw_triangle_func)_drawTriangleBack;
@@ -427,15 +553,10 @@ void RasterizationDrawCall::execute(bool restoreState) const {
 
 	c->vertex = prevVertex;
 	c->vertex_cnt = prevVertexCount;
-
-	if (restoreState) {
-		applyState(backupState);
-	}
 }
 
-RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState() const {
+RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState(GLContext *c) const {
 	RasterizationState state;
-	GLContext *c = gl_get_context();
 	state.enableBlending = c->blending_enabled;
 	state.sfactor = c->source_blending_factor;
 	state.dfactor = c->destination_blending_factor;
@@ -484,8 +605,7 @@ RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState()
 	return state;
 }
 
-void RasterizationDrawCall::applyState(const RasterizationDrawCall::RasterizationState &state) const {
-	GLContext *c = gl_get_context();
+void RasterizationDrawCall::applyState(GLContext *c, const RasterizationDrawCall::RasterizationState &state) const {
 	c->fb->enableBlending(state.enableBlending);
 	c->fb->setBlendingFactors(state.sfactor, state.dfactor);
 	c->fb->enableAlphaTest(state.alphaTestEnabled);
@@ -553,6 +673,20 @@ void RasterizationDrawCall::execute(const Common::Rect &clippingRectangle, bool
 	c->fb->resetScissorRectangle();
 }
 
+void RasterizationDrawCall::execute(GLContext *c, const Common::Rect &clippingRectangle) const {
+	// Drawing changes some of the vertices, so every part of the screen is drawn from a copy
+	if (c->vertex_max < _vertexCount) {
+		c->vertex_max = _vertexCount;
+		c->vertex = (GLVertex *)gl_realloc(c->vertex, _vertexCount * sizeof(GLVertex));
+	}
+	memcpy(c->vertex, _vertex, sizeof(GLVertex) * _vertexCount);
+
+	applyState(c, _state);
+	c->fb->setScissorRectangle(clippingRectangle);
+	draw(c, c->vertex);
+	c->fb->resetScissorRectangle();
+}
+
 bool RasterizationDrawCall::operator==(const RasterizationDrawCall &other) const {
 	if (_vertexCount == other._vertexCount &&
 		_drawTriangleFront == other._drawTriangleFront &&
@@ -570,10 +704,11 @@ bool RasterizationDrawCall::operator==(const RasterizationDrawCall &other) const
 
 
 BlittingDrawCall::BlittingDrawCall(BlitImage *image, const BlitTransform &transform, BlittingMode blittingMode) : DrawCall(DrawCall_Blitting), _transform(transform), _mode(blittingMode), _image(image) {
+	GLContext *c = gl_get_context();
 	tglIncBlitImageRef(image);
-	_blitState = captureState();
+	_blitState = captureState(c);
 	_imageVersion = tglGetBlitImageVersion(image);
-	if (gl_get_context()->_enableDirtyRectangles) {
+	if (c->needsDirtyRegions()) {
 		computeDirtyRegion();
 	}
 }
@@ -583,28 +718,35 @@ BlittingDrawCall::~BlittingDrawCall() {
 }
 
 void BlittingDrawCall::execute(bool restoreState) const {
+	GLContext *c = gl_get_context();
+
 	BlittingState backupState;
 	if (restoreState) {
-		backupState = captureState();
+		backupState = captureState(c);
 	}
-	applyState(_blitState);
+	applyState(c, _blitState);
+
+	blit(c);
 
+	if (restoreState) {
+		applyState(c, backupState);
+	}
+}
+
+void BlittingDrawCall::blit(GLContext *c) const {
 	switch (_mode) {
 	case BlittingDrawCall::BlitMode_Regular:
-		Internal::tglBlit(_image, _transform);
+		Internal::tglBlit(c, _image, _transform);
 		break;
 	case BlittingDrawCall::BlitMode_Fast:
-		Internal::tglBlitFast(_image, _transform._destinationRectangle.left, _transform._destinationRectangle.top);
+		Internal::tglBlitFast(c, _image, _transform._destinationRectangle.left, _transform._destinationRectangle.top);
 		break;
 	case BlittingDrawCall::BlitMode_ZBuffer:
-		Internal::tglBlitZBuffer(_image, _transform._destinationRectangle.left, _transform._destinationRectangle.top);
+		Internal::tglBlitZBuffer(c, _image, _transform._destinationRectangle.left, _transform._destinationRectangle.top);
 		break;
 	default:
 		break;
 	}
-	if (restoreState) {
-		applyState(backupState);
-	}
 }
 
 void BlittingDrawCall::execute(const Common::Rect &clippingRectangle, bool restoreState) const {
@@ -613,9 +755,15 @@ void BlittingDrawCall::execute(const Common::Rect &clippingRectangle, bool resto
 	Internal::tglBlitResetScissorRect();
 }
 
-BlittingDrawCall::BlittingState BlittingDrawCall::captureState() const {
+void BlittingDrawCall::execute(GLContext *c, const Common::Rect &clippingRectangle) const {
+	applyState(c, _blitState);
+	c->_scissorRect = clippingRectangle;
+	blit(c);
+	c->_scissorRect = c->renderRect;
+}
+
+BlittingDrawCall::BlittingState BlittingDrawCall::captureState(GLContext *c) const {
 	BlittingState state;
-	TinyGL::GLContext *c = gl_get_context();
 	state.enableBlending = c->blending_enabled;
 	state.sfactor = c->source_blending_factor;
 	state.dfactor = c->destination_blending_factor;
@@ -626,8 +774,7 @@ BlittingDrawCall::BlittingState BlittingDrawCall::captureState() const {
 	return state;
 }
 
-void BlittingDrawCall::applyState(const BlittingState &state) const {
-	TinyGL::GLContext *c = gl_get_context();
+void BlittingDrawCall::applyState(GLContext *c, const BlittingState &state) const {
 	c->fb->enableBlending(state.enableBlending);
 	c->fb->setBlendingFactors(state.sfactor, state.dfactor);
 	c->fb->enableAlphaTest(state.alphaTest);
@@ -690,7 +837,7 @@ ClearBufferDrawCall::ClearBufferDrawCall(bool clearZBuffer, int zValue,
 	  _rValue(rValue), _gValue(gValue), _bValue(bValue), _clearStencilBuffer(clearStencilBuffer),
 	  _stencilValue(stencilValue), DrawCall(DrawCall_Clear) {
 	TinyGL::GLContext *c = gl_get_context();
-	if (c->_enableDirtyRectangles) {
+	if (c->needsDirtyRegions()) {
 		_dirtyRegion = c->renderRect;
 	}
 }
@@ -708,6 +855,12 @@ void ClearBufferDrawCall::execute(const Common::Rect &clippingRectangle, bool re
 	                   _clearStencilBuffer, _stencilValue);
 }
 
+void ClearBufferDrawCall::execute(GLContext *c, const Common::Rect &clippingRectangle) const {
+	c->fb->clearRegion(clippingRectangle.left, clippingRectangle.top, clippingRectangle.width(), clippingRectangle.height(),
+	                   _clearZBuffer, _zValue, _clearColorBuffer, _rValue, _gValue, _bValue,
+	                   _clearStencilBuffer, _stencilValue);
+}
+
 bool ClearBufferDrawCall::operator==(const ClearBufferDrawCall &other) const {
 	return
 		_clearZBuffer == other._clearZBuffer &&
@@ -55,6 +55,10 @@ public:
 	}
 	virtual void execute(bool restoreState) const = 0;
 	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const = 0;
+	// Executes the draw call with another context that draws to the same frame buffer,
+	// used for rendering parts of the frame buffer on several threads. The state of
+	// that context is not restored.
+	virtual void execute(GLContext *c, const Common::Rect &clippingRectangle) const = 0;
 	DrawCallType getType() const { return _type; }
 	virtual const Common::Rect getDirtyRegion() const { return _dirtyRegion; }
 protected:
@@ -70,6 +74,7 @@ public:
 	bool operator==(const ClearBufferDrawCall &other) const;
 	virtual void execute(bool restoreState) const;
 	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual void execute(GLContext *c, const Common::Rect &clippingRectangle) const;
 
 	void *operator new(size_t size) {
 		return Internal::allocateFrame(size);
@@ -89,6 +94,7 @@ public:
 	bool operator==(const RasterizationDrawCall &other) const;
 	virtual void execute(bool restoreState) const;
 	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual void execute(GLContext *c, const Common::Rect &clippingRectangle) const;
 
 	void *operator new(size_t size) {
 		return Internal::allocateFrame(size);
@@ -97,6 +103,7 @@ public:
 	void operator delete(void *p) { }
 private:
 	void computeDirtyRegion();
+	void draw(GLContext *c, GLVertex *vertex) const;
 	typedef void (*gl_draw_triangle_func_ptr)(GLContext *c, TinyGL::GLVertex *p0, TinyGL::GLVertex *p1, TinyGL::GLVertex *p2);
 	int _vertexCount;
 	GLVertex *_vertex;
@@ -150,8 +157,8 @@ private:
 
 	RasterizationState _state;
 
-	RasterizationState captureState() const;
-	void applyState(const RasterizationState &state) const;
+	RasterizationState captureState(GLContext *c) const;
+	void applyState(GLContext *c, const RasterizationState &state) const;
 };
 
 // Encapsulate a blit call: it might execute either a color buffer or z buffer blit.
@@ -168,6 +175,7 @@ public:
 	bool operator==(const BlittingDrawCall &other) const;
 	virtual void execute(bool restoreState) const;
 	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual void execute(GLContext *c, const Common::Rect &clippingRectangle) const;
 
 	BlittingMode getBlittingMode() const { return _mode; }
 
@@ -178,6 +186,7 @@ public:
 	void operator delete(void *p) { }
 private:
 	void computeDirtyRegion();
+	void blit(GLContext *c) const;
 	BlitImage *_image;
 	BlitTransform _transform;
 	BlittingMode _mode;
@@ -202,8 +211,8 @@ private:
 		}
 	};
 
-	BlittingState captureState() const;
-	void applyState(const BlittingState &state) const;
+	BlittingState captureState(GLContext *c) const;
+	void applyState(GLContext *c, const BlittingState &state) const;
 
 	BlittingState _blitState;
 };
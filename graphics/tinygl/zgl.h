@@ -463,6 +463,10 @@ struct GLContext {
 	bool _debugRectsEnabled;
 	bool _profilingEnabled;
 
+	// Rendering of the draw calls on several threads
+	int _renderThreads;
+	Common::Array<GLContext *> _renderThreadContexts;
+
 	void gl_vertex_transform(GLVertex *v);
 	void gl_calc_fog_factor(GLVertex *v);
 
@@ -519,6 +523,10 @@ public:
 
 	void presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas);
 	void presentBufferSimple(Common::List<Common::Rect> &dirtyAreas);
+	bool canExecuteDrawCallsInParallel() const;
+	bool needsDirtyRegions() const { return _enableDirtyRectangles || _renderThreads > 1; }
+	void executeDrawCallsInParallel(const Common::Array<Common::Rect> &areas);
+	void disposeRenderThreadContexts();
 
 	void debugDrawRectangle(Common::Rect rect, int r, int g, int b);
 
@@ -0,0 +1,315 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+#include <immintrin.h>
+
+#include "graphics/tinygl/gl.h"
+#include "graphics/tinygl/texelbuffer.h"
+#include "graphics/tinygl/zspan.h"
+
+namespace TinyGL {
+
+static FORCEINLINE __m128i sse2_ramp(uint value, int step) {
+	return _mm_setr_epi32(value, value + step, value + 2 * step, value + 3 * step);
+}
+
+static FORCEINLINE __m128i sse2_select(__m128i mask, __m128i a, __m128i b) {
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static FORCEINLINE __m128i sse2_not(__m128i a) {
+	return _mm_xor_si128(a, _mm_set1_epi32(-1));
+}
+
+// Same as FrameBuffer::compareDepth(), on unsigned values
+static FORCEINLINE __m128i sse2_compareDepth(int func, __m128i zSrc, __m128i zDst) {
+	const __m128i sign = _mm_set1_epi32((int)0x80000000);
+	zSrc = _mm_xor_si128(zSrc, sign);
+	zDst = _mm_xor_si128(zDst, sign);
+	switch (func) {
+	case TGL_LESS:
+		return _mm_cmpgt_epi32(zSrc, zDst);
+	case TGL_EQUAL:
+		return _mm_cmpeq_epi32(zDst, zSrc);
+	case TGL_LEQUAL:
+		return sse2_not(_mm_cmpgt_epi32(zDst, zSrc));
+	case TGL_GREATER:
+		return _mm_cmpgt_epi32(zDst, zSrc);
+	case TGL_NOTEQUAL:
+		return sse2_not(_mm_cmpeq_epi32(zDst, zSrc));
+	case TGL_GEQUAL:
+		return sse2_not(_mm_cmpgt_epi32(zSrc, zDst));
+	case TGL_ALWAYS:
+		return _mm_set1_epi32(-1);
+	default:
+		return _mm_setzero_si128();
+	}
+}
+
+// Same as FrameBuffer::checkAlphaTest()
+static FORCEINLINE __m128i sse2_checkAlphaTest(int func, int ref, __m128i aSrc) {
+	const __m128i refVal = _mm_set1_epi32(ref);
+	switch (func) {
+	case TGL_LESS:
+		return _mm_cmplt_epi32(aSrc, refVal);
+	case TGL_EQUAL:
+		return _mm_cmpeq_epi32(aSrc, refVal);
+	case TGL_LEQUAL:
+		return sse2_not(_mm_cmpgt_epi32(aSrc, refVal));
+	case TGL_GREATER:
+		return _mm_cmpgt_epi32(aSrc, refVal);
+	case TGL_NOTEQUAL:
+		return sse2_not(_mm_cmpeq_epi32(aSrc, refVal));
+	case TGL_GEQUAL:
+		return sse2_not(_mm_cmplt_epi32(aSrc, refVal));
+	case TGL_ALWAYS:
+		return _mm_set1_epi32(-1);
+	default:
+		return _mm_setzero_si128();
+	}
+}
+
+static FORCEINLINE __m128i sse2_channel(__m128i color, int shift) {
+	return _mm_and_si128(_mm_srl_epi32(color, _mm_cvtsi32_si128(shift)), _mm_set1_epi32(0xFF));
+}
+
+// Frame buffer pixels to 0xAARRGGBB, like PixelFormat::colorToARGB()
+static FORCEINLINE __m128i sse2_toARGB(const SpanState &state, __m128i color) {
+	__m128i a = state.hasAlpha ? sse2_channel(color, state.aShift) : _mm_set1_epi32(0xFF);
+	__m128i r = sse2_channel(color, state.rShift);
+	__m128i g = sse2_channel(color, state.gShift);
+	__m128i b = sse2_channel(color, state.bShift);
+	return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(a, 24), _mm_slli_epi32(r, 16)),
+	                    _mm_or_si128(_mm_slli_epi32(g, 8), b));
+}
+
+// 0xAARRGGBB to frame buffer pixels, like PixelFormat::ARGBToColor()
+static FORCEINLINE __m128i sse2_fromARGB(const SpanState &state, __m128i color) {
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	__m128i r = _mm_sll_epi32(_mm_and_si128(_mm_srli_epi32(color, 16), mask), _mm_cvtsi32_si128(state.rShift));
+	__m128i g = _mm_sll_epi32(_mm_and_si128(_mm_srli_epi32(color, 8), mask), _mm_cvtsi32_si128(state.gShift));
+	__m128i b = _mm_sll_epi32(_mm_and_si128(color, mask), _mm_cvtsi32_si128(state.bShift));
+	__m128i result = _mm_or_si128(r, _mm_or_si128(g, b));
+	if (state.hasAlpha)
+		result = _mm_or_si128(result, _mm_sll_epi32(_mm_srli_epi32(color, 24), _mm_cvtsi32_si128(state.aShift)));
+	return result;
+}
+
+// (x * f) >> 8 on 16 bit channels
+static FORCEINLINE __m128i sse2_scale(__m128i x, __m128i f) {
+	return _mm_srli_epi16(_mm_mullo_epi16(x, f), 8);
+}
+
+static FORCEINLINE __m128i sse2_broadcastAlpha(__m128i x) {
+	return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+// Same as the blending in FrameBuffer::writePixel(), for two pixels with 16 bit channels
+static FORCEINLINE __m128i sse2_blend(const SpanState &state, __m128i src, __m128i dst) {
+	const __m128i full = _mm_set1_epi16(255);
+	const __m128i srcA = sse2_broadcastAlpha(src);
+	const __m128i dstA = sse2_broadcastAlpha(dst);
+
+	switch (state.srcFactor) {
+	case TGL_ZERO:
+		src = _mm_setzero_si128();
+		break;
+	case TGL_DST_COLOR:
+		src = sse2_scale(dst, src);
+		break;
+	case TGL_ONE_MINUS_DST_COLOR:
+		src = sse2_scale(src, _mm_sub_epi16(full, dst));
+		break;
+	case TGL_SRC_ALPHA:
+		src = sse2_scale(src, srcA);
+		break;
+	case TGL_ONE_MINUS_SRC_ALPHA:
+		src = sse2_scale(src, _mm_sub_epi16(full, srcA));
+		break;
+	case TGL_DST_ALPHA:
+		src = sse2_scale(src, dstA);
+		break;
+	case TGL_ONE_MINUS_DST_ALPHA:
+		src = sse2_scale(src, _mm_sub_epi16(full, dstA));
+		break;
+	default:
+		break;
+	}
+
+	// TGL_SRC_ALPHA_SATURATE is left to the generic code
+	switch (state.dstFactor) {
+	case TGL_ZERO:
+		dst = _mm_setzero_si128();
+		break;
+	case TGL_DST_COLOR:
+		dst = sse2_scale(dst, src);
+		break;
+	case TGL_ONE_MINUS_DST_COLOR:
+		dst = sse2_scale(dst, _mm_sub_epi16(full, src));
+		break;
+	case TGL_SRC_ALPHA:
+		dst = sse2_scale(dst, srcA);
+		break;
+	case TGL_ONE_MINUS_SRC_ALPHA:
+		dst = sse2_scale(dst, _mm_sub_epi16(full, srcA));
+		break;
+	case TGL_DST_ALPHA:
+		dst = sse2_scale(dst, dstA);
+		break;
+	case TGL_ONE_MINUS_DST_ALPHA:
+		dst = sse2_scale(dst, _mm_sub_epi16(full, dstA));
+		break;
+	default:
+		break;
+	}
+
+	return _mm_adds_epu8(src, dst);
+}
+
+template<int kFlags>
+static FORCEINLINE void drawPixelsSSE2(const SpanState &state, uint32 *pbuf, uint *pz, __m128i mask,
+                                       __m128i z, __m128i r, __m128i g, __m128i b, __m128i a,
+                                       int s, int t, int dsdx, int dtdx) {
+	const __m128i zDst = _mm_loadu_si128((const __m128i *)pz);
+	if (kFlags & kSpanDepthTest)
+		mask = _mm_and_si128(mask, sse2_compareDepth(state.depthFunc, z, zDst));
+	int pass = _mm_movemask_ps(_mm_castsi128_ps(mask));
+	if (!pass)
+		return;
+
+	if (kFlags & kSpanDepthOnly) {
+		if (kFlags & kSpanDepthWrite)
+			_mm_storeu_si128((__m128i *)pz, sse2_select(mask, z, zDst));
+		return;
+	}
+
+	// The interpolated colors, as bytes
+	__m128i color = _mm_or_si128(
+		_mm_or_si128(_mm_and_si128(_mm_slli_epi32(a, 16), _mm_set1_epi32((int)0xFF000000)),
+		             _mm_and_si128(_mm_slli_epi32(r, 8), _mm_set1_epi32(0x00FF0000))),
+		_mm_or_si128(_mm_and_si128(g, _mm_set1_epi32(0x0000FF00)),
+		             _mm_and_si128(_mm_srli_epi32(b, 8), _mm_set1_epi32(0x000000FF))));
+
+	if (kFlags & kSpanTexture) {
+		// Only fetch the texels which are going to be drawn
+		uint32 texels[4];
+		for (int i = 0; i < 4; i++) {
+			if (pass & (1 << i)) {
+				uint8 c_a, c_r, c_g, c_b;
+				state.texture->getARGBAt(state.wrapS, state.wrapT, s + i * dsdx, t + i * dtdx, c_a, c_r, c_g, c_b);
+				texels[i] = (c_a << 24) | (c_r << 16) | (c_g << 8) | c_b;
+			} else {
+				texels[i] = 0;
+			}
+		}
+
+		// Lighting keeps the low 8 bits of (texel * (color >> 8)) >> 8,
+		// for which the low 16 bits of color >> 8 are enough
+		const __m128i mask16 = _mm_set1_epi32(0xFFFF);
+		__m128i lightBG = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(b, 8), mask16), _mm_slli_epi32(_mm_srli_epi32(g, 8), 16));
+		__m128i lightRA = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(r, 8), mask16), _mm_slli_epi32(_mm_srli_epi32(a, 8), 16));
+		__m128i texel = _mm_loadu_si128((const __m128i *)texels);
+		__m128i lo = sse2_scale(_mm_unpacklo_epi8(texel, _mm_setzero_si128()), _mm_unpacklo_epi32(lightBG, lightRA));
+		__m128i hi = sse2_scale(_mm_unpackhi_epi8(texel, _mm_setzero_si128()), _mm_unpackhi_epi32(lightBG, lightRA));
+		color = _mm_packus_epi16(lo, hi);
+	}
+
+	if (kFlags & kSpanAlphaTest) {
+		mask = _mm_and_si128(mask, sse2_checkAlphaTest(state.alphaFunc, state.alphaRef, _mm_srli_epi32(color, 24)));
+		if (!_mm_movemask_ps(_mm_castsi128_ps(mask)))
+			return;
+	}
+
+	if (kFlags & kSpanDepthWrite)
+		_mm_storeu_si128((__m128i *)pz, sse2_select(mask, z, zDst));
+
+	const __m128i dst = _mm_loadu_si128((const __m128i *)pbuf);
+	if (kFlags & kSpanBlending) {
+		const __m128i dstARGB = sse2_toARGB(state, dst);
+		__m128i lo = sse2_blend(state, _mm_unpacklo_epi8(color, _mm_setzero_si128()), _mm_unpacklo_epi8(dstARGB, _mm_setzero_si128()));
+		__m128i hi = sse2_blend(state, _mm_unpackhi_epi8(color, _mm_setzero_si128()), _mm_unpackhi_epi8(dstARGB, _mm_setzero_si128()));
+		// Blended pixels are opaque, as with PixelFormat::RGBToColor()
+		color = _mm_or_si128(_mm_packus_epi16(lo, hi), _mm_set1_epi32((int)0xFF000000));
+	}
+	_mm_storeu_si128((__m128i *)pbuf, sse2_select(mask, sse2_fromARGB(state, color), dst));
+}
+
+template<int kFlags>
+static void drawSpanSSE2(const SpanState &state, const Span &span) {
+	__m128i z = sse2_ramp(span.z, span.dzdx);
+	__m128i r = sse2_ramp(span.r, (kFlags & kSpanSmooth) ? span.drdx : 0);
+	__m128i g = sse2_ramp(span.g, (kFlags & kSpanSmooth) ? span.dgdx : 0);
+	__m128i b = sse2_ramp(span.b, (kFlags & kSpanSmooth) ? span.dbdx : 0);
+	__m128i a = sse2_ramp(span.a, (kFlags & kSpanSmooth) ? span.dadx : 0);
+	const __m128i dz = _mm_set1_epi32(4 * span.dzdx);
+	const __m128i dr = _mm_set1_epi32(4 * span.drdx);
+	const __m128i dg = _mm_set1_epi32(4 * span.dgdx);
+	const __m128i db = _mm_set1_epi32(4 * span.dbdx);
+	const __m128i da = _mm_set1_epi32(4 * span.dadx);
+	int s = span.s, t = span.t;
+
+	int i = 0;
+	for (; i + 4 <= span.count; i += 4) {
+		drawPixelsSSE2<kFlags>(state, span.pbuf + i, span.pz + i, _mm_set1_epi32(-1), z, r, g, b, a, s, t, span.dsdx, span.dtdx);
+		z = _mm_add_epi32(z, dz);
+		if (kFlags & kSpanSmooth) {
+			r = _mm_add_epi32(r, dr);
+			g = _mm_add_epi32(g, dg);
+			b = _mm_add_epi32(b, db);
+			a = _mm_add_epi32(a, da);
+		}
+		s += 4 * span.dsdx;
+		t += 4 * span.dtdx;
+	}
+
+	// The last pixels go through a copy, so that nothing past the end of the span is touched
+	int left = span.count - i;
+	if (left > 0) {
+		uint32 pbuf[4];
+		uint pz[4];
+		memcpy(pbuf, span.pbuf + i, left * sizeof(uint32));
+		memcpy(pz, span.pz + i, left * sizeof(uint));
+		const __m128i mask = _mm_cmpgt_epi32(_mm_set1_epi32(left), _mm_setr_epi32(0, 1, 2, 3));
+		drawPixelsSSE2<kFlags>(state, pbuf, pz, mask, z, r, g, b, a, s, t, span.dsdx, span.dtdx);
+		memcpy(span.pbuf + i, pbuf, left * sizeof(uint32));
+		memcpy(span.pz + i, pz, left * sizeof(uint));
+	}
+}
+
+template<int kFlags>
+struct SpanTableSSE2 : public SpanTableSSE2<kFlags - 1> {
+	SpanTableSSE2() {
+		this->table[kFlags] = drawSpanSSE2<kFlags>;
+	}
+};
+
+template<>
+struct SpanTableSSE2<-1> {
+	SpanFunc table[kSpanFlagCount];
+};
+
+SpanFunc SpanKernels::getSSE2(int flags) {
+	static const SpanTableSSE2<kSpanFlagCount - 1> kernels;
+	return kernels.table[flags];
+}
+
+} // end of namespace TinyGL
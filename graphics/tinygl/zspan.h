@@ -0,0 +1,112 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_TINYGL_ZSPAN_H
+#define GRAPHICS_TINYGL_ZSPAN_H
+
+#include "common/scummsys.h"
+
+namespace TinyGL {
+
+class TexelBuffer;
+
+/**
+ * The state shared by all the spans of a triangle. Colors are written to a
+ * 32 bits per pixel frame buffer with 8 bits per channel, the alpha channel
+ * being optional.
+ */
+struct SpanState {
+	int depthFunc;
+	int alphaFunc, alphaRef;
+	int srcFactor, dstFactor;
+	int aShift, rShift, gShift, bShift;
+	bool hasAlpha;
+	const TexelBuffer *texture;
+	uint wrapS, wrapT;
+};
+
+/**
+ * A horizontal run of pixels, which lies completely within the scissor
+ * rectangle. The values are those of the first pixel.
+ */
+struct Span {
+	uint32 *pbuf;
+	uint *pz;
+	int count;
+	uint z, r, g, b, a;
+	int s, t;
+	int dzdx, drdx, dgdx, dbdx, dadx, dsdx, dtdx;
+
+	void advance(int n) {
+		pbuf += n;
+		pz += n;
+		z += n * dzdx;
+		r += n * drdx;
+		g += n * dgdx;
+		b += n * dbdx;
+		a += n * dadx;
+		s += n * dsdx;
+		t += n * dtdx;
+	}
+};
+
+/**
+ * Flags selecting a span kernel, matching the FrameBuffer::fillTriangle()
+ * template parameters. Fog and stencil are always drawn per pixel.
+ */
+enum {
+	kSpanDepthOnly  = 1 << 0,
+	kSpanDepthTest  = 1 << 1,
+	kSpanDepthWrite = 1 << 2,
+	kSpanSmooth     = 1 << 3,
+	kSpanTexture    = 1 << 4,
+	kSpanAlphaTest  = 1 << 5,
+	kSpanBlending   = 1 << 6,
+	kSpanFlagCount  = 1 << 7
+};
+
+typedef void (*SpanFunc)(const SpanState &state, const Span &span);
+
+/**
+ * Vector versions of the inner loop of FrameBuffer::fillTriangle(), which
+ * give the same result as drawing the pixels one by one.
+ */
+class SpanKernels {
+public:
+	typedef SpanFunc (*GetFunc)(int flags);
+
+	/** Returns the kernel for the kSpan* flags, or nullptr to draw per pixel. */
+	static SpanFunc get(int flags);
+
+	/** Selected on first use, set it to nullptr to select it again. */
+	static GetFunc getFunc;
+
+	static SpanFunc getNone(int flags) {
+		return nullptr;
+	}
+#ifdef SCUMMVM_SSE2
+	static SpanFunc getSSE2(int flags);
+#endif
+};
+
+} // end of namespace TinyGL
+
+#endif
@@ -26,6 +26,7 @@
  */
 
 #include "common/endian.h"
+#include "common/system.h"
 #include "graphics/tinygl/texelbuffer.h"
 #include "graphics/tinygl/zbuffer.h"
 #include "graphics/tinygl/zgl.h"
@@ -39,26 +40,23 @@ void FrameBuffer::putPixelNoTexture(int fbOffset, uint *pz, byte *ps, int _a,
                                     int x, int y, uint &z, uint &r, uint &g, uint &b, uint &a,
                                     int &dzdx, int &drdx, int &dgdx, int &dbdx, uint dadx,
                                     uint &fog, int fog_r, int fog_g, int fog_b, int &dfdx) {
-	if (kEnableScissor && scissorPixel(x + _a, y)) {
-		return;
-	}
-	if (kStencilEnabled) {
+	// the values are interpolated across the pixels which are not drawn as well
+	bool pass = !kEnableScissor || !scissorPixel(x + _a, y);
+	if (kStencilEnabled && pass) {
 		bool stencilResult = stencilTest(ps[_a]);
 		if (!stencilResult) {
 			stencilOp(false, true, ps + _a);
-			return;
+			pass = false;
+		} else {
+			if (kDepthTestEnabled) {
+				pass = compareDepth(z, pz[_a]);
+			}
+			stencilOp(true, pass, ps + _a);
 		}
+	} else if (kDepthTestEnabled && pass) {
+		pass = compareDepth(z, pz[_a]);
 	}
-	bool depthTestResult;
-	if (kDepthTestEnabled) {
-		depthTestResult = compareDepth(z, pz[_a]);
-	} else {
-		depthTestResult = true;
-	}
-	if (kStencilEnabled) {
-		stencilOp(true, depthTestResult, ps + _a);
-	}
-	if (depthTestResult) {
+	if (pass) {
 		writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite, kFogMode>
 		          (fbOffset + _a, a >> (ZB_POINT_ALPHA_BITS - 8), r >> (ZB_POINT_RED_BITS - 8), g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8),
 		          z, fog, fog_r, fog_g, fog_b);
@@ -82,26 +80,23 @@ void FrameBuffer::putPixelTexture(int fbOffset, const TexelBuffer *texture,
                                   uint &r, uint &g, uint &b, uint &a,
                                   int &dzdx, int &dsdx, int &dtdx, int &drdx, int &dgdx, int &dbdx, uint dadx,
                                   uint &fog, int fog_r, int fog_g, int fog_b, int &dfdx) {
-	if (kEnableScissor && scissorPixel(x + _a, y)) {
-		return;
-	}
-	if (kStencilEnabled) {
+	// the values are interpolated across the pixels which are not drawn as well
+	bool pass = !kEnableScissor || !scissorPixel(x + _a, y);
+	if (kStencilEnabled && pass) {
 		bool stencilResult = stencilTest(ps[_a]);
 		if (!stencilResult) {
 			stencilOp(false, true, ps + _a);
-			return;
+			pass = false;
+		} else {
+			if (kDepthTestEnabled) {
+				pass = compareDepth(z, pz[_a]);
+			}
+			stencilOp(true, pass, ps + _a);
 		}
+	} else if (kDepthTestEnabled && pass) {
+		pass = compareDepth(z, pz[_a]);
 	}
-	bool depthTestResult;
-	if (kDepthTestEnabled) {
-		depthTestResult = compareDepth(z, pz[_a]);
-	} else {
-		depthTestResult = true;
-	}
-	if (kStencilEnabled) {
-		stencilOp(true, depthTestResult, ps + _a);
-	}
-	if (depthTestResult) {
+	if (pass) {
 		uint8 c_a, c_r, c_g, c_b;
 		texture->getARGBAt(wrap_s, wrap_t, s, t, c_a, c_r, c_g, c_b);
 		if (kLightsMode) {
@@ -132,31 +127,101 @@ void FrameBuffer::putPixelTexture(int fbOffset, const TexelBuffer *texture,
 
 template <bool kDepthWrite, bool kEnableScissor, bool kStencilEnabled, bool kDepthTestEnabled>
 void FrameBuffer::putPixelDepth(uint *pz, byte *ps, int _a, int x, int y, uint &z, int &dzdx) {
-	if (kEnableScissor && scissorPixel(x + _a, y)) {
-		return;
-	}
-	if (kStencilEnabled) {
+	// the values are interpolated across the pixels which are not drawn as well
+	bool pass = !kEnableScissor || !scissorPixel(x + _a, y);
+	if (kStencilEnabled && pass) {
 		bool stencilResult = stencilTest(ps[_a]);
 		if (!stencilResult) {
 			stencilOp(false, true, ps + _a);
-			return;
+			pass = false;
+		} else {
+			if (kDepthTestEnabled) {
+				pass = compareDepth(z, pz[_a]);
+			}
+			stencilOp(true, pass, ps + _a);
 		}
+	} else if (kDepthTestEnabled && pass) {
+		pass = compareDepth(z, pz[_a]);
 	}
-	bool depthTestResult;
-	if (kDepthTestEnabled) {
-		depthTestResult = compareDepth(z, pz[_a]);
-	} else {
-		depthTestResult = true;
-	}
-	if (kStencilEnabled) {
-		stencilOp(true, depthTestResult, ps + _a);
-	}
-	if (kDepthWrite && depthTestResult) {
+	if (kDepthWrite && pass) {
 		pz[_a] = z;
 	}
 	z += dzdx;
 }
 
+SpanKernels::GetFunc SpanKernels::getFunc = nullptr;
+
+SpanFunc SpanKernels::get(int flags) {
+	if (!getFunc) {
+		getFunc = getNone;
+#ifdef SCUMMVM_SSE2
+		if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) getFunc = getSSE2;
+#endif
+	}
+	return getFunc(flags);
+}
+
+template <bool kDepthOnly, bool kTexture, bool kSmoothMode, bool kDepthWrite, bool kEnableAlphaTest, bool kEnableBlending, bool kDepthTestEnabled>
+SpanFunc FrameBuffer::getSpanFunc(SpanState &state) {
+	if (_pbufBpp != 4 || _pbufFormat.rLoss || _pbufFormat.gLoss || _pbufFormat.bLoss ||
+	    (_pbufFormat.aLoss != 0 && _pbufFormat.aLoss != 8))
+		return nullptr;
+	if (!kDepthOnly && kEnableBlending && _destinationBlendingFactor == TGL_SRC_ALPHA_SATURATE)
+		return nullptr;
+
+	int flags = 0;
+	if (kDepthOnly)
+		flags |= kSpanDepthOnly;
+	if (kDepthTestEnabled)
+		flags |= kSpanDepthTest;
+	if (kDepthWrite)
+		flags |= kSpanDepthWrite;
+	if (!kDepthOnly) {
+		if (kSmoothMode)
+			flags |= kSpanSmooth;
+		if (kTexture)
+			flags |= kSpanTexture;
+		if (kEnableAlphaTest)
+			flags |= kSpanAlphaTest;
+		if (kEnableBlending)
+			flags |= kSpanBlending;
+	}
+
+	SpanFunc func = SpanKernels::get(flags);
+	if (func) {
+		state.depthFunc = _depthFunc;
+		state.alphaFunc = _alphaTestFunc;
+		state.alphaRef = _alphaTestRefVal;
+		state.srcFactor = _sourceBlendingFactor;
+		state.dstFactor = _destinationBlendingFactor;
+		state.aShift = _pbufFormat.aShift;
+		state.rShift = _pbufFormat.rShift;
+		state.gShift = _pbufFormat.gShift;
+		state.bShift = _pbufFormat.bShift;
+		state.hasAlpha = _pbufFormat.aLoss == 0;
+		state.texture = _currentTexture;
+		state.wrapS = _wrapS;
+		state.wrapT = _wrapT;
+	}
+	return func;
+}
+
+template <bool kEnableScissor>
+void FrameBuffer::drawSpan(SpanFunc func, const SpanState &state, Span &span, int x, int count) {
+	int first = 0, last = count;
+	if (kEnableScissor) {
+		first = MAX<int>(_clipRectangle.left - x, 0);
+		last = MIN<int>(_clipRectangle.right - x, count);
+	}
+	if (first < last) {
+		Span clipped = span;
+		clipped.advance(first);
+		clipped.count = last - first;
+		func(state, clipped);
+	}
+	span.advance(count);
+}
+
 template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, bool kSmoothMode,
           bool kDepthWrite, bool kFogMode, bool kAlphaTestEnabled, bool kEnableScissor,
           bool kBlendingEnabled, bool kStencilEnabled, bool kDepthTestEnabled>
@@ -207,6 +272,10 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		p2 = tp;
 	}
 
+	// nothing to draw when the triangle is above or below the scissor rectangle
+	if (kEnableScissor && (p2->y < _clipRectangle.top || p0->y >= _clipRectangle.bottom))
+		return;
+
 	// we compute dXdx and dXdy for all interpolated values
 
 	fdx1 = (float)(p1->x - p0->x);
@@ -325,6 +394,14 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		ndtzdx = NB_INTERP * dtzdx;
 	}
 
+	// the vector kernels draw whole spans, the per pixel code handles fog and stencil
+	SpanState spanState;
+	SpanFunc spanFunc = nullptr;
+	if (!kFogMode && !kStencilEnabled) {
+		spanFunc = getSpanFunc<!kInterpRGB, kInterpST || kInterpSTZ, kSmoothMode, kDepthWrite,
+		                       kAlphaTestEnabled, kBlendingEnabled, kDepthTestEnabled>(spanState);
+	}
+
 	if (fz0 > 0) {
 		l1 = p0;
 		l2 = p2;
@@ -424,7 +501,11 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		// we draw all the scan line of the part
 		while (nb_lines > 0) {
 			int x = x1;
-			if (!kInterpRGB) {
+			if (kEnableScissor && (y < _clipRectangle.top || y >= _clipRectangle.bottom)) {
+				// only follow the edges outside of the scissor rectangle
+				if (y >= _clipRectangle.bottom)
+					return;
+			} else if (!kInterpRGB) {
 				int n;
 				uint *pz;
 				byte *ps = nullptr;
@@ -437,6 +518,15 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 				if (kStencilEnabled) {
 					ps = ps1 + x1;
 				}
+				if (spanFunc) {
+					Span span = {};
+					span.pbuf = (uint32 *)_pbuf + (pz - _zbuf);
+					span.pz = pz;
+					span.z = z;
+					span.dzdx = dzdx;
+					drawSpan<kEnableScissor>(spanFunc, spanState, span, x, n + 1);
+					n = -1;
+				}
 				while (n >= 3) {
 					putPixelDepth<kDepthWrite, kEnableScissor, kStencilEnabled, kDepthTestEnabled>(pz, ps, 0, x, y, z, dzdx);
 					putPixelDepth<kDepthWrite, kEnableScissor, kStencilEnabled, kDepthTestEnabled>(pz, ps, 1, x, y, z, dzdx);
@@ -483,6 +573,25 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 				if (kStencilEnabled) {
 					ps = ps1 + x1;
 				}
+				if (spanFunc) {
+					Span span = {};
+					span.pbuf = (uint32 *)_pbuf + pp;
+					span.pz = pz;
+					span.z = z;
+					span.r = r;
+					span.g = g;
+					span.b = b;
+					span.a = a;
+					span.dzdx = dzdx;
+					if (kSmoothMode) {
+						span.drdx = drdx;
+						span.dgdx = dgdx;
+						span.dbdx = dbdx;
+						span.dadx = dadx;
+					}
+					drawSpan<kEnableScissor>(spanFunc, spanState, span, x, n + 1);
+					n = -1;
+				}
 				while (n >= 3) {
 					putPixelNoTexture<kDepthWrite, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
 					                 (pp, pz, ps, 0, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
@@ -545,6 +654,23 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 				g = g1;
 				b = b1;
 				a = a1;
+				Span span = {};
+				if (spanFunc) {
+					span.pbuf = (uint32 *)_pbuf + pp;
+					span.pz = pz;
+					span.z = z;
+					span.r = r;
+					span.g = g;
+					span.b = b;
+					span.a = a;
+					span.dzdx = dzdx;
+					if (kSmoothMode) {
+						span.drdx = drdx;
+						span.dgdx = dgdx;
+						span.dbdx = dbdx;
+						span.dadx = dadx;
+					}
+				}
 				while (n >= (NB_INTERP - 1)) {
 					{
 						float ss, tt;
@@ -557,9 +683,17 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 						fz += fndzdx;
 						zinv = (float)(1.0 / fz);
 					}
-					for (int _a = 0; _a < NB_INTERP; _a++) {
-						putPixelTexture<kDepthWrite, kInterpRGB, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
-						               (pp, texture, _wrapS, _wrapT, pz, ps, _a, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
+					if (spanFunc) {
+						span.s = s;
+						span.t = t;
+						span.dsdx = dsdx;
+						span.dtdx = dtdx;
+						drawSpan<kEnableScissor>(spanFunc, spanState, span, x, NB_INTERP);
+					} else {
+						for (int _a = 0; _a < NB_INTERP; _a++) {
+							putPixelTexture<kDepthWrite, kInterpRGB, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
+							               (pp, texture, _wrapS, _wrapT, pz, ps, _a, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
+						}
 					}
 					pp += NB_INTERP;
 					if (kInterpZ) {
@@ -584,6 +718,15 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 					dtdx = (int)((dtzdx - tt * fdzdx) * zinv);
 				}
 
+				if (spanFunc && n >= 0) {
+					span.s = s;
+					span.t = t;
+					span.dsdx = dsdx;
+					span.dtdx = dtdx;
+					drawSpan<kEnableScissor>(spanFunc, spanState, span, x, n + 1);
+					n = -1;
+				}
+
 				while (n >= 0) {
 					putPixelTexture<kDepthWrite, kInterpRGB, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
 					               (pp, texture, _wrapS, _wrapT, pz, ps, 0, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
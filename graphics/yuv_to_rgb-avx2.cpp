@@ -0,0 +1,169 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+#include <immintrin.h>
+
+#include "graphics/yuv_to_rgb_kernels.h"
+
+namespace Graphics {
+
+// Negate x where sign is all ones
+static FORCEINLINE __m256i avx2_applySign(__m256i x, __m256i sign) {
+	return _mm256_sub_epi16(_mm256_xor_si256(x, sign), sign);
+}
+
+static FORCEINLINE __m256i avx2_mulhi(__m256i x, int mul) {
+	return _mm256_mulhi_epu16(x, _mm256_set1_epi16((int16)mul));
+}
+
+// The red, green and blue offsets of the table lookups
+static FORCEINLINE void avx2_chromaOffsets(__m256i u, __m256i v, __m256i &r, __m256i &g, __m256i &b) {
+	const __m256i bias = _mm256_set1_epi16(128);
+	const __m256i cu = _mm256_sub_epi16(u, bias);
+	const __m256i cv = _mm256_sub_epi16(v, bias);
+	const __m256i su = _mm256_srai_epi16(cu, 15);
+	const __m256i sv = _mm256_srai_epi16(cv, 15);
+	const __m256i au = avx2_applySign(cu, su);
+	const __m256i av = avx2_applySign(cv, sv);
+
+	r = avx2_applySign(_mm256_add_epi16(av, avx2_mulhi(av, YUVToRGBKernels::kCrRMul)), sv);
+	b = avx2_applySign(_mm256_add_epi16(au, avx2_mulhi(au, YUVToRGBKernels::kCbBMul)), su);
+	g = _mm256_sub_epi16(_mm256_setzero_si256(),
+	                     _mm256_add_epi16(avx2_applySign(avx2_mulhi(av, YUVToRGBKernels::kCrGMul), sv),
+	                                      avx2_applySign(avx2_mulhi(au, YUVToRGBKernels::kCbGMul), su)));
+}
+
+template<bool kITU>
+static FORCEINLINE __m256i avx2_channel(__m256i y, __m256i offset) {
+	__m256i c = _mm256_add_epi16(y, offset);
+	if (kITU) {
+		c = _mm256_min_epi16(_mm256_max_epi16(c, _mm256_set1_epi16(16)), _mm256_set1_epi16(235));
+		c = _mm256_sub_epi16(c, _mm256_set1_epi16(16));
+		return avx2_mulhi(_mm256_add_epi16(c, c), YUVToRGBKernels::kITUMul);
+	}
+	return _mm256_min_epi16(_mm256_max_epi16(c, _mm256_setzero_si256()), _mm256_set1_epi16(255));
+}
+
+static FORCEINLINE __m256i avx2_place16(__m256i c, __m128i loss, __m128i shift) {
+	return _mm256_sll_epi16(_mm256_srl_epi16(c, loss), shift);
+}
+
+static FORCEINLINE __m256i avx2_place32(__m128i c, __m128i loss, __m128i shift) {
+	return _mm256_sll_epi32(_mm256_srl_epi32(_mm256_cvtepu16_epi32(c), loss), shift);
+}
+
+template<int kBytesPerPixel, bool kHalfChroma, bool kAlpha, bool kITU>
+static int avx2_convertRow(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc,
+                           int width, const YUVToRGBKernels::Format &format) {
+	const __m128i rLoss = _mm_cvtsi32_si128(format.rLoss), rShift = _mm_cvtsi32_si128(format.rShift);
+	const __m128i gLoss = _mm_cvtsi32_si128(format.gLoss), gShift = _mm_cvtsi32_si128(format.gShift);
+	const __m128i bLoss = _mm_cvtsi32_si128(format.bLoss), bShift = _mm_cvtsi32_si128(format.bShift);
+	const __m128i aLoss = _mm_cvtsi32_si128(format.aLoss), aShift = _mm_cvtsi32_si128(format.aShift);
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		const __m256i y = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(ySrc + x)));
+
+		__m128i u8, v8;
+		if (kHalfChroma) {
+			u8 = _mm_loadl_epi64((const __m128i *)(uSrc + x / 2));
+			v8 = _mm_loadl_epi64((const __m128i *)(vSrc + x / 2));
+			u8 = _mm_unpacklo_epi8(u8, u8);
+			v8 = _mm_unpacklo_epi8(v8, v8);
+		} else {
+			u8 = _mm_loadu_si128((const __m128i *)(uSrc + x));
+			v8 = _mm_loadu_si128((const __m128i *)(vSrc + x));
+		}
+
+		__m256i r, g, b;
+		avx2_chromaOffsets(_mm256_cvtepu8_epi16(u8), _mm256_cvtepu8_epi16(v8), r, g, b);
+		r = avx2_channel<kITU>(y, r);
+		g = avx2_channel<kITU>(y, g);
+		b = avx2_channel<kITU>(y, b);
+
+		__m256i a;
+		if (kAlpha)
+			a = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(aSrc + x)));
+
+		if (kBytesPerPixel == 2) {
+			__m256i pix = _mm256_or_si256(_mm256_or_si256(avx2_place16(r, rLoss, rShift), avx2_place16(g, gLoss, gShift)),
+			                              avx2_place16(b, bLoss, bShift));
+			if (kAlpha)
+				pix = _mm256_or_si256(pix, avx2_place16(a, aLoss, aShift));
+			else
+				pix = _mm256_or_si256(pix, _mm256_set1_epi16((int16)format.alpha));
+			_mm256_storeu_si256((__m256i *)(dst + x * 2), pix);
+		} else {
+			for (int half = 0; half < 2; half++) {
+				const __m128i r16 = half ? _mm256_extracti128_si256(r, 1) : _mm256_castsi256_si128(r);
+				const __m128i g16 = half ? _mm256_extracti128_si256(g, 1) : _mm256_castsi256_si128(g);
+				const __m128i b16 = half ? _mm256_extracti128_si256(b, 1) : _mm256_castsi256_si128(b);
+				__m256i pix = _mm256_or_si256(_mm256_or_si256(avx2_place32(r16, rLoss, rShift), avx2_place32(g16, gLoss, gShift)),
+				                              avx2_place32(b16, bLoss, bShift));
+				if (kAlpha) {
+					const __m128i a16 = half ? _mm256_extracti128_si256(a, 1) : _mm256_castsi256_si128(a);
+					pix = _mm256_or_si256(pix, avx2_place32(a16, aLoss, aShift));
+				} else {
+					pix = _mm256_or_si256(pix, _mm256_set1_epi32(format.alpha));
+				}
+				_mm256_storeu_si256((__m256i *)(dst + x * 4 + half * 32), pix);
+			}
+		}
+	}
+
+	return x;
+}
+
+template<int kBytesPerPixel, bool kHalfChroma>
+static int avx2_convertRow(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc,
+                           int width, const YUVToRGBKernels::Format &format) {
+	if (aSrc) {
+		if (format.itu)
+			return avx2_convertRow<kBytesPerPixel, kHalfChroma, true, true>(dst, ySrc, uSrc, vSrc, aSrc, width, format);
+		else
+			return avx2_convertRow<kBytesPerPixel, kHalfChroma, true, false>(dst, ySrc, uSrc, vSrc, aSrc, width, format);
+	} else {
+		if (format.itu)
+			return avx2_convertRow<kBytesPerPixel, kHalfChroma, false, true>(dst, ySrc, uSrc, vSrc, aSrc, width, format);
+		else
+			return avx2_convertRow<kBytesPerPixel, kHalfChroma, false, false>(dst, ySrc, uSrc, vSrc, aSrc, width, format);
+	}
+}
+
+int YUVToRGBKernels::convertRowAVX2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc,
+                                    int width, bool halfChroma, const Format &format) {
+	if (format.bytesPerPixel == 2) {
+		if (halfChroma)
+			return avx2_convertRow<2, true>(dst, ySrc, uSrc, vSrc, aSrc, width, format);
+		else
+			return avx2_convertRow<2, false>(dst, ySrc, uSrc, vSrc, aSrc, width, format);
+	} else if (format.bytesPerPixel == 4) {
+		if (halfChroma)
+			return avx2_convertRow<4, true>(dst, ySrc, uSrc, vSrc, aSrc, width, format);
+		else
+			return avx2_convertRow<4, false>(dst, ySrc, uSrc, vSrc, aSrc, width, format);
+	}
+
+	return 0;
+}
+
+} // End of namespace Graphics
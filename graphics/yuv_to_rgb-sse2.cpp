@@ -0,0 +1,173 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+#include "common/endian.h"
+#include <immintrin.h>
+
+#include "graphics/yuv_to_rgb_kernels.h"
+
+namespace Graphics {
+
+// Negate x where sign is all ones
+static FORCEINLINE __m128i sse2_applySign(__m128i x, __m128i sign) {
+	return _mm_sub_epi16(_mm_xor_si128(x, sign), sign);
+}
+
+static FORCEINLINE __m128i sse2_mulhi(__m128i x, int mul) {
+	return _mm_mulhi_epu16(x, _mm_set1_epi16((int16)mul));
+}
+
+// The red, green and blue offsets of the table lookups
+static FORCEINLINE void sse2_chromaOffsets(__m128i u, __m128i v, __m128i &r, __m128i &g, __m128i &b) {
+	const __m128i bias = _mm_set1_epi16(128);
+	const __m128i cu = _mm_sub_epi16(u, bias);
+	const __m128i cv = _mm_sub_epi16(v, bias);
+	const __m128i su = _mm_srai_epi16(cu, 15);
+	const __m128i sv = _mm_srai_epi16(cv, 15);
+	const __m128i au = sse2_applySign(cu, su);
+	const __m128i av = sse2_applySign(cv, sv);
+
+	r = sse2_applySign(_mm_add_epi16(av, sse2_mulhi(av, YUVToRGBKernels::kCrRMul)), sv);
+	b = sse2_applySign(_mm_add_epi16(au, sse2_mulhi(au, YUVToRGBKernels::kCbBMul)), su);
+	g = _mm_sub_epi16(_mm_setzero_si128(),
+	                  _mm_add_epi16(sse2_applySign(sse2_mulhi(av, YUVToRGBKernels::kCrGMul), sv),
+	                                sse2_applySign(sse2_mulhi(au, YUVToRGBKernels::kCbGMul), su)));
+}
+
+template<bool kITU>
+static FORCEINLINE __m128i sse2_channel(__m128i y, __m128i offset) {
+	__m128i c = _mm_add_epi16(y, offset);
+	if (kITU) {
+		c = _mm_min_epi16(_mm_max_epi16(c, _mm_set1_epi16(16)), _mm_set1_epi16(235));
+		c = _mm_sub_epi16(c, _mm_set1_epi16(16));
+		return sse2_mulhi(_mm_add_epi16(c, c), YUVToRGBKernels::kITUMul);
+	}
+	return _mm_min_epi16(_mm_max_epi16(c, _mm_setzero_si128()), _mm_set1_epi16(255));
+}
+
+static FORCEINLINE __m128i sse2_place16(__m128i c, __m128i loss, __m128i shift) {
+	return _mm_sll_epi16(_mm_srl_epi16(c, loss), shift);
+}
+
+static FORCEINLINE __m128i sse2_place32(__m128i c, __m128i loss, __m128i shift) {
+	return _mm_sll_epi32(_mm_srl_epi32(c, loss), shift);
+}
+
+template<int kBytesPerPixel, bool kHalfChroma, bool kAlpha, bool kITU>
+static int sse2_convertRow(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc,
+                           int width, const YUVToRGBKernels::Format &format) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rLoss = _mm_cvtsi32_si128(format.rLoss), rShift = _mm_cvtsi32_si128(format.rShift);
+	const __m128i gLoss = _mm_cvtsi32_si128(format.gLoss), gShift = _mm_cvtsi32_si128(format.gShift);
+	const __m128i bLoss = _mm_cvtsi32_si128(format.bLoss), bShift = _mm_cvtsi32_si128(format.bShift);
+	const __m128i aLoss = _mm_cvtsi32_si128(format.aLoss), aShift = _mm_cvtsi32_si128(format.aShift);
+
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		const __m128i y = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(ySrc + x)), zero);
+
+		__m128i u, v;
+		if (kHalfChroma) {
+			u = _mm_cvtsi32_si128(READ_UINT32(uSrc + x / 2));
+			v = _mm_cvtsi32_si128(READ_UINT32(vSrc + x / 2));
+			u = _mm_unpacklo_epi8(u, u);
+			v = _mm_unpacklo_epi8(v, v);
+		} else {
+			u = _mm_loadl_epi64((const __m128i *)(uSrc + x));
+			v = _mm_loadl_epi64((const __m128i *)(vSrc + x));
+		}
+		u = _mm_unpacklo_epi8(u, zero);
+		v = _mm_unpacklo_epi8(v, zero);
+
+		__m128i r, g, b;
+		sse2_chromaOffsets(u, v, r, g, b);
+		r = sse2_channel<kITU>(y, r);
+		g = sse2_channel<kITU>(y, g);
+		b = sse2_channel<kITU>(y, b);
+
+		__m128i a;
+		if (kAlpha)
+			a = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(aSrc + x)), zero);
+
+		if (kBytesPerPixel == 2) {
+			__m128i pix = _mm_or_si128(_mm_or_si128(sse2_place16(r, rLoss, rShift), sse2_place16(g, gLoss, gShift)),
+			                           sse2_place16(b, bLoss, bShift));
+			if (kAlpha)
+				pix = _mm_or_si128(pix, sse2_place16(a, aLoss, aShift));
+			else
+				pix = _mm_or_si128(pix, _mm_set1_epi16((int16)format.alpha));
+			_mm_storeu_si128((__m128i *)(dst + x * 2), pix);
+		} else {
+			for (int half = 0; half < 2; half++) {
+				const __m128i r32 = half ? _mm_unpackhi_epi16(r, zero) : _mm_unpacklo_epi16(r, zero);
+				const __m128i g32 = half ? _mm_unpackhi_epi16(g, zero) : _mm_unpacklo_epi16(g, zero);
+				const __m128i b32 = half ? _mm_unpackhi_epi16(b, zero) : _mm_unpacklo_epi16(b, zero);
+				__m128i pix = _mm_or_si128(_mm_or_si128(sse2_place32(r32, rLoss, rShift), sse2_place32(g32, gLoss, gShift)),
+				                           sse2_place32(b32, bLoss, bShift));
+				if (kAlpha) {
+					const __m128i a32 = half ? _mm_unpackhi_epi16(a, zero) : _mm_unpacklo_epi16(a, zero);
+					pix = _mm_or_si128(pix, sse2_place32(a32, aLoss, aShift));
+				} else {
+					pix = _mm_or_si128(pix, _mm_set1_epi32(format.alpha));
+				}
+				_mm_storeu_si128((__m128i *)(dst + x * 4 + half * 16), pix);
+			}
+		}
+	}
+
+	return x;
+}
+
+template<int kBytesPerPixel, bool kHalfChroma>
+static int sse2_convertRow(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc,
+                           int width, const YUVToRGBKernels::Format &format) {
+	if (aSrc) {
+		if (format.itu)
+			return sse2_convertRow<kBytesPerPixel, kHalfChroma, true, true>(dst, ySrc, uSrc, vSrc, aSrc, width, format);
+		else
+			return sse2_convertRow<kBytesPerPixel, kHalfChroma, true, false>(dst, ySrc, uSrc, vSrc, aSrc, width, format);
+	} else {
+		if (format.itu)
+			return sse2_convertRow<kBytesPerPixel, kHalfChroma, false, true>(dst, ySrc, uSrc, vSrc, aSrc, width, format);
+		else
+			return sse2_convertRow<kBytesPerPixel, kHalfChroma, false, false>(dst, ySrc, uSrc, vSrc, aSrc, width, format);
+	}
+}
+
+int YUVToRGBKernels::convertRowSSE2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc,
+                                    int width, bool halfChroma, const Format &format) {
+	if (format.bytesPerPixel == 2) {
+		if (halfChroma)
+			return sse2_convertRow<2, true>(dst, ySrc, uSrc, vSrc, aSrc, width, format);
+		else
+			return sse2_convertRow<2, false>(dst, ySrc, uSrc, vSrc, aSrc, width, format);
+	} else if (format.bytesPerPixel == 4) {
+		if (halfChroma)
+			return sse2_convertRow<4, true>(dst, ySrc, uSrc, vSrc, aSrc, width, format);
+		else
+			return sse2_convertRow<4, false>(dst, ySrc, uSrc, vSrc, aSrc, width, format);
+	}
+
+	return 0;
+}
+
+} // End of namespace Graphics
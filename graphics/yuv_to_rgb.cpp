@@ -84,6 +84,8 @@
 
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_kernels.h"
+#include "common/system.h"
 
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
@@ -99,10 +101,12 @@ public:
 	YUVToRGBManager::LuminanceScale getScale() const { return _scale; }
 	const uint32 *getRGBToPix() const { return _rgbToPix; }
 	const uint32 *getAlphaToPix() const { return _alphaToPix; }
+	const YUVToRGBKernels::Format &getKernelFormat() const { return _kernelFormat; }
 
 private:
 	Graphics::PixelFormat _format;
 	YUVToRGBManager::LuminanceScale _scale;
+	YUVToRGBKernels::Format _kernelFormat;
 	uint32 _rgbToPix[3 * 768]; // 9216 bytes
 	uint32 _alphaToPix[256];   // 958 bytes
 };
@@ -163,6 +167,56 @@ YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::Lu
 	for (int i = 0; i < 256; i++) {
 		_alphaToPix[i] = format.ARGBToColor(i, 0, 0, 0);
 	}
+
+	// The kernels compute the same values as the tables, as long as every
+	// channel fits into the pixel
+	_kernelFormat.bytesPerPixel = format.bytesPerPixel;
+	_kernelFormat.rLoss = format.rLoss;
+	_kernelFormat.gLoss = format.gLoss;
+	_kernelFormat.bLoss = format.bLoss;
+	_kernelFormat.aLoss = format.aLoss;
+	_kernelFormat.rShift = format.rShift;
+	_kernelFormat.gShift = format.gShift;
+	_kernelFormat.bShift = format.bShift;
+	_kernelFormat.aShift = format.aShift;
+	_kernelFormat.alpha = format.ARGBToColor(alphaValue, 0, 0, 0);
+	_kernelFormat.itu = (scale == YUVToRGBManager::kScaleITU);
+
+	const uint8 losses[4] = { format.rLoss, format.gLoss, format.bLoss, format.aLoss };
+	const uint8 shifts[4] = { format.rShift, format.gShift, format.bShift, format.aShift };
+	for (int i = 0; i < 4; i++) {
+		if (losses[i] < 8 && shifts[i] + 8 - losses[i] > format.bytesPerPixel * 8)
+			_kernelFormat.bytesPerPixel = 0;
+	}
+	if (format.bytesPerPixel != 2 && format.bytesPerPixel != 4)
+		_kernelFormat.bytesPerPixel = 0;
+}
+
+YUVToRGBKernels::ConvertRowFunc YUVToRGBKernels::convertRowFunc = nullptr;
+
+int YUVToRGBKernels::convertRowGeneric(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc,
+                                       int width, bool halfChroma, const Format &format) {
+	// The table lookups of the callers handle the whole row
+	return 0;
+}
+
+int YUVToRGBKernels::convertRow(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc,
+                                int width, bool halfChroma, const Format &format) {
+	// If no function has been selected yet, detect and select
+	if (!convertRowFunc) {
+		convertRowFunc = convertRowGeneric;
+#ifdef SCUMMVM_SSE2
+		if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) convertRowFunc = convertRowSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+		if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) convertRowFunc = convertRowAVX2;
+#endif
+	}
+
+	if (!format.bytesPerPixel)
+		return 0;
+
+	return convertRowFunc(dst, ySrc, uSrc, vSrc, aSrc, width, halfChroma, format);
 }
 
 YUVToRGBManager::YUVToRGBManager() {
@@ -216,7 +270,14 @@ void convertYUV444ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	const uint32 *rgbToPix = lookup->getRGBToPix();
 
 	for (int h = 0; h < yHeight; h++) {
-		for (int w = 0; w < yWidth; w++) {
+		// Convert what we can with the kernels, and the rest with the tables
+		int done = YUVToRGBKernels::convertRow(dstPtr, ySrc, uSrc, vSrc, nullptr, yWidth, false, lookup->getKernelFormat());
+		dstPtr += done * sizeof(PixelInt);
+		ySrc += done;
+		uSrc += done;
+		vSrc += done;
+
+		for (int w = done; w < yWidth; w++) {
 			const uint32 *L;
 
 			int16 cr_r  = Cr_r_tab[*vSrc];
@@ -264,7 +325,15 @@ void convertYUV422ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	const uint32 *rgbToPix = lookup->getRGBToPix();
 
 	for (int h = 0; h < yHeight; h++) {
-		for (int w = 0; w < halfWidth; w++) {
+		// Convert what we can with the kernels, and the rest with the tables.
+		// The kernels always convert an even number of pixels.
+		int done = YUVToRGBKernels::convertRow(dstPtr, ySrc, uSrc, vSrc, nullptr, yWidth, true, lookup->getKernelFormat());
+		dstPtr += done * sizeof(PixelInt);
+		ySrc += done;
+		uSrc += done >> 1;
+		vSrc += done >> 1;
+
+		for (int w = done >> 1; w < halfWidth; w++) {
 			const uint32 *L;
 
 			int16 cr_r  = Cr_r_tab[*vSrc];
@@ -317,7 +386,17 @@ void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	const uint32 *rgbToPix = lookup->getRGBToPix();
 
 	for (int h = 0; h < halfHeight; h++) {
-		for (int w = 0; w < halfWidth; w++) {
+		// Convert what we can of both rows with the kernels, and the rest
+		// with the tables. The kernels always convert an even number of pixels.
+		const YUVToRGBKernels::Format &kernelFormat = lookup->getKernelFormat();
+		int done = YUVToRGBKernels::convertRow(dstPtr, ySrc, uSrc, vSrc, nullptr, yWidth, true, kernelFormat);
+		YUVToRGBKernels::convertRow(dstPtr + dstPitch, ySrc + yPitch, uSrc, vSrc, nullptr, done, true, kernelFormat);
+		dstPtr += done * sizeof(PixelInt);
+		ySrc += done;
+		uSrc += done >> 1;
+		vSrc += done >> 1;
+
+		for (int w = done >> 1; w < halfWidth; w++) {
 			const uint32 *L;
 
 			int16 cr_r  = Cr_r_tab[*vSrc];
@@ -378,7 +457,18 @@ void convertYUVA420ToRGBA(byte *dstPtr, int dstPitch, const YUVToRGBLookup *look
 	const uint32 *aToPix = lookup->getAlphaToPix();
 
 	for (int h = 0; h < halfHeight; h++) {
-		for (int w = 0; w < halfWidth; w++) {
+		// Convert what we can of both rows with the kernels, and the rest
+		// with the tables. The kernels always convert an even number of pixels.
+		const YUVToRGBKernels::Format &kernelFormat = lookup->getKernelFormat();
+		int done = YUVToRGBKernels::convertRow(dstPtr, ySrc, uSrc, vSrc, aSrc, yWidth, true, kernelFormat);
+		YUVToRGBKernels::convertRow(dstPtr + dstPitch, ySrc + yPitch, uSrc, vSrc, aSrc + yPitch, done, true, kernelFormat);
+		dstPtr += done * sizeof(PixelInt);
+		ySrc += done;
+		aSrc += done;
+		uSrc += done >> 1;
+		vSrc += done >> 1;
+
+		for (int w = done >> 1; w < halfWidth; w++) {
 			const uint32 *L;
 
 			int16 cr_r  = Cr_r_tab[*vSrc];
@@ -434,20 +524,6 @@ void YUVToRGBManager::convert420Alpha(Graphics::Surface *dst, YUVToRGBManager::L
 	out = (out##A * (4 - xDiff) * (4 - yDiff) + out##B * xDiff * (4 - yDiff) + \
 			out##C * yDiff * (4 - xDiff) + out##D * xDiff * yDiff) >> 4
 
-#define DO_YUV410_PIXEL() \
-	DO_INTERPOLATION(u); \
-	DO_INTERPOLATION(v); \
-	\
-	cr_r  = Cr_r_tab[v]; \
-	crb_g = Cr_g_tab[v] + Cb_g_tab[u]; \
-	cb_b  = Cb_b_tab[u]; \
-	\
-	PUT_PIXEL(*ySrc, dstPtr); \
-	dstPtr += sizeof(PixelInt); \
-	\
-	ySrc++; \
-	xDiff++
-
 template<typename PixelInt>
 void convertYUV410ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
 	// Keep the tables in pointers here to avoid a dereference on each pixel
@@ -456,31 +532,54 @@ void convertYUV410ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	const int16 *Cb_g_tab = Cr_g_tab + 256;
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
 	const uint32 *rgbToPix = lookup->getRGBToPix();
+	const YUVToRGBKernels::Format &kernelFormat = lookup->getKernelFormat();
 
-	int quarterWidth = yWidth >> 2;
+	// The interpolated chroma values of a part of the row
+	const int kPartWidth = 256;
+	byte uPart[kPartWidth], vPart[kPartWidth];
 
 	for (int y = 0; y < yHeight; y++) {
-		for (int x = 0; x < quarterWidth; x++) {
-			// Perform bilinear interpolation on the chroma values
-			// Based on the algorithm found here: http://tech-algorithm.com/articles/bilinear-image-scaling/
-			// Feel free to optimize further
-			int targetY = y >> 2;
-			int xDiff = 0;
-			int yDiff = y & 3;
-			int index = targetY * uvPitch + x;
-
-			// Declare some variables for the following macros
-			byte u, v;
-			int16 cr_r, crb_g, cb_b;
-			const uint32 *L;
-
-			READ_QUAD(uSrc, u);
-			READ_QUAD(vSrc, v);
-
-			DO_YUV410_PIXEL();
-			DO_YUV410_PIXEL();
-			DO_YUV410_PIXEL();
-			DO_YUV410_PIXEL();
+		for (int partX = 0; partX < yWidth; partX += kPartWidth) {
+			int partWidth = MIN(kPartWidth, yWidth - partX);
+
+			for (int x = 0; x < partWidth; x += 4) {
+				// Perform bilinear interpolation on the chroma values
+				// Based on the algorithm found here: http://tech-algorithm.com/articles/bilinear-image-scaling/
+				// Feel free to optimize further
+				int targetY = y >> 2;
+				int yDiff = y & 3;
+				int index = targetY * uvPitch + ((partX + x) >> 2);
+
+				// Declare some variables for the following macros
+				byte u, v;
+
+				READ_QUAD(uSrc, u);
+				READ_QUAD(vSrc, v);
+
+				for (int xDiff = 0; xDiff < 4; xDiff++) {
+					DO_INTERPOLATION(u);
+					DO_INTERPOLATION(v);
+					uPart[x + xDiff] = u;
+					vPart[x + xDiff] = v;
+				}
+			}
+
+			// Convert what we can with the kernels, and the rest with the tables
+			int done = YUVToRGBKernels::convertRow(dstPtr, ySrc, uPart, vPart, nullptr, partWidth, false, kernelFormat);
+			dstPtr += done * sizeof(PixelInt);
+			ySrc += done;
+
+			for (int x = done; x < partWidth; x++) {
+				const uint32 *L;
+
+				int16 cr_r  = Cr_r_tab[vPart[x]];
+				int16 crb_g = Cr_g_tab[vPart[x]] + Cb_g_tab[uPart[x]];
+				int16 cb_b  = Cb_b_tab[uPart[x]];
+
+				PUT_PIXEL(*ySrc, dstPtr);
+				ySrc++;
+				dstPtr += sizeof(PixelInt);
+			}
 		}
 
 		dstPtr += dstPitch - yWidth * sizeof(PixelInt);
@@ -490,7 +589,6 @@ void convertYUV410ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 
 #undef READ_QUAD
 #undef DO_INTERPOLATION
-#undef DO_YUV410_PIXEL
 
 void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
 	// Sanity checks
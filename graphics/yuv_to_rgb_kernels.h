@@ -0,0 +1,106 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_YUV_TO_RGB_KERNELS_H
+#define GRAPHICS_YUV_TO_RGB_KERNELS_H
+
+#include "common/scummsys.h"
+
+class YUVToRGBTestSuite;
+
+namespace Graphics {
+
+/**
+ * Vector versions of the YUVToRGBManager conversions.
+ *
+ * Rather than looking up each channel in the tables, the chroma offsets are
+ * computed with fixed point multiplications which round in the same way as
+ * the tables, and the channels are shifted into place. The result is the
+ * same as with the tables.
+ *
+ * The functions dispatch at runtime to SSE2 or AVX2 versions when the CPU
+ * supports them, in the same way as BlendBlit does.
+ */
+class YUVToRGBKernels {
+public:
+	/** The destination pixel format, as prepared by YUVToRGBLookup. */
+	struct Format {
+		uint8 bytesPerPixel; ///< 2 or 4, or 0 if the kernels do not support the format
+		uint8 rLoss, gLoss, bLoss, aLoss;
+		uint8 rShift, gShift, bShift, aShift;
+		uint32 alpha;        ///< OR'ed into each pixel when there is no alpha plane
+		bool itu;            ///< Luminance values range from [16, 235] rather than [0, 255]
+	};
+
+	/**
+	 * Convert a run of pixels of a row.
+	 *
+	 * The vector versions process as many pixels as they can in full
+	 * vectors and leave the rest to the caller.
+	 *
+	 * @param dst         The first pixel of the run.
+	 * @param ySrc        The luminance values.
+	 * @param uSrc        The U values.
+	 * @param vSrc        The V values.
+	 * @param aSrc        The alpha values, or nullptr to use Format::alpha.
+	 * @param width       Number of pixels in the run.
+	 * @param halfChroma  Whether each U and V value covers two pixels.
+	 * @param format      The destination pixel format.
+	 * @return The number of pixels which have been converted.
+	 */
+	static int convertRow(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc,
+	                      int width, bool halfChroma, const Format &format);
+
+	/**
+	 * Fixed point factors of the chroma offsets, so that for c in [0, 128]
+	 * the table value (int16)(k * c) equals (c * kMul) >> 16, plus c for
+	 * factors above one. Negative values are mirrored.
+	 */
+	enum {
+		kCrRMul = 26285, ///< 0.419 / 0.299 - 1
+		kCrGMul = 46773, ///< 0.299 / 0.419
+		kCbGMul = 22568, ///< 0.114 / 0.331
+		kCbBMul = 50685, ///< 0.587 / 0.331 - 1
+		kITUMul = 38156  ///< ((x * 2) * kITUMul) >> 16 equals x * 255 / 219 for x in [0, 219]
+	};
+
+private:
+	typedef int (*ConvertRowFunc)(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc,
+	                              int width, bool halfChroma, const Format &format);
+
+	static int convertRowGeneric(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc,
+	                             int width, bool halfChroma, const Format &format);
+#ifdef SCUMMVM_SSE2
+	static int convertRowSSE2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc,
+	                          int width, bool halfChroma, const Format &format);
+#endif
+#ifdef SCUMMVM_AVX2
+	static int convertRowAVX2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc,
+	                          int width, bool halfChroma, const Format &format);
+#endif
+
+	static ConvertRowFunc convertRowFunc;
+	friend class ::YUVToRGBTestSuite;
+};
+
+} // End of namespace Graphics
+
+#endif
@@ -419,10 +419,12 @@ void LauncherDialog::massAddGame() {
 	MessageDialog alert(_("Do you really want to run the mass game detector? "
 						  "This could potentially add a huge number of games."), _("Yes"), _("No"));
 	if (alert.runModal() == GUI::kMessageOK && _browser->runModal() > 0) {
-		ADCacheMan.clear();
+		// Share the computed MD5s between all the scanned directories
+		ADCacheMan.beginBatch();
 		MassAddDialog massAddDlg(_browser->getResult());
 
 		massAddDlg.runModal();
+		ADCacheMan.endBatch();
 
 		// Update the ListWidget and force a redraw
 
@@ -172,7 +172,7 @@ void MassAddDialog::handleTickle() {
 		Common::FSNode dir = _scanStack.pop();
 
 		Common::FSList files;
-		if (!dir.getChildren(files, Common::FSNode::kListAll)) {
+		if (!ADCacheMan.getChildren(dir, files)) {
 			continue;
 		}
 
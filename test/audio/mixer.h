@@ -0,0 +1,83 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mixer_intern.h"
+
+#include "../null_osystem.h"
+#include "helper.h"
+
+class MixerTestSuite : public CxxTest::TestSuite {
+private:
+	static void mixSine(Audio::MixerImpl &mixer, int16 *output, uint numFrames) {
+		Audio::SeekableAudioStream *s = createSineStream<int16>(11025, 1, nullptr, false, true);
+		mixer.setReady(true);
+		mixer.playStream(Audio::Mixer::kPlainSoundType, nullptr, s, -1, 200, 30, DisposeAfterUse::YES, false, false);
+		mixer.mixCallback((byte *)output, numFrames * 4);
+	}
+
+public:
+	void test_mix_in_blocks() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		// Callbacks longer than the backend said are mixed in several blocks
+		// of the accumulation buffer, with the same result
+		const uint numFrames = 1000;
+		int16 *expected = new int16[numFrames * 2];
+		int16 *actual = new int16[numFrames * 2];
+
+		Audio::MixerImpl mixerLarge(22050, true, 4096);
+		mixSine(mixerLarge, expected, numFrames);
+		Audio::MixerImpl mixerSmall(22050, true, 96);
+		mixSine(mixerSmall, actual, numFrames);
+
+		TS_ASSERT_EQUALS(memcmp(expected, actual, numFrames * 2 * sizeof(int16)), 0);
+
+		delete[] expected;
+		delete[] actual;
+#endif
+	}
+
+	void test_queued_state_is_visible() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		// Channel changes are only applied by the next audio callback, but
+		// queries have to reflect them right away
+		Audio::MixerImpl mixer(22050, true, 1024);
+		mixer.setReady(true);
+
+		Audio::SoundHandle handle;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(11025, 1, nullptr, false, true);
+		mixer.playStream(Audio::Mixer::kPlainSoundType, &handle, s, -1, 200, 0, DisposeAfterUse::YES, false, false);
+		TS_ASSERT(mixer.isSoundHandleActive(handle));
+
+		mixer.setChannelVolume(handle, 50);
+		mixer.setChannelBalance(handle, -20);
+		mixer.setChannelRate(handle, 22050);
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), 50);
+		TS_ASSERT_EQUALS(mixer.getChannelBalance(handle), -20);
+		TS_ASSERT_EQUALS(mixer.getChannelRate(handle), 22050u);
+
+		mixer.resetChannelRate(handle);
+		TS_ASSERT_EQUALS(mixer.getChannelRate(handle), 11025u);
+
+		// Flood the command queue; the commands which do not fit are kept in
+		// order for the next callback
+		for (int i = 0; i < 1000; i++)
+			mixer.setChannelVolume(handle, (i + 1) % 256);
+		mixer.setChannelVolume(handle, 0);
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), 0);
+
+		int16 samples[256 * 2];
+		mixer.mixCallback((byte *)samples, sizeof(samples));
+		bool silent = true;
+		for (int i = 0; i < 256 * 2; i++)
+			silent = silent && samples[i] == 0;
+		TS_ASSERT(silent);
+
+		mixer.stopHandle(handle);
+		TS_ASSERT(!mixer.isSoundHandleActive(handle));
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), 0);
+#endif
+	}
+};
@@ -0,0 +1,222 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mixer_kernels.h"
+#include "audio/rate.h"
+#include "audio/sinc_filter.h"
+
+#include "../instrset_detect.h"
+#include "../null_osystem.h"
+#include "helper.h"
+
+class MixerKernelsTestSuite : public CxxTest::TestSuite {
+private:
+	typedef void(*MixStereoFunc)(int32 *, const Audio::st_sample_t *, uint, Audio::st_volume_t, Audio::st_volume_t);
+	typedef void(*ClampFunc)(Audio::st_sample_t *, const int32 *, uint);
+	typedef int32(*ConvolveFunc)(const Audio::st_sample_t *, const int16 *, uint);
+
+	void compareMixStereo(MixStereoFunc func) {
+		// Use an odd frame count so the scalar tail is exercised as well
+		const uint numFrames = 301;
+		Audio::st_sample_t src[numFrames * 2];
+		int32 expected[numFrames * 2], actual[numFrames * 2];
+
+		uint32 seed = 12345;
+		for (uint i = 0; i < numFrames * 2; i++) {
+			seed = seed * 1103515245 + 12345;
+			src[i] = (Audio::st_sample_t)(seed >> 16);
+			expected[i] = actual[i] = (int32)(seed >> 8) % 100000;
+		}
+
+		const Audio::st_volume_t volumes[][2] = { { 0, 0 }, { 256, 256 }, { 255, 17 }, { 1, 200 }, { 128, 128 } };
+		for (uint v = 0; v < ARRAYSIZE(volumes); v++) {
+			Audio::MixerKernels::mixStereoGeneric(expected, src, numFrames, volumes[v][0], volumes[v][1]);
+			func(actual, src, numFrames, volumes[v][0], volumes[v][1]);
+			TS_ASSERT_EQUALS(memcmp(expected, actual, sizeof(expected)), 0);
+		}
+	}
+
+	void compareConvolve(ConvolveFunc func) {
+		const uint numTaps = 64;
+		Audio::st_sample_t samples[numTaps];
+		int16 taps[numTaps];
+
+		for (uint i = 0; i < numTaps; i++) {
+			samples[i] = (Audio::st_sample_t)((i * 7919) % 65536 - 32768);
+			taps[i] = (int16)((int)(i * 131) % 8192 - 4096);
+		}
+
+		TS_ASSERT_EQUALS(func(samples, taps, 16), Audio::MixerKernels::convolveGeneric(samples, taps, 16));
+		TS_ASSERT_EQUALS(func(samples, taps, numTaps), Audio::MixerKernels::convolveGeneric(samples, taps, numTaps));
+	}
+
+	void compareClamp(ClampFunc func) {
+		const uint numSamples = 203;
+		int32 src[numSamples];
+		Audio::st_sample_t expected[numSamples], actual[numSamples];
+
+		for (uint i = 0; i < numSamples; i++)
+			src[i] = ((int32)i - 100) * 997;
+
+		Audio::MixerKernels::clampGeneric(expected, src, numSamples);
+		func(actual, src, numSamples);
+		TS_ASSERT_EQUALS(memcmp(expected, actual, sizeof(expected)), 0);
+	}
+
+public:
+	void test_mix_stereo_generic() {
+		const Audio::st_sample_t src[4] = { 1000, -1000, -1, 32767 };
+		int32 dst[4] = { 0, 0, 5, 5 };
+
+		Audio::MixerKernels::mixStereoGeneric(dst, src, 2, 128, 256);
+		TS_ASSERT_EQUALS(dst[0], 500);
+		TS_ASSERT_EQUALS(dst[1], -1000);
+		// Rounds towards zero like the old per sample code
+		TS_ASSERT_EQUALS(dst[2], 5);
+		TS_ASSERT_EQUALS(dst[3], 5 + 32767);
+	}
+
+	void test_clamp_generic() {
+		const int32 src[4] = { 40000, -40000, 1234, -1234 };
+		Audio::st_sample_t dst[4];
+
+		Audio::MixerKernels::clampGeneric(dst, src, 4);
+		TS_ASSERT_EQUALS(dst[0], 32767);
+		TS_ASSERT_EQUALS(dst[1], -32768);
+		TS_ASSERT_EQUALS(dst[2], 1234);
+		TS_ASSERT_EQUALS(dst[3], -1234);
+	}
+
+	void test_simd_kernels() {
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2) {
+			compareMixStereo(Audio::MixerKernels::mixStereoSSE2);
+			compareClamp(Audio::MixerKernels::clampSSE2);
+			compareConvolve(Audio::MixerKernels::convolveSSE2);
+		}
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8) {
+			compareMixStereo(Audio::MixerKernels::mixStereoAVX2);
+			compareClamp(Audio::MixerKernels::clampAVX2);
+			compareConvolve(Audio::MixerKernels::convolveAVX2);
+		}
+#endif
+	}
+
+	void test_rate_converter_copy() {
+		// Select the kernels here, as there is no OSystem to query the CPU features
+		Audio::MixerKernels::mixStereoFunc = Audio::MixerKernels::mixStereoGeneric;
+		Audio::MixerKernels::clampFunc = Audio::MixerKernels::clampGeneric;
+		Audio::MixerKernels::convolveFunc = Audio::MixerKernels::convolveGeneric;
+
+		int16 *sine;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(11025, 1, &sine, false, true);
+		Audio::RateConverter *converter = Audio::makeRateConverter(11025, 11025, true, true, false);
+
+		const int numFrames = 1000;
+		int16 *buffer = new int16[numFrames * 2];
+		for (int i = 0; i < numFrames * 2; i++)
+			buffer[i] = (i & 1) ? 30000 : 0;
+
+		TS_ASSERT_EQUALS(converter->convert(*s, buffer, numFrames, 128, 256), numFrames);
+		for (int i = 0; i < numFrames; i++) {
+			TS_ASSERT_EQUALS(buffer[i * 2], sine[i * 2] / 2);
+			TS_ASSERT_EQUALS(buffer[i * 2 + 1], CLIP<int>(30000 + sine[i * 2 + 1], -32768, 32767));
+		}
+
+		delete[] buffer;
+		delete[] sine;
+		delete converter;
+		delete s;
+	}
+
+	void test_rate_converter_sinc() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		Audio::MixerKernels::mixStereoFunc = Audio::MixerKernels::mixStereoGeneric;
+		Audio::MixerKernels::clampFunc = Audio::MixerKernels::clampGeneric;
+		Audio::MixerKernels::convolveFunc = Audio::MixerKernels::convolveGeneric;
+
+		// A constant signal has to come out unchanged once the filter
+		// window is filled, as every phase has unity gain
+		const int numInput = 2000;
+		int16 *input = (int16 *)malloc(numInput * sizeof(int16));
+		for (int i = 0; i < numInput; i++)
+			input[i] = 10000;
+
+		byte flags = Audio::FLAG_16BITS;
+#ifdef SCUMM_LITTLE_ENDIAN
+		flags |= Audio::FLAG_LITTLE_ENDIAN;
+#endif
+		Audio::SeekableAudioStream *s = Audio::makeRawStream((const byte *)input, numInput * sizeof(int16), 11025, flags);
+		Audio::RateConverter *converter = Audio::makeRateConverter(11025, 48000, false, true, false, Audio::kResamplerSinc);
+
+		const int numFrames = 4000;
+		int16 *buffer = new int16[numFrames * 2];
+		memset(buffer, 0, numFrames * 2 * sizeof(int16));
+
+		TS_ASSERT_EQUALS(converter->convert(*s, buffer, numFrames, 256, 256), numFrames);
+		for (int i = 500; i < numFrames; i++) {
+			TS_ASSERT_EQUALS(buffer[i * 2], 10000);
+			TS_ASSERT_EQUALS(buffer[i * 2 + 1], 10000);
+		}
+
+		delete[] buffer;
+		delete converter;
+		delete s;
+		Audio::SincFilterManager::destroy();
+#endif
+	}
+
+	void test_rate_converter_sinc_drain() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		Audio::MixerKernels::mixStereoFunc = Audio::MixerKernels::mixStereoGeneric;
+		Audio::MixerKernels::clampFunc = Audio::MixerKernels::clampGeneric;
+		Audio::MixerKernels::convolveFunc = Audio::MixerKernels::convolveGeneric;
+
+		// The filter delays the output by half its length, so that many
+		// input samples have to be pushed through once the stream ended
+		const int numInput = 2000;
+		int16 *input = (int16 *)malloc(numInput * sizeof(int16));
+		for (int i = 0; i < numInput; i++)
+			input[i] = 10000;
+
+		byte flags = Audio::FLAG_16BITS;
+#ifdef SCUMM_LITTLE_ENDIAN
+		flags |= Audio::FLAG_LITTLE_ENDIAN;
+#endif
+		Audio::SeekableAudioStream *s = Audio::makeRawStream((const byte *)input, numInput * sizeof(int16), 11025, flags);
+		Audio::RateConverter *converter = Audio::makeRateConverter(11025, 48000, false, true, false, Audio::kResamplerSinc);
+		const int numTaps = SincFilterMan.getFilter(11025, 48000)->getNumTaps();
+
+		const int numFrames = 20000;
+		int16 *buffer = new int16[numFrames * 2];
+		memset(buffer, 0, numFrames * 2 * sizeof(int16));
+
+		int produced = 0;
+		while (converter->needsDraining() || !s->endOfStream()) {
+			const int res = converter->convert(*s, buffer + produced * 2, MIN(100, numFrames - produced), 256, 256);
+			if (res == 0)
+				break;
+			produced += res;
+		}
+
+		TS_ASSERT(!converter->needsDraining());
+		const int expected = (numInput + numTaps / 2) * 48000 / 11025;
+		TS_ASSERT_LESS_THAN_EQUALS(expected - 2, produced);
+		TS_ASSERT_LESS_THAN_EQUALS(produced, expected + 2);
+
+		// The input is constant until the end, and then fades out
+		TS_ASSERT_EQUALS(buffer[(produced - numTaps * 3) * 2], 10000);
+		TS_ASSERT_LESS_THAN(ABS(buffer[(produced - 1) * 2]), 5000);
+
+		delete[] buffer;
+		delete converter;
+		delete s;
+		Audio::SincFilterManager::destroy();
+#endif
+	}
+};
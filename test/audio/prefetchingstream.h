@@ -0,0 +1,144 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/prefetchingstream.h"
+
+#include "../null_osystem.h"
+#include "helper.h"
+
+class PrefetchingAudioStreamTestSuite : public CxxTest::TestSuite {
+private:
+	void testReadInOrder(const bool isStereo) {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		const int sampleRate = 11025;
+		const int totalSamples = sampleRate * (isStereo ? 2 : 1);
+
+		int16 *sine = 0;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(sampleRate, 1, &sine, false, isStereo);
+		Audio::SeekableAudioStream *prefetch = Audio::makePrefetchingAudioStream(s, DisposeAfterUse::YES, 100);
+
+		TS_ASSERT_EQUALS(prefetch->isStereo(), isStereo);
+		TS_ASSERT_EQUALS(prefetch->getRate(), sampleRate);
+		TS_ASSERT_EQUALS(prefetch->getLength().totalNumberOfFrames(), sampleRate);
+
+		int16 *buffer = new int16[totalSamples];
+
+		// Mix reads served from the ring with reads that underrun it
+		int pos = 0;
+		int step = 0;
+		while (pos < totalSamples) {
+			if (step++ % 3 != 2)
+				((Audio::PrefetchingSeekableAudioStream *)prefetch)->prefetch();
+
+			const int len = MIN(totalSamples - pos, 512 + step * 64);
+			const int read = prefetch->readBuffer(buffer + pos, len);
+			TS_ASSERT_EQUALS(read, len);
+			if (read <= 0)
+				break;
+			pos += read;
+		}
+
+		TS_ASSERT_EQUALS(memcmp(buffer, sine, totalSamples * sizeof(int16)), 0);
+		TS_ASSERT_EQUALS(prefetch->readBuffer(buffer, 2), 0);
+		TS_ASSERT(prefetch->endOfData());
+
+		delete[] buffer;
+		delete[] sine;
+		delete prefetch;
+#endif
+	}
+
+public:
+	void test_read_mono() {
+		testReadInOrder(false);
+	}
+
+	void test_read_stereo() {
+		testReadInOrder(true);
+	}
+
+	void test_seek_flushes_buffer() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		const int sampleRate = 11025;
+
+		int16 *sine = 0;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(sampleRate, 1, &sine, false, false);
+		Audio::PrefetchingSeekableAudioStream *prefetch = new Audio::PrefetchingSeekableAudioStream(s, DisposeAfterUse::YES, 100);
+
+		int16 buffer[256];
+		prefetch->prefetch();
+		TS_ASSERT_EQUALS(prefetch->readBuffer(buffer, 256), 256);
+		TS_ASSERT_EQUALS(memcmp(buffer, sine, sizeof(buffer)), 0);
+
+		// The buffered samples after the old position must be discarded
+		TS_ASSERT(prefetch->seek(Audio::Timestamp(0, 5000, sampleRate)));
+		TS_ASSERT_EQUALS(prefetch->readBuffer(buffer, 256), 256);
+		TS_ASSERT_EQUALS(memcmp(buffer, sine + 5000, sizeof(buffer)), 0);
+
+		prefetch->prefetch();
+		TS_ASSERT(prefetch->rewind());
+		prefetch->prefetch();
+		TS_ASSERT_EQUALS(prefetch->readBuffer(buffer, 256), 256);
+		TS_ASSERT_EQUALS(memcmp(buffer, sine, sizeof(buffer)), 0);
+
+		delete[] sine;
+		delete prefetch;
+#endif
+	}
+
+	void test_underrun_with_worker() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		const int sampleRate = 11025;
+
+		int16 *sine = 0;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(sampleRate, 1, &sine, false, false);
+		Audio::PrefetchingSeekableAudioStream *prefetch = new Audio::PrefetchingSeekableAudioStream(s, DisposeAfterUse::YES, 100);
+		prefetch->_buffer->_hasWorker.store(true);
+
+		// The mixer must not wait for a worker that is behind
+		int16 buffer[256];
+		TS_ASSERT_EQUALS(prefetch->readBuffer(buffer, 256), 256);
+		for (int i = 0; i < 256; ++i)
+			TS_ASSERT_EQUALS(buffer[i], 0);
+
+		// Nothing was skipped meanwhile
+		prefetch->prefetch();
+		TS_ASSERT_EQUALS(prefetch->readBuffer(buffer, 256), 256);
+		TS_ASSERT_EQUALS(memcmp(buffer, sine, sizeof(buffer)), 0);
+
+		// Once the source ended, the stream ends too
+		while (!prefetch->endOfData()) {
+			prefetch->prefetch();
+			prefetch->readBuffer(buffer, 256);
+		}
+		TS_ASSERT_EQUALS(prefetch->readBuffer(buffer, 256), 0);
+
+		delete[] sine;
+		delete prefetch;
+#endif
+	}
+
+	void test_not_seekable() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		// Only seekable sources give a seekable stream
+		Audio::SeekableAudioStream *s = createSineStream<int16>(11025, 1, nullptr, false, false);
+		Audio::AudioStream *loop = Audio::makeLoopingAudioStream(s, 2);
+		Audio::AudioStream *prefetch = Audio::makePrefetchingAudioStream(loop, DisposeAfterUse::YES, 100);
+
+		TS_ASSERT(dynamic_cast<Audio::SeekableAudioStream *>(prefetch) == nullptr);
+		TS_ASSERT(dynamic_cast<Audio::RewindableAudioStream *>(prefetch) == nullptr);
+
+		int16 buffer[256];
+		TS_ASSERT_EQUALS(prefetch->readBuffer(buffer, 256), 256);
+
+		delete prefetch;
+#endif
+	}
+};
@@ -0,0 +1,106 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "test/bench/bench.h"
+
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/mixer_kernels.h"
+#include "audio/rate.h"
+
+namespace Bench {
+
+namespace {
+
+/** An endless stream of noise. */
+class NoiseStream : public Audio::AudioStream {
+public:
+	NoiseStream(int rate, bool stereo) : _rate(rate), _stereo(stereo), _seed(5) {}
+
+	int readBuffer(int16 *buffer, const int numSamples) override {
+		for (int i = 0; i < numSamples; ++i) {
+			_seed = _seed * 1103515245 + 12345;
+			buffer[i] = _seed >> 16;
+		}
+		return numSamples;
+	}
+
+	bool isStereo() const override { return _stereo; }
+	int getRate() const override { return _rate; }
+	bool endOfData() const override { return false; }
+
+private:
+	int _rate;
+	bool _stereo;
+	uint32 _seed;
+};
+
+class RateConverterBenchmark : public Benchmark {
+public:
+	RateConverterBenchmark(const char *name, int inRate, bool inStereo, Audio::ResamplerQuality quality) :
+		Benchmark(name), _inRate(inRate), _inStereo(inStereo), _quality(quality), _input(nullptr), _converter(nullptr) {}
+
+	bool setUp() override {
+		Audio::MixerKernels::init();
+		_input = new NoiseStream(_inRate, _inStereo);
+		_converter = Audio::makeRateConverter(_inRate, kOutRate, _inStereo, true, false, _quality);
+		return _converter != nullptr;
+	}
+
+	void tearDown() override {
+		delete _converter;
+		delete _input;
+	}
+
+	uint64 run() override {
+		// Mix into the 32-bit buffer, like the mixer does for every channel
+		memset(_buffer, 0, sizeof(_buffer));
+		_converter->convert(*_input, _buffer, kFrames, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+		return sizeof(_buffer);
+	}
+
+private:
+	enum {
+		kOutRate = 44100,
+		// A typical mixer callback size
+		kFrames = 1024
+	};
+
+	int _inRate;
+	bool _inStereo;
+	Audio::ResamplerQuality _quality;
+	NoiseStream *_input;
+	Audio::RateConverter *_converter;
+	int32 _buffer[kFrames * 2];
+};
+
+RateConverterBenchmark rateCopyStereo("audio/rate_copy_44100_stereo", 44100, true, Audio::kResamplerLinear);
+RateConverterBenchmark rateCopyMono("audio/rate_copy_44100_mono", 44100, false, Audio::kResamplerLinear);
+RateConverterBenchmark rateFastStereo("audio/rate_fast_22050_stereo", 22050, true, Audio::kResamplerFast);
+RateConverterBenchmark rateLinearStereo("audio/rate_linear_22050_stereo", 22050, true, Audio::kResamplerLinear);
+RateConverterBenchmark rateLinearMono("audio/rate_linear_11025_mono", 11025, false, Audio::kResamplerLinear);
+RateConverterBenchmark rateSincStereo("audio/rate_sinc_22050_stereo", 22050, true, Audio::kResamplerSinc);
+RateConverterBenchmark rateSincMono("audio/rate_sinc_11025_mono", 11025, false, Audio::kResamplerSinc);
+
+} // End of anonymous namespace
+
+} // End of namespace Bench
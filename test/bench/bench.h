@@ -0,0 +1,90 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef TEST_BENCH_BENCH_H
+#define TEST_BENCH_BENCH_H
+
+#include "common/scummsys.h"
+
+namespace Bench {
+
+/**
+ * A micro-benchmark, run by the 'bench' target.
+ *
+ * Benchmarks register themselves when constructed, so each one is
+ * declared as a static instance next to its implementation. The runner
+ * calls setUp() once, then calls run() repeatedly until the minimum
+ * measurement time has passed, and finally calls tearDown().
+ */
+class Benchmark {
+public:
+	/**
+	 * @param name  Name of the benchmark, as "<module>/<case>". It is used
+	 *              to identify the results, so it should not change.
+	 */
+	Benchmark(const char *name);
+	virtual ~Benchmark() {}
+
+	const char *getName() const { return _name; }
+
+	/**
+	 * Prepare the input data.
+	 *
+	 * @return False if the benchmark cannot run in this build, for
+	 *         example because a library it needs is not available.
+	 */
+	virtual bool setUp() { return true; }
+
+	/** Free the input data. */
+	virtual void tearDown() {}
+
+	/**
+	 * Run one iteration of the benchmark.
+	 *
+	 * @return The number of bytes processed, used to report the
+	 *         throughput, or 0 if that does not make sense.
+	 */
+	virtual uint64 run() = 0;
+
+	/** Get the first of the registered benchmarks, in no particular order. */
+	static Benchmark *getFirst() { return _first; }
+	Benchmark *getNext() const { return _next; }
+
+private:
+	const char *_name;
+	Benchmark *_next;
+
+	static Benchmark *_first;
+};
+
+/**
+ * Keep the compiler from optimizing away a result that is otherwise
+ * unused.
+ */
+void doNotOptimize(uint32 value);
+
+/** Fill a buffer with deterministic pseudo random bytes. */
+void fillRandom(byte *data, uint32 size, uint32 seed);
+
+} // End of namespace Bench
+
+#endif
@@ -0,0 +1,256 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "test/bench/bench.h"
+
+#include "common/array.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/str.h"
+#include "common/compression/deflate.h"
+#include "common/memstream.h"
+
+namespace Bench {
+
+namespace {
+
+enum {
+	kNumKeys = 4096
+};
+
+class HashMapIntBenchmark : public Benchmark {
+public:
+	HashMapIntBenchmark(const char *name, bool insert) : Benchmark(name), _insert(insert) {}
+
+	bool setUp() override {
+		for (uint32 i = 0; i < kNumKeys; ++i)
+			_map[i * 2654435761U] = i;
+		return true;
+	}
+
+	void tearDown() override {
+		_map.clear();
+	}
+
+	uint64 run() override {
+		if (_insert) {
+			Common::HashMap<uint32, uint32> map;
+			for (uint32 i = 0; i < kNumKeys; ++i)
+				map[i * 2654435761U] = i;
+			doNotOptimize(map.size());
+		} else {
+			uint32 sum = 0;
+			// Half of the lookups miss
+			for (uint32 i = 0; i < kNumKeys * 2; ++i)
+				sum += _map.getValOrDefault(i * 2654435761U, 0);
+			doNotOptimize(sum);
+		}
+		return 0;
+	}
+
+private:
+	bool _insert;
+	Common::HashMap<uint32, uint32> _map;
+};
+
+HashMapIntBenchmark hashMapIntInsert("common/hashmap_uint32_insert_4096", true);
+HashMapIntBenchmark hashMapIntLookup("common/hashmap_uint32_lookup_8192", false);
+
+/** Looks up resource-like file names, case insensitively like the archives do. */
+class HashMapStringBenchmark : public Benchmark {
+public:
+	HashMapStringBenchmark() : Benchmark("common/hashmap_string_nocase_lookup_8192") {}
+
+	bool setUp() override {
+		for (uint32 i = 0; i < kNumKeys; ++i) {
+			_keys.push_back(Common::String::format("RESOURCE.%03u", i));
+			_lookups.push_back(Common::String::format("resource.%03u", i));
+			_lookups.push_back(Common::String::format("missing.%03u", i));
+			_map[_keys[i]] = i;
+		}
+		return true;
+	}
+
+	void tearDown() override {
+		_map.clear();
+		_keys.clear();
+		_lookups.clear();
+	}
+
+	uint64 run() override {
+		uint32 sum = 0;
+		for (uint i = 0; i < _lookups.size(); ++i)
+			sum += _map.getValOrDefault(_lookups[i], 0);
+		doNotOptimize(sum);
+		return 0;
+	}
+
+private:
+	Common::HashMap<Common::String, uint32, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> _map;
+	Common::Array<Common::String> _keys;
+	Common::Array<Common::String> _lookups;
+};
+
+HashMapStringBenchmark hashMapStringLookup;
+
+class StringConcatBenchmark : public Benchmark {
+public:
+	StringConcatBenchmark() : Benchmark("common/string_concat_1024") {}
+
+	uint64 run() override {
+		Common::String str;
+		for (uint i = 0; i < 1024; ++i) {
+			str += "part";
+			str += (char)('a' + (i & 15));
+		}
+		doNotOptimize(str.size());
+		return str.size();
+	}
+};
+
+StringConcatBenchmark stringConcat;
+
+class StringFormatBenchmark : public Benchmark {
+public:
+	StringFormatBenchmark() : Benchmark("common/string_format_1024") {}
+
+	uint64 run() override {
+		uint32 size = 0;
+		for (uint i = 0; i < 1024; ++i)
+			size += Common::String::format("%s.%03d:%x", "file", i, i * 7).size();
+		doNotOptimize(size);
+		return 0;
+	}
+};
+
+StringFormatBenchmark stringFormat;
+
+class StringSearchBenchmark : public Benchmark {
+public:
+	StringSearchBenchmark() : Benchmark("common/string_find_and_compare") {}
+
+	bool setUp() override {
+		for (uint i = 0; i < 256; ++i)
+			_text += Common::String::format("line %u of some text with words in it\n", i);
+		_text += "needle";
+		return true;
+	}
+
+	void tearDown() override {
+		_text.clear();
+	}
+
+	uint64 run() override {
+		uint32 result = _text.find("needle");
+		result += _text.contains("haystack") ? 1 : 0;
+		result += _text.equalsIgnoreCase(_text) ? 1 : 0;
+		doNotOptimize(result);
+		return _text.size() * 3;
+	}
+
+private:
+	Common::String _text;
+};
+
+StringSearchBenchmark stringSearch;
+
+#ifdef USE_ZLIB
+/** Inflates 1 MiB of data compressed to about half its size. */
+class InflateBenchmark : public Benchmark {
+public:
+	InflateBenchmark(const char *name, bool stream) : Benchmark(name), _stream(stream), _uncompressed(nullptr), _compressed(nullptr), _compressedSize(0) {}
+
+	bool setUp() override {
+		// Text-like data, with letters and frequent repetitions
+		_uncompressed = new byte[kSize];
+		fillRandom(_uncompressed, kSize, 6);
+		for (uint32 i = 0; i < kSize; ++i) {
+			if (i >= 64 && (_uncompressed[i] & 0x80))
+				_uncompressed[i] = _uncompressed[i - 64];
+			else
+				_uncompressed[i] = 'a' + (_uncompressed[i] & 15);
+		}
+
+		// The compressor takes ownership of the output stream, which leaves
+		// the data alone when it is deleted
+		Common::MemoryWriteStreamDynamic *output = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		Common::WriteStream *compressor = Common::wrapCompressedWriteStream(output);
+		compressor->write(_uncompressed, kSize);
+		compressor->finalize();
+		_compressed = output->getData();
+		_compressedSize = output->size();
+		delete compressor;
+
+		// Without zlib, the data is not compressed at all. The buffer variant
+		// inflates the raw deflate data, without the gzip header and trailer,
+		// so check that the header has no optional fields.
+		return _compressedSize > kGzipHeaderSize + kGzipTrailerSize &&
+		       _compressed[0] == 0x1F && _compressed[1] == 0x8B && _compressed[3] == 0;
+	}
+
+	void tearDown() override {
+		delete[] _uncompressed;
+		free(_compressed);
+	}
+
+	uint64 run() override {
+		if (_stream) {
+			Common::SeekableReadStream *input = new Common::MemoryReadStream(_compressed, _compressedSize);
+			Common::SeekableReadStream *stream = Common::wrapCompressedReadStream(input, DisposeAfterUse::YES, kSize);
+			uint32 sum = 0;
+			byte buffer[4096];
+			while (!stream->eos()) {
+				uint32 size = stream->read(buffer, sizeof(buffer));
+				sum += size ? buffer[size - 1] : 0;
+			}
+			delete stream;
+			doNotOptimize(sum);
+		} else {
+			byte *output = new byte[kSize];
+			uint size = kSize;
+			Common::inflateZlibHeaderless(output, &size, _compressed + kGzipHeaderSize, _compressedSize - kGzipHeaderSize - kGzipTrailerSize);
+			doNotOptimize(output[kSize - 1]);
+			delete[] output;
+		}
+		return kSize;
+	}
+
+private:
+	enum {
+		kSize = 1024 * 1024,
+		kGzipHeaderSize = 10,
+		kGzipTrailerSize = 8
+	};
+
+	bool _stream;
+	byte *_uncompressed;
+	byte *_compressed;
+	uint32 _compressedSize;
+};
+
+InflateBenchmark inflateBuffer("common/inflate_buffer_1mb", false);
+InflateBenchmark inflateStream("common/inflate_gzip_stream_1mb", true);
+#endif
+
+} // End of anonymous namespace
+
+} // End of namespace Bench
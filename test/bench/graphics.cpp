@@ -0,0 +1,253 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "test/bench/bench.h"
+
+#include "graphics/blit.h"
+#include "graphics/pixelformat.h"
+#include "graphics/scaler/normal.h"
+#ifdef USE_SCALERS
+#include "graphics/scaler/sai.h"
+#include "graphics/scaler/scalebit.h"
+#ifdef USE_HQ_SCALERS
+#include "graphics/scaler/hq.h"
+#endif
+#endif
+
+namespace Bench {
+
+namespace {
+
+// The size of a typical high resolution game screen
+enum {
+	kWidth = 640,
+	kHeight = 480
+};
+
+class CrossBlitBenchmark : public Benchmark {
+public:
+	CrossBlitBenchmark(const char *name, const Graphics::PixelFormat &srcFormat, const Graphics::PixelFormat &dstFormat) :
+		Benchmark(name), _srcFormat(srcFormat), _dstFormat(dstFormat), _src(nullptr), _dst(nullptr) {}
+
+	bool setUp() override {
+		_src = new byte[kWidth * kHeight * _srcFormat.bytesPerPixel];
+		_dst = new byte[kWidth * kHeight * _dstFormat.bytesPerPixel];
+		fillRandom(_src, kWidth * kHeight * _srcFormat.bytesPerPixel, 1);
+		return true;
+	}
+
+	void tearDown() override {
+		delete[] _src;
+		delete[] _dst;
+	}
+
+	uint64 run() override {
+		Graphics::crossBlit(_dst, _src, kWidth * _dstFormat.bytesPerPixel, kWidth * _srcFormat.bytesPerPixel,
+		                    kWidth, kHeight, _dstFormat, _srcFormat);
+		return kWidth * kHeight * _srcFormat.bytesPerPixel;
+	}
+
+private:
+	Graphics::PixelFormat _srcFormat, _dstFormat;
+	byte *_src, *_dst;
+};
+
+CrossBlitBenchmark crossBlit565To8888("graphics/crossBlit_rgb565_to_rgba8888",
+	Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0), Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+CrossBlitBenchmark crossBlit8888To565("graphics/crossBlit_rgba8888_to_rgb565",
+	Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0), Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+CrossBlitBenchmark crossBlitSwap("graphics/crossBlit_rgba8888_to_abgr8888",
+	Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0), Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24));
+
+class CrossBlitMapBenchmark : public Benchmark {
+public:
+	CrossBlitMapBenchmark(const char *name, uint bytesPerPixel, uint colors) :
+		Benchmark(name), _bytesPerPixel(bytesPerPixel), _colors(colors), _src(nullptr), _dst(nullptr) {}
+
+	bool setUp() override {
+		_src = new byte[kWidth * kHeight];
+		_dst = new byte[kWidth * kHeight * _bytesPerPixel];
+		fillRandom(_src, kWidth * kHeight, 4);
+		for (uint i = 0; i < kWidth * kHeight; i++)
+			_src[i] %= _colors;
+		fillRandom((byte *)_map, sizeof(_map), 5);
+		return true;
+	}
+
+	void tearDown() override {
+		delete[] _src;
+		delete[] _dst;
+	}
+
+	uint64 run() override {
+		Graphics::crossBlitMap(_dst, _src, kWidth * _bytesPerPixel, kWidth, kWidth, kHeight, _bytesPerPixel, _map);
+		return kWidth * kHeight;
+	}
+
+private:
+	uint _bytesPerPixel, _colors;
+	byte *_src, *_dst;
+	uint32 _map[256];
+};
+
+CrossBlitMapBenchmark crossBlitMap16To565("graphics/crossBlitMap_16_colors_to_rgb565", 2, 16);
+CrossBlitMapBenchmark crossBlitMap256To565("graphics/crossBlitMap_256_colors_to_rgb565", 2, 256);
+CrossBlitMapBenchmark crossBlitMap16To8888("graphics/crossBlitMap_16_colors_to_rgba8888", 4, 16);
+CrossBlitMapBenchmark crossBlitMap256To8888("graphics/crossBlitMap_256_colors_to_rgba8888", 4, 256);
+
+class KeyBlitBenchmark : public Benchmark {
+public:
+	KeyBlitBenchmark(const char *name, uint bytesPerPixel) :
+		Benchmark(name), _bytesPerPixel(bytesPerPixel), _src(nullptr), _dst(nullptr) {}
+
+	bool setUp() override {
+		_src = new byte[kWidth * kHeight * _bytesPerPixel];
+		_dst = new byte[kWidth * kHeight * _bytesPerPixel];
+		fillRandom(_src, kWidth * kHeight * _bytesPerPixel, 2);
+
+		// Make about a quarter of the pixels transparent
+		for (uint i = 0; i < kWidth * kHeight; i += 4)
+			memset(_src + i * _bytesPerPixel, 0, _bytesPerPixel);
+		return true;
+	}
+
+	void tearDown() override {
+		delete[] _src;
+		delete[] _dst;
+	}
+
+	uint64 run() override {
+		Graphics::keyBlit(_dst, _src, kWidth * _bytesPerPixel, kWidth * _bytesPerPixel, kWidth, kHeight, _bytesPerPixel, 0);
+		return kWidth * kHeight * _bytesPerPixel;
+	}
+
+private:
+	uint _bytesPerPixel;
+	byte *_src, *_dst;
+};
+
+KeyBlitBenchmark keyBlit1("graphics/keyBlit_clut8", 1);
+KeyBlitBenchmark keyBlit4("graphics/keyBlit_rgba8888", 4);
+
+class ScaleBlitBenchmark : public Benchmark {
+public:
+	ScaleBlitBenchmark(const char *name, bool bilinear) :
+		Benchmark(name), _bilinear(bilinear), _format(4, 8, 8, 8, 8, 24, 16, 8, 0), _src(nullptr), _dst(nullptr) {}
+
+	bool setUp() override {
+		_src = new byte[kSrcWidth * kSrcHeight * 4];
+		_dst = new byte[kWidth * kHeight * 4];
+		fillRandom(_src, kSrcWidth * kSrcHeight * 4, 3);
+		return true;
+	}
+
+	void tearDown() override {
+		delete[] _src;
+		delete[] _dst;
+	}
+
+	uint64 run() override {
+		if (_bilinear)
+			Graphics::scaleBlitBilinear(_dst, _src, kWidth * 4, kSrcWidth * 4, kWidth, kHeight, kSrcWidth, kSrcHeight, _format);
+		else
+			Graphics::scaleBlit(_dst, _src, kWidth * 4, kSrcWidth * 4, kWidth, kHeight, kSrcWidth, kSrcHeight, _format);
+		return kWidth * kHeight * 4;
+	}
+
+private:
+	enum {
+		kSrcWidth = 320,
+		kSrcHeight = 200
+	};
+
+	bool _bilinear;
+	Graphics::PixelFormat _format;
+	byte *_src, *_dst;
+};
+
+ScaleBlitBenchmark scaleBlit("graphics/scaleBlit_320x200_to_640x480", false);
+ScaleBlitBenchmark scaleBlitBilinear("graphics/scaleBlitBilinear_320x200_to_640x480", true);
+
+/**
+ * Scales a 320x200 screen in RGB565, which is what the SDL backend does
+ * for most games.
+ */
+template<class T>
+class ScalerBenchmark : public Benchmark {
+public:
+	ScalerBenchmark(const char *name, uint factor) :
+		Benchmark(name), _factor(factor), _scaler(nullptr), _src(nullptr), _dst(nullptr) {}
+
+	bool setUp() override {
+		_scaler = new T(Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+		_scaler->setFactor(_factor);
+
+		// Scalers read a few pixels around the rectangle they scale
+		_src = new uint16[kSrcPitch * (kSrcHeight + 2 * kPadding)];
+		_dst = new uint16[kSrcWidth * _factor * kSrcHeight * _factor];
+		fillRandom((byte *)_src, kSrcPitch * (kSrcHeight + 2 * kPadding) * 2, 4);
+		return true;
+	}
+
+	void tearDown() override {
+		delete _scaler;
+		delete[] _src;
+		delete[] _dst;
+	}
+
+	uint64 run() override {
+		const uint16 *src = _src + kPadding * kSrcPitch + kPadding;
+		_scaler->scale((const uint8 *)src, kSrcPitch * 2, (uint8 *)_dst, kSrcWidth * _factor * 2,
+		               kSrcWidth, kSrcHeight, 0, 0);
+		return kSrcWidth * kSrcHeight * 2;
+	}
+
+private:
+	enum {
+		kSrcWidth = 320,
+		kSrcHeight = 200,
+		kPadding = 4,
+		kSrcPitch = kSrcWidth + 2 * kPadding
+	};
+
+	uint _factor;
+	T *_scaler;
+	uint16 *_src, *_dst;
+};
+
+ScalerBenchmark<NormalScaler> normal2x("graphics/scaler_normal2x", 2);
+ScalerBenchmark<NormalScaler> normal3x("graphics/scaler_normal3x", 3);
+#ifdef USE_SCALERS
+ScalerBenchmark<AdvMameScaler> advMame2x("graphics/scaler_advmame2x", 2);
+ScalerBenchmark<AdvMameScaler> advMame3x("graphics/scaler_advmame3x", 3);
+ScalerBenchmark<SAIScaler> sai2x("graphics/scaler_2xsai", 2);
+ScalerBenchmark<SuperSAIScaler> superSai2x("graphics/scaler_super2xsai", 2);
+ScalerBenchmark<SuperEagleScaler> superEagle2x("graphics/scaler_supereagle", 2);
+#ifdef USE_HQ_SCALERS
+ScalerBenchmark<HQScaler> hq2x("graphics/scaler_hq2x", 2);
+ScalerBenchmark<HQScaler> hq3x("graphics/scaler_hq3x", 3);
+#endif
+#endif
+
+} // End of anonymous namespace
+
+} // End of namespace Bench
@@ -0,0 +1,329 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+// libjpeg uses forbidden symbols in its header. Thus, we need to allow them
+// here.
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "test/bench/bench.h"
+
+#include "common/memstream.h"
+#include "graphics/surface.h"
+#include "image/gif.h"
+#include "image/jpeg.h"
+#include "image/png.h"
+
+#ifdef USE_JPEG
+// The original release of libjpeg v6b did not contain any extern "C" in case
+// its header files are included in a C++ environment. To avoid any linking
+// issues we need to add it on our own.
+extern "C" {
+#include <jpeglib.h>
+}
+#endif
+
+namespace Bench {
+
+namespace {
+
+enum {
+	kWidth = 640,
+	kHeight = 480
+};
+
+/**
+ * Get the color of a pixel of the test picture: smooth gradients with some
+ * noise, so that it compresses like a typical background would.
+ */
+void getPixel(uint x, uint y, uint32 &seed, byte &r, byte &g, byte &b) {
+	seed = seed * 1103515245 + 12345;
+	const uint noise = (seed >> 16) & 15;
+	r = (x * 255 / kWidth + noise) & 0xFF;
+	g = (y * 255 / kHeight + noise) & 0xFF;
+	b = ((x + y) / 5 + noise) & 0xFF;
+}
+
+/**
+ * Decodes an image held in memory. Subclasses produce the encoded image,
+ * as the repository contains no large enough samples.
+ */
+class ImageDecoderBenchmark : public Benchmark {
+public:
+	ImageDecoderBenchmark(const char *name) : Benchmark(name), _data(nullptr), _size(0) {}
+
+	bool setUp() override {
+		Common::MemoryWriteStreamDynamic output(DisposeAfterUse::NO);
+		if (!encode(output)) {
+			free(output.getData());
+			return false;
+		}
+
+		_data = output.getData();
+		_size = output.size();
+
+		// Make sure the decoder accepts the image before timing it
+		Image::ImageDecoder *decoder = createDecoder();
+		Common::MemoryReadStream stream(_data, _size);
+		bool valid = decoder->loadStream(stream) && decoder->getSurface()->w == kWidth;
+		delete decoder;
+		return valid;
+	}
+
+	void tearDown() override {
+		free(_data);
+	}
+
+	uint64 run() override {
+		Image::ImageDecoder *decoder = createDecoder();
+		Common::MemoryReadStream stream(_data, _size);
+		decoder->loadStream(stream);
+		delete decoder;
+		return kWidth * kHeight * 3;
+	}
+
+protected:
+	virtual bool encode(Common::WriteStream &output) = 0;
+	virtual Image::ImageDecoder *createDecoder() = 0;
+
+private:
+	byte *_data;
+	uint32 _size;
+};
+
+#ifdef USE_PNG
+class PNGBenchmark : public ImageDecoderBenchmark {
+public:
+	PNGBenchmark() : ImageDecoderBenchmark("image/png_decode_640x480") {}
+
+protected:
+	bool encode(Common::WriteStream &output) override {
+		Graphics::Surface surface;
+		surface.create(kWidth, kHeight, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+
+		uint32 seed = 7;
+		for (uint y = 0; y < kHeight; ++y) {
+			for (uint x = 0; x < kWidth; ++x) {
+				byte r, g, b;
+				getPixel(x, y, seed, r, g, b);
+				*(uint32 *)surface.getBasePtr(x, y) = surface.format.ARGBToColor(0xFF, r, g, b);
+			}
+		}
+
+		bool result = Image::writePNG(output, surface);
+		surface.free();
+		return result;
+	}
+
+	Image::ImageDecoder *createDecoder() override {
+		return new Image::PNGDecoder();
+	}
+};
+
+PNGBenchmark pngDecode;
+#endif
+
+#ifdef USE_JPEG
+class JPEGBenchmark : public ImageDecoderBenchmark {
+public:
+	JPEGBenchmark() : ImageDecoderBenchmark("image/jpeg_decode_640x480") {}
+
+protected:
+	struct Destination {
+		jpeg_destination_mgr pub;
+		Common::WriteStream *stream;
+		JOCTET buffer[4096];
+	};
+
+	static void initDestination(j_compress_ptr cinfo) {
+		Destination *dest = (Destination *)cinfo->dest;
+		dest->pub.next_output_byte = dest->buffer;
+		dest->pub.free_in_buffer = sizeof(dest->buffer);
+	}
+
+	static boolean emptyOutputBuffer(j_compress_ptr cinfo) {
+		Destination *dest = (Destination *)cinfo->dest;
+		dest->stream->write(dest->buffer, sizeof(dest->buffer));
+		initDestination(cinfo);
+		return TRUE;
+	}
+
+	static void termDestination(j_compress_ptr cinfo) {
+		Destination *dest = (Destination *)cinfo->dest;
+		dest->stream->write(dest->buffer, sizeof(dest->buffer) - dest->pub.free_in_buffer);
+	}
+
+	bool encode(Common::WriteStream &output) override {
+		jpeg_compress_struct cinfo;
+		jpeg_error_mgr jerr;
+		cinfo.err = jpeg_std_error(&jerr);
+		jpeg_create_compress(&cinfo);
+
+		Destination dest;
+		dest.pub.init_destination = initDestination;
+		dest.pub.empty_output_buffer = emptyOutputBuffer;
+		dest.pub.term_destination = termDestination;
+		dest.stream = &output;
+		cinfo.dest = &dest.pub;
+
+		cinfo.image_width = kWidth;
+		cinfo.image_height = kHeight;
+		cinfo.input_components = 3;
+		cinfo.in_color_space = JCS_RGB;
+		jpeg_set_defaults(&cinfo);
+		jpeg_set_quality(&cinfo, 85, TRUE);
+		jpeg_start_compress(&cinfo, TRUE);
+
+		uint32 seed = 8;
+		JSAMPLE row[kWidth * 3];
+		for (uint y = 0; y < kHeight; ++y) {
+			for (uint x = 0; x < kWidth; ++x)
+				getPixel(x, y, seed, row[x * 3], row[x * 3 + 1], row[x * 3 + 2]);
+
+			JSAMPROW rowPointer = row;
+			jpeg_write_scanlines(&cinfo, &rowPointer, 1);
+		}
+
+		jpeg_finish_compress(&cinfo);
+		jpeg_destroy_compress(&cinfo);
+		return true;
+	}
+
+	Image::ImageDecoder *createDecoder() override {
+		return new Image::JPEGDecoder();
+	}
+};
+
+JPEGBenchmark jpegDecode;
+#endif
+
+#ifdef USE_GIF
+class GIFBenchmark : public ImageDecoderBenchmark {
+public:
+	GIFBenchmark() : ImageDecoderBenchmark("image/gif_decode_640x480") {}
+
+protected:
+	/** Writes LZW codes to GIF data sub-blocks. */
+	class CodeWriter {
+	public:
+		CodeWriter(Common::WriteStream &output) : _output(output), _bits(0), _numBits(0), _blockSize(0) {}
+
+		void write(uint code, uint size) {
+			_bits |= code << _numBits;
+			_numBits += size;
+			while (_numBits >= 8) {
+				writeByte(_bits & 0xFF);
+				_bits >>= 8;
+				_numBits -= 8;
+			}
+		}
+
+		void finish() {
+			if (_numBits)
+				writeByte(_bits & 0xFF);
+			flushBlock();
+			_output.writeByte(0);
+		}
+
+	private:
+		void writeByte(byte value) {
+			_block[_blockSize++] = value;
+			if (_blockSize == sizeof(_block))
+				flushBlock();
+		}
+
+		void flushBlock() {
+			if (!_blockSize)
+				return;
+			_output.writeByte(_blockSize);
+			_output.write(_block, _blockSize);
+			_blockSize = 0;
+		}
+
+		Common::WriteStream &_output;
+		uint32 _bits;
+		uint _numBits;
+		byte _block[255];
+		uint _blockSize;
+	};
+
+	bool encode(Common::WriteStream &output) override {
+		output.write("GIF89a", 6);
+		output.writeUint16LE(kWidth);
+		output.writeUint16LE(kHeight);
+		output.writeByte(0xF7); // Global palette with 256 entries
+		output.writeByte(0);
+		output.writeByte(0);
+
+		// A grayscale palette, the picture only uses the red channel
+		for (uint i = 0; i < 256; ++i) {
+			output.writeByte(i);
+			output.writeByte(i);
+			output.writeByte(i);
+		}
+
+		output.writeByte(0x2C);
+		output.writeUint16LE(0);
+		output.writeUint16LE(0);
+		output.writeUint16LE(kWidth);
+		output.writeUint16LE(kHeight);
+		output.writeByte(0);
+
+		// Write every pixel as a literal code, and clear the code table
+		// before the decoder would switch to 10-bit codes. The decoder still
+		// does all of its work, and no LZW encoder is needed here.
+		const uint kClear = 256, kEnd = 257, kCodeSize = 9, kMaxLiterals = 254;
+		output.writeByte(8);
+		CodeWriter writer(output);
+
+		uint32 seed = 9;
+		uint literals = kMaxLiterals;
+		for (uint y = 0; y < kHeight; ++y) {
+			for (uint x = 0; x < kWidth; ++x) {
+				if (literals == kMaxLiterals) {
+					writer.write(kClear, kCodeSize);
+					literals = 0;
+				}
+
+				byte r, g, b;
+				getPixel(x, y, seed, r, g, b);
+				writer.write(r, kCodeSize);
+				literals++;
+			}
+		}
+
+		writer.write(kEnd, kCodeSize);
+		writer.finish();
+		output.writeByte(0x3B);
+		return true;
+	}
+
+	Image::ImageDecoder *createDecoder() override {
+		return new Image::GIFDecoder();
+	}
+};
+
+GIFBenchmark gifDecode;
+#endif
+
+} // End of anonymous namespace
+
+} // End of namespace Bench
@@ -0,0 +1,164 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+#define FORBIDDEN_SYMBOL_EXCEPTION_fprintf
+#define FORBIDDEN_SYMBOL_EXCEPTION_stderr
+#define FORBIDDEN_SYMBOL_EXCEPTION_stdout
+
+#include "test/bench/bench.h"
+#include "test/null_osystem.h"
+
+#include "common/array.h"
+#include "common/str.h"
+#include "common/system.h"
+#include "common/util.h"
+
+// Runs the micro-benchmarks and prints the results as CSV, one line per
+// benchmark, so that runs of different versions can be compared with a
+// script. Usage:
+//
+//   runner [--filter=TEXT] [--time=MSECS]
+//
+// --filter only runs the benchmarks whose name contains TEXT, and --time
+// sets the minimum measurement time of each benchmark.
+
+namespace Bench {
+
+Benchmark *Benchmark::_first = nullptr;
+
+Benchmark::Benchmark(const char *name) : _name(name), _next(_first) {
+	_first = this;
+}
+
+static volatile uint32 g_sink = 0;
+
+void doNotOptimize(uint32 value) {
+	g_sink = g_sink + value;
+}
+
+void fillRandom(byte *data, uint32 size, uint32 seed) {
+	// A simple LCG, enough to defeat run length based shortcuts
+	for (uint32 i = 0; i < size; ++i) {
+		seed = seed * 1103515245 + 12345;
+		data[i] = seed >> 16;
+	}
+}
+
+enum {
+	kDefaultMinTime = 500,
+	kRepetitions = 3
+};
+
+struct Result {
+	uint64 iterations;
+	uint32 millis;
+	uint64 bytes;
+};
+
+static Result measure(Benchmark &benchmark, uint64 iterations) {
+	Result result;
+	result.iterations = iterations;
+	result.bytes = 0;
+
+	const uint32 start = g_system->getMillis();
+	for (uint64 i = 0; i < iterations; ++i)
+		result.bytes += benchmark.run();
+	result.millis = g_system->getMillis() - start;
+
+	return result;
+}
+
+static void runBenchmark(Benchmark &benchmark, uint32 minTime) {
+	if (!benchmark.setUp()) {
+		printf("%s,skipped,,,\n", benchmark.getName());
+		benchmark.tearDown();
+		return;
+	}
+
+	// Find how many iterations take at least the minimum time, then keep
+	// the fastest of a few runs of that many iterations.
+	uint64 iterations = 1;
+	Result best = measure(benchmark, iterations);
+	while (best.millis < minTime) {
+		if (best.millis == 0)
+			iterations *= 16;
+		else
+			iterations = MAX<uint64>(iterations * 2, iterations * minTime / best.millis + 1);
+		best = measure(benchmark, iterations);
+	}
+
+	for (int i = 1; i < kRepetitions; ++i) {
+		Result result = measure(benchmark, iterations);
+		if (result.millis < best.millis)
+			best = result;
+	}
+
+	benchmark.tearDown();
+
+	const double nsPerIteration = best.millis * 1000000.0 / best.iterations;
+	Common::String throughput;
+	if (best.bytes && best.millis)
+		throughput = Common::String::format("%.2f", best.bytes / 1048576.0 / (best.millis / 1000.0));
+
+	printf("%s,%llu,%.1f,%s\n", benchmark.getName(), (unsigned long long)best.iterations, nsPerIteration, throughput.c_str());
+	fflush(stdout);
+}
+
+} // End of namespace Bench
+
+int main(int argc, char *argv[]) {
+	Common::String filter;
+	uint32 minTime = Bench::kDefaultMinTime;
+
+	for (int i = 1; i < argc; ++i) {
+		const Common::String arg(argv[i]);
+		if (arg.hasPrefix("--filter=")) {
+			filter = arg.substr(9);
+		} else if (arg.hasPrefix("--time=")) {
+			minTime = MAX(1, atoi(arg.c_str() + 7));
+		} else {
+			fprintf(stderr, "Usage: %s [--filter=TEXT] [--time=MSECS]\n", argv[0]);
+			return 1;
+		}
+	}
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+	Common::install_null_g_system();
+#endif
+
+	// Sort the benchmarks by name, so the output order is stable
+	Common::Array<Bench::Benchmark *> benchmarks;
+	for (Bench::Benchmark *b = Bench::Benchmark::getFirst(); b; b = b->getNext()) {
+		if (filter.empty() || strstr(b->getName(), filter.c_str()))
+			benchmarks.push_back(b);
+	}
+	Common::sort(benchmarks.begin(), benchmarks.end(), [](const Bench::Benchmark *a, const Bench::Benchmark *b) {
+		return strcmp(a->getName(), b->getName()) < 0;
+	});
+
+	printf("benchmark,iterations,ns_per_iteration,mb_per_second\n");
+	for (uint i = 0; i < benchmarks.size(); ++i)
+		Bench::runBenchmark(*benchmarks[i], minTime);
+
+	return 0;
+}
@@ -0,0 +1,122 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/flathashmap.h"
+#include "common/hash-str.h"
+
+class FlatHashMapTestSuite : public CxxTest::TestSuite
+{
+	public:
+	void test_empty_clear() {
+		Common::FlatHashMap<int, int> container;
+		TS_ASSERT(container.empty());
+		container[0] = 17;
+		container[1] = 33;
+		TS_ASSERT(!container.empty());
+		container.clear();
+		TS_ASSERT(container.empty());
+
+		Common::FlatHashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> container2;
+		TS_ASSERT(container2.empty());
+		container2["foo"] = "bar";
+		container2["quux"] = "blub";
+		TS_ASSERT(!container2.empty());
+		TS_ASSERT(container2.contains("FOO"));
+		TS_ASSERT_EQUALS(container2["Quux"], "blub");
+		container2.clear(true);
+		TS_ASSERT(container2.empty());
+		TS_ASSERT(!container2.contains("foo"));
+	}
+
+	void test_add_remove() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = 33;
+		container[2] = 45;
+		TS_ASSERT(container.contains(1));
+		container.erase(1);
+		TS_ASSERT(!container.contains(1));
+		TS_ASSERT_EQUALS(container.size(), 2u);
+		container[1] = 42;
+		TS_ASSERT_EQUALS(container[1], 42);
+		container.erase(container.find(0));
+		container.erase(1);
+		container.erase(2);
+		TS_ASSERT(container.empty());
+		TS_ASSERT_EQUALS(container.begin(), container.end());
+	}
+
+	void test_lookup_with_default() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container.setVal(4, 96);
+
+		const Common::FlatHashMap<int, int> &containerRef = container;
+
+		TS_ASSERT_EQUALS(containerRef[4], 96);
+		TS_ASSERT_EQUALS(containerRef.getValOrDefault(0), 17);
+		TS_ASSERT_EQUALS(containerRef.getValOrDefault(17), 0);
+		TS_ASSERT_EQUALS(containerRef.getValOrDefault(17, -10), -10);
+
+		int val = 0;
+		TS_ASSERT(containerRef.tryGetVal(4, val));
+		TS_ASSERT_EQUALS(val, 96);
+		TS_ASSERT(!containerRef.tryGetVal(5, val));
+	}
+
+	void test_copy() {
+		Common::FlatHashMap<int, Common::String> map1, container2;
+		map1[323] = "foo";
+		map1[17] = "bar";
+		map1.erase(17);
+		container2 = map1;
+		Common::FlatHashMap<int, Common::String> container3(container2);
+		TS_ASSERT_EQUALS(container2[323], "foo");
+		TS_ASSERT_EQUALS(container3[323], "foo");
+		TS_ASSERT(!container3.contains(17));
+		TS_ASSERT_EQUALS(container3.size(), 1u);
+	}
+
+	void test_grow_and_churn() {
+		// Compare against HashMap while inserting enough keys to grow the
+		// table several times and erasing enough to reuse deleted slots
+		Common::FlatHashMap<uint, uint> flat;
+		Common::HashMap<uint, uint> ref;
+
+		uint seed = 1;
+		for (int i = 0; i < 20000; ++i) {
+			seed = seed * 1103515245 + 12345;
+			const uint key = (seed >> 8) & 4095;
+			if (i % 3 == 2) {
+				flat.erase(key);
+				ref.erase(key);
+			} else {
+				flat[key] = i;
+				ref[key] = i;
+			}
+		}
+
+		TS_ASSERT_EQUALS(flat.size(), ref.size());
+		for (Common::HashMap<uint, uint>::const_iterator i = ref.begin(); i != ref.end(); ++i)
+			TS_ASSERT_EQUALS(flat.getValOrDefault(i->_key, (uint)-1), i->_value);
+
+		uint count = 0;
+		for (Common::FlatHashMap<uint, uint>::const_iterator i = flat.begin(); i != flat.end(); ++i) {
+			TS_ASSERT(ref.contains(i->_key));
+			++count;
+		}
+		TS_ASSERT_EQUALS(count, ref.size());
+	}
+
+	void test_collision() {
+		// Keys that only differ in their high bits
+		Common::FlatHashMap<int, int> h;
+		for (int i = 0; i < 8; ++i)
+			h[5 + (i << 20)] = i;
+		for (int i = 0; i < 8; i += 2)
+			h.erase(5 + (i << 20));
+		for (int i = 0; i < 8; ++i)
+			TS_ASSERT_EQUALS(h.contains(5 + (i << 20)), (i & 1) != 0);
+		for (int i = 1; i < 8; i += 2)
+			TS_ASSERT_EQUALS(h[5 + (i << 20)], i);
+	}
+};
@@ -0,0 +1,127 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/compression/unzip.h"
+#include "common/memstream.h"
+#include "common/substream.h"
+
+// A zip file with two stored members, "a.txt" containing "Hello, zip!" and
+// "dir/b.bin" containing the bytes 0 to 31
+static const byte zipTestData[] = {
+	0x50, 0x4b, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x83, 0x14, 0x51, 0x5d, 0x8c, 0x4e,
+	0x52, 0xe1, 0x0b, 0x00, 0x00, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x61, 0x2e,
+	0x74, 0x78, 0x74, 0x48, 0x65, 0x6c, 0x6c, 0x6f, 0x2c, 0x20, 0x7a, 0x69, 0x70, 0x21, 0x50, 0x4b,
+	0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x83, 0x14, 0x51, 0x5d, 0x8a, 0x7e, 0x26, 0x91,
+	0x20, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x64, 0x69, 0x72, 0x2f,
+	0x62, 0x2e, 0x62, 0x69, 0x6e, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a,
+	0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a,
+	0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x50, 0x4b, 0x01, 0x02, 0x14, 0x03, 0x14, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x83, 0x14, 0x51, 0x5d, 0x8c, 0x4e, 0x52, 0xe1, 0x0b, 0x00, 0x00, 0x00, 0x0b, 0x00, 0x00,
+	0x00, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x01, 0x00,
+	0x00, 0x00, 0x00, 0x61, 0x2e, 0x74, 0x78, 0x74, 0x50, 0x4b, 0x01, 0x02, 0x14, 0x03, 0x14, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x83, 0x14, 0x51, 0x5d, 0x8a, 0x7e, 0x26, 0x91, 0x20, 0x00, 0x00, 0x00,
+	0x20, 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x80, 0x01, 0x2e, 0x00, 0x00, 0x00, 0x64, 0x69, 0x72, 0x2f, 0x62, 0x2e, 0x62, 0x69, 0x6e, 0x50,
+	0x4b, 0x05, 0x06, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x6a, 0x00, 0x00, 0x00, 0x75,
+	0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+class ZipTestSuite : public CxxTest::TestSuite {
+	void checkMembers(Common::Archive *archive) {
+		TS_ASSERT(archive->hasFile("a.txt"));
+		TS_ASSERT(archive->hasFile("dir/b.bin"));
+		TS_ASSERT(!archive->hasFile("c.txt"));
+
+		Common::SeekableReadStream *a = archive->createReadStreamForMember("a.txt");
+		TS_ASSERT(a);
+		if (a) {
+			TS_ASSERT_EQUALS(a->size(), 11);
+			TS_ASSERT_EQUALS(a->readString(0, 11), "Hello, zip!");
+			delete a;
+		}
+
+		Common::SeekableReadStream *b = archive->createReadStreamForMember("dir/b.bin");
+		TS_ASSERT(b);
+		if (b) {
+			TS_ASSERT_EQUALS(b->size(), 32);
+			for (int i = 0; i < 32; ++i)
+				TS_ASSERT_EQUALS(b->readByte(), i);
+			delete b;
+		}
+	}
+
+	public:
+	void test_stream_archive() {
+		Common::SeekableReadStream *stream = new Common::SeekableSubReadStream(
+			new Common::MemoryReadStream(zipTestData, sizeof(zipTestData)), 0, sizeof(zipTestData), DisposeAfterUse::YES);
+		Common::Archive *archive = Common::makeZipArchive(stream);
+		TS_ASSERT(archive);
+		if (archive) {
+			checkMembers(archive);
+			delete archive;
+		}
+	}
+
+	void test_memory_archive() {
+		Common::Archive *archive = Common::makeZipArchive(new Common::MemoryReadStream(zipTestData, sizeof(zipTestData)));
+		TS_ASSERT(archive);
+		if (!archive)
+			return;
+
+		checkMembers(archive);
+
+		// Without a shared owner of the memory, the members are copied
+		Common::MemoryReadStream *a = dynamic_cast<Common::MemoryReadStream *>(archive->createReadStreamForMember("a.txt"));
+		TS_ASSERT(a);
+		if (a) {
+			TS_ASSERT_DIFFERS(a->getData(), zipTestData + 35);
+			delete a;
+		}
+
+		delete archive;
+	}
+
+	void test_shared_memory_archive() {
+		byte *data = new byte[sizeof(zipTestData)];
+		memcpy(data, zipTestData, sizeof(zipTestData));
+		Common::SharedPtr<byte> sharedData(data, Common::ArrayDeleter<byte>());
+
+		Common::Archive *archive = Common::makeZipArchive(new Common::MemoryReadStream(sharedData, sizeof(zipTestData)));
+		TS_ASSERT(archive);
+		if (!archive)
+			return;
+
+		checkMembers(archive);
+
+		// Stored members of archives in shared memory are read in place, and
+		// keep the memory alive after the archive is gone
+		Common::MemoryReadStream *a = dynamic_cast<Common::MemoryReadStream *>(archive->createReadStreamForMember("a.txt"));
+		delete archive;
+		sharedData.reset();
+
+		TS_ASSERT(a);
+		if (a) {
+			TS_ASSERT_EQUALS(a->getData(), data + 35);
+
+			char text[12] = {};
+			TS_ASSERT_EQUALS(a->read(text, 11), 11u);
+			TS_ASSERT_EQUALS(Common::String(text), "Hello, zip!");
+			TS_ASSERT_EQUALS(a->getData(), data + 35);
+			delete a;
+		}
+	}
+
+	void test_memory_archive_crc() {
+		byte data[sizeof(zipTestData)];
+		memcpy(data, zipTestData, sizeof(data));
+		data[35] = 'J';
+
+		Common::Archive *archive = Common::makeZipArchive(new Common::MemoryReadStream(data, sizeof(data)));
+		TS_ASSERT(archive);
+		if (!archive)
+			return;
+
+		TS_ASSERT(!archive->createReadStreamForMember("a.txt"));
+		delete archive;
+	}
+};
@@ -0,0 +1,104 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/rect.h"
+#include "graphics/blit.h"
+#include "graphics/blit/blit-clut.h"
+
+#include "../instrset_detect.h"
+
+class BlitTestSuite : public CxxTest::TestSuite {
+public:
+	void test_copy_blit_changed() {
+		const uint w = 37, h = 6, bpp = 2;
+		const uint dstPitch = 40 * bpp;
+		uint16 src[h][w], dst[h][40];
+
+		for (uint y = 0; y < h; y++) {
+			for (uint x = 0; x < w; x++)
+				src[y][x] = dst[y][x] = (uint16)(y * 1000 + x);
+			dst[y][w] = dst[y][w + 1] = dst[y][w + 2] = 0xDEAD;
+		}
+
+		Common::Array<Common::Rect> changed;
+		TS_ASSERT(!Graphics::copyBlitChanged((byte *)dst, (const byte *)src, dstPitch, sizeof(src[0]), w, h, bpp, changed));
+		TS_ASSERT(changed.empty());
+
+		// Rows 1 and 2 change and are reported together, row 4 on its own.
+		// Only the low byte of the last changed pixel differs.
+		src[1][3] = 1;
+		src[2][30] ^= 0x0100;
+		src[2][20] = 2;
+		src[4][36] ^= 1;
+
+		TS_ASSERT(Graphics::copyBlitChanged((byte *)dst, (const byte *)src, dstPitch, sizeof(src[0]), w, h, bpp, changed));
+		TS_ASSERT_EQUALS(changed.size(), 2u);
+		TS_ASSERT_EQUALS(changed[0], Common::Rect(3, 1, 31, 3));
+		TS_ASSERT_EQUALS(changed[1], Common::Rect(36, 4, 37, 5));
+
+		for (uint y = 0; y < h; y++) {
+			TS_ASSERT_EQUALS(memcmp(dst[y], src[y], sizeof(src[y])), 0);
+			TS_ASSERT_EQUALS(dst[y][w], 0xDEAD);
+		}
+
+		// Nothing is left to change
+		TS_ASSERT(!Graphics::copyBlitChanged((byte *)dst, (const byte *)src, dstPitch, sizeof(src[0]), w, h, bpp, changed));
+	}
+
+	// Compare a vector version of crossBlitMap() with the generic code
+	void compareCrossBlitMap(Graphics::CLUT8Blit::ConvertFunc func) {
+		const uint w = 83, h = 5, srcPitch = 90, dstPitch = 100 * 4;
+		byte src[h * srcPitch];
+		uint32 map[256];
+
+		for (uint i = 0; i < 256; i++)
+			map[i] = 0x01000193 * i ^ 0xA5C3E10F;
+
+		for (int colors = 16; colors <= 256; colors *= 16) {
+			for (uint i = 0; i < sizeof(src); i++)
+				src[i] = (byte)((i * 7 + i / 13) % colors);
+			// A few pixels outside of the first 16 colors in one run
+			src[srcPitch + 40] = 200;
+			// Runs of a single color, in and outside of the first 16
+			memset(src + 2 * srcPitch, 200, w);
+			memset(src + 3 * srcPitch, 5, w);
+
+			for (uint bpp = 1; bpp <= 4; bpp++) {
+				byte expected[h * dstPitch], actual[h * dstPitch];
+				memset(expected, 0xEE, sizeof(expected));
+				memset(actual, 0xEE, sizeof(actual));
+
+				Graphics::CLUT8Blit::convertFunc = Graphics::CLUT8Blit::convertGeneric;
+				TS_ASSERT(Graphics::crossBlitMap(expected, src, dstPitch, srcPitch, w, h, bpp, map));
+				Graphics::CLUT8Blit::convertFunc = func;
+				TS_ASSERT(Graphics::crossBlitMap(actual, src, dstPitch, srcPitch, w, h, bpp, map));
+				TS_ASSERT_EQUALS(memcmp(expected, actual, sizeof(expected)), 0);
+			}
+
+			// In place
+			byte expected[sizeof(src)], actual[sizeof(src)];
+			memcpy(expected, src, sizeof(src));
+			memcpy(actual, src, sizeof(src));
+
+			Graphics::CLUT8Blit::convertFunc = Graphics::CLUT8Blit::convertGeneric;
+			TS_ASSERT(Graphics::crossBlitMap(expected, expected, srcPitch, srcPitch, w, h, 1, map));
+			Graphics::CLUT8Blit::convertFunc = func;
+			TS_ASSERT(Graphics::crossBlitMap(actual, actual, srcPitch, srcPitch, w, h, 1, map));
+			TS_ASSERT_EQUALS(memcmp(expected, actual, sizeof(expected)), 0);
+		}
+
+		// Leave the selection to the next user
+		Graphics::CLUT8Blit::convertFunc = nullptr;
+	}
+
+	void test_cross_blit_map() {
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2)
+			compareCrossBlitMap(Graphics::CLUT8Blit::convertSSE2);
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8)
+			compareCrossBlitMap(Graphics::CLUT8Blit::convertAVX2);
+#endif
+	}
+};
@@ -0,0 +1,85 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/dirty_tile_map.h"
+
+class DirtyTileMapTestSuite : public CxxTest::TestSuite {
+public:
+	void test_empty() {
+		Graphics::DirtyTileMap map;
+		map.resize(320, 200);
+		TS_ASSERT(map.isEmpty());
+
+		Common::Array<Common::Rect> rects;
+		map.getRects(rects);
+		TS_ASSERT(rects.empty());
+
+		// Areas outside of the map are ignored
+		map.addRect(Common::Rect(320, 0, 400, 10));
+		map.addRect(Common::Rect(-20, -20, 0, 0));
+		TS_ASSERT(map.isEmpty());
+	}
+
+	void test_tiles() {
+		Graphics::DirtyTileMap map;
+		map.resize(320, 200);
+
+		map.addRect(Common::Rect(17, 3, 20, 5));
+		TS_ASSERT(!map.isEmpty());
+
+		Common::Array<Common::Rect> rects;
+		map.getRects(rects);
+		TS_ASSERT_EQUALS(rects.size(), 1u);
+		TS_ASSERT_EQUALS(rects[0], Common::Rect(16, 0, 32, 16));
+
+		map.clear();
+		TS_ASSERT(map.isEmpty());
+		map.getRects(rects);
+		TS_ASSERT(rects.empty());
+	}
+
+	void test_merge() {
+		Graphics::DirtyTileMap map;
+		map.resize(320, 200);
+
+		// Overlapping and touching rects end up as one rect
+		map.addRect(Common::Rect(0, 0, 20, 20));
+		map.addRect(Common::Rect(10, 10, 40, 30));
+		map.addRect(Common::Rect(0, 20, 48, 32));
+
+		Common::Array<Common::Rect> rects;
+		map.getRects(rects);
+		TS_ASSERT_EQUALS(rects.size(), 1u);
+		TS_ASSERT_EQUALS(rects[0], Common::Rect(0, 0, 48, 32));
+
+		// Many small rects don't give more rects than there are tiles
+		map.clear();
+		for (int y = 0; y < 64; y += 2)
+			for (int x = 0; x < 64; x += 2)
+				map.addRect(Common::Rect(x, y, x + 1, y + 1));
+
+		map.getRects(rects);
+		TS_ASSERT_EQUALS(rects.size(), 1u);
+		TS_ASSERT_EQUALS(rects[0], Common::Rect(0, 0, 64, 64));
+	}
+
+	void test_spans() {
+		Graphics::DirtyTileMap map;
+		// Wider than a word of tiles, and not a multiple of the tile size
+		map.resize(1000, 40);
+
+		map.addRect(Common::Rect(500, 0, 1000, 40));
+		map.addRect(Common::Rect(0, 16, 16, 17));
+
+		Common::Array<Common::Rect> rects;
+		map.getRects(rects);
+		// Spans which continue from the row above extend that rect
+		TS_ASSERT_EQUALS(rects.size(), 2u);
+		TS_ASSERT_EQUALS(rects[0], Common::Rect(496, 0, 1000, 40));
+		TS_ASSERT_EQUALS(rects[1], Common::Rect(0, 16, 16, 32));
+
+		map.markAll();
+		map.getRects(rects);
+		TS_ASSERT_EQUALS(rects.size(), 1u);
+		TS_ASSERT_EQUALS(rects[0], Common::Rect(0, 0, 1000, 40));
+	}
+};
@@ -0,0 +1,317 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/pixelformat.h"
+#include "graphics/scaler/kernels.h"
+#include "graphics/scaler/intern.h"
+#include "graphics/scaler/edge.h"
+#include "graphics/scaler/hq.h"
+#include "graphics/scaler/sai.h"
+
+#include "../instrset_detect.h"
+#include "../null_osystem.h"
+
+class ScalerKernelsTestSuite : public CxxTest::TestSuite {
+private:
+	typedef ScalerKernels::HQPatternsFunc HQPatternsFunc;
+	typedef ScalerKernels::SAI2xFunc SAI2xFunc;
+	typedef ScalerKernels::EdgeFlagsFunc EdgeFlagsFunc;
+
+	// Use an odd width so the scalar tails are exercised as well
+	static const int kWidth = 67;
+	static const int kHeight = 9;
+	// Enough room around the image for the neighbours read by all scalers
+	static const int kPadding = 3;
+	static const int kPitchPixels = kWidth + 2 * kPadding;
+	static const int kRows = kHeight + 2 * kPadding;
+
+	uint32 _seed;
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return (_seed >> 16) | (_seed << 16);
+	}
+
+	/**
+	 * Fill an image with a few colors, so that the comparisons between
+	 * neighbours go both ways, and some random pixels in between.
+	 */
+	template<typename Pixel>
+	void fillImage(Pixel *pixels, int count) {
+		Pixel palette[4];
+		for (int i = 0; i < 4; i++)
+			palette[i] = (Pixel)nextRandom();
+
+		for (int i = 0; i < count; i++) {
+			const uint32 r = nextRandom();
+			pixels[i] = (r & 0x300) ? palette[r & 3] : (Pixel)nextRandom();
+		}
+	}
+
+	void compareHQPatterns(HQPatternsFunc func) {
+		uint32 yuv[3][kWidth + 2];
+
+		_seed = 1;
+		for (int row = 0; row < 3; row++) {
+			for (int i = 0; i < kWidth + 2; i++) {
+				// Keep the values close to each other, so that all the
+				// thresholds of diffYUV are hit
+				const uint32 r = nextRandom();
+				const uint32 y = 0x80 + (r & 0x3F);
+				const uint32 u = 0x80 + ((r >> 8) & 0x0F);
+				const uint32 v = 0x80 + ((r >> 16) & 0x0F);
+				yuv[row][i] = (r & 0x01000000) ? yuv[row][0] : (y << 16) | (u << 8) | v;
+			}
+		}
+
+		uint8 expected[kWidth], actual[kWidth];
+		for (int width = 1; width <= kWidth; width += 11) {
+			ScalerKernels::hqPatternsGeneric(yuv[0], yuv[1], yuv[2], expected, width);
+			func(yuv[0], yuv[1], yuv[2], actual, width);
+			TS_ASSERT_EQUALS(memcmp(expected, actual, width), 0);
+		}
+	}
+
+	template<typename Pixel>
+	void compareEdgeFlags(EdgeFlagsFunc genericFunc, EdgeFlagsFunc func) {
+		Pixel src[kRows * kPitchPixels], oldSrc[kRows * kPitchPixels];
+
+		_seed = 2;
+		fillImage(src, ARRAYSIZE(src));
+		memcpy(oldSrc, src, sizeof(src));
+		for (uint i = 0; i < ARRAYSIZE(oldSrc); i += 7)
+			oldSrc[i] ^= 1;
+
+		const uint32 pitch = kPitchPixels * sizeof(Pixel);
+		uint8 expected[kWidth], actual[kWidth];
+		for (int y = kPadding; y < kPadding + kHeight; y++) {
+			const uint8 *s = (const uint8 *)(src + y * kPitchPixels + kPadding);
+			const uint8 *o = (const uint8 *)(oldSrc + y * kPitchPixels + kPadding);
+
+			genericFunc(s, pitch, o, pitch, expected, kWidth);
+			func(s, pitch, o, pitch, actual, kWidth);
+			TS_ASSERT_EQUALS(memcmp(expected, actual, kWidth), 0);
+
+			genericFunc(s, pitch, nullptr, 0, expected, kWidth);
+			func(s, pitch, nullptr, 0, actual, kWidth);
+			TS_ASSERT_EQUALS(memcmp(expected, actual, kWidth), 0);
+		}
+	}
+
+	/**
+	 * Scale the same image with the generic kernels and with the given
+	 * ones, twice so that the Edge scaler compares against an old source.
+	 */
+	template<typename Pixel>
+	void compareScaler(Scaler &scaler, uint factor, bool useSource) {
+		Pixel src[kRows * kPitchPixels];
+		Pixel *expected = new Pixel[kWidth * kHeight * factor * factor];
+		Pixel *actual = new Pixel[kWidth * kHeight * factor * factor];
+
+		const uint32 srcPitch = kPitchPixels * sizeof(Pixel);
+		const uint32 dstPitch = kWidth * factor * sizeof(Pixel);
+		const uint32 size = kWidth * kHeight * factor * factor * sizeof(Pixel);
+		const uint8 *start = (const uint8 *)(src + kPadding * kPitchPixels + kPadding);
+
+		scaler.setFactor(factor);
+		for (int generic = 1; generic >= 0; generic--) {
+			Pixel *dst = generic ? expected : actual;
+			memset(dst, 0, size);
+			selectKernels(generic != 0);
+
+			_seed = 3;
+			fillImage(src, ARRAYSIZE(src));
+			if (useSource) {
+				SourceScaler &sourceScaler = (SourceScaler &)scaler;
+				sourceScaler.setSource((const byte *)src, srcPitch, kWidth, kHeight, kPadding);
+				sourceScaler.enableSource(true);
+				scaler.scale(start, srcPitch, (uint8 *)dst, dstPitch, kWidth, kHeight, 0, 0);
+
+				// Change some pixels, the others are taken from the old source
+				for (uint i = 0; i < ARRAYSIZE(src); i += 13)
+					src[i] = (Pixel)nextRandom();
+			}
+			scaler.scale(start, srcPitch, (uint8 *)dst, dstPitch, kWidth, kHeight, 0, 0);
+		}
+
+		TS_ASSERT_EQUALS(memcmp(expected, actual, size), 0);
+
+		delete[] expected;
+		delete[] actual;
+	}
+
+	template<typename ScalerType>
+	void compareScalers(uint factor, bool useSource) {
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0)
+		};
+
+		for (uint i = 0; i < ARRAYSIZE(formats); i++) {
+			ScalerType scaler(formats[i]);
+			if (formats[i].bytesPerPixel == 2)
+				compareScaler<uint16>(scaler, factor, useSource);
+			else
+				compareScaler<uint32>(scaler, factor, useSource);
+		}
+	}
+
+	/**
+	 * Scale an image in one go and in bands, which must give the same
+	 * result. The bands read the rows next to them.
+	 */
+	template<typename Pixel>
+	void compareBands(Scaler &scaler, uint factor) {
+		const int width = 21, height = 45;
+		const int pitchPixels = width + 2 * kPadding;
+		Pixel src[(height + 2 * kPadding) * pitchPixels];
+		Pixel *expected = new Pixel[width * height * factor * factor];
+		Pixel *actual = new Pixel[width * height * factor * factor];
+
+		const uint32 srcPitch = pitchPixels * sizeof(Pixel);
+		const uint32 dstPitch = width * factor * sizeof(Pixel);
+		const uint32 size = width * height * factor * factor * sizeof(Pixel);
+		const uint8 *start = (const uint8 *)(src + kPadding * pitchPixels + kPadding);
+
+		_seed = 5;
+		fillImage(src, ARRAYSIZE(src));
+		memset(expected, 0, size);
+		memset(actual, 0, size);
+
+		scaler.setFactor(factor);
+		scaler.scale(start, srcPitch, (uint8 *)expected, dstPitch, width, height, 0, 0);
+		scaler.scaleInBands(start, srcPitch, (uint8 *)actual, dstPitch, width, height, 0, 0);
+		TS_ASSERT_EQUALS(memcmp(expected, actual, size), 0);
+
+		delete[] expected;
+		delete[] actual;
+	}
+
+	template<typename ScalerType>
+	void compareBands(uint factor) {
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0)
+		};
+
+		for (uint i = 0; i < ARRAYSIZE(formats); i++) {
+			ScalerType scaler(formats[i]);
+			if (formats[i].bytesPerPixel == 2)
+				compareBands<uint16>(scaler, factor);
+			else
+				compareBands<uint32>(scaler, factor);
+		}
+	}
+
+	// The kernels to compare against the generic ones in the scaler tests
+	static HQPatternsFunc _hqPatterns;
+	static SAI2xFunc _sai2x16, _sai2x32;
+	static EdgeFlagsFunc _edgeFlags16, _edgeFlags32;
+
+	static void selectKernels(bool generic) {
+		ScalerKernels::hqPatternsFunc = generic ? ScalerKernels::hqPatternsGeneric : _hqPatterns;
+		ScalerKernels::sai2x16Func = generic ? ScalerKernels::sai2xGeneric : _sai2x16;
+		ScalerKernels::sai2x32Func = generic ? ScalerKernels::sai2xGeneric : _sai2x32;
+		ScalerKernels::edgeFlags16Func = generic ? ScalerKernels::edgeFlags16Generic : _edgeFlags16;
+		ScalerKernels::edgeFlags32Func = generic ? ScalerKernels::edgeFlags32Generic : _edgeFlags32;
+	}
+
+	void compareKernels(HQPatternsFunc hqPatterns, SAI2xFunc sai2x16, SAI2xFunc sai2x32,
+	                    EdgeFlagsFunc edgeFlags16, EdgeFlagsFunc edgeFlags32) {
+		compareHQPatterns(hqPatterns);
+		compareEdgeFlags<uint16>(ScalerKernels::edgeFlags16Generic, edgeFlags16);
+		compareEdgeFlags<uint32>(ScalerKernels::edgeFlags32Generic, edgeFlags32);
+
+		_hqPatterns = hqPatterns;
+		_sai2x16 = sai2x16;
+		_sai2x32 = sai2x32;
+		_edgeFlags16 = edgeFlags16;
+		_edgeFlags32 = edgeFlags32;
+
+#ifdef USE_HQ_SCALERS
+		compareScalers<HQScaler>(2, false);
+		compareScalers<HQScaler>(3, false);
+#endif
+		compareScalers<SAIScaler>(2, false);
+#ifdef USE_EDGE_SCALERS
+		compareScalers<EdgeScaler>(2, true);
+		compareScalers<EdgeScaler>(3, true);
+#endif
+	}
+
+public:
+	void test_hq_patterns_generic() {
+		// Identical values never differ, Y differs above 0x30, U above 7
+		// and V above 6
+		const uint32 above[3] = { 0x800000, 0x300000, 0x000700 };
+		const uint32 center[3] = { 0x000006, 0x000000, 0x000000 };
+		const uint32 below[3] = { 0x310000, 0x000800, 0x000007 };
+		uint8 pattern;
+
+		ScalerKernels::hqPatternsGeneric(above, center, below, &pattern, 1);
+		TS_ASSERT_EQUALS(pattern, 0x01 | 0x20 | 0x40 | 0x80);
+	}
+
+	void test_edge_flags_generic() {
+		const uint16 src[3][4] = {
+			{ 1, 1, 1, 2 },
+			{ 1, 1, 1, 1 },
+			{ 1, 1, 1, 1 }
+		};
+		const uint16 oldSrc[3][4] = {
+			{ 1, 1, 1, 3 },
+			{ 1, 1, 1, 1 },
+			{ 1, 1, 1, 1 }
+		};
+		uint8 flags[2];
+
+		ScalerKernels::edgeFlags16Generic((const uint8 *)&src[1][1], sizeof(src[0]), (const uint8 *)&oldSrc[1][1], sizeof(oldSrc[0]), flags, 2);
+		TS_ASSERT_EQUALS(flags[0], ScalerKernels::kEdgeSolid | ScalerKernels::kEdgeUnchanged);
+		TS_ASSERT_EQUALS(flags[1], 0);
+
+		ScalerKernels::edgeFlags16Generic((const uint8 *)&src[1][1], sizeof(src[0]), nullptr, 0, flags, 1);
+		TS_ASSERT_EQUALS(flags[0], ScalerKernels::kEdgeSolid);
+	}
+
+	void test_scale_in_bands() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+#ifdef USE_HQ_SCALERS
+		compareBands<HQScaler>(3);
+#endif
+		compareBands<SAIScaler>(2);
+		compareBands<SuperEagleScaler>(2);
+#ifdef USE_EDGE_SCALERS
+		// Scaled in one go
+		compareBands<EdgeScaler>(2);
+#endif
+#endif
+	}
+
+	void test_simd_kernels() {
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2) {
+			compareKernels(ScalerKernels::hqPatternsSSE2, ScalerKernels::sai2x16SSE2, ScalerKernels::sai2x32SSE2,
+			               ScalerKernels::edgeFlags16SSE2, ScalerKernels::edgeFlags32SSE2);
+		}
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8) {
+			compareKernels(ScalerKernels::hqPatternsAVX2, ScalerKernels::sai2x16AVX2, ScalerKernels::sai2x32AVX2,
+			               ScalerKernels::edgeFlags16AVX2, ScalerKernels::edgeFlags32AVX2);
+		}
+#endif
+		// Leave the selection to the next user
+		ScalerKernels::hqPatternsFunc = nullptr;
+		ScalerKernels::sai2x16Func = ScalerKernels::sai2x32Func = nullptr;
+		ScalerKernels::edgeFlags16Func = ScalerKernels::edgeFlags32Func = nullptr;
+	}
+};
+
+ScalerKernelsTestSuite::HQPatternsFunc ScalerKernelsTestSuite::_hqPatterns = nullptr;
+ScalerKernelsTestSuite::SAI2xFunc ScalerKernelsTestSuite::_sai2x16 = nullptr;
+ScalerKernelsTestSuite::SAI2xFunc ScalerKernelsTestSuite::_sai2x32 = nullptr;
+ScalerKernelsTestSuite::EdgeFlagsFunc ScalerKernelsTestSuite::_edgeFlags16 = nullptr;
+ScalerKernelsTestSuite::EdgeFlagsFunc ScalerKernelsTestSuite::_edgeFlags32 = nullptr;
@@ -0,0 +1,409 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/tinygl/tinygl.h"
+#include "graphics/tinygl/zgl.h"
+#include "graphics/tinygl/zspan.h"
+
+class TinyGLTestSuite : public CxxTest::TestSuite {
+	static const int kWidth = 160, kHeight = 120;
+
+	TinyGL::ContextHandle *createTestContext(bool dirtyRects, int renderThreads,
+	                                         const Graphics::PixelFormat &format = Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24)) {
+		TinyGL::ContextHandle *handle = TinyGL::createContext(kWidth, kHeight, format, 256, true, dirtyRects);
+		TinyGL::gl_get_context()->_renderThreads = renderThreads;
+		tglViewport(0, 0, kWidth, kHeight);
+		return handle;
+	}
+
+	// A few triangles and blits which cross the bands of the frame buffer
+	void drawScene(int frame) {
+		tglClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+
+		tglEnable(TGL_DEPTH_TEST);
+		tglShadeModel(TGL_SMOOTH);
+		tglBegin(TGL_TRIANGLES);
+		tglColor3f(1.0f, 0.0f, 0.0f);
+		tglVertex3f(-0.9f, -0.8f + frame * 0.1f, 0.5f);
+		tglColor3f(0.0f, 1.0f, 0.0f);
+		tglVertex3f(0.7f, -0.2f, -0.5f);
+		tglColor3f(0.0f, 0.0f, 1.0f);
+		tglVertex3f(-0.2f, 0.9f, 0.0f);
+		tglEnd();
+
+		tglShadeModel(TGL_FLAT);
+		tglBegin(TGL_TRIANGLE_STRIP);
+		tglColor3f(1.0f, 1.0f, 0.0f);
+		tglVertex3f(0.0f, -1.2f, 0.2f);
+		tglVertex3f(0.5f, -0.9f, -0.8f);
+		tglVertex3f(0.2f, 0.3f, 0.2f);
+		tglVertex3f(0.9f, 0.6f, -0.8f);
+		tglEnd();
+		tglDisable(TGL_DEPTH_TEST);
+
+		Graphics::Surface surface;
+		surface.create(24, 40, Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24));
+		for (int y = 0; y < surface.h; y++) {
+			for (int x = 0; x < surface.w; x++) {
+				surface.setPixel(x, y, surface.format.ARGBToColor((x + y) % 3 ? 255 : 128, x * 10, y * 6, 200));
+			}
+		}
+		TinyGL::BlitImage *image = tglGenBlitImage();
+		tglUploadBlitImage(image, surface, 0, false);
+		surface.free();
+
+		tglEnable(TGL_BLEND);
+		tglBlendFunc(TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA);
+		tglBlit(image, 10, 20);
+
+		TinyGL::BlitTransform scaled(100, 50 + frame * 3);
+		scaled._destinationRectangle.setWidth(50);
+		scaled._destinationRectangle.setHeight(60);
+		scaled.flip(true, true);
+		tglBlit(image, scaled);
+
+		TinyGL::BlitTransform rotated(40, 60);
+		rotated.rotate(30, 12, 20);
+		rotated.tint(0.8f, 1.0f, 0.5f, 0.5f);
+		tglBlit(image, rotated);
+		tglDisable(TGL_BLEND);
+
+		tglDeleteBlitImage(image);
+	}
+
+	// A shaded, textured triangle which stays where it is, and a small one
+	// in front of it which moves, so that only a part of the first one is
+	// redrawn with dirty rects
+	void drawShadedScene(int frame, TGLuint texture) {
+		tglClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+
+		tglEnable(TGL_DEPTH_TEST);
+		tglEnable(TGL_TEXTURE_2D);
+		tglBindTexture(TGL_TEXTURE_2D, texture);
+		tglShadeModel(TGL_SMOOTH);
+		tglBegin(TGL_TRIANGLES);
+		tglColor3f(1.0f, 0.0f, 0.0f);
+		tglTexCoord2f(0.0f, 0.0f);
+		tglVertex3f(-0.9f, -0.8f, 0.5f);
+		tglColor3f(0.0f, 1.0f, 0.0f);
+		tglTexCoord2f(3.0f, 0.5f);
+		tglVertex3f(0.9f, -0.2f, -0.5f);
+		tglColor3f(0.0f, 0.0f, 1.0f);
+		tglTexCoord2f(0.5f, 2.0f);
+		tglVertex3f(-0.2f, 0.9f, 0.0f);
+		tglEnd();
+		tglDisable(TGL_TEXTURE_2D);
+
+		tglShadeModel(TGL_FLAT);
+		tglBegin(TGL_TRIANGLES);
+		tglColor3f(1.0f, 1.0f, 0.0f);
+		tglVertex3f(0.0f + frame * 0.1f, -0.1f, -0.9f);
+		tglVertex3f(0.2f + frame * 0.1f, -0.1f, -0.9f);
+		tglVertex3f(0.1f + frame * 0.1f, 0.1f, -0.9f);
+		tglEnd();
+		tglDisable(TGL_DEPTH_TEST);
+	}
+
+	// Triangles drawn with the render state selected by the bits of variant
+	void drawStateScene(int variant, TGLuint texture) {
+		static const TGLenum depthFuncs[] = { TGL_LESS, TGL_GEQUAL, TGL_EQUAL, TGL_NOTEQUAL, TGL_ALWAYS };
+		static const TGLenum blendFactors[][2] = {
+			{ TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA },
+			{ TGL_ONE, TGL_ONE },
+			{ TGL_DST_COLOR, TGL_ZERO },
+			{ TGL_ONE_MINUS_DST_ALPHA, TGL_DST_ALPHA },
+			{ TGL_ZERO, TGL_ONE_MINUS_DST_COLOR },
+			{ TGL_ONE_MINUS_DST_COLOR, TGL_SRC_ALPHA }
+		};
+
+		tglClearColor(0.3f, 0.2f, 0.1f, 0.6f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+
+		tglEnable(TGL_DEPTH_TEST);
+		tglDepthFunc(TGL_LESS);
+		tglShadeModel(TGL_SMOOTH);
+		tglBegin(TGL_TRIANGLES);
+		tglColor4f(0.9f, 0.5f, 0.1f, 0.2f);
+		tglVertex3f(-1.0f, -0.6f, 0.8f);
+		tglColor4f(0.2f, 1.0f, 0.4f, 0.9f);
+		tglVertex3f(0.9f, -0.9f, -0.6f);
+		tglColor4f(0.0f, 0.3f, 1.0f, 0.5f);
+		tglVertex3f(0.1f, 1.0f, 0.0f);
+		tglEnd();
+
+		// Only update the depth buffer
+		tglColorMask(TGL_FALSE, TGL_FALSE, TGL_FALSE, TGL_FALSE);
+		tglBegin(TGL_TRIANGLES);
+		tglVertex3f(-0.3f, -1.0f, -0.2f);
+		tglVertex3f(0.6f, 0.2f, 0.9f);
+		tglVertex3f(-0.8f, 0.7f, -0.9f);
+		tglEnd();
+		tglColorMask(TGL_TRUE, TGL_TRUE, TGL_TRUE, TGL_TRUE);
+
+		tglDepthFunc(depthFuncs[variant % ARRAYSIZE(depthFuncs)]);
+		tglDepthMask((variant & 1) ? TGL_FALSE : TGL_TRUE);
+		tglShadeModel((variant & 2) ? TGL_FLAT : TGL_SMOOTH);
+		if (variant & 4) {
+			tglEnable(TGL_ALPHA_TEST);
+			tglAlphaFunc(TGL_GREATER, 0.4f);
+		}
+		if (variant & 8) {
+			tglEnable(TGL_BLEND);
+			tglBlendFunc(blendFactors[variant % ARRAYSIZE(blendFactors)][0], blendFactors[variant % ARRAYSIZE(blendFactors)][1]);
+		}
+		if (variant & 16) {
+			tglEnable(TGL_TEXTURE_2D);
+			tglBindTexture(TGL_TEXTURE_2D, texture);
+		}
+
+		for (int i = 0; i < 3; i++) {
+			tglBegin(TGL_TRIANGLES);
+			tglColor4f(1.0f, 0.8f, 0.3f * i, 0.9f);
+			tglTexCoord2f(0.0f, 0.0f);
+			tglVertex3f(-0.9f + i * 0.3f, -0.9f, 0.7f - i * 0.5f);
+			tglColor4f(0.1f, 0.4f, 0.9f, 0.1f);
+			tglTexCoord2f(2.5f, 0.2f);
+			tglVertex3f(0.8f, -0.5f + i * 0.4f, -0.7f);
+			tglColor4f(0.6f, 0.0f, 0.7f, 0.6f);
+			tglTexCoord2f(0.3f, 1.7f);
+			tglVertex3f(-0.4f, 0.95f - i * 0.2f, 0.3f);
+			tglEnd();
+		}
+
+		tglDisable(TGL_TEXTURE_2D);
+		tglDisable(TGL_BLEND);
+		tglDisable(TGL_ALPHA_TEST);
+		tglDepthMask(TGL_TRUE);
+		tglDisable(TGL_DEPTH_TEST);
+	}
+
+	TGLuint createTestTexture(bool linear) {
+		byte pixels[16 * 16 * 4];
+		for (int i = 0; i < 16 * 16; i++) {
+			pixels[i * 4 + 0] = i * 7;
+			pixels[i * 4 + 1] = 255 - i;
+			pixels[i * 4 + 2] = (i % 16) * 16;
+			pixels[i * 4 + 3] = (i * 13) % 256;
+		}
+		TGLuint texture;
+		tglGenTextures(1, &texture);
+		tglBindTexture(TGL_TEXTURE_2D, texture);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, linear ? TGL_LINEAR : TGL_NEAREST);
+		tglTexImage2D(TGL_TEXTURE_2D, 0, TGL_RGBA, 16, 16, 0, TGL_RGBA, TGL_UNSIGNED_BYTE, pixels);
+		return texture;
+	}
+
+public:
+	// The vector span kernels give the same result as drawing pixel by pixel,
+	// with dirty rects they only draw the parts within the scissor rectangle
+	void test_span_kernels() {
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0)
+		};
+
+		for (uint f = 0; f < ARRAYSIZE(formats); f++) {
+			for (int dirtyRects = 0; dirtyRects < 2; dirtyRects++) {
+				TinyGL::ContextHandle *generic = createTestContext(dirtyRects, 1, formats[f]);
+				TGLuint genericTextures[2] = { createTestTexture(false), createTestTexture(true) };
+				TinyGL::ContextHandle *vector = createTestContext(dirtyRects, 1, formats[f]);
+				TGLuint vectorTextures[2] = { createTestTexture(false), createTestTexture(true) };
+
+				for (int variant = 0; variant < 64; variant++) {
+					Graphics::Surface expected, actual;
+
+					TinyGL::setContext(generic);
+					TinyGL::SpanKernels::getFunc = TinyGL::SpanKernels::getNone;
+					drawStateScene(variant, genericTextures[variant >> 5]);
+					TinyGL::presentBuffer();
+					TinyGL::getSurfaceRef(expected);
+
+					TinyGL::setContext(vector);
+					TinyGL::SpanKernels::getFunc = nullptr;
+					drawStateScene(variant, vectorTextures[variant >> 5]);
+					TinyGL::presentBuffer();
+					TinyGL::getSurfaceRef(actual);
+
+					bool same = true;
+					for (int y = 0; y < kHeight; y++)
+						same = same && !memcmp(expected.getBasePtr(0, y), actual.getBasePtr(0, y), kWidth * 4);
+					TS_ASSERT(same);
+				}
+
+				TinyGL::destroyContext(generic);
+				TinyGL::destroyContext(vector);
+			}
+		}
+	}
+
+	// Spans which start outside of the scissor rectangle of a dirty rect
+	// are shaded the same as when they are drawn in full
+	void test_scissored_spans() {
+		TinyGL::ContextHandle *full = createTestContext(false, 1);
+		TGLuint fullTexture = createTestTexture(false);
+		TinyGL::ContextHandle *dirty = createTestContext(true, 1);
+		TGLuint dirtyTexture = createTestTexture(false);
+		TinyGL::SpanKernels::getFunc = TinyGL::SpanKernels::getNone;
+
+		for (int frame = 0; frame < 3; frame++) {
+			Graphics::Surface expected, actual;
+
+			TinyGL::setContext(full);
+			drawShadedScene(frame, fullTexture);
+			TinyGL::presentBuffer();
+			TinyGL::getSurfaceRef(expected);
+
+			TinyGL::setContext(dirty);
+			drawShadedScene(frame, dirtyTexture);
+			TinyGL::presentBuffer();
+			TinyGL::getSurfaceRef(actual);
+
+			bool same = true;
+			for (int y = 0; y < kHeight; y++)
+				same = same && !memcmp(expected.getBasePtr(0, y), actual.getBasePtr(0, y), kWidth * 4);
+			TS_ASSERT(same);
+		}
+
+		TinyGL::SpanKernels::getFunc = nullptr;
+		TinyGL::destroyContext(full);
+		TinyGL::destroyContext(dirty);
+	}
+
+	// Depth values are written exactly, so that drawing the same sloped
+	// triangles again passes an equal depth test everywhere
+	void test_depth_write_precision() {
+		TinyGL::ContextHandle *handle = createTestContext(false, 1);
+		TinyGL::SpanKernels::getFunc = TinyGL::SpanKernels::getNone;
+
+		tglClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+		tglEnable(TGL_DEPTH_TEST);
+
+		for (int i = 0; i < 2; i++) {
+			tglDepthFunc(i ? TGL_EQUAL : TGL_ALWAYS);
+			tglBegin(TGL_TRIANGLE_STRIP);
+			tglColor3f(i ? 1.0f : 0.0f, 0.0f, 1.0f);
+			tglVertex3f(-0.5f, -0.5f, -0.3f);
+			tglVertex3f(0.5f, -0.5f, 0.6f);
+			tglVertex3f(-0.5f, 0.5f, -0.2f);
+			tglVertex3f(0.5f, 0.5f, 0.7f);
+			tglEnd();
+		}
+		tglDepthFunc(TGL_LESS);
+		tglDisable(TGL_DEPTH_TEST);
+
+		Graphics::Surface surface;
+		TinyGL::presentBuffer();
+		TinyGL::getSurfaceRef(surface);
+
+		// Only the second color is left
+		bool same = true;
+		for (int y = kHeight / 4 + 1; y < kHeight * 3 / 4 - 1; y++) {
+			for (int x = kWidth / 4 + 1; x < kWidth * 3 / 4 - 1; x++)
+				same = same && surface.getPixel(x, y) == surface.format.ARGBToColor(255, 255, 0, 255);
+		}
+		TS_ASSERT(same);
+
+		TinyGL::SpanKernels::getFunc = nullptr;
+		TinyGL::destroyContext(handle);
+	}
+
+	// Clipping a flipped, scaled or rotated blit leaves the image where it
+	// is, and only skips the pixels outside the clipping rectangle
+	void test_transformed_blit_clipping() {
+		TinyGL::ContextHandle *handle = createTestContext(false, 1);
+
+		Graphics::Surface surface;
+		surface.create(24, 40, Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24));
+		for (int y = 0; y < surface.h; y++) {
+			for (int x = 0; x < surface.w; x++) {
+				surface.setPixel(x, y, surface.format.ARGBToColor(255, x * 10, y * 6, 200));
+			}
+		}
+		TinyGL::BlitImage *image = tglGenBlitImage();
+		tglUploadBlitImage(image, surface, 0, false);
+		surface.free();
+
+		TinyGL::BlitTransform transforms[3] = {
+			TinyGL::BlitTransform(20, 30),
+			TinyGL::BlitTransform(90, 20),
+			TinyGL::BlitTransform(50, 50)
+		};
+		transforms[0].flip(true, true);
+		transforms[1]._destinationRectangle.setWidth(50);
+		transforms[1]._destinationRectangle.setHeight(60);
+		transforms[1].flip(false, true);
+		transforms[2].rotate(30, 12, 20);
+
+		const Common::Rect clips[] = {
+			Common::Rect(0, 40, kWidth, 72),
+			Common::Rect(30, 0, 100, kHeight),
+			Common::Rect(95, 35, 130, 60)
+		};
+
+		for (uint t = 0; t < ARRAYSIZE(transforms); t++) {
+			Graphics::Surface full, clipped;
+
+			tglClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			tglClear(TGL_COLOR_BUFFER_BIT);
+			tglBlit(image, transforms[t]);
+			TinyGL::presentBuffer();
+			TinyGL::getSurfaceRef(clipped);
+			full.copyFrom(clipped);
+
+			for (uint i = 0; i < ARRAYSIZE(clips); i++) {
+				tglClear(TGL_COLOR_BUFFER_BIT);
+				TinyGL::presentBuffer();
+
+				TinyGL::BlittingDrawCall call(image, transforms[t], TinyGL::BlittingDrawCall::BlitMode_Regular);
+				call.execute(clips[i], false);
+				TinyGL::getSurfaceRef(clipped);
+
+				bool same = true;
+				for (int y = 0; y < kHeight; y++) {
+					for (int x = 0; x < kWidth; x++) {
+						uint32 expected = clips[i].contains(x, y) ? full.getPixel(x, y) : full.format.ARGBToColor(255, 0, 0, 0);
+						same = same && clipped.getPixel(x, y) == expected;
+					}
+				}
+				TS_ASSERT(same);
+			}
+
+			full.free();
+		}
+
+		tglDeleteBlitImage(image);
+		TinyGL::destroyContext(handle);
+	}
+
+	// Drawing the frame buffer in bands on several threads gives the same
+	// result as drawing all of it in one go
+	void test_parallel_rendering() {
+		for (int dirtyRects = 0; dirtyRects < 2; dirtyRects++) {
+			TinyGL::ContextHandle *serial = createTestContext(dirtyRects, 1);
+			TinyGL::ContextHandle *parallel = createTestContext(dirtyRects, 4);
+
+			for (int frame = 0; frame < 3; frame++) {
+				Graphics::Surface expected, actual;
+
+				TinyGL::setContext(serial);
+				drawScene(frame);
+				TinyGL::presentBuffer();
+				TinyGL::getSurfaceRef(expected);
+
+				TinyGL::setContext(parallel);
+				drawScene(frame);
+				TinyGL::presentBuffer();
+				TinyGL::getSurfaceRef(actual);
+
+				for (int y = 0; y < kHeight; y++) {
+					TS_ASSERT_EQUALS(memcmp(expected.getBasePtr(0, y), actual.getBasePtr(0, y), kWidth * 4), 0);
+				}
+			}
+
+			TinyGL::destroyContext(serial);
+			TinyGL::destroyContext(parallel);
+		}
+	}
+};
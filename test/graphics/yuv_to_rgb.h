@@ -0,0 +1,161 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_kernels.h"
+
+#include "../instrset_detect.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite {
+private:
+	typedef Graphics::YUVToRGBKernels::ConvertRowFunc ConvertRowFunc;
+
+	// The widths leave tails for the tables, and the last one is split
+	// into parts by convert410
+	static const int kHeight = 8;
+	static const int kMaxWidth = 300;
+	static const int kPitch = kMaxWidth + 5;
+
+	byte _y[kHeight * kPitch], _u[kHeight * kPitch], _v[kHeight * kPitch], _a[kHeight * kPitch];
+
+	void fillPlanes() {
+		uint32 seed = 1;
+		for (int i = 0; i < kHeight * kPitch; i++) {
+			seed = seed * 1103515245 + 12345;
+			_y[i] = seed >> 24;
+			_u[i] = seed >> 16;
+			_v[i] = seed >> 8;
+			// Include the extremes, which hit the clamping of both scales
+			if ((i % 17) == 0) {
+				_y[i] = (i & 1) ? 255 : 0;
+				_u[i] = (i & 2) ? 255 : 0;
+				_v[i] = (i & 4) ? 255 : 0;
+			}
+			_a[i] = seed;
+		}
+	}
+
+	void convert(Graphics::Surface &dst, int type, Graphics::YUVToRGBManager::LuminanceScale scale, int width) {
+		switch (type) {
+		case 0:
+			YUVToRGBMan.convert444(&dst, scale, _y, _u, _v, width, kHeight, kPitch, kPitch);
+			break;
+		case 1:
+			YUVToRGBMan.convert422(&dst, scale, _y, _u, _v, width, kHeight, kPitch, kPitch);
+			break;
+		case 2:
+			YUVToRGBMan.convert420(&dst, scale, _y, _u, _v, width, kHeight, kPitch, kPitch);
+			break;
+		case 3:
+			YUVToRGBMan.convert420Alpha(&dst, scale, _y, _u, _v, _a, width, kHeight, kPitch, kPitch);
+			break;
+		default:
+			YUVToRGBMan.convert410(&dst, scale, _y, _u, _v, width, kHeight, kPitch, kPitch / 4);
+			break;
+		}
+	}
+
+	void compareKernel(ConvertRowFunc func) {
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15),
+			Graphics::PixelFormat(2, 4, 4, 4, 4, 12, 8, 4, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 0, 8, 16, 0)
+		};
+		const int widths[] = { 4, 60, kMaxWidth };
+		const Graphics::YUVToRGBManager::LuminanceScale scales[] = {
+			Graphics::YUVToRGBManager::kScaleFull, Graphics::YUVToRGBManager::kScaleITU
+		};
+
+		fillPlanes();
+
+		for (uint f = 0; f < ARRAYSIZE(formats); f++) {
+			Graphics::Surface expected, actual;
+			expected.create(kMaxWidth, kHeight, formats[f]);
+			actual.create(kMaxWidth, kHeight, formats[f]);
+
+			for (uint s = 0; s < ARRAYSIZE(scales); s++) {
+				for (uint w = 0; w < ARRAYSIZE(widths); w++) {
+					for (int type = 0; type < 5; type++) {
+						memset(expected.getPixels(), 0x5A, expected.pitch * kHeight);
+						memset(actual.getPixels(), 0x5A, actual.pitch * kHeight);
+
+						Graphics::YUVToRGBKernels::convertRowFunc = Graphics::YUVToRGBKernels::convertRowGeneric;
+						convert(expected, type, scales[s], widths[w]);
+						Graphics::YUVToRGBKernels::convertRowFunc = func;
+						convert(actual, type, scales[s], widths[w]);
+
+						TSM_ASSERT_EQUALS(Common::String::format("format %d, scale %d, width %d, type %d", f, s, widths[w], type).c_str(),
+						                  memcmp(expected.getPixels(), actual.getPixels(), expected.pitch * kHeight), 0);
+					}
+				}
+			}
+
+			expected.free();
+			actual.free();
+		}
+	}
+
+public:
+	void test_convert410() {
+		// Interpolate the chroma planes in full and convert them as 444,
+		// which has to give the same result as converting the parts of
+		// the rows of 410 with the kernels and the tables
+		static const int kUVPitch = kPitch / 4;
+		byte u[kHeight * kPitch], v[kHeight * kPitch];
+
+		fillPlanes();
+
+		for (int y = 0; y < kHeight; y++) {
+			for (int x = 0; x < kMaxWidth; x++) {
+				const int index = (y >> 2) * kUVPitch + (x >> 2);
+				const int xDiff = x & 3, yDiff = y & 3;
+				u[y * kPitch + x] = (_u[index] * (4 - xDiff) * (4 - yDiff) + _u[index + 1] * xDiff * (4 - yDiff) +
+				                     _u[index + kUVPitch] * yDiff * (4 - xDiff) + _u[index + kUVPitch + 1] * xDiff * yDiff) >> 4;
+				v[y * kPitch + x] = (_v[index] * (4 - xDiff) * (4 - yDiff) + _v[index + 1] * xDiff * (4 - yDiff) +
+				                     _v[index + kUVPitch] * yDiff * (4 - xDiff) + _v[index + kUVPitch + 1] * xDiff * yDiff) >> 4;
+			}
+		}
+
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+		const int widths[] = { 4, 60, kMaxWidth };
+
+		for (uint f = 0; f < ARRAYSIZE(formats); f++) {
+			Graphics::Surface expected, actual;
+			expected.create(kMaxWidth, kHeight, formats[f]);
+			actual.create(kMaxWidth, kHeight, formats[f]);
+
+			for (uint w = 0; w < ARRAYSIZE(widths); w++) {
+				memset(expected.getPixels(), 0x5A, expected.pitch * kHeight);
+				memset(actual.getPixels(), 0x5A, actual.pitch * kHeight);
+
+				YUVToRGBMan.convert444(&expected, Graphics::YUVToRGBManager::kScaleITU, _y, u, v, widths[w], kHeight, kPitch, kPitch);
+				YUVToRGBMan.convert410(&actual, Graphics::YUVToRGBManager::kScaleITU, _y, _u, _v, widths[w], kHeight, kPitch, kUVPitch);
+
+				TSM_ASSERT_EQUALS(Common::String::format("format %d, width %d", f, widths[w]).c_str(),
+				                  memcmp(expected.getPixels(), actual.getPixels(), expected.pitch * kHeight), 0);
+			}
+
+			expected.free();
+			actual.free();
+		}
+	}
+
+	void test_simd_kernels() {
+#ifdef SCUMMVM_SSE2
+		if (instrset_detect() >= 2)
+			compareKernel(Graphics::YUVToRGBKernels::convertRowSSE2);
+#endif
+#ifdef SCUMMVM_AVX2
+		if (instrset_detect() >= 8)
+			compareKernel(Graphics::YUVToRGBKernels::convertRowAVX2);
+#endif
+		// Leave the selection to the next user
+		Graphics::YUVToRGBKernels::convertRowFunc = nullptr;
+	}
+};
@@ -5,7 +5,7 @@
 #
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/common/formats/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/math/*.h $(srcdir)/test/image/*.h
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/common/formats/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/math/*.h $(srcdir)/test/image/*.h $(srcdir)/test/graphics/blit.h $(srcdir)/test/graphics/dirty_tile_map.h $(srcdir)/test/graphics/yuv_to_rgb.h
 TEST_LIBS    :=
 
 ifdef POSIX
@@ -30,6 +30,19 @@ endif
 
 TEST_LIBS +=	audio/libaudio.a math/libmath.a common/formats/libformats.a common/compression/libcompression.a common/libcommon.a image/libimage.a graphics/libgraphics.a
 
+ifdef USE_SCALERS
+	TESTS += $(srcdir)/test/graphics/scaler_kernels.h
+endif
+
+ifdef USE_TINYGL
+	TESTS += $(srcdir)/test/graphics/tinygl.h
+endif
+
+ifdef USE_BINK
+	TESTS += $(srcdir)/test/video/bink.h
+	TEST_LIBS += video/libvideo.a math/libmath.a
+endif
+
 ifeq ($(ENABLE_WINTERMUTE), STATIC_PLUGIN)
 	TESTS += $(srcdir)/test/engines/wintermute/*.h
 	TEST_LIBS += engines/wintermute/libwintermute.a
@@ -52,6 +65,11 @@ TEST_LDFLAGS := $(LDFLAGS) $(LIBS)
 TEST_CXXFLAGS  := $(filter-out -Wglobal-constructors,$(CXXFLAGS))
 TEST_CXXFLAGS += -Wno-self-assign-overloaded
 
+ifdef POSIX
+# The null OSystem of the tests runs the jobs of runParallel() on threads
+TEST_LDFLAGS += -lpthread
+endif
+
 ifdef WIN32
 TEST_LDFLAGS := $(filter-out -mwindows,$(TEST_LDFLAGS))
 endif
@@ -81,7 +99,7 @@ test/runner.cpp: $(TESTS) $(srcdir)/test/module.mk
 
 clean: clean-test
 clean-test:
-	-$(RM) test/runner.cpp test/runner test/engine-data/encoding.dat test/null_osystem.o
+	-$(RM) test/runner.cpp test/runner test/engine-data/encoding.dat test/null_osystem.o test/bench/runner
 	-rmdir test/engine-data
 
 test/engine-data/encoding.dat: $(srcdir)/dists/engine-data/encoding.dat
@@ -90,4 +108,21 @@ test/engine-data/encoding.dat: $(srcdir)/dists/engine-data/encoding.dat
 
 copy-dat: test/engine-data/encoding.dat
 
-.PHONY: test clean-test copy-dat
+######################################################################
+# Micro-benchmarks of the core libraries, printing CSV results.
+# Use the 'bench' target to run them, and BENCH_FLAGS to pass options
+# to the runner, e.g. BENCH_FLAGS="--filter=scaler --time=1000".
+#
+######################################################################
+
+BENCH_SRCS   := $(wildcard $(srcdir)/test/bench/*.cpp)
+# The graphics code depends on common code, which comes earlier in TEST_LIBS
+BENCH_LIBS   := $(TEST_LIBS) common/libcommon.a
+
+bench: test/bench/runner
+	./test/bench/runner $(BENCH_FLAGS)
+test/bench/runner: $(BENCH_SRCS) $(srcdir)/test/bench/bench.h $(BENCH_LIBS)
+	@mkdir -p test/bench
+	+$(QUIET_CXX)$(LD) $(TEST_CXXFLAGS) $(CPPFLAGS) $(TEST_CFLAGS) -o $@ $(BENCH_SRCS) $(BENCH_LIBS) $(TEST_LDFLAGS)
+
+.PHONY: test clean-test copy-dat bench
@@ -1,8 +1,13 @@
 #define USE_NULL_DRIVER 1
 #define NULL_DRIVER_USE_FOR_TEST 1
 #include "null_osystem.h"
+#include "instrset_detect.h"
 #include "../backends/platform/null/null.cpp"
 
+#ifdef POSIX
+#include <pthread.h>
+#endif
+
 //#define DISPLAY_ERROR_MESSAGES
 
 void Common::install_null_g_system() {
@@ -15,6 +20,64 @@ void Common::install_null_g_system() {
 	g_system = OSystem_NULL_create(silenceLogs);
 }
 
+bool OSystem_NULL::hasFeature(Feature f) {
+	// There is no graphics manager to ask, so report the CPU features here
+	// to let the code under test pick its SIMD implementations.
+#if defined(__x86_64__) || defined(__amd64) || defined(_M_X64)  || defined(_M_AMD64) || \
+	defined(__i386__)   || defined(__i386)  || defined(_M_IX86)
+	if (f == kFeatureCpuSSE2)
+		return instrset_detect() >= 2;
+	if (f == kFeatureCpuAVX2)
+		return instrset_detect() >= 8;
+#endif
+	return false;
+}
+
+int OSystem_NULL::getParallelJobCount() {
+	// Let the code under test split its work as it would for several threads.
+	return 4;
+}
+
+#ifdef POSIX
+struct NullParallelJob {
+	OSystem::ParallelJobFunc func;
+	void *data;
+	int job;
+};
+
+static void *runNullParallelJob(void *arg) {
+	NullParallelJob *job = (NullParallelJob *)arg;
+	job->func(job->data, job->job);
+	return nullptr;
+}
+#endif
+
+void OSystem_NULL::runParallel(ParallelJobFunc func, void *data, int numJobs) {
+#ifdef POSIX
+	// Run every job on a thread of its own, so that the tests notice jobs
+	// which write to the same memory.
+	Common::Array<NullParallelJob> jobs(numJobs);
+	Common::Array<pthread_t> threads(numJobs);
+	Common::Array<bool> started(numJobs);
+
+	for (int i = 0; i < numJobs; i++) {
+		jobs[i].func = func;
+		jobs[i].data = data;
+		jobs[i].job = i;
+		started[i] = pthread_create(&threads[i], nullptr, runNullParallelJob, &jobs[i]) == 0;
+		if (!started[i])
+			func(data, i);
+	}
+
+	for (int i = 0; i < numJobs; i++) {
+		if (started[i])
+			pthread_join(threads[i], nullptr);
+	}
+#else
+	OSystem::runParallel(func, data, numJobs);
+#endif
+}
+
 bool BaseBackend::setScaler(const char *name, int factor) {
 	return false;
 }
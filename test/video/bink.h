@@ -0,0 +1,106 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "video/bink_decoder.h"
+#include "video/bink_dsp.h"
+
+#include "../null_osystem.h"
+
+class BinkTestSuite : public CxxTest::TestSuite {
+	// Coefficients from small DC-only blocks up to values which overflow a
+	// byte, but not the 32-bit intermediate values
+	static void fillBlock(int32 *block, uint seed) {
+		uint32 state = seed * 0x9E3779B9 + 1;
+		int range = 2 << (seed % 13);
+		for (int i = 0; i < 64; i++) {
+			state = state * 1664525 + 1013904223;
+			if (i == 0 || (seed & 1) || (state >> 28) == 0)
+				block[i] = (int32)((state >> 8) % range) - range / 2;
+			else
+				block[i] = 0;
+		}
+	}
+
+public:
+	void test_idct() {
+		const uint pitch = 13;
+		for (uint seed = 0; seed < 200; seed++) {
+			int32 block[64], scratch[64];
+			byte expected[8 * pitch], actual[8 * pitch];
+			fillBlock(block, seed);
+			for (uint i = 0; i < sizeof(expected); i++)
+				expected[i] = actual[i] = i * 7 + seed;
+
+			Video::BinkDSP::functions = &Video::BinkDSP::genericFunctions;
+			memcpy(scratch, block, sizeof(block));
+			Video::BinkDSP::idctPut(expected, pitch, scratch);
+			Video::BinkDSP::functions = nullptr;
+			memcpy(scratch, block, sizeof(block));
+			Video::BinkDSP::idctPut(actual, pitch, scratch);
+			TS_ASSERT_EQUALS(memcmp(expected, actual, sizeof(expected)), 0);
+
+			Video::BinkDSP::functions = &Video::BinkDSP::genericFunctions;
+			memcpy(scratch, block, sizeof(block));
+			Video::BinkDSP::idctAdd(expected, pitch, scratch);
+			Video::BinkDSP::functions = nullptr;
+			memcpy(scratch, block, sizeof(block));
+			Video::BinkDSP::idctAdd(actual, pitch, scratch);
+			TS_ASSERT_EQUALS(memcmp(expected, actual, sizeof(expected)), 0);
+		}
+	}
+
+	// Decoding the plane groups of a BIKi frame in parallel from offsets
+	// which do not match the planes fails without an error, and the planes
+	// are decoded one after the other from then on
+	void test_parallel_planes_fallback() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		// Parallel decoding has to be asked for
+		Video::BinkDecoder::BinkVideoTrack inOrder(64, 48, 1, Common::Rational(25), true, false, MKTAG('B', 'I', 'K', 'i'));
+		TS_ASSERT_EQUALS(inOrder._bundleSets, 1);
+
+		Video::BinkDecoder::BinkVideoTrack track(64, 48, 1, Common::Rational(25), true, false, MKTAG('B', 'I', 'K', 'i'), true);
+		if (track._bundleSets < Video::BinkDecoder::BinkVideoTrack::kPlaneGroupMAX)
+			return;
+
+		const uint32 size = 2048;
+		byte *data = (byte *)malloc(size);
+		for (uint seed = 0; seed < 200; seed++) {
+			uint32 state = seed * 0x9E3779B9 + 1;
+			for (uint32 i = 0; i < size; i++) {
+				state = state * 1664525 + 1013904223;
+				// Mostly zeros, so that many frames get past the bundle headers
+				data[i] = (state & 0x300) ? 0 : state >> 24;
+			}
+			// The chroma planes start half way through the packet
+			WRITE_LE_UINT32(data, size / 2);
+
+			Video::BinkDecoder::VideoFrame frame;
+			frame.data = data;
+			frame.dataSize = size;
+			frame.bits = new Common::BitStream32LELSB(new Common::MemoryReadStream(data, size), DisposeAfterUse::YES);
+
+			track._planeOffsetModes = Video::BinkDecoder::BinkVideoTrack::kPlaneOffsetFromPacket;
+			TS_ASSERT(!track.decodePlanesInParallel(frame));
+			TS_ASSERT_EQUALS(track._planeOffsetModes, 0u);
+		}
+		free(data);
+#endif
+	}
+
+	void test_scale() {
+		const uint pitch = 21;
+		byte src[64], expected[16 * pitch], actual[16 * pitch];
+		for (uint i = 0; i < 64; i++)
+			src[i] = i * 37;
+		for (uint i = 0; i < sizeof(expected); i++)
+			expected[i] = actual[i] = i;
+
+		Video::BinkDSP::functions = &Video::BinkDSP::genericFunctions;
+		Video::BinkDSP::scale(expected + 2, pitch, src);
+		Video::BinkDSP::functions = nullptr;
+		Video::BinkDSP::scale(actual + 2, pitch, src);
+		TS_ASSERT_EQUALS(memcmp(expected, actual, sizeof(expected)), 0);
+	}
+};
@@ -28,8 +28,10 @@
 
 #include "common/util.h"
 #include "common/textconsole.h"
+#include "common/debug.h"
 #include "common/math.h"
 #include "common/stream.h"
+#include "common/memstream.h"
 #include "common/substream.h"
 #include "common/file.h"
 #include "common/str.h"
@@ -45,6 +47,7 @@
 
 #include "video/binkdata.h"
 #include "video/bink_decoder.h"
+#include "video/bink_dsp.h"
 
 static const uint32 kBIKfID = MKTAG('B', 'I', 'K', 'f');
 static const uint32 kBIKgID = MKTAG('B', 'I', 'K', 'g');
@@ -63,6 +66,7 @@ namespace Video {
 
 BinkDecoder::BinkDecoder() {
 	_bink = 0;
+	_parallelPlanes = false;
 }
 
 BinkDecoder::~BinkDecoder() {
@@ -103,7 +107,7 @@ bool BinkDecoder::loadStream(Common::SeekableReadStream *stream) {
 
 	// BIKh and BIKi swap the chroma planes
 	addTrack(new BinkVideoTrack(width, height, frameCount,
-			Common::Rational(frameRateNum, frameRateDen), (id == kBIKhID || id == kBIKiID), videoFlags & kVideoFlagAlpha, id));
+			Common::Rational(frameRateNum, frameRateDen), (id == kBIKhID || id == kBIKiID), videoFlags & kVideoFlagAlpha, id, _parallelPlanes));
 
 	uint32 audioTrackCount = _bink->readUint32LE();
 
@@ -200,16 +204,28 @@ void BinkDecoder::readNextPacket() {
 		}
 	}
 
-	uint32 videoPacketStart = _bink->pos();
-	uint32 videoPacketEnd   = _bink->pos() + frameSize;
+	// Read the video packet into memory, so that the plane groups can be decoded in parallel
+	byte *data = (byte *)malloc(frameSize);
+	if (!data && frameSize)
+		error("Failed to allocate %u bytes for the video packet", frameSize);
 
-	frame.bits = new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink,
-			videoPacketStart, videoPacketEnd), DisposeAfterUse::YES);
+	const uint32 dataRead = _bink->read(data, frameSize);
+	if (dataRead != frameSize) {
+		// Decode what there is, like from a truncated file
+		warning("Bink video packet truncated to %u of %u bytes", dataRead, frameSize);
+		memset(data + dataRead, 0, frameSize - dataRead);
+	}
+
+	frame.data     = data;
+	frame.dataSize = frameSize;
+	frame.bits = new Common::BitStream32LELSB(new Common::MemoryReadStream(data,
+			frameSize, DisposeAfterUse::YES), DisposeAfterUse::YES);
 
 	videoTrack->decodePacket(frame);
 
 	delete frame.bits;
 	frame.bits = 0;
+	frame.data = 0;
 }
 
 VideoDecoder::AudioTrack *BinkDecoder::getAudioTrack(int index) {
@@ -222,7 +238,7 @@ VideoDecoder::AudioTrack *BinkDecoder::getAudioTrack(int index) {
 	return (AudioTrack *)track;
 }
 
-BinkDecoder::VideoFrame::VideoFrame() : bits(0) {
+BinkDecoder::VideoFrame::VideoFrame() : bits(0), data(0), dataSize(0) {
 }
 
 BinkDecoder::VideoFrame::~VideoFrame() {
@@ -242,31 +258,30 @@ BinkDecoder::AudioInfo::~AudioInfo() {
 	delete dct;
 }
 
-BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, uint32 frameCount, const Common::Rational &frameRate, bool swapPlanes, bool hasAlpha, uint32 id) :
-		_frameCount(frameCount), _frameRate(frameRate), _swapPlanes(swapPlanes), _hasAlpha(hasAlpha), _id(id), _surface(nullptr) {
+BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, uint32 frameCount, const Common::Rational &frameRate, bool swapPlanes, bool hasAlpha, uint32 id, bool parallelPlanes) :
+		_frameCount(frameCount), _frameRate(frameRate), _swapPlanes(swapPlanes), _hasAlpha(hasAlpha), _id(id),
+		_parallelPlanes(parallelPlanes), _surface(nullptr) {
 	_curFrame = -1;
 
 	for (int i = 0; i < 16; i++)
 		_huffman[i] = 0;
 
-	for (int i = 0; i < kSourceMAX; i++) {
-		_bundles[i].countLength = 0;
+	for (int g = 0; g < kPlaneGroupMAX; g++) {
+		for (int i = 0; i < kSourceMAX; i++) {
+			_bundles[g][i].countLength = 0;
 
-		_bundles[i].huffman.index = 0;
-		for (int j = 0; j < 16; j++)
-			_bundles[i].huffman.symbols[j] = j;
+			_bundles[g][i].huffman.index = 0;
+			for (int j = 0; j < 16; j++)
+				_bundles[g][i].huffman.symbols[j] = j;
 
-		_bundles[i].data     = 0;
-		_bundles[i].dataEnd  = 0;
-		_bundles[i].curDec   = 0;
-		_bundles[i].curPtr   = 0;
+			_bundles[g][i].data     = 0;
+			_bundles[g][i].dataEnd  = 0;
+			_bundles[g][i].curDec   = 0;
+			_bundles[g][i].curPtr   = 0;
+		}
 	}
 
-	for (int i = 0; i < 16; i++) {
-		_colHighHuffman[i].index = 0;
-		for (int j = 0; j < 16; j++)
-			_colHighHuffman[i].symbols[j] = j;
-	}
+	_planeOffsetModes = 0;
 
 	// Make the surface even-sized:
 	_surfaceHeight = _height = height;
@@ -459,24 +474,8 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 		_surface->w = _width;
 	}
 
-	if (_hasAlpha) {
-		if (_id == kBIKiID)
-			frame.bits->skip(32);
-
-		decodePlane(frame, 3, false);
-	}
-
-	if (_id == kBIKiID)
-		frame.bits->skip(32);
-
-	for (int i = 0; i < 3; i++) {
-		int planeIdx = ((i == 0) || !_swapPlanes) ? i : (i ^ 3);
-
-		decodePlane(frame, planeIdx, i != 0);
-
-		if (frame.bits->pos() >= frame.bits->size())
-			break;
-	}
+	if (!decodePlanesInParallel(frame))
+		decodePlanes(*frame.bits);
 
 	// Convert the YUV data we have to our format
 	// The width used here is the surface-width, and not the video-width
@@ -498,7 +497,142 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 	_curFrame++;
 }
 
-void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, bool isChroma) {
+void BinkDecoder::BinkVideoTrack::decodePlanes(Common::BitStream32LELSB &bits) {
+	uint32 offsetModes = kPlaneOffsetAll;
+
+	for (int g = _hasAlpha ? kPlaneGroupAlpha : kPlaneGroupLuma; g < kPlaneGroupMAX; g++) {
+		PlaneGroup group = (PlaneGroup)g;
+
+		if (group == kPlaneGroupChroma) {
+			if (bits.pos() < bits.size())
+				decodePlaneGroup(bits, _bundles[0], group, false);
+			break;
+		}
+
+		uint32 offsetPos = bits.pos();
+		uint32 offset    = 0;
+		if (_id == kBIKiID)
+			offset = bits.getBits<32>();
+
+		decodePlaneGroup(bits, _bundles[0], group, false);
+
+		// Remember which ways of reading the offset give the actual end of the planes
+		uint32 matchingModes = 0;
+		for (uint32 mode = 1; mode < kPlaneOffsetAll; mode <<= 1)
+			if (getPlaneEnd((PlaneOffsetMode)mode, offsetPos, offset) == bits.pos())
+				matchingModes |= mode;
+		offsetModes &= matchingModes;
+	}
+
+	_planeOffsetModes = (_id == kBIKiID) ? offsetModes : 0;
+}
+
+bool BinkDecoder::BinkVideoTrack::decodePlanesInParallel(VideoFrame &frame) {
+	if (_bundleSets < kPlaneGroupMAX || !_planeOffsetModes)
+		return false;
+
+	// The offsets matched on the last frame decoded in order, use the first way which did
+	PlaneOffsetMode mode = kPlaneOffsetFromPacket;
+	while (!(_planeOffsetModes & mode))
+		mode = (PlaneOffsetMode)(mode << 1);
+
+	const uint32 size = frame.bits->size();
+
+	PlaneGroupJobs jobs;
+	jobs.track    = this;
+	jobs.data     = frame.data;
+	jobs.dataSize = frame.dataSize;
+
+	int numJobs = 0;
+	uint32 pos = 0;
+	for (int g = _hasAlpha ? kPlaneGroupAlpha : kPlaneGroupLuma; g < kPlaneGroupMAX; g++) {
+		PlaneGroup group = (PlaneGroup)g;
+
+		if (group == kPlaneGroupChroma) {
+			jobs.start[group] = pos;
+			jobs.end[group]   = size;
+			if (pos < size)
+				jobs.groups[numJobs++] = group;
+			break;
+		}
+
+		if (pos + 32 > size)
+			return false;
+
+		uint32 offset = READ_LE_UINT32(frame.data + pos / 8);
+		jobs.start[group] = pos + 32;
+		jobs.end[group]   = getPlaneEnd(mode, pos, offset);
+		jobs.groups[numJobs++] = group;
+
+		pos = jobs.end[group];
+		if ((pos & 0x1F) || (pos < jobs.start[group]) || (pos > size))
+			return false;
+	}
+
+	g_system->runParallel(decodePlaneGroupJob, &jobs, numJobs);
+
+	// Should the planes not have ended where the offsets said, the following
+	// planes were decoded from the wrong data. They are all decoded again then.
+	for (int i = 0; i < numJobs; i++) {
+		PlaneGroup group = jobs.groups[i];
+		if (jobs.failed[group] || (group != kPlaneGroupChroma && jobs.decodedEnd[group] != jobs.end[group])) {
+			debug(1, "Bink plane offsets do not match the planes, decoding them one after the other");
+			_planeOffsetModes = 0;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void BinkDecoder::BinkVideoTrack::decodePlaneGroupJob(void *data, int job) {
+	PlaneGroupJobs &jobs = *(PlaneGroupJobs *)data;
+	PlaneGroup group = jobs.groups[job];
+	uint32 start = jobs.start[group] / 8;
+
+	Common::MemoryReadStream stream(jobs.data + start, jobs.dataSize - start);
+	Common::BitStream32LELSB bits(stream);
+
+	jobs.failed[group]     = !jobs.track->decodePlaneGroup(bits, jobs.track->_bundles[group], group, true);
+	jobs.decodedEnd[group] = jobs.start[group] + bits.pos();
+}
+
+bool BinkDecoder::BinkVideoTrack::decodePlaneGroup(Common::BitStream32LELSB &bits, Bundle *bundles, PlaneGroup group, bool speculative) {
+	switch (group) {
+	case kPlaneGroupAlpha:
+		return decodePlane(bits, bundles, 3, false, speculative);
+	case kPlaneGroupLuma:
+		return decodePlane(bits, bundles, 0, false, speculative);
+	case kPlaneGroupChroma:
+		for (int i = 1; i < 3; i++) {
+			int planeIdx = _swapPlanes ? (i ^ 3) : i;
+
+			if (!decodePlane(bits, bundles, planeIdx, true, speculative))
+				return false;
+
+			if (bits.pos() >= bits.size())
+				break;
+		}
+		return true;
+	default:
+		return true;
+	}
+}
+
+uint32 BinkDecoder::BinkVideoTrack::getPlaneEnd(PlaneOffsetMode mode, uint32 offsetPos, uint32 offset) {
+	switch (mode) {
+	case kPlaneOffsetFromPacket:
+		return offset * 8;
+	case kPlaneOffsetFromOffset:
+		return offsetPos + offset * 8;
+	case kPlaneOffsetFromPlanes:
+		return offsetPos + 32 + offset * 8;
+	default:
+		return 0;
+	}
+}
+
+bool BinkDecoder::BinkVideoTrack::decodePlane(Common::BitStream32LELSB &bits, Bundle *bundles, int planeIdx, bool isChroma, bool speculative) {
 	uint32 blockWidth  = isChroma ? _uvBlockWidth  : _yBlockWidth;
 	uint32 blockHeight = isChroma ? _uvBlockHeight : _yBlockHeight;
 	uint32 width       = blockWidth  * 8;
@@ -506,7 +640,8 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 
 	DecodeContext ctx;
 
-	ctx.video     = &video;
+	ctx.bits      = &bits;
+	ctx.bundles   = bundles;
 	ctx.planeIdx  = planeIdx;
 	ctx.destStart = _curPlanes[planeIdx];
 	ctx.destEnd   = _curPlanes[planeIdx] + width * height;
@@ -514,6 +649,9 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 	ctx.prevEnd   = _oldPlanes[planeIdx] + width * height;
 	ctx.pitch     = width;
 
+	ctx.speculative = speculative;
+	ctx.failed      = false;
+
 	for (int i = 0; i < 64; i++) {
 		ctx.coordMap[i] = (i & 7) + (i >> 3) * ctx.pitch;
 
@@ -524,27 +662,29 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 	}
 
 	for (int i = 0; i < kSourceMAX; i++) {
-		_bundles[i].countLength = _bundles[i].countLengths[isChroma ? 1 : 0];
+		ctx.bundles[i].countLength = ctx.bundles[i].countLengths[isChroma ? 1 : 0];
 
-		readBundle(video, (Source) i);
+		readBundle(ctx, (Source) i);
 	}
 
 	for (ctx.blockY = 0; ctx.blockY < blockHeight; ctx.blockY++) {
-		readBlockTypes              (video, _bundles[kSourceBlockTypes]);
-		readBlockTypes              (video, _bundles[kSourceSubBlockTypes]);
-		readColors                  (video, _bundles[kSourceColors]);
-		readPatterns                (video, _bundles[kSourcePattern]);
-		readMotionValues            (video, _bundles[kSourceXOff]);
-		readMotionValues            (video, _bundles[kSourceYOff]);
-		readDCS<kDCStartBits, false>(video, _bundles[kSourceIntraDC]);
-		readDCS<kDCStartBits, true> (video, _bundles[kSourceInterDC]);
-		readRuns                    (video, _bundles[kSourceRun]);
+		readBlockTypes              (ctx, ctx.bundles[kSourceBlockTypes]);
+		readBlockTypes              (ctx, ctx.bundles[kSourceSubBlockTypes]);
+		readColors                  (ctx, ctx.bundles[kSourceColors]);
+		readPatterns                (ctx, ctx.bundles[kSourcePattern]);
+		readMotionValues            (ctx, ctx.bundles[kSourceXOff]);
+		readMotionValues            (ctx, ctx.bundles[kSourceYOff]);
+		readDCS<kDCStartBits, false>(ctx, ctx.bundles[kSourceIntraDC]);
+		readDCS<kDCStartBits, true> (ctx, ctx.bundles[kSourceInterDC]);
+		readRuns                    (ctx, ctx.bundles[kSourceRun]);
+		if (ctx.failed)
+			return false;
 
 		ctx.dest = ctx.destStart + 8 * ctx.blockY * ctx.pitch;
 		ctx.prev = ctx.prevStart + 8 * ctx.blockY * ctx.pitch;
 
 		for (ctx.blockX = 0; ctx.blockX < blockWidth; ctx.blockX++, ctx.dest += 8, ctx.prev += 8) {
-			BlockType blockType = (BlockType) getBundleValue(kSourceBlockTypes);
+			BlockType blockType = (BlockType) getBundleValue(ctx, kSourceBlockTypes);
 
 			// 16x16 block type on odd line means part of the already decoded block, so skip it
 			if ((ctx.blockY & 1) && (blockType == kBlockScaled)) {
@@ -586,35 +726,66 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 				blockRaw(ctx);
 				break;
 			default:
-				error("Unknown block type: %d", blockType);
+				decodeError(ctx, "Unknown block type: %d", blockType);
 			}
 
+			if (ctx.failed)
+				return false;
 		}
 
 	}
 
-	if (video.bits->pos() & 0x1F) // next plane data starts at 32-bit boundary
-		video.bits->skip(32 - (video.bits->pos() & 0x1F));
+	if (bits.pos() & 0x1F) // next plane data starts at 32-bit boundary
+		bits.skip(32 - (bits.pos() & 0x1F));
 
+	return true;
 }
 
-void BinkDecoder::BinkVideoTrack::readBundle(VideoFrame &video, Source source) {
+void BinkDecoder::BinkVideoTrack::decodeError(DecodeContext &ctx, const char *s, ...) {
+	if (ctx.speculative) {
+		ctx.failed = true;
+		return;
+	}
+
+	va_list va;
+	va_start(va, s);
+	Common::String message = Common::String::vformat(s, va);
+	va_end(va);
+
+	error("%s", message.c_str());
+}
+
+void BinkDecoder::BinkVideoTrack::decodeWarning(DecodeContext &ctx, const char *s, ...) {
+	if (ctx.speculative) {
+		ctx.failed = true;
+		return;
+	}
+
+	va_list va;
+	va_start(va, s);
+	Common::String message = Common::String::vformat(s, va);
+	va_end(va);
+
+	warning("%s", message.c_str());
+}
+
+void BinkDecoder::BinkVideoTrack::readBundle(DecodeContext &ctx, Source source) {
 	if (source == kSourceColors) {
 		for (int i = 0; i < 16; i++)
-			readHuffman(video, _colHighHuffman[i]);
+			readHuffman(ctx, ctx.colHighHuffman[i]);
 
-		_colLastVal = 0;
+		ctx.colLastVal = 0;
 	}
 
 	if ((source != kSourceIntraDC) && (source != kSourceInterDC))
-		readHuffman(video, _bundles[source].huffman);
+		readHuffman(ctx, ctx.bundles[source].huffman);
 
-	_bundles[source].curDec = _bundles[source].data;
-	_bundles[source].curPtr = _bundles[source].data;
+	ctx.bundles[source].curDec = ctx.bundles[source].data;
+	ctx.bundles[source].curPtr = ctx.bundles[source].data;
 }
 
-void BinkDecoder::BinkVideoTrack::readHuffman(VideoFrame &video, Huffman &huffman) {
-	huffman.index = video.bits->getBits<4>();
+void BinkDecoder::BinkVideoTrack::readHuffman(DecodeContext &ctx, Huffman &huffman) {
+	huffman.index = ctx.bits->getBits<4>();
 
 	if (huffman.index == 0) {
 		// The first tree always gives raw nibbles
@@ -626,17 +797,18 @@ void BinkDecoder::BinkVideoTrack::readHuffman(VideoFrame &video, Huffman &huffma
 
 	byte hasSymbol[16];
 
-	if (video.bits->getBit()) {
+	if (ctx.bits->getBit()) {
 		// Symbol selection
 		memset(hasSymbol, 0, 16);
 
-		uint8 length = video.bits->getBits<3>();
+		uint8 length = ctx.bits->getBits<3>();
 		for (int i = 0; i <= length; i++) {
-			huffman.symbols[i] = video.bits->getBits<4>();
+			huffman.symbols[i] = ctx.bits->getBits<4>();
 			hasSymbol[huffman.symbols[i]] = 1;
 		}
 
-		for (int i = 0; i < 16; i++)
+		// Symbols selected twice would leave no room for the rest
+		for (int i = 0; i < 16 && length < 15; i++)
 			if (hasSymbol[i] == 0)
 				huffman.symbols[++length] = i;
 
@@ -648,7 +820,7 @@ void BinkDecoder::BinkVideoTrack::readHuffman(VideoFrame &video, Huffman &huffma
 	byte tmp1[16], tmp2[16];
 	byte *in = tmp1, *out = tmp2;
 
-	uint8 depth = video.bits->getBits<2>();
+	uint8 depth = ctx.bits->getBits<2>();
 
 	for (int i = 0; i < 16; i++)
 		in[i] = i;
@@ -657,7 +829,7 @@ void BinkDecoder::BinkVideoTrack::readHuffman(VideoFrame &video, Huffman &huffma
 		int size = 1 << i;
 
 		for (int j = 0; j < 16; j += (size << 1))
-			mergeHuffmanSymbols(video, out + j, in + j, size);
+			mergeHuffmanSymbols(ctx, out + j, in + j, size);
 
 		SWAP(in, out);
 	}
@@ -665,12 +837,12 @@ void BinkDecoder::BinkVideoTrack::readHuffman(VideoFrame &video, Huffman &huffma
 	memcpy(huffman.symbols, in, 16);
 }
 
-void BinkDecoder::BinkVideoTrack::mergeHuffmanSymbols(VideoFrame &video, byte *dst, const byte *src, int size) {
+void BinkDecoder::BinkVideoTrack::mergeHuffmanSymbols(DecodeContext &ctx, byte *dst, const byte *src, int size) {
 	const byte *src2  = src + size;
 	int size2 = size;
 
 	do {
-		if (!video.bits->getBit()) {
+		if (!ctx.bits->getBit()) {
 			*dst++ = *src++;
 			size--;
 		} else {
@@ -692,33 +864,41 @@ void BinkDecoder::BinkVideoTrack::initBundles() {
 	uint32 bh     = (_height + 7) >> 3;
 	uint32 blocks = bw * bh;
 
-	for (int i = 0; i < kSourceMAX; i++) {
-		_bundles[i].data    = new byte[blocks * 64];
-		_bundles[i].dataEnd = _bundles[i].data + blocks * 64;
-	}
+	// Only BIKi frames tell where their planes are, so that they can be decoded in parallel
+	_bundleSets = (_parallelPlanes && _id == kBIKiID && g_system->getParallelJobCount() > 1) ? kPlaneGroupMAX : 1;
 
 	uint32 cbw[2] = { (uint32)((_width + 7) >> 3), (uint32)((_width  + 15) >> 4) };
 	uint32 cw [2] = { (uint32)( _width          ), (uint32)( _width        >> 1) };
 
-	// Calculate the lengths of an element count in bits
-	for (int i = 0; i < 2; i++) {
-		int width = MAX<uint32>(cw[i], 8);
+	for (int g = 0; g < _bundleSets; g++) {
+		Bundle *bundles = _bundles[g];
 
-		_bundles[kSourceBlockTypes   ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
-		_bundles[kSourceSubBlockTypes].countLengths[i] = Common::intLog2(((width + 7) >> 4) + 511) + 1;
-		_bundles[kSourceColors       ].countLengths[i] = Common::intLog2((cbw[i])     * 64  + 511) + 1;
-		_bundles[kSourceIntraDC      ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
-		_bundles[kSourceInterDC      ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
-		_bundles[kSourceXOff         ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
-		_bundles[kSourceYOff         ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
-		_bundles[kSourcePattern      ].countLengths[i] = Common::intLog2((cbw[i]      << 3) + 511) + 1;
-		_bundles[kSourceRun          ].countLengths[i] = Common::intLog2((cbw[i])     * 48  + 511) + 1;
+		for (int i = 0; i < kSourceMAX; i++) {
+			bundles[i].data    = new byte[blocks * 64];
+			bundles[i].dataEnd = bundles[i].data + blocks * 64;
+		}
+
+		// Calculate the lengths of an element count in bits
+		for (int i = 0; i < 2; i++) {
+			int width = MAX<uint32>(cw[i], 8);
+
+			bundles[kSourceBlockTypes   ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
+			bundles[kSourceSubBlockTypes].countLengths[i] = Common::intLog2(((width + 7) >> 4) + 511) + 1;
+			bundles[kSourceColors       ].countLengths[i] = Common::intLog2((cbw[i])     * 64  + 511) + 1;
+			bundles[kSourceIntraDC      ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
+			bundles[kSourceInterDC      ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
+			bundles[kSourceXOff         ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
+			bundles[kSourceYOff         ].countLengths[i] = Common::intLog2((width       >> 3) + 511) + 1;
+			bundles[kSourcePattern      ].countLengths[i] = Common::intLog2((cbw[i]      << 3) + 511) + 1;
+			bundles[kSourceRun          ].countLengths[i] = Common::intLog2((cbw[i])     * 48  + 511) + 1;
+		}
 	}
 }
 
 void BinkDecoder::BinkVideoTrack::deinitBundles() {
-	for (int i = 0; i < kSourceMAX; i++)
-		delete[] _bundles[i].data;
+	for (int g = 0; g < _bundleSets; g++)
+		for (int i = 0; i < kSourceMAX; i++)
+			delete[] _bundles[g][i].data;
 }
 
 void BinkDecoder::BinkVideoTrack::initHuffman() {
@@ -726,29 +906,29 @@ void BinkDecoder::BinkVideoTrack::initHuffman() {
 		_huffman[i] = new Common::Huffman<Common::BitStream32LELSB>(binkHuffmanLengths[i][15], 16, binkHuffmanCodes[i], binkHuffmanLengths[i]);
 }
 
-byte BinkDecoder::BinkVideoTrack::getHuffmanSymbol(VideoFrame &video, Huffman &huffman) {
-	return huffman.symbols[_huffman[huffman.index]->getSymbol(*video.bits)];
+byte BinkDecoder::BinkVideoTrack::getHuffmanSymbol(DecodeContext &ctx, Huffman &huffman) {
+	return huffman.symbols[_huffman[huffman.index]->getSymbol(*ctx.bits)];
 }
 
-int32 BinkDecoder::BinkVideoTrack::getBundleValue(Source source) {
+int32 BinkDecoder::BinkVideoTrack::getBundleValue(DecodeContext &ctx, Source source) {
 	if ((source < kSourceXOff) || (source == kSourceRun))
-		return *_bundles[source].curPtr++;
+		return *ctx.bundles[source].curPtr++;
 
 	if ((source == kSourceXOff) || (source == kSourceYOff))
-		return (int8) *_bundles[source].curPtr++;
+		return (int8) *ctx.bundles[source].curPtr++;
 
-	int16 ret = *((int16 *) _bundles[source].curPtr);
+	int16 ret = *((int16 *) ctx.bundles[source].curPtr);
 
-	_bundles[source].curPtr += 2;
+	ctx.bundles[source].curPtr += 2;
 
 	return ret;
 }
 
-uint32 BinkDecoder::BinkVideoTrack::readBundleCount(VideoFrame &video, Bundle &bundle) {
+uint32 BinkDecoder::BinkVideoTrack::readBundleCount(DecodeContext &ctx, Bundle &bundle) {
 	if (!bundle.curDec || (bundle.curDec > bundle.curPtr))
 		return 0;
 
-	uint32 n = video.bits->getBits(bundle.countLength);
+	uint32 n = ctx.bits->getBits(bundle.countLength);
 	if (n == 0)
 		bundle.curDec = 0;
 
@@ -772,19 +952,21 @@ void BinkDecoder::BinkVideoTrack::blockScaledSkip(DecodeContext &ctx) {
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledRun(DecodeContext &ctx) {
-	const uint8 *scan = binkPatterns[ctx.video->bits->getBits<4>()];
+	const uint8 *scan = binkPatterns[ctx.bits->getBits<4>()];
 
 	int i = 0;
 	do {
-		int run = getBundleValue(kSourceRun) + 1;
+		int run = getBundleValue(ctx, kSourceRun) + 1;
 
 		i += run;
-		if (i > 64)
-			error("Run went out of bounds");
+		if (i > 64) {
+			decodeError(ctx, "Run went out of bounds");
+			return;
+		}
 
-		if (ctx.video->bits->getBit()) {
+		if (ctx.bits->getBit()) {
 
-			byte v = getBundleValue(kSourceColors);
+			byte v = getBundleValue(ctx, kSourceColors);
 			for (int j = 0; j < run; j++, scan++)
 				ctx.dest[ctx.coordScaledMap1[*scan]] =
 				ctx.dest[ctx.coordScaledMap2[*scan]] =
@@ -796,7 +978,7 @@ void BinkDecoder::BinkVideoTrack::blockScaledRun(DecodeContext &ctx) {
 				ctx.dest[ctx.coordScaledMap1[*scan]] =
 				ctx.dest[ctx.coordScaledMap2[*scan]] =
 				ctx.dest[ctx.coordScaledMap3[*scan]] =
-				ctx.dest[ctx.coordScaledMap4[*scan]] = getBundleValue(kSourceColors);
+				ctx.dest[ctx.coordScaledMap4[*scan]] = getBundleValue(ctx, kSourceColors);
 
 	} while (i < 63);
 
@@ -804,32 +986,24 @@ void BinkDecoder::BinkVideoTrack::blockScaledRun(DecodeContext &ctx) {
 		ctx.dest[ctx.coordScaledMap1[*scan]] =
 		ctx.dest[ctx.coordScaledMap2[*scan]] =
 		ctx.dest[ctx.coordScaledMap3[*scan]] =
-		ctx.dest[ctx.coordScaledMap4[*scan]] = getBundleValue(kSourceColors);
+		ctx.dest[ctx.coordScaledMap4[*scan]] = getBundleValue(ctx, kSourceColors);
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledIntra(DecodeContext &ctx) {
 	int32 block[64];
 	memset(block, 0, 64 * sizeof(int32));
 
-	block[0] = getBundleValue(kSourceIntraDC);
+	block[0] = getBundleValue(ctx, kSourceIntraDC);
 
-	readDCTCoeffs(*ctx.video, block, true);
+	readDCTCoeffs(ctx, block, true);
 
-	IDCT(block);
-
-	int32 *src   = block;
-	byte  *dest1 = ctx.dest;
-	byte  *dest2 = ctx.dest + ctx.pitch;
-	for (int j = 0; j < 8; j++, dest1 += (ctx.pitch << 1) - 16, dest2 += (ctx.pitch << 1) - 16, src += 8) {
-
-		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2)
-			dest1[0] = dest1[1] = dest2[0] = dest2[1] = src[i];
-
-	}
+	byte pixels[64];
+	BinkDSP::idctPut(pixels, 8, block);
+	BinkDSP::scale(ctx.dest, ctx.pitch, pixels);
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledFill(DecodeContext &ctx) {
-	byte v = getBundleValue(kSourceColors);
+	byte v = getBundleValue(ctx, kSourceColors);
 
 	byte *dest = ctx.dest;
 	for (int i = 0; i < 16; i++, dest += ctx.pitch)
@@ -840,35 +1014,34 @@ void BinkDecoder::BinkVideoTrack::blockScaledPattern(DecodeContext &ctx) {
 	byte col[2];
 
 	for (int i = 0; i < 2; i++)
-		col[i] = getBundleValue(kSourceColors);
+		col[i] = getBundleValue(ctx, kSourceColors);
 
-	byte *dest1 = ctx.dest;
-	byte *dest2 = ctx.dest + ctx.pitch;
-	for (int j = 0; j < 8; j++, dest1 += (ctx.pitch << 1) - 16, dest2 += (ctx.pitch << 1) - 16) {
-		byte v = getBundleValue(kSourcePattern);
+	byte pixels[64];
+	byte *dest = pixels;
+	for (int j = 0; j < 8; j++) {
+		byte v = getBundleValue(ctx, kSourcePattern);
 
-		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2, v >>= 1)
-			dest1[0] = dest1[1] = dest2[0] = dest2[1] = col[v & 1];
+		for (int i = 0; i < 8; i++, v >>= 1)
+			*dest++ = col[v & 1];
 	}
+
+	BinkDSP::scale(ctx.dest, ctx.pitch, pixels);
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledRaw(DecodeContext &ctx) {
-	byte row[8];
-
-	byte *dest1 = ctx.dest;
-	byte *dest2 = ctx.dest + ctx.pitch;
-	for (int j = 0; j < 8; j++, dest1 += (ctx.pitch << 1) - 16, dest2 += (ctx.pitch << 1) - 16) {
-		memcpy(row, _bundles[kSourceColors].curPtr, 8);
-
-		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2)
-			dest1[0] = dest1[1] = dest2[0] = dest2[1] = row[i];
+	BinkDSP::scale(ctx.dest, ctx.pitch, ctx.bundles[kSourceColors].curPtr);
 
-		_bundles[kSourceColors].curPtr += 8;
-	}
+	ctx.bundles[kSourceColors].curPtr += 64;
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaled(DecodeContext &ctx) {
-	BlockType blockType = (BlockType) getBundleValue(kSourceSubBlockTypes);
+	BlockType blockType = (BlockType) getBundleValue(ctx, kSourceSubBlockTypes);
+
+	// A damaged stream could place the block past the plane, skip it then
+	if (ctx.dest + 15 * ctx.pitch + 16 > ctx.destEnd) {
+		decodeWarning(ctx, "16x16 block out of bounds (%d | %d)", ctx.blockX * 8, ctx.blockY * 8);
+		return;
+	}
 
 	switch (blockType) {
 	case kBlockRun:
@@ -887,7 +1060,8 @@ void BinkDecoder::BinkVideoTrack::blockScaled(DecodeContext &ctx) {
 		blockScaledRaw(ctx);
 		break;
 	default:
-		error("Invalid 16x16 block type: %d", blockType);
+		decodeError(ctx, "Invalid 16x16 block type: %d", blockType);
+		return;
 	}
 
 	ctx.blockX += 1;
@@ -896,54 +1070,60 @@ void BinkDecoder::BinkVideoTrack::blockScaled(DecodeContext &ctx) {
 }
 
 void BinkDecoder::BinkVideoTrack::blockMotion(DecodeContext &ctx) {
-	int8 xOff = getBundleValue(kSourceXOff);
-	int8 yOff = getBundleValue(kSourceYOff);
+	int8 xOff = getBundleValue(ctx, kSourceXOff);
+	int8 yOff = getBundleValue(ctx, kSourceYOff);
 
 	byte *dest = ctx.dest;
 	byte *prev = ctx.prev + yOff * ((int32) ctx.pitch) + xOff;
-	if ((prev < ctx.prevStart) || (prev > ctx.prevEnd))
-		error("Copy out of bounds (%d | %d)", ctx.blockX * 8 + xOff, ctx.blockY * 8 + yOff);
+	if ((prev < ctx.prevStart) || (prev + 7 * ctx.pitch + 8 > ctx.prevEnd)) {
+		decodeError(ctx, "Copy out of bounds (%d | %d)", ctx.blockX * 8 + xOff, ctx.blockY * 8 + yOff);
+		return;
+	}
 
 	for (int j = 0; j < 8; j++, dest += ctx.pitch, prev += ctx.pitch)
 		memcpy(dest, prev, 8);
 }
 
 void BinkDecoder::BinkVideoTrack::blockRun(DecodeContext &ctx) {
-	const uint8 *scan = binkPatterns[ctx.video->bits->getBits<4>()];
+	const uint8 *scan = binkPatterns[ctx.bits->getBits<4>()];
 
 	int i = 0;
 	do {
-		int run = getBundleValue(kSourceRun) + 1;
+		int run = getBundleValue(ctx, kSourceRun) + 1;
 
 		i += run;
-		if (i > 64)
-			error("Run went out of bounds");
+		if (i > 64) {
+			decodeError(ctx, "Run went out of bounds");
+			return;
+		}
 
-		if (ctx.video->bits->getBit()) {
+		if (ctx.bits->getBit()) {
 
-			byte v = getBundleValue(kSourceColors);
+			byte v = getBundleValue(ctx, kSourceColors);
 			for (int j = 0; j < run; j++)
 				ctx.dest[ctx.coordMap[*scan++]] = v;
 
 		} else
 			for (int j = 0; j < run; j++)
-				ctx.dest[ctx.coordMap[*scan++]] = getBundleValue(kSourceColors);
+				ctx.dest[ctx.coordMap[*scan++]] = getBundleValue(ctx, kSourceColors);
 
 	} while (i < 63);
 
 	if (i == 63)
-		ctx.dest[ctx.coordMap[*scan++]] = getBundleValue(kSourceColors);
+		ctx.dest[ctx.coordMap[*scan++]] = getBundleValue(ctx, kSourceColors);
 }
 
 void BinkDecoder::BinkVideoTrack::blockResidue(DecodeContext &ctx) {
 	blockMotion(ctx);
+	if (ctx.failed)
+		return;
 
-	byte v = ctx.video->bits->getBits<7>();
+	byte v = ctx.bits->getBits<7>();
 
 	int16 block[64];
 	memset(block, 0, 64 * sizeof(int16));
 
-	readResidue(*ctx.video, block, v);
+	readResidue(ctx, block, v);
 
 	byte  *dst = ctx.dest;
 	int16 *src = block;
@@ -956,15 +1136,15 @@ void BinkDecoder::BinkVideoTrack::blockIntra(DecodeContext &ctx) {
 	int32 block[64];
 	memset(block, 0, 64 * sizeof(int32));
 
-	block[0] = getBundleValue(kSourceIntraDC);
+	block[0] = getBundleValue(ctx, kSourceIntraDC);
 
-	readDCTCoeffs(*ctx.video, block, true);
+	readDCTCoeffs(ctx, block, true);
 
-	IDCTPut(ctx, block);
+	BinkDSP::idctPut(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockFill(DecodeContext &ctx) {
-	byte v = getBundleValue(kSourceColors);
+	byte v = getBundleValue(ctx, kSourceColors);
 
 	byte *dest = ctx.dest;
 	for (int i = 0; i < 8; i++, dest += ctx.pitch)
@@ -973,26 +1153,28 @@ void BinkDecoder::BinkVideoTrack::blockFill(DecodeContext &ctx) {
 
 void BinkDecoder::BinkVideoTrack::blockInter(DecodeContext &ctx) {
 	blockMotion(ctx);
+	if (ctx.failed)
+		return;
 
 	int32 block[64];
 	memset(block, 0, 64 * sizeof(int32));
 
-	block[0] = getBundleValue(kSourceInterDC);
+	block[0] = getBundleValue(ctx, kSourceInterDC);
 
-	readDCTCoeffs(*ctx.video, block, false);
+	readDCTCoeffs(ctx, block, false);
 
-	IDCTAdd(ctx, block);
+	BinkDSP::idctAdd(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockPattern(DecodeContext &ctx) {
 	byte col[2];
 
 	for (int i = 0; i < 2; i++)
-		col[i] = getBundleValue(kSourceColors);
+		col[i] = getBundleValue(ctx, kSourceColors);
 
 	byte *dest = ctx.dest;
 	for (int i = 0; i < 8; i++, dest += ctx.pitch - 8) {
-		byte v = getBundleValue(kSourcePattern);
+		byte v = getBundleValue(ctx, kSourcePattern);
 
 		for (int j = 0; j < 8; j++, v >>= 1)
 			*dest++ = col[v & 1];
@@ -1001,47 +1183,51 @@ void BinkDecoder::BinkVideoTrack::blockPattern(DecodeContext &ctx) {
 
 void BinkDecoder::BinkVideoTrack::blockRaw(DecodeContext &ctx) {
 	byte *dest = ctx.dest;
-	byte *data = _bundles[kSourceColors].curPtr;
+	byte *data = ctx.bundles[kSourceColors].curPtr;
 	for (int i = 0; i < 8; i++, dest += ctx.pitch, data += 8)
 		memcpy(dest, data, 8);
 
-	_bundles[kSourceColors].curPtr += 64;
+	ctx.bundles[kSourceColors].curPtr += 64;
 }
 
-void BinkDecoder::BinkVideoTrack::readRuns(VideoFrame &video, Bundle &bundle) {
-	uint32 n = readBundleCount(video, bundle);
+void BinkDecoder::BinkVideoTrack::readRuns(DecodeContext &ctx, Bundle &bundle) {
+	uint32 n = readBundleCount(ctx, bundle);
 	if (n == 0)
 		return;
 
 	byte *decEnd = bundle.curDec + n;
-	if (decEnd > bundle.dataEnd)
-		error("Run value went out of bounds");
+	if (decEnd > bundle.dataEnd) {
+		decodeError(ctx, "Run value went out of bounds");
+		return;
+	}
 
-	if (video.bits->getBit()) {
-		byte v = video.bits->getBits<4>();
+	if (ctx.bits->getBit()) {
+		byte v = ctx.bits->getBits<4>();
 
 		memset(bundle.curDec, v, n);
 		bundle.curDec += n;
 
 	} else
 		while (bundle.curDec < decEnd)
-			*bundle.curDec++ = getHuffmanSymbol(video, bundle.huffman);
+			*bundle.curDec++ = getHuffmanSymbol(ctx, bundle.huffman);
 }
 
-void BinkDecoder::BinkVideoTrack::readMotionValues(VideoFrame &video, Bundle &bundle) {
-	uint32 n = readBundleCount(video, bundle);
+void BinkDecoder::BinkVideoTrack::readMotionValues(DecodeContext &ctx, Bundle &bundle) {
+	uint32 n = readBundleCount(ctx, bundle);
 	if (n == 0)
 		return;
 
 	byte *decEnd = bundle.curDec + n;
-	if (decEnd > bundle.dataEnd)
-		error("Too many motion values");
+	if (decEnd > bundle.dataEnd) {
+		decodeError(ctx, "Too many motion values");
+		return;
+	}
 
-	if (video.bits->getBit()) {
-		byte v = video.bits->getBits<4>();
+	if (ctx.bits->getBit()) {
+		byte v = ctx.bits->getBits<4>();
 
 		if (v) {
-			int sign = -(int)video.bits->getBit();
+			int sign = -(int)ctx.bits->getBit();
 			v = (v ^ sign) - sign;
 		}
 
@@ -1052,10 +1238,10 @@ void BinkDecoder::BinkVideoTrack::readMotionValues(VideoFrame &video, Bundle &bu
 	}
 
 	do {
-		byte v = getHuffmanSymbol(video, bundle.huffman);
+		byte v = getHuffmanSymbol(ctx, bundle.huffman);
 
 		if (v) {
-			int sign = -(int)video.bits->getBit();
+			int sign = -(int)ctx.bits->getBit();
 			v = (v ^ sign) - sign;
 		}
 
@@ -1065,17 +1251,19 @@ void BinkDecoder::BinkVideoTrack::readMotionValues(VideoFrame &video, Bundle &bu
 }
 
 const uint8 rleLens[4] = { 4, 8, 12, 32 };
-void BinkDecoder::BinkVideoTrack::readBlockTypes(VideoFrame &video, Bundle &bundle) {
-	uint32 n = readBundleCount(video, bundle);
+void BinkDecoder::BinkVideoTrack::readBlockTypes(DecodeContext &ctx, Bundle &bundle) {
+	uint32 n = readBundleCount(ctx, bundle);
 	if (n == 0)
 		return;
 
 	byte *decEnd = bundle.curDec + n;
-	if (decEnd > bundle.dataEnd)
-		error("Too many block type values");
+	if (decEnd > bundle.dataEnd) {
+		decodeError(ctx, "Too many block type values");
+		return;
+	}
 
-	if (video.bits->getBit()) {
-		byte v = video.bits->getBits<4>();
+	if (ctx.bits->getBit()) {
+		byte v = ctx.bits->getBits<4>();
 
 		memset(bundle.curDec, v, n);
 
@@ -1086,13 +1274,19 @@ void BinkDecoder::BinkVideoTrack::readBlockTypes(VideoFrame &video, Bundle &bund
 	byte last = 0;
 	do {
 
-		byte v = getHuffmanSymbol(video, bundle.huffman);
+		byte v = getHuffmanSymbol(ctx, bundle.huffman);
 
 		if (v < 12) {
 			last = v;
 			*bundle.curDec++ = v;
 		} else {
 			int run = rleLens[v - 12];
+			if (bundle.curDec + run > bundle.dataEnd) {
+				decodeWarning(ctx, "Too many block type values");
+				if (ctx.failed)
+					return;
+				run = bundle.dataEnd - bundle.curDec;
+			}
 
 			memset(bundle.curDec, last, run);
 
@@ -1102,39 +1296,43 @@ void BinkDecoder::BinkVideoTrack::readBlockTypes(VideoFrame &video, Bundle &bund
 	} while (bundle.curDec < decEnd);
 }
 
-void BinkDecoder::BinkVideoTrack::readPatterns(VideoFrame &video, Bundle &bundle) {
-	uint32 n = readBundleCount(video, bundle);
+void BinkDecoder::BinkVideoTrack::readPatterns(DecodeContext &ctx, Bundle &bundle) {
+	uint32 n = readBundleCount(ctx, bundle);
 	if (n == 0)
 		return;
 
 	byte *decEnd = bundle.curDec + n;
-	if (decEnd > bundle.dataEnd)
-		error("Too many pattern values");
+	if (decEnd > bundle.dataEnd) {
+		decodeError(ctx, "Too many pattern values");
+		return;
+	}
 
 	byte v;
 	while (bundle.curDec < decEnd) {
-		v  = getHuffmanSymbol(video, bundle.huffman);
-		v |= getHuffmanSymbol(video, bundle.huffman) << 4;
+		v  = getHuffmanSymbol(ctx, bundle.huffman);
+		v |= getHuffmanSymbol(ctx, bundle.huffman) << 4;
 		*bundle.curDec++ = v;
 	}
 }
 
 
-void BinkDecoder::BinkVideoTrack::readColors(VideoFrame &video, Bundle &bundle) {
-	uint32 n = readBundleCount(video, bundle);
+void BinkDecoder::BinkVideoTrack::readColors(DecodeContext &ctx, Bundle &bundle) {
+	uint32 n = readBundleCount(ctx, bundle);
 	if (n == 0)
 		return;
 
 	byte *decEnd = bundle.curDec + n;
-	if (decEnd > bundle.dataEnd)
-		error("Too many color values");
+	if (decEnd > bundle.dataEnd) {
+		decodeError(ctx, "Too many color values");
+		return;
+	}
 
-	if (video.bits->getBit()) {
-		_colLastVal = getHuffmanSymbol(video, _colHighHuffman[_colLastVal]);
+	if (ctx.bits->getBit()) {
+		ctx.colLastVal = getHuffmanSymbol(ctx, ctx.colHighHuffman[ctx.colLastVal]);
 
 		byte v;
-		v = getHuffmanSymbol(video, bundle.huffman);
-		v = (_colLastVal << 4) | v;
+		v = getHuffmanSymbol(ctx, bundle.huffman);
+		v = (ctx.colLastVal << 4) | v;
 
 		if (_id != kBIKiID) {
 			int sign = ((int8) v) >> 7;
@@ -1149,11 +1347,11 @@ void BinkDecoder::BinkVideoTrack::readColors(VideoFrame &video, Bundle &bundle)
 	}
 
 	while (bundle.curDec < decEnd) {
-		_colLastVal = getHuffmanSymbol(video, _colHighHuffman[_colLastVal]);
+		ctx.colLastVal = getHuffmanSymbol(ctx, ctx.colHighHuffman[ctx.colLastVal]);
 
 		byte v;
-		v = getHuffmanSymbol(video, bundle.huffman);
-		v = (_colLastVal << 4) | v;
+		v = getHuffmanSymbol(ctx, bundle.huffman);
+		v = (ctx.colLastVal << 4) | v;
 
 		if (_id != kBIKiID) {
 			int sign = ((int8) v) >> 7;
@@ -1165,16 +1363,25 @@ void BinkDecoder::BinkVideoTrack::readColors(VideoFrame &video, Bundle &bundle)
 }
 
 template<int startBits, bool hasSign>
-void BinkDecoder::BinkVideoTrack::readDCS(VideoFrame &video, Bundle &bundle) {
-	uint32 length = readBundleCount(video, bundle);
+void BinkDecoder::BinkVideoTrack::readDCS(DecodeContext &ctx, Bundle &bundle) {
+	uint32 length = readBundleCount(ctx, bundle);
 	if (length == 0)
 		return;
 
+	if (bundle.curDec + length * 2 > bundle.dataEnd) {
+		decodeWarning(ctx, "Too many DC values");
+		if (ctx.failed)
+			return;
+		length = (bundle.dataEnd - bundle.curDec) / 2;
+		if (length == 0)
+			return;
+	}
+
 	int16 *dest = (int16 *) bundle.curDec;
 
-	int32 v = video.bits->getBits<startBits - (hasSign ? 1 : 0)>();
+	int32 v = ctx.bits->getBits<startBits - (hasSign ? 1 : 0)>();
 	if (v && hasSign) {
-		int sign = -(int)video.bits->getBit();
+		int sign = -(int)ctx.bits->getBit();
 		v = (v ^ sign) - sign;
 	}
 
@@ -1184,22 +1391,24 @@ void BinkDecoder::BinkVideoTrack::readDCS(VideoFrame &video, Bundle &bundle) {
 	for (uint32 i = 0; i < length; i += 8) {
 		uint32 length2 = MIN<uint32>(length - i, 8);
 
-		byte bSize = video.bits->getBits<4>();
+		byte bSize = ctx.bits->getBits<4>();
 
 		if (bSize) {
 
 			for (uint32 j = 0; j < length2; j++) {
-				int16 v2 = video.bits->getBits(bSize);
+				int16 v2 = ctx.bits->getBits(bSize);
 				if (v2) {
-					int sign = -(int)video.bits->getBit();
+					int sign = -(int)ctx.bits->getBit();
 					v2 = (v2 ^ sign) - sign;
 				}
 
 				v += v2;
 				*dest++ = v;
 
-				if ((v < -32768) || (v > 32767))
-					error("DC value went out of bounds: %d", v);
+				if ((v < -32768) || (v > 32767)) {
+					decodeError(ctx, "DC value went out of bounds: %d", v);
+					return;
+				}
 			}
 
 		} else
@@ -1211,7 +1420,7 @@ void BinkDecoder::BinkVideoTrack::readDCS(VideoFrame &video, Bundle &bundle) {
 }
 
 /** Reads 8x8 block of DCT coefficients. */
-void BinkDecoder::BinkVideoTrack::readDCTCoeffs(VideoFrame &video, int32 *block, bool isIntra) {
+void BinkDecoder::BinkVideoTrack::readDCTCoeffs(DecodeContext &ctx, int32 *block, bool isIntra) {
 	int coefCount = 0;
 	int coefIdx[64];
 
@@ -1226,13 +1435,13 @@ void BinkDecoder::BinkVideoTrack::readDCTCoeffs(VideoFrame &video, int32 *block,
 	coefList[listEnd] = 2;  modeList[listEnd++] = 3;
 	coefList[listEnd] = 3;  modeList[listEnd++] = 3;
 
-	int bits = video.bits->getBits<4>() - 1;
+	int bits = ctx.bits->getBits<4>() - 1;
 	for (int mask = bits >= 0 ? 1 << bits : 0; bits >= 0; mask >>= 1, bits--) {
 		int listPos = listStart;
 
 		while (listPos < listEnd) {
 
-			if (!(modeList[listPos] | coefList[listPos]) || !video.bits->getBit()) {
+			if (!(modeList[listPos] | coefList[listPos]) || !ctx.bits->getBit()) {
 				listPos++;
 				continue;
 			}
@@ -1251,17 +1460,17 @@ void BinkDecoder::BinkVideoTrack::readDCTCoeffs(VideoFrame &video, int32 *block,
 					modeList[listPos++] = 0;
 				}
 				for (int i = 0; i < 4; i++, ccoef++) {
-					if (video.bits->getBit()) {
+					if (ctx.bits->getBit()) {
 						coefList[--listStart] = ccoef;
 						modeList[  listStart] = 3;
 					} else {
 						int t;
 						if (!bits) {
-							t = 1 - (video.bits->getBit() << 1);
+							t = 1 - (ctx.bits->getBit() << 1);
 						} else {
-							t = video.bits->getBits(bits) | mask;
+							t = ctx.bits->getBits(bits) | mask;
 
-							int sign = -(int)video.bits->getBit();
+							int sign = -(int)ctx.bits->getBit();
 							t = (t ^ sign) - sign;
 						}
 						block[binkScan[ccoef]] = t;
@@ -1282,11 +1491,11 @@ void BinkDecoder::BinkVideoTrack::readDCTCoeffs(VideoFrame &video, int32 *block,
 			case 3:
 				int t;
 				if (!bits) {
-					t = 1 - (video.bits->getBit() << 1);
+					t = 1 - (ctx.bits->getBit() << 1);
 				} else {
-					t = video.bits->getBits(bits) | mask;
+					t = ctx.bits->getBits(bits) | mask;
 
-					int sign = -(int)video.bits->getBit();
+					int sign = -(int)ctx.bits->getBit();
 					t = (t ^ sign) - sign;
 				}
 				block[binkScan[ccoef]] = t;
@@ -1301,7 +1510,7 @@ void BinkDecoder::BinkVideoTrack::readDCTCoeffs(VideoFrame &video, int32 *block,
 		}
 	}
 
-	uint8 quantIdx = video.bits->getBits<4>();
+	uint8 quantIdx = ctx.bits->getBits<4>();
 	const int32 *quant = isIntra ? binkIntraQuant[quantIdx] : binkInterQuant[quantIdx];
 	block[0] = (block[0] * quant[0]) >> 11;
 
@@ -1313,7 +1522,7 @@ void BinkDecoder::BinkVideoTrack::readDCTCoeffs(VideoFrame &video, int32 *block,
 }
 
 /** Reads 8x8 block with residue after motion compensation. */
-void BinkDecoder::BinkVideoTrack::readResidue(VideoFrame &video, int16 *block, int masksCount) {
+void BinkDecoder::BinkVideoTrack::readResidue(DecodeContext &ctx, int16 *block, int masksCount) {
 	int nzCoeff[64];
 	int nzCoeffCount = 0;
 
@@ -1326,10 +1535,10 @@ void BinkDecoder::BinkVideoTrack::readResidue(VideoFrame &video, int16 *block, i
 	coefList[listEnd] = 44; modeList[listEnd++] = 0;
 	coefList[listEnd] =  0; modeList[listEnd++] = 2;
 
-	for (int mask = 1 << video.bits->getBits<3>(); mask; mask >>= 1) {
+	for (int mask = 1 << ctx.bits->getBits<3>(); mask; mask >>= 1) {
 
 		for (int i = 0; i < nzCoeffCount; i++) {
-			if (!video.bits->getBit())
+			if (!ctx.bits->getBit())
 				continue;
 			if (block[nzCoeff[i]] < 0)
 				block[nzCoeff[i]] -= mask;
@@ -1343,7 +1552,7 @@ void BinkDecoder::BinkVideoTrack::readResidue(VideoFrame &video, int16 *block, i
 		int listPos = listStart;
 		while (listPos < listEnd) {
 
-			if (!(coefList[listPos] | modeList[listPos]) || !video.bits->getBit()) {
+			if (!(coefList[listPos] | modeList[listPos]) || !ctx.bits->getBit()) {
 				listPos++;
 				continue;
 			}
@@ -1363,13 +1572,13 @@ void BinkDecoder::BinkVideoTrack::readResidue(VideoFrame &video, int16 *block, i
 				}
 
 				for (int i = 0; i < 4; i++, ccoef++) {
-					if (video.bits->getBit()) {
+					if (ctx.bits->getBit()) {
 						coefList[--listStart] = ccoef;
 						modeList[  listStart] = 3;
 					} else {
 						nzCoeff[nzCoeffCount++] = binkScan[ccoef];
 
-						int sign = -(int)video.bits->getBit();
+						int sign = -(int)ctx.bits->getBit();
 						block[binkScan[ccoef]] = (mask ^ sign) - sign;
 
 						masksCount--;
@@ -1392,7 +1601,7 @@ void BinkDecoder::BinkVideoTrack::readResidue(VideoFrame &video, int16 *block, i
 				{
 					nzCoeff[nzCoeffCount++] = binkScan[ccoef];
 
-					int sign = -(int)video.bits->getBit();
+					int sign = -(int)ctx.bits->getBit();
 					block[binkScan[ccoef]] = (mask ^ sign) - sign;
 
 					coefList[listPos]   = 0;
@@ -1410,88 +1619,6 @@ void BinkDecoder::BinkVideoTrack::readResidue(VideoFrame &video, int16 *block, i
 	}
 }
 
-#define A1  2896 /* (1/sqrt(2))<<12 */
-#define A2  2217
-#define A3  3784
-#define A4 -5352
-
-#define IDCT_TRANSFORM(dest,s0,s1,s2,s3,s4,s5,s6,s7,d0,d1,d2,d3,d4,d5,d6,d7,munge,src) {\
-	const int a0 = (src)[s0] + (src)[s4]; \
-	const int a1 = (src)[s0] - (src)[s4]; \
-	const int a2 = (src)[s2] + (src)[s6]; \
-	const int a3 = (A1*((src)[s2] - (src)[s6])) >> 11; \
-	const int a4 = (src)[s5] + (src)[s3]; \
-	const int a5 = (src)[s5] - (src)[s3]; \
-	const int a6 = (src)[s1] + (src)[s7]; \
-	const int a7 = (src)[s1] - (src)[s7]; \
-	const int b0 = a4 + a6; \
-	const int b1 = (A3*(a5 + a7)) >> 11; \
-	const int b2 = ((A4*a5) >> 11) - b0 + b1; \
-	const int b3 = (A1*(a6 - a4) >> 11) - b2; \
-	const int b4 = ((A2*a7) >> 11) + b3 - b1; \
-	(dest)[d0] = munge(a0+a2   +b0); \
-	(dest)[d1] = munge(a1+a3-a2+b2); \
-	(dest)[d2] = munge(a1-a3+a2+b3); \
-	(dest)[d3] = munge(a0-a2   -b4); \
-	(dest)[d4] = munge(a0-a2   +b4); \
-	(dest)[d5] = munge(a1-a3+a2-b3); \
-	(dest)[d6] = munge(a1+a3-a2-b2); \
-	(dest)[d7] = munge(a0+a2   -b0); \
-}
-/* end IDCT_TRANSFORM macro */
-
-#define MUNGE_NONE(x) (x)
-#define IDCT_COL(dest,src) IDCT_TRANSFORM(dest,0,8,16,24,32,40,48,56,0,8,16,24,32,40,48,56,MUNGE_NONE,src)
-
-#define MUNGE_ROW(x) (((x) + 0x7F)>>8)
-#define IDCT_ROW(dest,src) IDCT_TRANSFORM(dest,0,1,2,3,4,5,6,7,0,1,2,3,4,5,6,7,MUNGE_ROW,src)
-
-static inline void IDCTCol(int32 *dest, const int32 *src) {
-	if ((src[8] | src[16] | src[24] | src[32] | src[40] | src[48] | src[56]) == 0) {
-		dest[ 0] =
-		dest[ 8] =
-		dest[16] =
-		dest[24] =
-		dest[32] =
-		dest[40] =
-		dest[48] =
-		dest[56] = src[0];
-	} else {
-		IDCT_COL(dest, src);
-	}
-}
-
-void BinkDecoder::BinkVideoTrack::IDCT(int32 *block) {
-	int i;
-	int32 temp[64];
-
-	for (i = 0; i < 8; i++)
-		IDCTCol(&temp[i], &block[i]);
-	for (i = 0; i < 8; i++) {
-		IDCT_ROW( (&block[8*i]), (&temp[8*i]) );
-	}
-}
-
-void BinkDecoder::BinkVideoTrack::IDCTAdd(DecodeContext &ctx, int32 *block) {
-	int i, j;
-
-	IDCT(block);
-	byte *dest = ctx.dest;
-	for (i = 0; i < 8; i++, dest += ctx.pitch, block += 8)
-		for (j = 0; j < 8; j++)
-			 dest[j] += block[j];
-}
-
-void BinkDecoder::BinkVideoTrack::IDCTPut(DecodeContext &ctx, int32 *block) {
-	int i;
-	int32 temp[64];
-	for (i = 0; i < 8; i++)
-		IDCTCol(&temp[i], &block[i]);
-	for (i = 0; i < 8; i++) {
-		IDCT_ROW( (&ctx.dest[i*ctx.pitch]), (&temp[8*i]) );
-	}
-}
-
 BinkDecoder::BinkAudioTrack::BinkAudioTrack(BinkDecoder::AudioInfo &audio, Audio::Mixer::SoundType soundType) :
 		AudioTrack(soundType),
 		_audioInfo(&audio) {
@@ -58,6 +58,8 @@ namespace Graphics {
 struct Surface;
 }
 
+class BinkTestSuite;
+
 namespace Video {
 
 /**
@@ -76,6 +78,19 @@ public:
 
 	Common::Rational getFrameRate();
 
+	/**
+	 * Decode the plane groups of BIKi videos in parallel, when the backend
+	 * runs jobs on several threads. Must be called before loadStream().
+	 *
+	 * BIKi packets store an offset ahead of each plane group, but what it
+	 * is relative to is not documented. The ways of reading it which match
+	 * the planes decoded in order are used for the following frames, and
+	 * the planes are decoded in order again as soon as they do not match.
+	 * This is off by default, and should only be enabled for videos it was
+	 * checked on.
+	 */
+	void setParallelPlaneDecoding(bool enable) { _parallelPlanes = enable; }
+
 protected:
 	void readNextPacket();
 	bool supportsAudioTrackSwitching() const { return true; }
@@ -140,6 +155,8 @@ private:
 		uint32 size;
 
 		Common::BitStream32LELSB *bits;
+		const byte *data; ///< The video packet, which bits reads from.
+		uint32 dataSize;
 
 		VideoFrame();
 		~VideoFrame();
@@ -147,7 +164,7 @@ private:
 
 	class BinkVideoTrack : public FixedRateVideoTrack {
 	public:
-		BinkVideoTrack(uint32 width, uint32 height, uint32 frameCount, const Common::Rational &frameRate, bool swapPlanes, bool hasAlpha, uint32 id);
+		BinkVideoTrack(uint32 width, uint32 height, uint32 frameCount, const Common::Rational &frameRate, bool swapPlanes, bool hasAlpha, uint32 id, bool parallelPlanes = false);
 		~BinkVideoTrack();
 
 		uint16 getWidth() const override { return _width; }
@@ -168,30 +185,6 @@ private:
 		Common::Rational getFrameRate() const override { return _frameRate; }
 
 	private:
-		/** A decoder state. */
-		struct DecodeContext {
-			VideoFrame *video;
-
-			uint32 planeIdx;
-
-			uint32 blockX;
-			uint32 blockY;
-
-			byte *dest;
-			byte *prev;
-
-			byte *destStart, *destEnd;
-			byte *prevStart, *prevEnd;
-
-			uint32 pitch;
-
-			int coordMap[64];
-			int coordScaledMap1[64];
-			int coordScaledMap2[64];
-			int coordScaledMap3[64];
-			int coordScaledMap4[64];
-		};
-
 		/** IDs for different data types used in Bink video codec. */
 		enum Source {
 			kSourceBlockTypes    = 0, ///< 8x8 block types.
@@ -241,6 +234,76 @@ private:
 			byte *curPtr; ///< Pointer to the data that wasn't yet read.
 		};
 
+		/** A decoder state. */
+		struct DecodeContext {
+			Common::BitStream32LELSB *bits;
+			Bundle *bundles;
+
+			/** Huffman codebooks to use for decoding high nibbles in color data types. */
+			Huffman colHighHuffman[16];
+			/** Value of the last decoded high nibble in color data types. */
+			int colLastVal;
+
+			uint32 planeIdx;
+
+			uint32 blockX;
+			uint32 blockY;
+
+			byte *dest;
+			byte *prev;
+
+			byte *destStart, *destEnd;
+			byte *prevStart, *prevEnd;
+
+			uint32 pitch;
+
+			int coordMap[64];
+			int coordScaledMap1[64];
+			int coordScaledMap2[64];
+			int coordScaledMap3[64];
+			int coordScaledMap4[64];
+
+			/** Whether invalid data fails the decode instead of being fatal. */
+			bool speculative;
+			/** Set when a speculative decode ran into invalid data. */
+			bool failed;
+		};
+
+		/**
+		 * Groups of planes which are decoded one after the other. In BIKi
+		 * frames, the alpha and luma groups start with their offset.
+		 */
+		enum PlaneGroup {
+			kPlaneGroupAlpha = 0,
+			kPlaneGroupLuma     ,
+			kPlaneGroupChroma   ,
+
+			kPlaneGroupMAX
+		};
+
+		/** The ways to read a BIKi plane offset, as a bit mask. */
+		enum PlaneOffsetMode {
+			kPlaneOffsetFromPacket = 1 << 0, ///< Bytes from the start of the video packet.
+			kPlaneOffsetFromOffset = 1 << 1, ///< Bytes from the start of the offset.
+			kPlaneOffsetFromPlanes = 1 << 2, ///< Bytes from the end of the offset.
+
+			kPlaneOffsetAll = 7
+		};
+
+		/** The plane groups of a BIKi frame, decoded by runParallel(). */
+		struct PlaneGroupJobs {
+			BinkVideoTrack *track;
+
+			const byte *data;
+			uint32 dataSize;
+
+			PlaneGroup groups[kPlaneGroupMAX];
+			uint32 start[kPlaneGroupMAX]; ///< In bits, at a 32-bit boundary.
+			uint32 end[kPlaneGroupMAX];   ///< As predicted by the plane offsets.
+			uint32 decodedEnd[kPlaneGroupMAX];
+			bool failed[kPlaneGroupMAX];  ///< The data was invalid.
+		};
+
 		int _curFrame;
 		int _frameCount;
 
@@ -258,14 +321,15 @@ private:
 
 		Common::Rational _frameRate;
 
-		Bundle _bundles[kSourceMAX]; ///< Bundles for decoding all data types.
+		/** Bundles for decoding all data types, for each plane group decoded in parallel. */
+		Bundle _bundles[kPlaneGroupMAX][kSourceMAX];
+		int _bundleSets; ///< Number of allocated sets of bundles.
+		bool _parallelPlanes; ///< Were the plane groups allowed to be decoded in parallel?
 
-		Common::Huffman<Common::BitStream32LELSB> *_huffman[16]; ///< The 16 Huffman codebooks used in Bink decoding.
+		/** The plane offset modes which matched the last frame decoded in order. */
+		uint32 _planeOffsetModes;
 
-		/** Huffman codebooks to use for decoding high nibbles in color data types. */
-		Huffman _colHighHuffman[16];
-		/** Value of the last decoded high nibble in color data types. */
-		int _colLastVal;
+		Common::Huffman<Common::BitStream32LELSB> *_huffman[16]; ///< The 16 Huffman codebooks used in Bink decoding.
 
 		uint32 _yBlockWidth;   ///< Width of the Y plane in blocks
 		uint32 _yBlockHeight;  ///< Height of the Y plane in blocks
@@ -283,24 +347,45 @@ private:
 		/** Initialize the Huffman decoders. */
 		void initHuffman();
 
-		/** Decode a plane. */
-		void decodePlane(VideoFrame &video, int planeIdx, bool isChroma);
+		/** Decode all planes of a frame, one after the other. */
+		void decodePlanes(Common::BitStream32LELSB &bits);
+		/** Decode the plane groups of a BIKi frame in parallel, if their offsets are known to be right. */
+		bool decodePlanesInParallel(VideoFrame &frame);
+		static void decodePlaneGroupJob(void *data, int job);
+
+		/**
+		 * Decode the planes of a group.
+		 *
+		 * A speculative decode returns false on invalid data, which is
+		 * otherwise fatal.
+		 */
+		bool decodePlaneGroup(Common::BitStream32LELSB &bits, Bundle *bundles, PlaneGroup group, bool speculative);
+		/** Decode a plane, see decodePlaneGroup(). */
+		bool decodePlane(Common::BitStream32LELSB &bits, Bundle *bundles, int planeIdx, bool isChroma, bool speculative);
+
+		/** Report invalid data. Fails the decode if it is speculative, and errors out otherwise. */
+		void decodeError(DecodeContext &ctx, const char *s, ...) GCC_PRINTF(3, 4);
+		/** Report invalid data the caller can skip. Fails the decode if it is speculative, and warns otherwise. */
+		void decodeWarning(DecodeContext &ctx, const char *s, ...) GCC_PRINTF(3, 4);
+
+		/** Get the end of the planes following a BIKi plane offset. */
+		static uint32 getPlaneEnd(PlaneOffsetMode mode, uint32 offsetPos, uint32 offset);
 
 		/** Read/Initialize a bundle for decoding a plane. */
-		void readBundle(VideoFrame &video, Source source);
+		void readBundle(DecodeContext &ctx, Source source);
 
 		/** Read the symbols for a Huffman code. */
-		void readHuffman(VideoFrame &video, Huffman &huffman);
+		void readHuffman(DecodeContext &ctx, Huffman &huffman);
 		/** Merge two Huffman symbol lists. */
-		void mergeHuffmanSymbols(VideoFrame &video, byte *dst, const byte *src, int size);
+		void mergeHuffmanSymbols(DecodeContext &ctx, byte *dst, const byte *src, int size);
 
 		/** Read and translate a symbol out of a Huffman code. */
-		byte getHuffmanSymbol(VideoFrame &video, Huffman &huffman);
+		byte getHuffmanSymbol(DecodeContext &ctx, Huffman &huffman);
 
 		/** Get a direct value out of a bundle. */
-		int32 getBundleValue(Source source);
+		int32 getBundleValue(DecodeContext &ctx, Source source);
 		/** Read a count value out of a bundle. */
-		uint32 readBundleCount(VideoFrame &video, Bundle &bundle);
+		uint32 readBundleCount(DecodeContext &ctx, Bundle &bundle);
 
 		// Handle the block types
 		void blockSkip         (DecodeContext &ctx);
@@ -321,20 +406,17 @@ private:
 		void blockRaw          (DecodeContext &ctx);
 
 		// Read the bundles
-		void readRuns        (VideoFrame &video, Bundle &bundle);
-		void readMotionValues(VideoFrame &video, Bundle &bundle);
-		void readBlockTypes  (VideoFrame &video, Bundle &bundle);
-		void readPatterns    (VideoFrame &video, Bundle &bundle);
-		void readColors      (VideoFrame &video, Bundle &bundle);
+		void readRuns        (DecodeContext &ctx, Bundle &bundle);
+		void readMotionValues(DecodeContext &ctx, Bundle &bundle);
+		void readBlockTypes  (DecodeContext &ctx, Bundle &bundle);
+		void readPatterns    (DecodeContext &ctx, Bundle &bundle);
+		void readColors      (DecodeContext &ctx, Bundle &bundle);
 		template<int startBits, bool hasSign>
-		void readDCS         (VideoFrame &video, Bundle &bundle);
-		void readDCTCoeffs   (VideoFrame &video, int32 *block, bool isIntra);
-		void readResidue     (VideoFrame &video, int16 *block, int masksCount);
-
-		// Bink video IDCT
-		void IDCT(int32 *block);
-		void IDCTPut(DecodeContext &ctx, int32 *block);
-		void IDCTAdd(DecodeContext &ctx, int32 *block);
+		void readDCS         (DecodeContext &ctx, Bundle &bundle);
+		void readDCTCoeffs   (DecodeContext &ctx, int32 *block, bool isIntra);
+		void readResidue     (DecodeContext &ctx, int16 *block, int masksCount);
+
+		friend class ::BinkTestSuite;
 	};
 
 	class BinkAudioTrack : public AudioTrack {
@@ -372,11 +454,14 @@ private:
 	};
 
 	Common::SeekableReadStream *_bink;
+	bool _parallelPlanes;
 
 	Common::Array<AudioInfo> _audioTracks; ///< All audio tracks.
 	Common::Array<VideoFrame> _frames;      ///< All video frames.
 
 	void initAudioTrack(AudioInfo &audio);
+
+	friend class ::BinkTestSuite;
 };
 
 } // End of namespace Video
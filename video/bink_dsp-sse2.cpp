@@ -0,0 +1,149 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+#include <immintrin.h>
+
+#include "video/bink_dsp.h"
+
+namespace Video {
+
+// The low 32 bits of the products, as there is no pmulld before SSE4.1
+static FORCEINLINE __m128i sse2_mulConst(__m128i a, int32 c) {
+	const __m128i k = _mm_set1_epi32(c);
+	__m128i even = _mm_shuffle_epi32(_mm_mul_epu32(a, k), _MM_SHUFFLE(0, 0, 2, 0));
+	__m128i odd = _mm_shuffle_epi32(_mm_mul_epu32(_mm_srli_epi64(a, 32), k), _MM_SHUFFLE(0, 0, 2, 0));
+	return _mm_unpacklo_epi32(even, odd);
+}
+
+static FORCEINLINE __m128i sse2_mulShift(__m128i a, int32 c) {
+	return _mm_srai_epi32(sse2_mulConst(a, c), 11);
+}
+
+static FORCEINLINE void sse2_transpose(__m128i &r0, __m128i &r1, __m128i &r2, __m128i &r3) {
+	__m128i t0 = _mm_unpacklo_epi32(r0, r1);
+	__m128i t1 = _mm_unpacklo_epi32(r2, r3);
+	__m128i t2 = _mm_unpackhi_epi32(r0, r1);
+	__m128i t3 = _mm_unpackhi_epi32(r2, r3);
+	r0 = _mm_unpacklo_epi64(t0, t1);
+	r1 = _mm_unpackhi_epi64(t0, t1);
+	r2 = _mm_unpacklo_epi64(t2, t3);
+	r3 = _mm_unpackhi_epi64(t2, t3);
+}
+
+// IDCT_TRANSFORM from bink_dsp.cpp on four columns or rows at once
+static FORCEINLINE void sse2_idctTransform(__m128i *d, const __m128i *s) {
+	const __m128i a0 = _mm_add_epi32(s[0], s[4]);
+	const __m128i a1 = _mm_sub_epi32(s[0], s[4]);
+	const __m128i a2 = _mm_add_epi32(s[2], s[6]);
+	const __m128i a3 = sse2_mulShift(_mm_sub_epi32(s[2], s[6]), 2896);
+	const __m128i a4 = _mm_add_epi32(s[5], s[3]);
+	const __m128i a5 = _mm_sub_epi32(s[5], s[3]);
+	const __m128i a6 = _mm_add_epi32(s[1], s[7]);
+	const __m128i a7 = _mm_sub_epi32(s[1], s[7]);
+	const __m128i b0 = _mm_add_epi32(a4, a6);
+	const __m128i b1 = sse2_mulShift(_mm_add_epi32(a5, a7), 3784);
+	const __m128i b2 = _mm_add_epi32(_mm_sub_epi32(sse2_mulShift(a5, -5352), b0), b1);
+	const __m128i b3 = _mm_sub_epi32(sse2_mulShift(_mm_sub_epi32(a6, a4), 2896), b2);
+	const __m128i b4 = _mm_sub_epi32(_mm_add_epi32(sse2_mulShift(a7, 2217), b3), b1);
+	const __m128i c0 = _mm_add_epi32(a0, a2);
+	const __m128i c1 = _mm_sub_epi32(_mm_add_epi32(a1, a3), a2);
+	const __m128i c2 = _mm_add_epi32(_mm_sub_epi32(a1, a3), a2);
+	const __m128i c3 = _mm_sub_epi32(a0, a2);
+	d[0] = _mm_add_epi32(c0, b0);
+	d[1] = _mm_add_epi32(c1, b2);
+	d[2] = _mm_add_epi32(c2, b3);
+	d[3] = _mm_sub_epi32(c3, b4);
+	d[4] = _mm_add_epi32(c3, b4);
+	d[5] = _mm_sub_epi32(c2, b3);
+	d[6] = _mm_sub_epi32(c1, b2);
+	d[7] = _mm_sub_epi32(c0, b0);
+}
+
+// Transform the block, and pack each row of the result to bytes
+static FORCEINLINE void sse2_idct(__m128i *rows, const int32 *block) {
+	__m128i s[8], d[8], temp[16];
+
+	// The columns, four at a time. Row k ends up in temp[k * 2 + half].
+	for (int h = 0; h < 2; h++) {
+		for (int k = 0; k < 8; k++)
+			s[k] = _mm_loadu_si128((const __m128i *)(block + k * 8 + h * 4));
+		sse2_idctTransform(d, s);
+		for (int k = 0; k < 8; k++)
+			temp[k * 2 + h] = d[k];
+	}
+
+	// The rows, four at a time after transposing them to columns
+	for (int r = 0; r < 2; r++) {
+		for (int h = 0; h < 2; h++) {
+			s[h * 4 + 0] = temp[(r * 4 + 0) * 2 + h];
+			s[h * 4 + 1] = temp[(r * 4 + 1) * 2 + h];
+			s[h * 4 + 2] = temp[(r * 4 + 2) * 2 + h];
+			s[h * 4 + 3] = temp[(r * 4 + 3) * 2 + h];
+			sse2_transpose(s[h * 4 + 0], s[h * 4 + 1], s[h * 4 + 2], s[h * 4 + 3]);
+		}
+		sse2_idctTransform(d, s);
+		for (int k = 0; k < 8; k++)
+			d[k] = _mm_srai_epi32(_mm_add_epi32(d[k], _mm_set1_epi32(0x7F)), 8);
+		sse2_transpose(d[0], d[1], d[2], d[3]);
+		sse2_transpose(d[4], d[5], d[6], d[7]);
+
+		// Storing to a byte keeps the low 8 bits, rather than saturating
+		const __m128i mask = _mm_set1_epi32(0xFF);
+		for (int i = 0; i < 4; i++) {
+			__m128i row = _mm_packs_epi32(_mm_and_si128(d[i], mask), _mm_and_si128(d[i + 4], mask));
+			rows[r * 4 + i] = _mm_packus_epi16(row, row);
+		}
+	}
+}
+
+void BinkDSP::idctPutSSE2(byte *dest, uint pitch, int32 *block) {
+	__m128i rows[8];
+	sse2_idct(rows, block);
+
+	for (int i = 0; i < 8; i++, dest += pitch)
+		_mm_storel_epi64((__m128i *)dest, rows[i]);
+}
+
+void BinkDSP::idctAddSSE2(byte *dest, uint pitch, int32 *block) {
+	__m128i rows[8];
+	sse2_idct(rows, block);
+
+	for (int i = 0; i < 8; i++, dest += pitch)
+		_mm_storel_epi64((__m128i *)dest, _mm_add_epi8(_mm_loadl_epi64((const __m128i *)dest), rows[i]));
+}
+
+void BinkDSP::scaleSSE2(byte *dest, uint pitch, const byte *src) {
+	for (int j = 0; j < 8; j++, dest += pitch << 1, src += 8) {
+		__m128i row = _mm_loadl_epi64((const __m128i *)src);
+		row = _mm_unpacklo_epi8(row, row);
+		_mm_storeu_si128((__m128i *)dest, row);
+		_mm_storeu_si128((__m128i *)(dest + pitch), row);
+	}
+}
+
+const BinkDSP::Functions BinkDSP::sse2Functions = {
+	idctPutSSE2,
+	idctAddSSE2,
+	scaleSSE2
+};
+
+} // End of namespace Video
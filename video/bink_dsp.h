@@ -0,0 +1,81 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef VIDEO_BINK_DSP_H
+#define VIDEO_BINK_DSP_H
+
+#include "common/scummsys.h"
+
+class BinkTestSuite;
+
+namespace Video {
+
+/**
+ * The pixel processing of the Bink video decoder.
+ *
+ * The functions dispatch at runtime to SSE2 versions when the CPU supports
+ * them, in the same way as BlendBlit does. All versions give exactly the
+ * same result.
+ */
+class BinkDSP {
+public:
+	/**
+	 * Apply the inverse DCT to an 8x8 block of coefficients and write the
+	 * result to the pixels. The block is used as scratch space.
+	 */
+	static void idctPut(byte *dest, uint pitch, int32 *block);
+
+	/**
+	 * Apply the inverse DCT to an 8x8 block of coefficients and add the
+	 * result to the pixels. The block is used as scratch space.
+	 */
+	static void idctAdd(byte *dest, uint pitch, int32 *block);
+
+	/** Scale a packed 8x8 block of pixels to 16x16 by doubling each pixel. */
+	static void scale(byte *dest, uint pitch, const byte *src);
+
+private:
+	struct Functions {
+		void (*idctPut)(byte *dest, uint pitch, int32 *block);
+		void (*idctAdd)(byte *dest, uint pitch, int32 *block);
+		void (*scale)(byte *dest, uint pitch, const byte *src);
+	};
+
+	static const Functions *getFunctions();
+
+	static void idctPutGeneric(byte *dest, uint pitch, int32 *block);
+	static void idctAddGeneric(byte *dest, uint pitch, int32 *block);
+	static void scaleGeneric(byte *dest, uint pitch, const byte *src);
+	static const Functions genericFunctions;
+#ifdef SCUMMVM_SSE2
+	static void idctPutSSE2(byte *dest, uint pitch, int32 *block);
+	static void idctAddSSE2(byte *dest, uint pitch, int32 *block);
+	static void scaleSSE2(byte *dest, uint pitch, const byte *src);
+	static const Functions sse2Functions;
+#endif
+
+	static const Functions *functions;
+	friend class ::BinkTestSuite;
+};
+
+} // End of namespace Video
+
+#endif